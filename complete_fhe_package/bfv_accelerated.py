@@ -25,8 +25,7 @@ class BFVSchemeAccelerated(BaseBFVScheme):
             try:
                 # Find an NTT-friendly prime (q = 1 mod 2N)
                 # The C++ backend strictly requires this.
-                target_q = 1 << q_bits
-                self.q = self._find_ntt_prime(target_q, N)
+                self.q = fhe_fast_mult.find_ntt_prime(N, q_bits)
 
                 # 3. Update dependent parameters with new q
                 self.poly_ring = PolynomialRing(N, self.q)
@@ -42,22 +41,6 @@ class BFVSchemeAccelerated(BaseBFVScheme):
                 print("  Falling back to Pure Python (slow but working)")
                 self.use_cpp = False
 
-    def _find_ntt_prime(self, start_q, N):
-        """Find a prime q satisfying q = 1 mod 2N"""
-        m = 2 * N
-        # Start search from start_q, ensuring alignment with m
-        q = (start_q // m) * m + 1
-
-        def is_prime(n):
-            if n % 2 == 0: return False
-            for i in range(3, int(n**0.5) + 1, 2):
-                if n % i == 0: return False
-            return True
-
-        while not is_prime(q):
-            q += m
-        return q
-
     def multiply(self, ct1, ct2):
         """
         Use C++ for the heavy O(N^2) Multiplication
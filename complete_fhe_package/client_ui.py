@@ -1,12 +1,12 @@
 # client_ui.py
 import streamlit as st
 import requests
-import pickle
 import time
 from example_accelerated import BFVSchemeAccelerated
+from custom_fhe import serialization
 
 # CONFIG
-SERVER_URL = "http://localhost:8000/search"  # Change this to your Cloud URL later
+SERVER_URL = "http://localhost:8000"  # Change this to your Cloud URL later
 
 st.title("🔒 Private Database Search")
 st.write("Upload your encrypted data. The server will process it blindly.")
@@ -23,9 +23,11 @@ if st.button("Generate & Encrypt Dummy Data"):
         data = [{"id": i, "date": st.session_state.fhe.encrypt_int(20260201 + i)} for i in range(10)]
         target = [st.session_state.fhe.encrypt_int(20260205)]  # Looking for Feb 5th
 
-        # Save to session
-        st.session_state.enc_db = pickle.dumps(data)
-        st.session_state.enc_query = pickle.dumps(target)
+        # Save to session; row i of the batch is the record with id i
+        fhe = st.session_state.fhe
+        st.session_state.enc_db = serialization.dumps([row["date"] for row in data], fhe.N, fhe.q, fhe.t)
+        st.session_state.enc_query = serialization.dumps(target, fhe.N, fhe.q, fhe.t)
+        st.session_state.num_queries = len(target)
         st.success("Data Encrypted! Keys remain on this machine.")
 
 # 3. UPLOAD TO SERVER
@@ -33,29 +35,36 @@ if 'enc_db' in st.session_state:
     st.write("---")
     st.write("### ☁️ Server Interaction")
 
+    if st.button("Upload Database"):
+        # Once per database: the server keeps it in its memory-mapped store
+        with st.spinner("Uploading encrypted database..."):
+            response = requests.post(SERVER_URL + "/db", files={'date_file': st.session_state.enc_db})
+        if response.status_code == 200:
+            st.success(f"Database stored ({response.json()['rows']} rows)")
+        else:
+            st.error("Upload failed")
+
     if st.button("Send to Secure Server"):
-        files = {
-            'db_file': st.session_state.enc_db,
-            'query_file': st.session_state.enc_query
-        }
+        files = {'query_file': st.session_state.enc_query}
 
         with st.spinner("Server is processing (Homomorphic Search)..."):
-            response = requests.post(SERVER_URL, files=files)
+            response = requests.post(SERVER_URL + "/search", files=files, data={'column': 'date'})
 
         if response.status_code == 200:
             st.success("Results Received!")
-            encrypted_results = pickle.loads(response.content)
+            diffs, _ = serialization.loads(response.content)
+            k = st.session_state.num_queries
 
             # 4. DECRYPTION (Happens Locally)
             st.write("### 🔓 Decrypted Results")
-            for res in encrypted_results:
+            for row_id in range(len(diffs) // k):
                 # Decrypt logic (simplified)
                 is_match = False
-                for diff in res['diffs']:
+                for diff in diffs[row_id * k:(row_id + 1) * k]:
                     val = st.session_state.fhe.decrypt_batch(diff, num=1)[0]
                     if val == 0: is_match = True
 
                 if is_match:
-                    st.write(f"✅ Match Found at Row ID: {res['id']}")
+                    st.write(f"✅ Match Found at Row ID: {row_id}")
         else:
             st.error("Server Error")
\ No newline at end of file
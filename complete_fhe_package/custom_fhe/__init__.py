@@ -9,6 +9,7 @@ Now with C++ Accelerated Multiplication!
 from .bfv_scheme import BFVScheme
 from .ciphertext import Ciphertext, Plaintext
 from .keys import PublicKey, SecretKey, RelinearizationKey, RotationKey
+from .noise import NoiseEstimator, select_parameters
 
 # Try to import accelerated version
 try:
@@ -22,7 +23,9 @@ try:
         'PublicKey',
         'SecretKey',
         'RelinearizationKey',
-        'RotationKey'
+        'RotationKey',
+        'NoiseEstimator',
+        'select_parameters'
     ]
 except ImportError:
     # Accelerated version not available (C++ not built)
@@ -33,7 +36,9 @@ except ImportError:
         'PublicKey',
         'SecretKey',
         'RelinearizationKey',
-        'RotationKey'
+        'RotationKey',
+        'NoiseEstimator',
+        'select_parameters'
     ]
 
 __version__ = "2.0.0"  # Updated with C++ acceleration
@@ -5,7 +5,10 @@ Integrates NTT-based multiplication from C++ backend
 
 import numpy as np
 from custom_fhe.bfv_scheme import BFVScheme as BaseBFVScheme
-from custom_fhe.ciphertext import Ciphertext
+from custom_fhe.ciphertext import Ciphertext, Plaintext
+from custom_fhe import eval_form
+from custom_fhe.noise import NoiseEstimator
+from custom_fhe.keys import PublicKey, SecretKey, RelinearizationKey, RotationKey
 
 try:
     import fhe_fast_mult
@@ -32,20 +35,35 @@ class BFVSchemeAccelerated(BaseBFVScheme):
         super().__init__(N, t, q_bits, sigma)
         
         self.use_cpp = use_cpp and CPP_AVAILABLE
+
+        # Key objects last loaded into the C++ encryptor
+        self._cpp_secret_key = None
+        self._cpp_public_key = None
+        self.rotation_key = None
+        self.batch_encoder = None
         
         if self.use_cpp:
-            # Find NTT-friendly prime
-            self.q_ntt = fhe_fast_mult.find_ntt_prime(N)
+            # Largest NTT-friendly prime below 2^q_bits (Miller-Rabin, in C++)
+            self.q_ntt = fhe_fast_mult.find_ntt_prime(N, q_bits)
             
-            # Initialize C++ multiplier
+            # Initialize C++ objects; all three share one set of NTT tables via the registry
             try:
                 self.cpp_mult = fhe_fast_mult.BFVMultiplier(N, self.q_ntt, t)
                 self.cpp_ntt = fhe_fast_mult.NTT(N, self.q_ntt)
+                self.cpp_enc = fhe_fast_mult.BFVEncryptor(N, self.q_ntt, t, sigma)
+                # Plaintext operands, encoded once per distinct value (LRU)
+                self.cpp_plain = fhe_fast_mult.PlaintextEvaluator(N, self.q_ntt, t)
                 
                 # Update q to NTT-friendly value
                 self.q = self.q_ntt
                 self.poly_ring.q = self.q_ntt
                 self.delta = self.q // self.t
+
+                # Slot batching needs a prime t = 1 (mod 2N), e.g. 65537 for N <= 32768
+                try:
+                    self.batch_encoder = fhe_fast_mult.BatchEncoder(N, t)
+                except ValueError:
+                    self.batch_encoder = None
                 
                 print(f"✓ C++ accelerated multiplication enabled")
                 print(f"  N={N}, q={self.q_ntt}, t={t}")
@@ -54,60 +72,535 @@ class BFVSchemeAccelerated(BaseBFVScheme):
                 print(f"⚠ C++ initialization failed: {e}")
                 print(f"  Falling back to Python implementation")
                 self.use_cpp = False
+
+        # Analytical noise bounds, carried on every ciphertext as ct.noise_bits
+        self.noise = NoiseEstimator(N, self.q, t, sigma, ks_base_bits=self.T.bit_length() - 1)
+
+    def _tracked(self, ct, noise_bits):
+        ct.noise_bits = noise_bits
+        return ct
+
+    def noise_budget(self, ct):
+        """Estimated bits of noise headroom left (None if ct is untracked); needs no keys"""
+        return self.noise.budget(ct.noise_bits)
+
+    def measure_noise_budget(self, ct):
+        """Exact noise budget in bits, measured with the secret key"""
+        self._require_cpp()
+        if self.secret_key is None: raise ValueError("No Secret Key")
+        self._sync_cpp_keys()
+        comps = [np.asarray(c, dtype=np.int64) for c in ct.get_components()]
+        return self.cpp_enc.noise_budget(comps, ct.is_ntt)
     
+    # ------------------------------------------------------------------
+    # Keys, encryption and decryption (native when the C++ backend is present)
+    # ------------------------------------------------------------------
+
+    def key_generation(self):
+        """Ternary secret and public key sampled and multiplied in C++"""
+        if not self.use_cpp:
+            return super().key_generation()
+
+        s, b, a = self.cpp_enc.keygen()
+        self.secret_key = SecretKey(s)
+        self.public_key = PublicKey(b, a, a_seed=self.cpp_enc.public_key_seed())
+        self._cpp_secret_key = self.secret_key
+        self._cpp_public_key = self.public_key
+        return self.secret_key, self.public_key
+
+    def _sync_cpp_keys(self):
+        # Keys assigned from Python (e.g. loaded from disk) replace the native copies
+        if self.secret_key is not None and self._cpp_secret_key is not self.secret_key:
+            self.cpp_enc.set_secret_key(np.asarray(self.secret_key.get_polynomial(), dtype=np.int64))
+            self._cpp_secret_key = self.secret_key
+        if self.public_key is not None and self._cpp_public_key is not self.public_key:
+            pk0, pk1 = self.public_key.get_components()
+            if pk1 is None:
+                # Seed-only key (pk1 was not shipped): expand a natively
+                self.cpp_enc.set_public_key_seeded(np.asarray(pk0, dtype=np.int64), self.public_key.a_seed)
+            else:
+                self.cpp_enc.set_public_key(np.asarray(pk0, dtype=np.int64), np.asarray(pk1, dtype=np.int64))
+            self._cpp_public_key = self.public_key
+
+    def encrypt(self, plaintext, ntt=False):
+        """
+        Public-key encryption; ntt=True returns the ciphertext in evaluation
+        form (saves the two inverse transforms)
+        """
+        if not self.use_cpp:
+            return self._tracked(super().encrypt(plaintext), self.noise.fresh())
+        if self.public_key is None: raise ValueError("No Public Key")
+        self._sync_cpp_keys()
+
+        c0, c1 = self.cpp_enc.encrypt(np.asarray(plaintext.get_poly(), dtype=np.int64), ntt)
+        return Ciphertext([c0, c1], params={'N': self.N, 't': self.t, 'q': self.q}, is_ntt=ntt,
+                          noise_bits=self.noise.fresh())
+
+    def encrypt_symmetric(self, plaintext, ntt=False):
+        """
+        Secret-key encryption. c1 is expanded from a 32-byte seed kept in
+        ct.a_seed, so a serialized fresh ciphertext can carry the seed in
+        place of c1 (about half the size). Requires the C++ backend.
+        """
+        self._require_cpp()
+        if self.secret_key is None: raise ValueError("No Secret Key")
+        self._sync_cpp_keys()
+
+        c0, seed = self.cpp_enc.encrypt_symmetric(np.asarray(plaintext.get_poly(), dtype=np.int64), ntt)
+        c1 = fhe_fast_mult.expand_uniform(seed, self.N, self.q)
+        if ntt:
+            self.cpp_ntt.forward_inplace(c1)
+        return Ciphertext([c0, c1], params={'N': self.N, 't': self.t, 'q': self.q},
+                          is_ntt=ntt, a_seed=seed, noise_bits=self.noise.fresh(symmetric=True))
+
+    def encrypt_many(self, plaintexts, ntt=False):
+        """Encrypt a list of plaintexts in one call, spread across the C++ thread pool"""
+        if not self.use_cpp:
+            return [self.encrypt(pt) for pt in plaintexts]
+        if self.public_key is None: raise ValueError("No Public Key")
+        self._sync_cpp_keys()
+
+        messages = np.array([pt.get_poly() for pt in plaintexts], dtype=np.int64).reshape(-1, self.N)
+        params = {'N': self.N, 't': self.t, 'q': self.q}
+        fresh = self.noise.fresh()
+        return [Ciphertext([c0, c1], params=params, is_ntt=ntt, noise_bits=fresh)
+                for c0, c1 in self.cpp_enc.encrypt_many(messages, ntt)]
+
+    def decrypt(self, ciphertext):
+        """Decryption of a ciphertext of any size, in either form"""
+        if not self.use_cpp:
+            return super().decrypt(ciphertext)
+        if self.secret_key is None: raise ValueError("No Secret Key")
+        self._sync_cpp_keys()
+
+        comps = [np.asarray(c, dtype=np.int64) for c in ciphertext.get_components()]
+        m = self.cpp_enc.decrypt(comps, ciphertext.is_ntt)
+        return Plaintext(m, params={'N': self.N, 't': self.t, 'q': self.q})
+
+    # ------------------------------------------------------------------
+    # Evaluation (NTT) form
+    # ------------------------------------------------------------------
+
+    def _require_cpp(self):
+        if not self.use_cpp:
+            raise RuntimeError("Evaluation form needs the C++ backend")
+
+    def to_ntt(self, ct):
+        """Ciphertext in evaluation form; no-op if it already is"""
+        if ct.is_ntt:
+            return ct
+        self._require_cpp()
+        return eval_form.to_ntt(self.cpp_ntt, ct)
+
+    def to_coeff(self, ct):
+        """Ciphertext in coefficient form; no-op if it already is"""
+        if not ct.is_ntt:
+            return ct
+        self._require_cpp()
+        return eval_form.to_coeff(self.cpp_ntt, ct)
+
+    def plain_to_ntt(self, pt):
+        """Transform a plaintext once for repeated multiply_plain calls"""
+        self._require_cpp()
+        return eval_form.plain_to_ntt(self.cpp_ntt, pt)
+
+    def add(self, ct1, ct2):
+        """Homomorphic addition; stays in evaluation form if either input is"""
+        noise = self.noise.add(ct1.noise_bits, ct2.noise_bits)
+        if self.use_cpp:
+            return self._tracked(eval_form.add(self.cpp_ntt, ct1, ct2), noise)
+        comps = [self.poly_ring.add(a, b) for a, b in zip(ct1.get_components(), ct2.get_components())]
+        return Ciphertext(comps, params=ct1.params, noise_bits=noise)
+
+    def sub(self, ct1, ct2):
+        """Homomorphic subtraction; stays in evaluation form if either input is"""
+        noise = self.noise.add(ct1.noise_bits, ct2.noise_bits)
+        if self.use_cpp:
+            return self._tracked(eval_form.sub(self.cpp_ntt, ct1, ct2), noise)
+        comps = [self.poly_ring.sub(a, b) for a, b in zip(ct1.get_components(), ct2.get_components())]
+        return Ciphertext(comps, params=ct1.params, noise_bits=noise)
+
+    def add_many(self, cts):
+        """Sum of a list of ciphertexts with delayed modular reduction"""
+        if not cts:
+            raise ValueError("add_many needs at least one ciphertext")
+        noise = self.noise.add(*[ct.noise_bits for ct in cts])
+        if self.use_cpp:
+            return self._tracked(eval_form.sum_many(self.cpp_ntt, cts), noise)
+        comps = [self.poly_ring.sum([ct.get_components()[i] for ct in cts]) for i in range(cts[0].size)]
+        return Ciphertext(comps, params=cts[0].params, noise_bits=noise)
+
+    def dot_product(self, cts, pts):
+        """
+        sum_i cts[i] * pts[i] (encrypted vector times plaintext weights) as one fused
+        multiply-accumulate in evaluation form; the result is in evaluation form
+        """
+        self._require_cpp()
+        noise = self.noise.add(*[self.noise.multiply_plain(ct.noise_bits) for ct in cts]) if cts else None
+        return self._tracked(eval_form.dot_product(self.cpp_ntt, cts, pts), noise)
+
+    def scan_subtract(self, db_cts, query_cts, out=None):
+        """
+        db_cts[r] - query_cts[j] for the whole rows x targets grid in one C++ call;
+        returns grid[r][j] (Ciphertext views of one arena). Requires the C++ backend.
+        """
+        self._require_cpp()
+        grid, _ = eval_form.scan_subtract(self.cpp_ntt, db_cts, query_cts, out)
+        return grid
+
+    def add_plain(self, ct, pt):
+        """
+        ct + m for a plaintext m (Plaintext, int constant or coefficient list),
+        without encrypting m; keeps the form of ct
+        """
+        noise = self.noise.add_plain(ct.noise_bits)
+        if self.use_cpp:
+            return self._tracked(eval_form.add_plain(self.cpp_plain, ct, pt), noise)
+        comps = [self.poly_ring.add(ct.get_components()[0], self._scaled_plain(pt))] + list(ct.get_components()[1:])
+        return Ciphertext(comps, params=ct.params, noise_bits=noise)
+
+    def sub_plain(self, ct, pt):
+        """ct - m for a plaintext m; keeps the form of ct"""
+        noise = self.noise.add_plain(ct.noise_bits)
+        if self.use_cpp:
+            return self._tracked(eval_form.sub_plain(self.cpp_plain, ct, pt), noise)
+        comps = [self.poly_ring.sub(ct.get_components()[0], self._scaled_plain(pt))] + list(ct.get_components()[1:])
+        return Ciphertext(comps, params=ct.params, noise_bits=noise)
+
+    def _scaled_plain(self, pt):
+        # delta m mod q for the Python fallback
+        if not isinstance(pt, Plaintext):
+            pt = self.encode(pt)
+        m = np.asarray(pt.get_poly(), dtype=object) % self.t
+        return ((m * self.delta) % self.q).astype(np.int64)
+
+    def scan_subtract_plain(self, db_cts, targets, out=None):
+        """
+        db_cts[r] - targets[j] against known plaintext targets (range search over
+        public bounds): no query encryption, only c0 changes, and the result
+        carries the row's noise. Returns grid[r][j]. Requires the C++ backend.
+        """
+        self._require_cpp()
+        grid, _ = eval_form.scan_subtract_plain(self.cpp_plain, self.cpp_ntt, db_cts, targets, out)
+        for row, ct in zip(grid, db_cts):
+            for diff in row:
+                diff.noise_bits = self.noise.add_plain(ct.noise_bits)
+        return grid
+
+    def multiply_plain(self, ct, pt):
+        """
+        Ciphertext times plaintext polynomial (Plaintext, int or coefficient list).
+        Coefficient-form plaintexts go through the cached encoder and keep the form
+        of ct; NTT-form plaintexts give an evaluation-form result.
+        """
+        if self.use_cpp and not getattr(pt, 'is_ntt', False):
+            noise = self.noise.multiply_plain(ct.noise_bits, self.t // 2 + 1)
+            return self._tracked(eval_form.multiply_plain_cached(self.cpp_plain, ct, pt), noise)
+        if not isinstance(pt, Plaintext):
+            pt = self.encode(pt)
+        noise = self.noise.multiply_plain(ct.noise_bits)
+        if self.use_cpp:
+            return self._tracked(eval_form.multiply_plain(self.cpp_ntt, ct, pt), noise)
+        m = pt.get_poly() % self.q
+        comps = [self.poly_ring.mul(c, m) for c in ct.get_components()]
+        return Ciphertext(comps, params=ct.params, noise_bits=noise)
+
     def multiply(self, ct1, ct2):
         """
         Homomorphic multiplication with C++ acceleration
         
         Args:
-            ct1, ct2: Ciphertext objects (must be size-2)
+            ct1, ct2: Ciphertext objects (either form). Size-3 inputs are
+                relinearized here, so a product can stay unrelinearized until
+                it feeds another multiplication (add, multiply_plain and
+                decrypt all take size 3).
         
         Returns:
-            Ciphertext object (size-3, needs relinearization)
+            Ciphertext object (size-3, coefficient form, needs relinearization)
         """
+        # The tensor product scales exact integer products: coefficients only
+        ct1, ct2 = self.to_coeff(self.relinearize(ct1)), self.to_coeff(self.relinearize(ct2))
         if not ct1.is_fresh() or not ct2.is_fresh():
-            raise ValueError("Can only multiply fresh ciphertexts (size 2)")
+            raise ValueError("Can only multiply size-2 or size-3 ciphertexts")
+        noise = self.noise.multiply(ct1.noise_bits, ct2.noise_bits)
         
         # Use C++ backend if available
         if self.use_cpp:
-            return self._multiply_cpp(ct1, ct2)
+            return self._tracked(self._multiply_cpp(ct1, ct2), noise)
         else:
             # Fall back to Python implementation
-            return super().multiply(ct1, ct2)
+            return self._tracked(super().multiply(ct1, ct2), noise)
     
     def _multiply_cpp(self, ct1, ct2):
         """C++ accelerated multiplication"""
         c1_0, c1_1 = ct1.get_components()
         c2_0, c2_1 = ct2.get_components()
         
-        # Convert to numpy arrays for C++ interface
-        c1_0_np = np.array(c1_0, dtype=np.int64)
-        c1_1_np = np.array(c1_1, dtype=np.int64)
-        c2_0_np = np.array(c2_0, dtype=np.int64)
-        c2_1_np = np.array(c2_1, dtype=np.int64)
-        
-        # Call C++ multiplication
-        d0_np, d1_np, d2_np = self.cpp_mult.multiply_ciphertexts(
-            c1_0_np, c1_1_np, c2_0_np, c2_1_np
+        # int64 arrays are passed to C++ without copying; results own their C++ storage
+        d0, d1, d2 = self.cpp_mult.multiply_ciphertexts(
+            np.asarray(c1_0, dtype=np.int64),
+            np.asarray(c1_1, dtype=np.int64),
+            np.asarray(c2_0, dtype=np.int64),
+            np.asarray(c2_1, dtype=np.int64)
         )
-        
-        # Convert back to Python lists
-        d0 = d0_np.tolist() if hasattr(d0_np, 'tolist') else list(d0_np)
-        d1 = d1_np.tolist() if hasattr(d1_np, 'tolist') else list(d1_np)
-        d2 = d2_np.tolist() if hasattr(d2_np, 'tolist') else list(d2_np)
-        
+
         return Ciphertext([d0, d1, d2], params=ct1.params)
+
+    def multiply_many(self, pairs):
+        """
+        Multiply a list of (ct1, ct2) pairs; the C++ backend spreads them
+        across its thread pool (see fhe_fast_mult.set_num_threads)
+
+        Returns:
+            List of size-3 Ciphertext objects
+        """
+        if not self.use_cpp:
+            return [self.multiply(ct1, ct2) for ct1, ct2 in pairs]
+
+        if not pairs:
+            return []
+        pairs = [(self.to_coeff(self.relinearize(ct1)), self.to_coeff(self.relinearize(ct2)))
+                 for ct1, ct2 in pairs]
+        for ct1, ct2 in pairs:
+            if not ct1.is_fresh() or not ct2.is_fresh():
+                raise ValueError("Can only multiply size-2 or size-3 ciphertexts")
+
+        # One (count, 3, N) result array; each ciphertext's components are row views of it
+        arena = self.cpp_mult.multiply_batch(eval_form.stack([a for a, _ in pairs]),
+                                             eval_form.stack([b for _, b in pairs]))
+        return [Ciphertext(list(d), params=ct1.params,
+                           noise_bits=self.noise.multiply(ct1.noise_bits, ct2.noise_bits))
+                for d, (ct1, ct2) in zip(arena, pairs)]
     
+    def generate_relin_key(self):
+        """Generate the relinearization key in C++ and load it into the multiplier"""
+        if not self.use_cpp:
+            return super().generate_relin_key()
+        if self.secret_key is None: raise ValueError("Keys not generated")
+        self._sync_cpp_keys()
+
+        key_b, key_a, seed = self.cpp_enc.relin_keygen(self.T.bit_length() - 1, return_seed=True)
+        self.relin_key = RelinearizationKey(list(zip(key_b, key_a)))
+        self.relin_key.a_seed = seed
+        self._load_cpp_relin_key()
+        return self.relin_key
+
+    def _load_cpp_relin_key(self):
+        keys = self.relin_key.get_components()
+        key_b = [np.asarray(k[0], dtype=np.int64) for k in keys]
+        key_a = [np.asarray(k[1], dtype=np.int64) for k in keys]
+        self.cpp_mult.set_relin_key(key_b, key_a, self.T.bit_length() - 1)
+
+    def relinearize(self, ciphertext):
+        """
+        Relinearization with C++ key switching (NTT-form keys)
+
+        Args:
+            ciphertext: Ciphertext object (size-3)
+
+        Returns:
+            Ciphertext object (size-2)
+        """
+        if ciphertext.size != 3:
+            return ciphertext
+
+        ciphertext = self.to_coeff(ciphertext)
+        noise = self.noise.relinearize(ciphertext.noise_bits)
+        if not self.use_cpp:
+            return self._tracked(super().relinearize(ciphertext), noise)
+
+        if not self.cpp_mult.has_relin_key():
+            self._load_cpp_relin_key()
+
+        d0, d1, d2 = ciphertext.get_components()
+        c0, c1 = self.cpp_mult.relinearize(
+            np.asarray(d0, dtype=np.int64),
+            np.asarray(d1, dtype=np.int64),
+            np.asarray(d2, dtype=np.int64)
+        )
+        return Ciphertext([c0, c1], params=ciphertext.params, noise_bits=noise)
+
+    # ------------------------------------------------------------------
+    # Slot batching and rotations
+    # ------------------------------------------------------------------
+
+    def _require_batching(self):
+        self._require_cpp()
+        if self.batch_encoder is None:
+            raise RuntimeError(f"Batching needs a prime t = 1 (mod 2N); t={self.t} is not")
+
+    def encode_batch(self, values):
+        """
+        Pack up to N values into the 2 x (N/2) slot matrix (row 0 first), so
+        add/multiply act slot-wise and rotate_rows / rotate_columns move slots
+        """
+        self._require_batching()
+        poly = self.batch_encoder.encode(np.asarray(values, dtype=np.int64) % self.t)
+        return Plaintext(poly, params={'N': self.N, 't': self.t, 'q': self.q})
+
+    def decode_batch(self, pt):
+        """All N slot values of a decrypted batched plaintext"""
+        self._require_batching()
+        return self.batch_encoder.decode(np.asarray(pt.get_poly(), dtype=np.int64))
+
+    def generate_galois_keys(self, steps=None):
+        """
+        Generate rotation keys in C++ and load them into the multiplier.
+
+        Args:
+            steps: row rotation amounts (negative = right); default is every
+                   power of two both ways, enough for any rotation in log N steps.
+                   The row-swap key is always included.
+
+        Returns:
+            RotationKey mapping Galois element -> [(b_i, a_i)]
+        """
+        self._require_batching()
+        if self.secret_key is None: raise ValueError("Keys not generated")
+        self._sync_cpp_keys()
+
+        base_bits = self.T.bit_length() - 1
+        keys = {}
+        for g in self._galois_elements(steps):
+            key_b, key_a = self.cpp_enc.galois_keygen(g, base_bits)
+            keys[g] = list(zip(key_b, key_a))
+            self.cpp_mult.set_galois_key(g, list(key_b), list(key_a), base_bits)
+        self.rotation_key = RotationKey(keys)
+        return self.rotation_key
+
+    def _galois_elements(self, steps=None):
+        """Sorted Galois elements for row rotations by `steps` plus the row swap"""
+        if steps is None:
+            steps = []
+            k = 1
+            while k < self.n_slots:
+                steps += [k, -k]
+                k <<= 1
+        elements = {fhe_fast_mult.galois_element(self.N, k) for k in steps}
+        elements.add(fhe_fast_mult.galois_column_swap(self.N))
+        return sorted(elements)
+
+    def generate_keys(self, galois_steps=None):
+        """
+        Secret key, public key, relinearization key and (with batching) rotation
+        keys in one native call that generates every key-switching digit in
+        parallel; all of them are loaded into the multiplier.
+
+        Args:
+            galois_steps: rotation amounts as for generate_galois_keys (None for
+                          the default set); ignored without batching
+
+        Returns:
+            (SecretKey, PublicKey, RelinearizationKey, RotationKey or None)
+        """
+        if not self.use_cpp:
+            self.key_generation()
+            return self.secret_key, self.public_key, self.generate_relin_key(), None
+
+        base_bits = self.T.bit_length() - 1
+        elements = self._galois_elements(galois_steps) if self.batch_encoder is not None else []
+        keys = self.cpp_enc.keygen_bundle(base_bits, elements)
+
+        pk_b, pk_a, pk_seed = keys['public']
+        self.secret_key = SecretKey(keys['secret'])
+        self.public_key = PublicKey(pk_b, pk_a, a_seed=pk_seed)
+        self._cpp_secret_key = self.secret_key
+        self._cpp_public_key = self.public_key
+
+        key_b, key_a, seed = keys['relin']
+        self.relin_key = RelinearizationKey(list(zip(key_b, key_a)))
+        self.relin_key.a_seed = seed
+        self.cpp_mult.set_relin_key(list(key_b), list(key_a), base_bits)
+
+        self.rotation_key = None
+        if elements:
+            rotation = {}
+            for g, (key_b, key_a, _) in keys['galois'].items():
+                rotation[g] = list(zip(key_b, key_a))
+                self.cpp_mult.set_galois_key(g, list(key_b), list(key_a), base_bits)
+            self.rotation_key = RotationKey(rotation)
+        return self.secret_key, self.public_key, self.relin_key, self.rotation_key
+
+    def _load_cpp_galois_key(self, g):
+        key = self.rotation_key.get_key(g) if self.rotation_key is not None else None
+        if key is None:
+            raise ValueError(f"No rotation key for Galois element {g}")
+        self.cpp_mult.set_galois_key(g, [np.asarray(k[0], dtype=np.int64) for k in key],
+                                     [np.asarray(k[1], dtype=np.int64) for k in key],
+                                     self.T.bit_length() - 1)
+
+    def _galois_ready(self, ct, elements):
+        self._require_cpp()
+        if ct.size != 2: raise ValueError("Relinearize before rotating")
+        for g in elements:
+            if not self.cpp_mult.has_galois_key(g):
+                self._load_cpp_galois_key(g)
+        return [np.asarray(c, dtype=np.int64) for c in ct.get_components()]
+
+    def apply_galois(self, ct, g):
+        """
+        X -> X^g on a size-2 ciphertext, key-switched back to the secret key.
+        Stays in the ciphertext's form: in evaluation form the automorphism is
+        a slot permutation.
+        """
+        c0, c1 = self._galois_ready(ct, [g])
+        r0, r1 = self.cpp_mult.apply_galois(c0, c1, g, ct.is_ntt)
+        return Ciphertext([r0, r1], params=ct.params, is_ntt=ct.is_ntt,
+                          noise_bits=self.noise.rotate(ct.noise_bits))
+
+    def rotate_rows(self, ct, steps):
+        """Rotate both slot rows left by steps (right if negative)"""
+        steps %= self.n_slots
+        if steps == 0:
+            return ct
+        return self.apply_galois(ct, fhe_fast_mult.galois_element(self.N, steps))
+
+    def rotate_rows_many(self, ct, steps_list):
+        """
+        Several rotations of one ciphertext with hoisted key switching: the
+        decomposition of c1 is computed once and shared by every key
+        """
+        elements = [fhe_fast_mult.galois_element(self.N, k % self.n_slots) for k in steps_list]
+        rotated = [k % self.n_slots != 0 for k in steps_list]
+        needed = [g for g, r in zip(elements, rotated) if r]
+        c0, c1 = self._galois_ready(ct, needed)
+        results = iter(self.cpp_mult.apply_galois_many(c0, c1, needed, ct.is_ntt))
+        noise = self.noise.rotate(ct.noise_bits)
+        out = []
+        for r in rotated:
+            if r:
+                r0, r1 = next(results)
+                out.append(Ciphertext([r0, r1], params=ct.params, is_ntt=ct.is_ntt, noise_bits=noise))
+            else:
+                out.append(ct)
+        return out
+
+    def rotate_columns(self, ct):
+        """Swap the two slot rows"""
+        return self.apply_galois(ct, fhe_fast_mult.galois_column_swap(self.N))
+
+    def sum_slots(self, ct):
+        """
+        Every slot ends up holding the sum of all N slots (log N rotations by
+        powers of two, then one row swap), run natively in evaluation form;
+        needs the default rotation keys
+        """
+        elements = [fhe_fast_mult.galois_element(self.N, 1 << i)
+                    for i in range(self.n_slots.bit_length() - 1)]
+        elements.append(fhe_fast_mult.galois_column_swap(self.N))
+        c0, c1 = self._galois_ready(ct, elements)
+        r0, r1 = self.cpp_mult.rotate_and_sum(c0, c1, ct.is_ntt)
+        return Ciphertext([r0, r1], params=ct.params, is_ntt=ct.is_ntt,
+                          noise_bits=self.noise.rotate_and_sum(ct.noise_bits, len(elements)))
+
     def poly_multiply(self, a, b):
         """
         Fast polynomial multiplication using C++ NTT
         Can be used by other operations that need polynomial multiplication
         """
         if self.use_cpp:
-            a_np = np.array(a, dtype=np.int64)
-            b_np = np.array(b, dtype=np.int64)
-            result_np = self.cpp_ntt.multiply(a_np, b_np)
-            return result_np.tolist() if hasattr(result_np, 'tolist') else list(result_np)
+            return self.cpp_ntt.multiply(np.asarray(a, dtype=np.int64),
+                                         np.asarray(b, dtype=np.int64))
         else:
             return self.poly_ring.mul(a, b)
     
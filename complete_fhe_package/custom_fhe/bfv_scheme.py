@@ -102,7 +102,9 @@ class BFVScheme:
         # noisy_m = c0 + c1*s
         c1_s = self.poly_ring.mul(c1, s)
         noisy_m = self.poly_ring.add(c0, c1_s)
+        return self._scale_to_plaintext(noisy_m)
 
+    def _scale_to_plaintext(self, noisy_m):
         # Scale: round(noisy * t / q) using OBJECT math
         noisy_obj = noisy_m.astype(object)
         scaled = (noisy_obj * self.t + (self.q // 2)) // self.q
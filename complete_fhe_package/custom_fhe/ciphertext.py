@@ -7,31 +7,49 @@ import numpy as np
 
 class Plaintext:
     """Plaintext polynomial representation"""
+
+    is_ntt = False
     
-    def __init__(self, poly, params=None):
+    def __init__(self, poly, params=None, is_ntt=False):
         """
         Args:
             poly: Polynomial coefficients as numpy array
             params: Optional parameters (N, t, q)
+            is_ntt: True if poly holds NTT slots mod q (evaluation form)
         """
         self.poly = poly
         self.params = params
+        self.is_ntt = is_ntt
     
     def get_poly(self):
         return self.poly
     
     def __repr__(self):
-        return f"Plaintext(degree={len(self.poly)}, coeffs={self.poly[:4]}...)"
+        form = ", ntt" if self.is_ntt else ""
+        return f"Plaintext(degree={len(self.poly)}, coeffs={self.poly[:4]}...{form})"
 
 
 class Ciphertext:
     """Ciphertext representation (c0, c1) or (c0, c1, c2) for fresh/multiplied"""
+
+    # Class defaults keep ciphertexts pickled before these fields existed loadable
+    is_ntt = False
+    a_seed = None
+    noise_bits = None
     
-    def __init__(self, components, params=None):
+    def __init__(self, components, params=None, is_ntt=False, a_seed=None, noise_bits=None):
         """
         Args:
             components: List of polynomial components [c0, c1] or [c0, c1, c2]
             params: Optional parameters (N, t, q)
+            is_ntt: True if the components are in evaluation (NTT) form.
+                Add, sub and multiply-by-plain stay in that form; multiply,
+                relinearize and decrypt convert back to coefficients.
+            a_seed: 32-byte seed with c1 = fhe_fast_mult.expand_uniform(a_seed, N, q)
+                in coefficient form (fresh symmetric encryptions), so c1 can be
+                shipped as the seed. Results of operations carry no seed.
+            noise_bits: log2 of the analytical invariant-noise bound
+                (custom_fhe.noise), or None when untracked
         """
         if not isinstance(components, list):
             raise ValueError("Components must be a list of polynomials")
@@ -39,6 +57,9 @@ class Ciphertext:
         self.components = components
         self.params = params
         self.size = len(components)
+        self.is_ntt = is_ntt
+        self.a_seed = a_seed
+        self.noise_bits = noise_bits
     
     def get_components(self):
         return self.components
@@ -48,12 +69,13 @@ class Ciphertext:
         return self.size == 2
     
     def __repr__(self):
-        return f"Ciphertext(size={self.size}, N={len(self.components[0])})"
+        form = ", ntt" if self.is_ntt else ""
+        return f"Ciphertext(size={self.size}, N={len(self.components[0])}{form})"
     
     def copy(self):
         """Create a deep copy of the ciphertext"""
         new_components = [c.copy() for c in self.components]
-        return Ciphertext(new_components, self.params)
+        return Ciphertext(new_components, self.params, self.is_ntt, self.a_seed, self.noise_bits)
     
     def __add__(self, other):
         """Addition placeholder - actual implementation in BFVScheme"""
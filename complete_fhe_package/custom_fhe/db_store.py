@@ -0,0 +1,109 @@
+"""
+Server-side encrypted database store
+A thin wrapper over fhe_fast_mult.CiphertextStore: an on-disk, memory-mapped
+columnar file of fresh ciphertexts (e.g. 'date', 'email'), kept in NTT form.
+The database is uploaded once; searches then read the mapped columns page by
+page instead of unpickling every row per request.
+
+SearchPipeline runs those searches on native stage threads (decode, scan,
+encode overlapping on row chunks) behind asyncio futures.
+"""
+
+import asyncio
+
+from .ciphertext import Ciphertext
+from . import serialization
+
+try:
+    import fhe_fast_mult as _native
+except ImportError:
+    _native = None
+
+
+def build_store(path, columns, N, q, t, ntt=True):
+    """
+    Write {column name: [Ciphertext, ...]} to path (same row count per column)
+    """
+    if _native is None:
+        raise RuntimeError("The ciphertext store requires the C++ backend (fhe_fast_mult)")
+    batches = {name: serialization.dumps(cts, N, q, t) for name, cts in columns.items()}
+    _native.CiphertextStore.build(path, batches, ntt)
+
+
+def build_store_from_batches(path, batches, ntt=True):
+    """Write a store straight from uploaded {column name: serialization.dumps bytes}"""
+    if _native is None:
+        raise RuntimeError("The ciphertext store requires the C++ backend (fhe_fast_mult)")
+    _native.CiphertextStore.build(path, batches, ntt)
+
+
+def open_store(path):
+    if _native is None:
+        raise RuntimeError("The ciphertext store requires the C++ backend (fhe_fast_mult)")
+    return _native.CiphertextStore(path)
+
+
+def iter_ciphertexts(store, column):
+    """Yield each row of a column as a Ciphertext over read-only views of the mapping"""
+    params = {'N': store.get_N(), 't': store.get_t(), 'q': store.get_q()}
+    is_ntt = store.is_ntt()
+    for row in store.column(column):
+        yield Ciphertext([row[0], row[1]], params=params, is_ntt=is_ntt)
+
+
+class PipelineBusy(RuntimeError):
+    """Every slot of the pipeline's request queue is taken; retry later"""
+
+
+class SearchPipeline:
+    """
+    asyncio front end of fhe_fast_mult.SearchPipeline: `await search(...)`
+    suspends the handler, not the event loop, while the native stages decode
+    the query, scan the column and serialize the result
+
+    Args:
+        max_pending: searches allowed to wait for the decode stage; more raise
+            PipelineBusy instead of queueing without bound
+        chunk_bytes: differences computed per scan step (bounds memory in flight)
+        depth: chunks buffered between two stages
+    """
+
+    def __init__(self, max_pending=64, chunk_bytes=2 << 20, depth=2):
+        if _native is None:
+            raise RuntimeError("The search pipeline requires the C++ backend (fhe_fast_mult)")
+        self._pipeline = _native.SearchPipeline(max_pending, chunk_bytes, depth)
+
+    def submit(self, store, column, query):
+        """Queue a search; returns the native SearchJob (wait() / result())"""
+        job = self._pipeline.try_submit(store, column, query)
+        if job is None:
+            raise PipelineBusy("Search pipeline is full")
+        return job
+
+    async def search(self, store, column, query):
+        """
+        Differences of every row of `column` against a serialization.dumps
+        query batch, as one serialized batch (rows * len(query), store form)
+        """
+        loop = asyncio.get_running_loop()
+        future = loop.create_future()
+        job = self.submit(store, column, query)
+
+        def resolve():
+            if future.cancelled():
+                return
+            try:
+                future.set_result(job.result())
+            except Exception as e:
+                future.set_exception(e)
+
+        # Runs on a pipeline thread; only hops back onto the loop
+        job.add_done_callback(lambda: loop.call_soon_threadsafe(resolve))
+        return await future
+
+    def pending(self):
+        return self._pipeline.pending()
+
+    def close(self):
+        """Finish the queued searches and stop the stage threads"""
+        self._pipeline.shutdown()
@@ -0,0 +1,193 @@
+"""
+Evaluation-form (NTT-domain) helpers for the C++ accelerated schemes
+A component in evaluation form holds its NTT slots mod q. Add, sub and
+multiply-by-plain are element-wise there, so an operand reused many times
+(public key, query ciphertext, plaintext mask) is transformed once; only the
+tensor product, relinearization and decryption scaling need coefficients.
+"""
+
+import numpy as np
+from .ciphertext import Ciphertext, Plaintext
+
+try:
+    import fhe_fast_mult as _native
+except ImportError:
+    _native = None
+
+
+def poly_to_ntt(ntt, poly):
+    """Any integer polynomial (signed or not) -> fresh array of NTT slots mod q"""
+    a = np.mod(np.asarray(poly, dtype=np.int64), ntt.get_q())
+    ntt.forward_inplace(a)
+    return a
+
+
+def to_ntt(ntt, ct):
+    """Ciphertext in evaluation form (returned unchanged if it already is)"""
+    if ct.is_ntt:
+        return ct
+    # One (size, N) batch: every component goes through a single C++ call
+    batch = np.array(ct.get_components(), dtype=np.int64)
+    ntt.forward_batch(batch)
+    return Ciphertext(list(batch), params=ct.params, is_ntt=True)
+
+
+def to_coeff(ntt, ct):
+    """Ciphertext in coefficient form (returned unchanged if it already is)"""
+    if not ct.is_ntt:
+        return ct
+    batch = np.array(ct.get_components(), dtype=np.int64)
+    ntt.inverse_batch(batch)
+    return Ciphertext(list(batch), params=ct.params, is_ntt=False)
+
+
+def plain_to_ntt(ntt, pt):
+    """Plaintext in evaluation form, ready for repeated multiply_plain calls"""
+    if pt.is_ntt:
+        return pt
+    return Plaintext(poly_to_ntt(ntt, pt.get_poly()), params=pt.params, is_ntt=True)
+
+
+def _match_forms(ntt, ct1, ct2):
+    # Mixed operands meet in evaluation form: transform the coefficient one
+    if ct1.is_ntt != ct2.is_ntt:
+        return to_ntt(ntt, ct1), to_ntt(ntt, ct2)
+    return ct1, ct2
+
+
+def add(ntt, ct1, ct2):
+    if ct1.size != ct2.size:
+        raise ValueError("Ciphertexts must have the same size")
+    ct1, ct2 = _match_forms(ntt, ct1, ct2)
+    comps = [ntt.add(np.asarray(a, dtype=np.int64), np.asarray(b, dtype=np.int64))
+             for a, b in zip(ct1.get_components(), ct2.get_components())]
+    return Ciphertext(comps, params=ct1.params, is_ntt=ct1.is_ntt)
+
+
+def sub(ntt, ct1, ct2):
+    if ct1.size != ct2.size:
+        raise ValueError("Ciphertexts must have the same size")
+    ct1, ct2 = _match_forms(ntt, ct1, ct2)
+    comps = [ntt.subtract(np.asarray(a, dtype=np.int64), np.asarray(b, dtype=np.int64))
+             for a, b in zip(ct1.get_components(), ct2.get_components())]
+    return Ciphertext(comps, params=ct1.params, is_ntt=ct1.is_ntt)
+
+
+def multiply_plain(ntt, ct, pt):
+    """
+    ct * m for a plaintext polynomial m. The result is in evaluation form
+    unless both operands are in coefficient form.
+    """
+    if not ct.is_ntt and not pt.is_ntt:
+        m = np.mod(np.asarray(pt.get_poly(), dtype=np.int64), ntt.get_q())
+        comps = [ntt.multiply(np.asarray(c, dtype=np.int64), m) for c in ct.get_components()]
+        return Ciphertext(comps, params=ct.params, is_ntt=False)
+
+    ct = to_ntt(ntt, ct)
+    m = plain_to_ntt(ntt, pt).get_poly()
+    comps = [ntt.pointwise_multiply(np.asarray(c, dtype=np.int64), m) for c in ct.get_components()]
+    return Ciphertext(comps, params=ct.params, is_ntt=True)
+
+
+def plain_operand(pt):
+    """
+    Plaintext, int constant or coefficient list -> a PlaintextEvaluator operand.
+    Encodings are cached by value, so pass the same constant freely.
+    """
+    if isinstance(pt, Plaintext):
+        if pt.is_ntt:
+            raise ValueError("Cached plaintext ops take coefficient-form plaintexts")
+        return np.asarray(pt.get_poly(), dtype=np.int64)
+    return pt
+
+
+def _plain_op(op, ct, pt):
+    comps = op(np.array(ct.get_components(), dtype=np.int64), plain_operand(pt), ct.is_ntt)
+    return Ciphertext(list(comps), params=ct.params, is_ntt=ct.is_ntt)
+
+
+def add_plain(plain, ct, pt):
+    """ct + m through a PlaintextEvaluator (c0 += delta m); keeps the form of ct"""
+    return _plain_op(plain.add_plain, ct, pt)
+
+
+def sub_plain(plain, ct, pt):
+    """ct - m (c0 -= delta m); keeps the form of ct"""
+    return _plain_op(plain.sub_plain, ct, pt)
+
+
+def multiply_plain_cached(plain, ct, pt):
+    """ct * m with m's NTT taken from the evaluator's cache; keeps the form of ct"""
+    return _plain_op(plain.multiply_plain, ct, pt)
+
+
+def stack(cts):
+    """(count, size, N) int64 matrix of ciphertext components, for the batch kernels"""
+    return np.array([ct.get_components() for ct in cts], dtype=np.int64)
+
+
+def sum_many(ntt, cts):
+    """
+    Sum of many same-size ciphertexts in one native call, reducing mod q once per
+    headroom rather than after every addition. Mixed forms meet in evaluation form.
+    """
+    if not cts:
+        raise ValueError("Nothing to sum")
+    is_ntt = any(ct.is_ntt for ct in cts)
+    if is_ntt:
+        cts = [to_ntt(ntt, ct) for ct in cts]
+    total = _native.sum_ciphertexts(stack(cts), ntt.get_q())
+    return Ciphertext(list(total), params=cts[0].params, is_ntt=is_ntt)
+
+
+def dot_product(ntt, cts, pts):
+    """
+    sum_i cts[i] * pts[i] with a fused multiply-accumulate in evaluation form
+    (128-bit partial sums, one reduction per headroom); the result is in evaluation form
+    """
+    if not cts or len(cts) != len(pts):
+        raise ValueError("Need one plaintext per ciphertext")
+    cts = [to_ntt(ntt, ct) for ct in cts]
+    slots = np.array([plain_to_ntt(ntt, pt).get_poly() for pt in pts], dtype=np.int64)
+    total = _native.dot_product(stack(cts), slots, ntt.get_q())
+    return Ciphertext(list(total), params=cts[0].params, is_ntt=True)
+
+
+def scan_subtract(ntt, db_cts, query_cts, out=None):
+    """
+    Every db row minus every query in one native call (blind equality / range
+    search). Mixed forms meet in evaluation form. Returns (grid, arena): grid[r][j]
+    is db_cts[r] - query_cts[j] as a Ciphertext over views of arena, a
+    (rows, targets, size, N) array that is written in place when out is given.
+    """
+    if not db_cts or not query_cts:
+        return [[] for _ in db_cts], None
+    is_ntt = any(ct.is_ntt for ct in db_cts) or any(ct.is_ntt for ct in query_cts)
+    if is_ntt:
+        db_cts = [to_ntt(ntt, ct) for ct in db_cts]
+        query_cts = [to_ntt(ntt, ct) for ct in query_cts]
+
+    arena = _native.scan_subtract(stack(db_cts), stack(query_cts), ntt.get_q(), out)
+    params = db_cts[0].params
+    grid = [[Ciphertext(list(arena[r, j]), params=params, is_ntt=is_ntt)
+             for j in range(len(query_cts))] for r in range(len(db_cts))]
+    return grid, arena
+
+
+def scan_subtract_plain(plain, ntt, db_cts, targets, out=None):
+    """
+    scan_subtract against known plaintext targets (ints, coefficient lists or
+    Plaintexts): db_cts[r] - targets[j] touches only c0 and needs no query
+    encryption. Returns (grid, arena) like scan_subtract.
+    """
+    if not db_cts or not targets:
+        return [[] for _ in db_cts], None
+    is_ntt = any(ct.is_ntt for ct in db_cts)
+    if is_ntt:
+        db_cts = [to_ntt(ntt, ct) for ct in db_cts]
+
+    arena = plain.scan_subtract_plain(stack(db_cts), [plain_operand(pt) for pt in targets], is_ntt, out)
+    params = db_cts[0].params
+    grid = [[Ciphertext(list(arena[r, j]), params=params, is_ntt=is_ntt)
+             for j in range(len(targets))] for r in range(len(db_cts))]
+    return grid, arena
@@ -7,15 +7,21 @@ import numpy as np
 
 class PublicKey:
     """Public key for encryption"""
+
+    # Class default keeps keys pickled before the field existed loadable
+    a_seed = None
     
-    def __init__(self, pk0, pk1):
+    def __init__(self, pk0, pk1, a_seed=None):
         """
         Args:
             pk0: First component (polynomial)
             pk1: Second component (polynomial)
+            a_seed: Optional 32-byte seed that pk1 expands from
+                (fhe_fast_mult.expand_uniform), set by the C++ key generation
         """
         self.pk0 = pk0
         self.pk1 = pk1
+        self.a_seed = a_seed
     
     def get_components(self):
         return self.pk0, self.pk1
@@ -39,6 +45,10 @@ class RelinearizationKey:
     """
     Relinearization key for reducing ciphertext size after multiplication
     """
+
+    # Seed with digit i's a = fhe_fast_mult.expand_uniform(a_seed, N, q, stream=i),
+    # when the key was generated natively
+    a_seed = None
     
     def __init__(self, evk_components):
         """
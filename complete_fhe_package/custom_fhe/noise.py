@@ -0,0 +1,184 @@
+"""
+Noise-budget estimation and parameter selection
+Tracks an analytical bound on the invariant noise ||[t * ct(s)]_q|| of every
+ciphertext, in bits, so a circuit's headroom is known without the secret key:
+
+    budget = log2(q) - 1 - noise_bits      (decryption fails at 0)
+
+The bounds are heuristic infinity-norm estimates: a product of two random
+polynomials grows by the expansion factor d = 2 sqrt(N). Against
+BFVEncryptor.noise_budget they sit 0-6 bits on the safe side for fresh
+ciphertexts and one or two multiplications.
+"""
+
+import math
+
+try:
+    import fhe_fast_mult as _native
+except ImportError:
+    _native = None
+
+# Largest log2(q) for 128-bit classical security with a ternary secret
+# (HomomorphicEncryption.org standard, Table 1)
+SECURE_LOG_Q = {1024: 27, 2048: 54, 4096: 109, 8192: 218, 16384: 438, 32768: 881}
+
+# Key-switching digits and RNS primes stay below 2^61 (fhe_cpp/rns.h), and a single
+# modulus below 2^62 (the lazy NTT butterflies)
+MAX_PRIME_BITS = 60
+MAX_SINGLE_BITS = 62
+
+
+def _log2_add(a, b):
+    """log2(2^a + 2^b)"""
+    if a is None or b is None:
+        return None
+    hi, lo = max(a, b), min(a, b)
+    return hi + math.log2(1.0 + 2.0 ** (lo - hi))
+
+
+class NoiseEstimator:
+    """
+    Noise bounds for one parameter set, in log2 units (None means unknown)
+
+    Args:
+        N, q, t, sigma: scheme parameters (q is the full ciphertext modulus)
+        ks_base_bits: key-switching gadget base 2^ks_base_bits; None means one
+            digit per RNS prime of ks_base_bits = prime size (num_primes > 1)
+        num_primes: RNS limbs in q (1 for the single-modulus backend)
+        q_mod_t: q mod t, which scales the message rounding term (default:
+            computed from q; t - 1 is the worst case when q is not yet known)
+    """
+
+    def __init__(self, N, q, t, sigma=3.2, ks_base_bits=None, num_primes=1, q_mod_t=None):
+        self.N = N
+        self.q = q
+        self.t = t
+        self.log_q = math.log2(q)
+        self.bound = 6 * int(sigma)                 # Errors are clipped to 6 sigma
+        self.expansion = 2.0 * math.sqrt(N)
+
+        if ks_base_bits is None:
+            ks_base_bits = math.ceil(self.log_q / num_primes)
+            digits = num_primes
+        else:
+            digits = math.ceil(self.log_q / ks_base_bits)
+        self.ks_digits = digits
+        self.ks_base_bits = ks_base_bits
+
+        # -(q mod t) m: the rounding term every message carries
+        r = q % t if q_mod_t is None else q_mod_t
+        self._rounding = math.log2(max(1, r * (t - 1)))
+
+    # ------------------------------------------------------------------
+    # Bounds
+    # ------------------------------------------------------------------
+
+    def fresh(self, symmetric=False):
+        """Public-key encryption: e u + e1 + e2 s; secret-key encryption: e"""
+        e = self.bound if symmetric else self.bound * (2 * self.expansion + 1)
+        return _log2_add(math.log2(self.t * e), self._rounding)
+
+    def add(self, *noise):
+        """Sum of ciphertexts"""
+        total = noise[0]
+        for n in noise[1:]:
+            total = _log2_add(total, n)
+        return total
+
+    def add_plain(self, noise):
+        """Plus or minus a plaintext: only the message rounding term, -(q mod t) m"""
+        return _log2_add(noise, self._rounding)
+
+    def multiply_plain(self, noise, plain_norm=None):
+        """Times a plaintext with coefficients below plain_norm (default t)"""
+        if noise is None:
+            return None
+        plain_norm = plain_norm or self.t
+        return noise + math.log2(self.expansion * plain_norm)
+
+    def multiply(self, noise1, noise2):
+        """Tensor product, before relinearization: t d (1 + d) / 2 (v1 + v2), d the expansion"""
+        total = _log2_add(noise1, noise2)
+        if total is None:
+            return None
+        return total + math.log2(self.t * self.expansion * (1 + self.expansion) / 2)
+
+    def key_switch(self):
+        """Noise a key switch adds: t * digits * T * B * sqrt(N)"""
+        return math.log2(self.t * self.ks_digits * self.bound * math.sqrt(self.N)) + self.ks_base_bits
+
+    def relinearize(self, noise):
+        """Size 3 -> 2 (the same for Galois key switching)"""
+        if noise is None:
+            return None
+        return _log2_add(noise, self.key_switch())
+
+    def rotate(self, noise):
+        """Automorphisms keep the norm; the key switch adds to it"""
+        return self.relinearize(noise)
+
+    def rotate_and_sum(self, noise, rotations):
+        """rotations doubling steps x <- x + rot(x)"""
+        for _ in range(rotations):
+            noise = _log2_add(noise, self.rotate(noise))
+        return noise
+
+    def budget(self, noise):
+        """Remaining bits; 0 once decryption may fail"""
+        if noise is None:
+            return None
+        return max(0.0, self.log_q - 1 - noise)
+
+    def depth_budget(self, depth, relinearize=True):
+        """Budget left after `depth` levels of squaring fresh ciphertexts"""
+        noise = self.fresh()
+        for _ in range(depth):
+            noise = self.multiply(noise, noise)
+            if relinearize:
+                noise = self.relinearize(noise)
+        return self.budget(noise)
+
+
+def select_parameters(depth, t, sigma=3.2, min_budget=1, security_table=None):
+    """
+    Smallest (N, q chain) that evaluates a circuit of multiplicative depth
+    `depth` with plaintext modulus t and at least min_budget bits left,
+    under 128-bit security. Candidates are ordered by N, then number of
+    primes, then total log2(q): smaller N and fewer limbs are the cheapest.
+
+    A single-prime q (num_primes == 1) runs on BFVSchemeAccelerated with
+    q_bits = prime_bits and its default gadget base 2^(q_bits // 2); longer
+    chains assume one key-switching digit per prime (RNSBFVMultiplier).
+
+    Returns:
+        dict with N, num_primes, prime_bits, log_q, budget (predicted bits left)
+        and primes (NTT-friendly, when the C++ backend is available)
+    """
+    if depth < 0:
+        raise ValueError("depth must be non-negative")
+    table = security_table or SECURE_LOG_Q
+
+    for N in sorted(table):
+        max_log_q = table[N]
+        # Primes exceed t and are = 1 (mod 2N); 4 spare bits leave enough candidates
+        min_bits = max(t.bit_length() + 1, (2 * N).bit_length() + 4)
+        for num_primes in range(1, max_log_q // min_bits + 1):
+            top = MAX_SINGLE_BITS if num_primes == 1 else MAX_PRIME_BITS
+            top = min(top, max_log_q // num_primes)
+            for bits in range(min_bits, top + 1):
+                q = 1 << (bits * num_primes)
+                base = bits // 2 if num_primes == 1 else None
+                est = NoiseEstimator(N, q - 1, t, sigma, ks_base_bits=base, num_primes=num_primes,
+                                     q_mod_t=t - 1)
+                budget = est.depth_budget(depth)
+                if budget < min_budget:
+                    continue
+                params = {'N': N, 't': t, 'num_primes': num_primes, 'prime_bits': bits,
+                          'log_q': bits * num_primes, 'budget': budget}
+                if _native is not None:
+                    try:
+                        params['primes'] = list(_native.find_ntt_primes(N, bits, num_primes))
+                    except (ValueError, RuntimeError):
+                        continue    # Not enough NTT primes of this size
+                return params
+    raise ValueError(f"No secure parameters for depth {depth} with t={t}")
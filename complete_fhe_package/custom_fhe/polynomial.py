@@ -6,6 +6,12 @@ Implements efficient polynomial arithmetic in R_q = Z_q[X]/(X^N + 1)
 import numpy as np
 from numpy.polynomial import polynomial as P
 
+# Native ChaCha20 samplers when the C++ module is built; NumPy's generator otherwise
+try:
+    import fhe_fast_mult as _native
+except ImportError:
+    _native = None
+
 class PolynomialRing:
     def __init__(self, N, q):
         self.N = N
@@ -16,6 +22,22 @@ class PolynomialRing:
     def add(self, a, b):
         return (a + b) % self.q
 
+    def sum(self, polys):
+        """
+        Sum of many polynomials, reducing once per int64 headroom instead of per add:
+        after a reduction the partial sum is < q, so headroom - 1 more terms fit
+        """
+        headroom = ((1 << 63) - 1) // max(self.q, 1)
+        step = max(headroom - 1, 1)
+        acc = np.zeros(self.N, dtype=np.int64)
+        for i in range(0, len(polys), step):
+            chunk = polys[i:i + step]
+            if step == 1:
+                acc = self.add(acc, chunk[0])
+            else:
+                acc = (acc + np.sum(np.asarray(chunk, dtype=np.int64), axis=0)) % self.q
+        return acc
+
     def sub(self, a, b):
         return (a - b) % self.q
 
@@ -59,9 +81,13 @@ class PolynomialRing:
 
     def random_uniform(self, size=None):
         if size is None: size = self.N
+        if _native is not None and isinstance(size, int):
+            return _native.sample_uniform(size, self.q)
         return np.random.randint(0, self.q, size=size, dtype=np.int64)
 
     def random_ternary(self):
+        if _native is not None:
+            return _native.sample_ternary(self.N)
         return np.random.choice([-1, 0, 1], size=self.N).astype(np.int64)
 
     def random_bounded(self, bound):
@@ -77,5 +103,7 @@ class DiscreteGaussian:
         return np.round(samples).astype(np.int64)
 
     def sample_bounded(self, bound):
+        if _native is not None:
+            return _native.sample_gaussian(self.N, self.sigma, int(bound))
         samples = self.sample()
         return np.clip(samples, -bound, bound)
\ No newline at end of file
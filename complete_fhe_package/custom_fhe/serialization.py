@@ -0,0 +1,62 @@
+"""
+Binary ciphertext serialization
+Wraps the C++ wire format (fhe_cpp/serialize.h): one shared (N, q, t) header
+per batch, coefficients bit-packed to ceil(log2 q) bits, and seeded c1
+components (symmetric encryptions) written as their 32-byte seed. Unlike
+pickle, loading never executes code from the payload.
+"""
+
+import numpy as np
+from .ciphertext import Ciphertext
+
+try:
+    import fhe_fast_mult as _native
+except ImportError:
+    _native = None
+
+
+def _require_native():
+    if _native is None:
+        raise RuntimeError("Ciphertext serialization requires the C++ backend (fhe_fast_mult)")
+
+
+def dumps(ciphertexts, N, q, t, compress_seeds=True):
+    """
+    Serialize a list of ciphertexts over one (N, q, t) to bytes.
+    Components must already be reduced into [0, q).
+
+    Args:
+        compress_seeds: write c1 as its seed when the ciphertext has a_seed
+    """
+    _require_native()
+    items = []
+    for ct in ciphertexts:
+        seed = ct.a_seed if compress_seeds else None
+        comps = [np.asarray(c, dtype=np.int64) for c in ct.get_components()]
+        items.append((comps, bool(ct.is_ntt), seed))
+    return _native.serialize_ciphertexts(items, N, q, t)
+
+
+def dumps_array(arena, q, t, is_ntt=False):
+    """
+    Serialize a (count, size, N) ciphertext array, e.g. a scan_subtract arena
+    reshaped to (rows * targets, size, N), without building Ciphertext objects
+    """
+    _require_native()
+    return _native.serialize_ciphertext_array(np.asarray(arena, dtype=np.int64), q, t, is_ntt)
+
+
+def loads(data):
+    """
+    Deserialize bytes (or any bytes-like object, e.g. a memoryview) into
+    (ciphertexts, params). All components are row views of one contiguous
+    (rows, N) int64 array, ready for NTT.forward_batch / inverse_batch.
+    """
+    _require_native()
+    (N, q, t), rows, records = _native.deserialize_ciphertexts(data)
+    params = {'N': N, 't': t, 'q': q}
+    cts = []
+    for first, size, is_ntt, seed in records:
+        cts.append(Ciphertext(list(rows[first:first + size]), params=params,
+                              is_ntt=is_ntt, a_seed=seed))
+    return cts, params
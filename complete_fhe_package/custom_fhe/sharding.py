@@ -0,0 +1,215 @@
+"""
+Sharded encrypted database
+Partitions the ciphertext store by row range across worker nodes. Each worker
+is a regular server_api instance holding its rows [begin, end) in its own
+memory-mapped store; the coordinator:
+
+    upload : slices every uploaded column batch by row range and sends each
+             worker its shard (records are copied as-is, seeds stay seeds)
+    session: agrees on (N, q, t), row count and columns with every worker once;
+             the worker keeps its store and NTT tables warm under a session id
+    search : broadcasts the client's compact query batch to all shards at once,
+             each worker runs the native scan pipeline on its rows, and the
+             partial results are concatenated in shard order
+
+Results are row-major, so the merged batch is byte-identical to what a single
+node holding the whole table would return.
+"""
+
+import asyncio
+import threading
+from concurrent.futures import ThreadPoolExecutor
+
+from . import db_store
+
+try:
+    import fhe_fast_mult as _native
+except ImportError:
+    _native = None
+
+try:
+    import requests
+except ImportError:
+    requests = None
+
+
+def shard_ranges(rows, num_shards):
+    """Contiguous [begin, end) row ranges, sizes differing by at most one"""
+    if num_shards < 1:
+        raise ValueError("Need at least one shard")
+    base, extra = divmod(rows, num_shards)
+    ranges, begin = [], 0
+    for i in range(num_shards):
+        end = begin + base + (1 if i < extra else 0)
+        ranges.append((begin, end))
+        begin = end
+    return ranges
+
+
+def check_shard_batches(batches, row_begin, row_end):
+    """
+    Worker side of an upload: every {column name: batch} must hold exactly the
+    rows [row_begin, row_end). Raises ValueError before anything is replaced.
+    """
+    if _native is None:
+        raise RuntimeError("Sharding requires the C++ backend (fhe_fast_mult)")
+    if not batches:
+        raise ValueError("Shard upload has no columns")
+    counts = {_native.ciphertext_batch_info(data)[3] for data in batches.values()}
+    if row_begin < 0 or counts != {row_end - row_begin}:
+        raise ValueError("Shard row count does not match its range")
+
+
+class SessionExpired(RuntimeError):
+    """The worker no longer knows the session (restart or new upload)"""
+
+
+class WorkerError(RuntimeError):
+    """A worker could not be reached or failed the request"""
+
+
+class ShardCoordinator:
+    """
+    Args:
+        workers: base URLs of the worker nodes, e.g. ["http://10.0.0.2:8000"]
+        timeout: seconds per worker request
+        max_concurrency: worker requests in flight at once (all shards of
+            several searches); default 8 per worker
+    """
+
+    def __init__(self, workers, timeout=120, max_concurrency=None):
+        if _native is None:
+            raise RuntimeError("Sharding requires the C++ backend (fhe_fast_mult)")
+        if requests is None:
+            raise RuntimeError("Sharding requires the 'requests' package")
+        if not workers:
+            raise ValueError("Need at least one worker")
+        self.workers = [w.rstrip('/') for w in workers]
+        self.timeout = timeout
+        self.ranges = []
+        self.params = None              # (N, q, t) of the uploaded table
+        self.columns = []
+
+        self._executor = ThreadPoolExecutor(max_workers=max_concurrency or 8 * len(self.workers))
+        self._local = threading.local()
+        self._session_ids = [None] * len(self.workers)
+        self._session_locks = [threading.Lock() for _ in self.workers]
+
+    # ------------------------------------------------------------------
+    # HTTP
+    # ------------------------------------------------------------------
+
+    def _http(self, i):
+        """Keep-alive connection to worker i, one per executor thread"""
+        sessions = getattr(self._local, 'sessions', None)
+        if sessions is None:
+            sessions = self._local.sessions = [requests.Session() for _ in self.workers]
+        return sessions[i]
+
+    def _post(self, i, path, **kwargs):
+        try:
+            r = self._http(i).post(self.workers[i] + path, timeout=self.timeout, **kwargs)
+            if r.status_code == 410:
+                raise SessionExpired(self.workers[i])
+            if r.status_code == 503:
+                raise db_store.PipelineBusy(f"Shard {self.workers[i]} is busy")
+            if r.status_code == 400:
+                raise ValueError(r.json().get('detail', r.text))
+            r.raise_for_status()
+        except requests.RequestException as e:
+            raise WorkerError(f"Shard {self.workers[i]}: {e}") from e
+        return r
+
+    # ------------------------------------------------------------------
+    # Upload and sessions
+    # ------------------------------------------------------------------
+
+    def upload(self, columns, ntt=True):
+        """
+        Partition {column name: serialization.dumps batch} across the workers
+        (same row count and parameters per column); returns the row count.
+        If any worker fails, no table is served until an upload succeeds.
+        """
+        infos = {name: _native.ciphertext_batch_info(data) for name, data in columns.items()}
+        shapes = set(infos.values())
+        if len(shapes) != 1:
+            raise ValueError("Columns must share (N, q, t) and row count")
+        N, q, t, rows = shapes.pop()
+
+        ranges = shard_ranges(rows, len(self.workers))
+
+        # Fail closed: from the first send until every worker has confirmed its
+        # shard, searches are refused rather than merging old and new shards
+        self.params = None
+        self.ranges = []
+        self._session_ids = [None] * len(self.workers)
+
+        def send(i):
+            begin, end = ranges[i]
+            files = [('columns', (name, _native.slice_ciphertexts(data, begin, end)))
+                     for name, data in columns.items()]
+            self._post(i, "/shard/db", files=files,
+                       data={'row_begin': begin, 'row_end': end, 'ntt': int(ntt)})
+
+        list(self._executor.map(send, range(len(self.workers))))
+        self.ranges = ranges
+        self.columns = list(columns)
+        self.params = (N, q, t)
+        try:
+            for i in range(len(self.workers)):
+                self._session(i)
+        except Exception:
+            self.params = None
+            raise
+        return rows
+
+    def _session(self, i, renew=False):
+        """Session id on worker i, negotiated on first use"""
+        with self._session_locks[i]:
+            if renew or self._session_ids[i] is None:
+                if self.params is None:
+                    raise RuntimeError("No database uploaded")
+                N, q, t = self.params
+                begin, end = self.ranges[i]
+                r = self._post(i, "/shard/session", json={
+                    'N': N, 'q': q, 't': t, 'row_begin': begin, 'row_end': end,
+                    'columns': self.columns})
+                self._session_ids[i] = r.json()['session']
+            return self._session_ids[i]
+
+    # ------------------------------------------------------------------
+    # Search
+    # ------------------------------------------------------------------
+
+    def _search_shard(self, i, column, query):
+        session = self._session(i)
+        for attempt in range(2):
+            try:
+                r = self._post(i, "/shard/search", files={'query_file': query},
+                               data={'session': session, 'column': column})
+                return r.content
+            except SessionExpired:
+                if attempt:
+                    raise
+                session = self._session(i, renew=True)
+
+    async def search(self, column, query):
+        """
+        Differences of every row of `column` against a serialization.dumps
+        query batch, merged over all shards (rows * len(query), row-major)
+        """
+        if self.params is None:
+            raise RuntimeError("No database uploaded")
+        if column not in self.columns:
+            raise ValueError(f"No such column: {column}")
+        loop = asyncio.get_running_loop()
+        parts = await asyncio.gather(*(
+            loop.run_in_executor(self._executor, self._search_shard, i, column, query)
+            for i in range(len(self.workers))))
+        return _native.concat_ciphertexts(parts)
+
+    def num_rows(self):
+        return self.ranges[-1][1] if self.ranges else 0
+
+    def close(self):
+        self._executor.shutdown(wait=False)
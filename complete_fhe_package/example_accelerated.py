@@ -11,7 +11,9 @@ sys.path.append(os.getcwd())
 
 try:
     from custom_fhe.bfv_scheme import BFVScheme
-    from custom_fhe.ciphertext import Ciphertext
+    from custom_fhe.ciphertext import Ciphertext, Plaintext
+    from custom_fhe.keys import PublicKey, SecretKey, RelinearizationKey
+    from custom_fhe import eval_form
     import fhe_fast_mult  # The C++ module
     CPP_AVAILABLE = True
 except ImportError as e:
@@ -27,8 +29,7 @@ class BFVSchemeAccelerated(BFVScheme):
         if self.use_cpp:
             try:
                 # Find NTT-friendly prime
-                target_q = 1 << q_bits
-                self.q = self._find_ntt_prime(target_q, N)
+                self.q = fhe_fast_mult.find_ntt_prime(N, q_bits)
 
                 # Update dependent parameters
                 from custom_fhe.polynomial import PolynomialRing
@@ -38,40 +39,119 @@ class BFVSchemeAccelerated(BFVScheme):
 
                 # Initialize C++
                 self.cpp_mult = fhe_fast_mult.BFVMultiplier(N, self.q, self.t)
+                self.cpp_ntt = fhe_fast_mult.NTT(N, self.q)
+                self.cpp_enc = fhe_fast_mult.BFVEncryptor(N, self.q, self.t, sigma)
+                self.cpp_plain = fhe_fast_mult.PlaintextEvaluator(N, self.q, self.t)
                 print(f" Accelerator active (N={N}, q={self.q})")
             except Exception as e:
                 print(f" Accelerator init failed: {e}")
                 self.use_cpp = False
 
-    def _find_ntt_prime(self, start_q, N):
-        m = 2 * N
-        q = (start_q // m) * m + 1
-        def is_prime(n):
-            if n % 2 == 0: return False
-            for i in range(3, int(n**0.5) + 1, 2):
-                if n % i == 0: return False
-            return True
-        while not is_prime(q):
-            q += m
-        return q
+    # Keys, encryption and decryption run natively (NTT products, C++ samplers)
+    def key_generation(self):
+        if not self.use_cpp:
+            return super().key_generation()
+        s, b, a = self.cpp_enc.keygen()
+        self.secret_key = SecretKey(s)
+        self.public_key = PublicKey(b, a)
+        return self.secret_key, self.public_key
+
+    def encrypt(self, plaintext, ntt=False):
+        if not self.use_cpp:
+            return super().encrypt(plaintext)
+        c0, c1 = self.cpp_enc.encrypt(np.asarray(plaintext.get_poly(), dtype=np.int64), ntt)
+        return Ciphertext([c0, c1], params={'N': self.N, 't': self.t, 'q': self.q}, is_ntt=ntt)
+
+    def encrypt_many(self, plaintexts, ntt=False):
+        if not self.use_cpp:
+            return [self.encrypt(pt) for pt in plaintexts]
+        messages = np.array([pt.get_poly() for pt in plaintexts], dtype=np.int64).reshape(-1, self.N)
+        params = {'N': self.N, 't': self.t, 'q': self.q}
+        return [Ciphertext([c0, c1], params=params, is_ntt=ntt)
+                for c0, c1 in self.cpp_enc.encrypt_many(messages, ntt)]
+
+    # Evaluation (NTT) form: add/sub stay there, multiply/relin/decrypt convert back
+    def to_ntt(self, ct):
+        return eval_form.to_ntt(self.cpp_ntt, ct) if self.use_cpp else ct
+
+    def to_coeff(self, ct):
+        return eval_form.to_coeff(self.cpp_ntt, ct) if ct.is_ntt else ct
+
+    def scan_subtract(self, db_cts, query_cts, out=None):
+        # Whole rows x targets subtraction grid in one C++ call: grid[r][j] = db[r] - query[j]
+        grid, _ = eval_form.scan_subtract(self.cpp_ntt, db_cts, query_cts, out)
+        return grid
+
+    def scan_subtract_plain(self, db_cts, targets, out=None):
+        # Same grid against known plaintext targets: no query encryption, cached encodings
+        grid, _ = eval_form.scan_subtract_plain(self.cpp_plain, self.cpp_ntt, db_cts, targets, out)
+        return grid
+
+    def add_plain(self, ct, pt):
+        return eval_form.add_plain(self.cpp_plain, ct, pt)
+
+    def sub_plain(self, ct, pt):
+        return eval_form.sub_plain(self.cpp_plain, ct, pt)
+
+    def multiply_plain(self, ct, pt):
+        return eval_form.multiply_plain_cached(self.cpp_plain, ct, pt)
+
+    def decrypt(self, ciphertext):
+        if not self.use_cpp:
+            return super().decrypt(ciphertext)
+        comps = [np.asarray(c, dtype=np.int64) for c in ciphertext.get_components()]
+        m = self.cpp_enc.decrypt(comps, ciphertext.is_ntt)
+        return Plaintext(m, params={'N': self.N, 't': self.t, 'q': self.q})
 
     def multiply(self, ct1, ct2):
         if self.use_cpp:
+            ct1, ct2 = self.to_coeff(ct1), self.to_coeff(ct2)
             c1_0, c1_1 = ct1.get_components()
             c2_0, c2_1 = ct2.get_components()
             d0, d1, d2 = self.cpp_mult.multiply_ciphertexts(
-                np.array(c1_0, dtype=np.int64),
-                np.array(c1_1, dtype=np.int64),
-                np.array(c2_0, dtype=np.int64),
-                np.array(c2_1, dtype=np.int64)
+                np.asarray(c1_0, dtype=np.int64),
+                np.asarray(c1_1, dtype=np.int64),
+                np.asarray(c2_0, dtype=np.int64),
+                np.asarray(c2_1, dtype=np.int64)
             )
-            return Ciphertext([np.array(d0), np.array(d1), np.array(d2)], params=ct1.params)
+            return Ciphertext([d0, d1, d2], params=ct1.params)
         else:
             return super().multiply(ct1, ct2)
 
+    def multiply_many(self, pairs):
+        # One call for the whole batch; the C++ thread pool splits it across cores
+        if not self.use_cpp:
+            return [self.multiply(ct1, ct2) for ct1, ct2 in pairs]
+        pairs = [(self.to_coeff(ct1), self.to_coeff(ct2)) for ct1, ct2 in pairs]
+        batch = [(tuple(np.asarray(c, dtype=np.int64) for c in ct1.get_components()),
+                  tuple(np.asarray(c, dtype=np.int64) for c in ct2.get_components()))
+                 for ct1, ct2 in pairs]
+        results = self.cpp_mult.multiply_many(batch)
+        return [Ciphertext(list(d), params=ct1.params) for d, (ct1, _) in zip(results, pairs)]
+
+    def generate_relin_key(self):
+        if not self.use_cpp:
+            return super().generate_relin_key()
+        base_bits = self.T.bit_length() - 1
+        key_b, key_a = self.cpp_enc.relin_keygen(base_bits)
+        self.relin_key = RelinearizationKey(list(zip(key_b, key_a)))
+        self.cpp_mult.set_relin_key(key_b, key_a, base_bits)
+        return self.relin_key
+
+    def relinearize(self, ciphertext):
+        if self.use_cpp and ciphertext.size == 3:
+            d0, d1, d2 = self.to_coeff(ciphertext).get_components()
+            c0, c1 = self.cpp_mult.relinearize(
+                np.asarray(d0, dtype=np.int64),
+                np.asarray(d1, dtype=np.int64),
+                np.asarray(d2, dtype=np.int64)
+            )
+            return Ciphertext([c0, c1], params=ciphertext.params)
+        return super().relinearize(ciphertext)
+
     def get_backend_info(self):
         return {
-            'backend': 'C++ Multiplication / Python Relin' if self.use_cpp else 'Pure Python',
+            'backend': 'C++ Multiplication / C++ Relin' if self.use_cpp else 'Pure Python',
             'q': self.q
         }
 
@@ -101,6 +181,9 @@ class FastFHE_Custom:
         return centered.tolist()
 
     def homomorphic_sub(self, ct1, ct2):
+        # Either operand may be in evaluation form (e.g. a query reused against every row)
+        if ct1.is_ntt or ct2.is_ntt:
+            return eval_form.sub(self.HE.cpp_ntt, ct1, ct2)
         c1_0, c1_1 = ct1.get_components()
         c2_0, c2_1 = ct2.get_components()
         d0 = self.HE.poly_ring.sub(c1_0, c2_0)
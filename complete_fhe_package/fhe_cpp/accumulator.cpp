@@ -0,0 +1,170 @@
+/*
+ * Lazy Accumulation Implementation
+ */
+
+#include "accumulator.h"
+#include "arena.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace fhe_cpp {
+
+static const size_t kBlockCoeffs = 1024;        // Coefficients per pool task (16 KB of 128-bit lanes)
+static const uint64_t kMaxLazyTerms = 1ULL << 32;
+
+// Terms are at most q (sub adds q - a), so q per term is the bound
+uint64_t lazy_add_limit(uint64_t q) {
+    return std::min<uint64_t>(kMaxLazyTerms, ~0ULL / q);
+}
+
+uint64_t lazy_product_limit(uint64_t q) {
+    // (q - 1)^2 < 2^(2 bits), so 2^(128 - 2 bits) products fit
+    int bits = 0;
+    while (bits < 64 && ((q - 1) >> bits) != 0) bits++;
+    const int spare = 128 - 2 * bits;
+    return spare >= 32 ? kMaxLazyTerms : (1ULL << spare);
+}
+
+// 128-bit lane -> [0, q); needs only that the lane did not overflow
+static inline uint64_t fold128(const Modulus& q, uint128_w v) {
+    return q.reduce(q.reduce(v.high), v.low);
+}
+
+static inline uint128_w mac(uint128_w acc, uint64_t a, uint64_t b) {
+    return add128(acc, mul64x64(a, b));
+}
+
+LazyAccumulator::LazyAccumulator(int N, ModInt q, int size)
+    : N(N), size(size), q_mod((uint64_t)q) {
+    if (N < 1 || size < 1) throw std::invalid_argument("Accumulator needs N >= 1 and size >= 1");
+    if (q < 2) throw std::invalid_argument("Modulus must be at least 2");
+    add_limit = lazy_add_limit((uint64_t)q);
+    prod_limit = lazy_product_limit((uint64_t)q);
+    sums.assign((size_t)size * N, 0);
+}
+
+void LazyAccumulator::fold_sums() {
+    for (uint64_t& v : sums) v = q_mod.reduce(v);
+    add_terms = 1;
+}
+
+void LazyAccumulator::fold_prods() {
+    for (uint128_w& v : prods) v = {fold128(q_mod, v), 0};
+    prod_terms = 1;
+}
+
+void LazyAccumulator::add(const ModInt* a) {
+    if (add_terms >= add_limit) fold_sums();
+    const size_t n = sums.size();
+    for (size_t j = 0; j < n; j++) sums[j] += (uint64_t)a[j];
+    add_terms++;
+}
+
+void LazyAccumulator::sub(const ModInt* a) {
+    // -a = q - a, still at most q per term (a = 0 adds q, which folds away)
+    if (add_terms >= add_limit) fold_sums();
+    const uint64_t q = q_mod.value();
+    const size_t n = sums.size();
+    for (size_t j = 0; j < n; j++) sums[j] += q - (uint64_t)a[j];
+    add_terms++;
+}
+
+void LazyAccumulator::fma(const ModInt* a, const ModInt* b) {
+    if (prods.empty()) prods.assign(sums.size(), uint128_w{0, 0});
+    if (prod_terms >= prod_limit) fold_prods();
+    for (int c = 0; c < size; c++) {
+        uint128_w* lane = prods.data() + (size_t)c * N;
+        const ModInt* ac = a + (size_t)c * N;
+        for (int j = 0; j < N; j++) lane[j] = mac(lane[j], (uint64_t)ac[j], (uint64_t)b[j]);
+    }
+    prod_terms++;
+}
+
+void LazyAccumulator::result_into(ModInt* out) const {
+    const uint64_t q = q_mod.value();
+    const size_t n = sums.size();
+    for (size_t j = 0; j < n; j++) {
+        uint64_t v = q_mod.reduce(sums[j]);
+        if (!prods.empty()) {
+            const uint64_t p = fold128(q_mod, prods[j]);
+            v += p;
+            v -= q & (0 - (uint64_t)(v >= q));
+        }
+        out[j] = (ModInt)v;
+    }
+}
+
+std::vector<ModInt> LazyAccumulator::result() const {
+    std::vector<ModInt> out(sums.size());
+    result_into(out.data());
+    return out;
+}
+
+void LazyAccumulator::reset() {
+    std::fill(sums.begin(), sums.end(), 0);
+    if (!prods.empty()) std::fill(prods.begin(), prods.end(), uint128_w{0, 0});
+    add_terms = 0;
+    prod_terms = 0;
+}
+
+void sum_rows(const ModInt* a, size_t count, size_t comp_len, ModInt q, ModInt* out) {
+    if (q < 2) throw std::invalid_argument("Modulus must be at least 2");
+    const Modulus q_mod((uint64_t)q);
+    const uint64_t limit = lazy_add_limit((uint64_t)q);
+
+    const size_t blocks = (comp_len + kBlockCoeffs - 1) / kBlockCoeffs;
+    default_pool()->parallel_for(blocks, [&](size_t blk) {
+        const size_t begin = blk * kBlockCoeffs;
+        const size_t len = std::min(kBlockCoeffs, comp_len - begin);
+        uint64_t acc[kBlockCoeffs] = {0};
+        uint64_t terms = 0;
+        for (size_t r = 0; r < count; r++) {
+            if (terms >= limit) {
+                for (size_t j = 0; j < len; j++) acc[j] = q_mod.reduce(acc[j]);
+                terms = 1;
+            }
+            const ModInt* row = a + r * comp_len + begin;
+            for (size_t j = 0; j < len; j++) acc[j] += (uint64_t)row[j];
+            terms++;
+        }
+        for (size_t j = 0; j < len; j++) out[begin + j] = (ModInt)q_mod.reduce(acc[j]);
+    });
+}
+
+void dot_product(const ModInt* cts, const ModInt* pts, size_t count, int size, int N,
+                 ModInt q, ModInt* out) {
+    if (q < 2) throw std::invalid_argument("Modulus must be at least 2");
+    if (size < 1 || N < 1) throw std::invalid_argument("Ciphertexts need size >= 1 and N >= 1");
+    const Modulus q_mod((uint64_t)q);
+    const uint64_t limit = lazy_product_limit((uint64_t)q);
+    const size_t n = (size_t)N;
+    const size_t ct_len = (size_t)size * n;
+
+    // Task = (component, coefficient block); the plaintext block is shared by components
+    const size_t blocks_per_comp = (n + kBlockCoeffs - 1) / kBlockCoeffs;
+    default_pool()->parallel_for((size_t)size * blocks_per_comp, [&](size_t task) {
+        const size_t c = task / blocks_per_comp;
+        const size_t begin = (task % blocks_per_comp) * kBlockCoeffs;
+        const size_t len = std::min(kBlockCoeffs, n - begin);
+
+        ScratchScope scratch;
+        uint128_w* acc = scratch.alloc<uint128_w>(len);
+        std::fill(acc, acc + len, uint128_w{0, 0});
+        uint64_t terms = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (terms >= limit) {
+                for (size_t j = 0; j < len; j++) acc[j] = {fold128(q_mod, acc[j]), 0};
+                terms = 1;
+            }
+            const ModInt* a = cts + i * ct_len + c * n + begin;
+            const ModInt* b = pts + i * n + begin;
+            for (size_t j = 0; j < len; j++) acc[j] = mac(acc[j], (uint64_t)a[j], (uint64_t)b[j]);
+            terms++;
+        }
+        ModInt* o = out + c * n + begin;
+        for (size_t j = 0; j < len; j++) o[j] = (ModInt)fold128(q_mod, acc[j]);
+    });
+}
+
+} // namespace fhe_cpp
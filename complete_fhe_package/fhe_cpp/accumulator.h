@@ -0,0 +1,80 @@
+/*
+ * Lazy Accumulation
+ * Sums of many polynomials or ciphertexts mod q without a reduction per
+ * operation. Additions collect in unsigned 64-bit lanes and products in 128-bit
+ * lanes; each tracks how many terms it holds against the headroom q allows and
+ * folds (reduces once) only when the next term could overflow, or when read.
+ * Addition and the products are linear, so this holds in either form; the
+ * fused multiply-accumulate is the NTT-form slot-wise product.
+ */
+
+#ifndef FHE_ACCUMULATOR_H
+#define FHE_ACCUMULATOR_H
+
+#include "ntt.h"
+#include "wide_arith.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace fhe_cpp {
+
+// Terms < q that fit an un-reduced unsigned 64-bit / 128-bit-product sum
+uint64_t lazy_add_limit(uint64_t q);
+uint64_t lazy_product_limit(uint64_t q);
+
+// size components of N residues each (one ciphertext, or size = 1 for a polynomial)
+class LazyAccumulator {
+private:
+    int N;
+    int size;
+    Modulus q_mod;
+    uint64_t add_limit;
+    uint64_t prod_limit;
+
+    std::vector<uint64_t> sums;         // size x N; holds add_terms values < q per lane
+    std::vector<uint128_w> prods;       // size x N; allocated by the first fma
+    uint64_t add_terms = 0;
+    uint64_t prod_terms = 0;
+
+    void fold_sums();
+    void fold_prods();
+
+public:
+    LazyAccumulator(int N, ModInt q, int size = 1);
+
+    int get_N() const { return N; }
+    int get_size() const { return size; }
+    ModInt get_q() const { return (ModInt)q_mod.value(); }
+
+    // acc += a / acc -= a for size x N residues in [0, q)
+    void add(const ModInt* a);
+    void sub(const ModInt* a);
+
+    // acc[c] += a[c] * b slot-wise: a is size x N (e.g. an NTT-form ciphertext),
+    // b is N values (e.g. an NTT-form plaintext) shared by every component
+    void fma(const ModInt* a, const ModInt* b);
+
+    // Reduced size x N result in [0, q); the accumulator is left as is
+    void result_into(ModInt* out) const;
+    std::vector<ModInt> result() const;
+
+    void reset();
+
+    // Terms waiting in each lane set since its last fold
+    uint64_t pending_additions() const { return add_terms; }
+    uint64_t pending_products() const { return prod_terms; }
+};
+
+// out (comp_len) = sum over count rows of a (count x comp_len), each in [0, q).
+// Coefficient blocks run on the default thread pool with one reduction per headroom.
+void sum_rows(const ModInt* a, size_t count, size_t comp_len, ModInt q, ModInt* out);
+
+// out (size x N) = sum_i cts[i] * pts[i] slot-wise, for cts count x size x N and
+// pts count x N in NTT form: an encrypted dot product with (plaintext) weights
+void dot_product(const ModInt* cts, const ModInt* pts, size_t count, int size, int N,
+                 ModInt q, ModInt* out);
+
+} // namespace fhe_cpp
+
+#endif // FHE_ACCUMULATOR_H
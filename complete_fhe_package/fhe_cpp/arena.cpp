@@ -0,0 +1,58 @@
+/*
+ * Scratch Arena Implementation
+ */
+
+#include "arena.h"
+#include "stats.h"
+#include <algorithm>
+
+namespace fhe_cpp {
+
+void* aligned_alloc_bytes(size_t bytes) {
+    return ::operator new(std::max<size_t>(bytes, 1), std::align_val_t(kScratchAlign));
+}
+
+void aligned_free_bytes(void* p) {
+    ::operator delete(p, std::align_val_t(kScratchAlign));
+}
+
+ScratchArena::~ScratchArena() {
+    for (Block& b : blocks) aligned_free_bytes(b.data);
+}
+
+ScratchArena& ScratchArena::local() {
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+void* ScratchArena::allocate(size_t bytes) {
+    bytes = (bytes + kScratchAlign - 1) / kScratchAlign * kScratchAlign;
+
+    // Bump within the current block, else move on to the first later block that fits
+    while (current < blocks.size()) {
+        if (offset + bytes <= blocks[current].size) {
+            void* p = blocks[current].data + offset;
+            offset += bytes;
+            return p;
+        }
+        current++;
+        offset = 0;
+    }
+
+    // Grow geometrically so a steady workload settles on a handful of blocks
+    size_t size = std::max(kScratchBlockBytes, bytes);
+    if (!blocks.empty()) size = std::max(size, 2 * blocks.back().size);
+    FHE_STAT_BYTES(Stat::ArenaGrow, size);
+    blocks.push_back({static_cast<uint8_t*>(aligned_alloc_bytes(size)), size});
+    current = blocks.size() - 1;
+    offset = bytes;
+    return blocks[current].data;
+}
+
+size_t ScratchArena::reserved_bytes() const {
+    size_t total = 0;
+    for (const Block& b : blocks) total += b.size;
+    return total;
+}
+
+} // namespace fhe_cpp
@@ -0,0 +1,126 @@
+/*
+ * Scratch Arena and Flat Ciphertexts
+ * Per-thread bump allocator for kernel temporaries: 64-byte-aligned blocks that
+ * are kept for the life of the thread, so once a kernel has run at a given size
+ * its temporaries cost no heap traffic. A ScratchScope records the arena's top
+ * and rewinds to it on exit, so nested kernels stack their scratch in the same
+ * memory. FlatCiphertext holds size x N coefficients in one aligned buffer.
+ */
+
+#ifndef FHE_ARENA_H
+#define FHE_ARENA_H
+
+#include "ntt.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace fhe_cpp {
+
+const size_t kScratchAlign = 64;                    // Cache line / AVX-512 vector
+const size_t kScratchBlockBytes = 1 << 20;          // Smallest block the arena reserves
+
+void* aligned_alloc_bytes(size_t bytes);
+void aligned_free_bytes(void* p);
+
+class ScratchArena {
+private:
+    struct Block {
+        uint8_t* data;
+        size_t size;
+    };
+    std::vector<Block> blocks;
+    size_t current = 0;                 // Block being bumped
+    size_t offset = 0;                  // Bytes used in blocks[current]
+
+    ScratchArena() = default;
+
+public:
+    struct Mark {
+        size_t block;
+        size_t offset;
+    };
+
+    ~ScratchArena();
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    // The calling thread's arena
+    static ScratchArena& local();
+
+    // Uninitialized, 64-byte-aligned storage for bytes; valid until the enclosing rewind
+    void* allocate(size_t bytes);
+
+    Mark mark() const { return {current, offset}; }
+    void rewind(const Mark& m) { current = m.block; offset = m.offset; }
+
+    size_t reserved_bytes() const;
+    size_t block_count() const { return blocks.size(); }
+};
+
+// Scratch for one kernel invocation, released (not freed) when the scope ends
+class ScratchScope {
+private:
+    ScratchArena& arena;
+    ScratchArena::Mark start;
+
+public:
+    ScratchScope() : arena(ScratchArena::local()), start(arena.mark()) {}
+    ~ScratchScope() { arena.rewind(start); }
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+    template <typename T>
+    T* alloc(size_t n) { return static_cast<T*>(arena.allocate(n * sizeof(T))); }
+};
+
+// std::allocator drop-in with 64-byte alignment
+template <typename T>
+struct AlignedAllocator {
+    typedef T value_type;
+
+    AlignedAllocator() = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(aligned_alloc_bytes(n * sizeof(T))); }
+    void deallocate(T* p, size_t) { aligned_free_bytes(p); }
+
+    template <typename U> bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+typedef std::vector<ModInt, AlignedAllocator<ModInt>> AlignedPoly;
+
+// size components of N coefficients, component i at data() + i N
+class FlatCiphertext {
+private:
+    int N = 0;
+    int size = 0;
+    AlignedPoly coeffs;
+
+public:
+    bool ntt_form = false;
+
+    FlatCiphertext() = default;
+    FlatCiphertext(int size, int N) { resize(size, N); }
+
+    // Keeps the buffer when it is already large enough
+    void resize(int new_size, int new_N) {
+        size = new_size;
+        N = new_N;
+        coeffs.resize((size_t)size * N);
+    }
+
+    int get_N() const { return N; }
+    int get_size() const { return size; }
+
+    ModInt* data() { return coeffs.data(); }
+    const ModInt* data() const { return coeffs.data(); }
+    ModInt* component(int i) { return coeffs.data() + (size_t)i * N; }
+    const ModInt* component(int i) const { return coeffs.data() + (size_t)i * N; }
+};
+
+} // namespace fhe_cpp
+
+#endif // FHE_ARENA_H
@@ -0,0 +1,69 @@
+/*
+ * BFV Batch Encoder Implementation
+ */
+
+#include "batch_encoder.h"
+#include "primes.h"
+#include <stdexcept>
+
+namespace fhe_cpp {
+
+static ModInt checked_plain_modulus(int N, ModInt t) {
+    if (N < 4 || (N & (N - 1)) != 0) throw std::invalid_argument("N must be a power of two >= 4");
+    if (t < 3 || !is_prime((uint64_t)t) || ((uint64_t)t - 1) % (2 * (uint64_t)N) != 0) {
+        throw std::invalid_argument("Batching needs a prime t = 1 (mod 2N)");
+    }
+    return t;
+}
+
+BatchEncoder::BatchEncoder(int N, ModInt t) : ntt(N, checked_plain_modulus(N, t)), N(N), t(t) {
+    if (!ntt.is_valid()) throw std::runtime_error("NTT mod t init failed");
+
+    int log_n = 0;
+    while ((1 << log_n) < N) log_n++;
+    auto bitrev = [log_n](uint64_t x) {
+        uint64_t r = 0;
+        for (int b = 0; b < log_n; b++) r |= ((x >> b) & 1) << (log_n - 1 - b);
+        return (int)r;
+    };
+
+    // NTT slot k holds a(psi^(2 bitrev(k) + 1)), so exponent e sits at bitrev((e - 1) / 2)
+    const uint64_t m = 2 * (uint64_t)N;
+    const int half = N / 2;
+    slot_to_ntt.resize(N);
+    uint64_t e = 1;
+    for (int i = 0; i < half; i++) {
+        slot_to_ntt[i] = bitrev((e - 1) / 2);
+        slot_to_ntt[half + i] = bitrev((m - e - 1) / 2);
+        e = e * 3 % m;
+    }
+}
+
+std::vector<ModInt> BatchEncoder::encode(const std::vector<ModInt>& values) const {
+    if ((int)values.size() > N) throw std::invalid_argument("More values than slots");
+
+    std::vector<ModInt> res(N, 0);
+    for (size_t i = 0; i < values.size(); i++) {
+        ModInt v = values[i] % t;
+        res[slot_to_ntt[i]] = (v < 0) ? v + t : v;
+    }
+    ntt.inverse(res);
+    return res;
+}
+
+std::vector<ModInt> BatchEncoder::decode(const std::vector<ModInt>& poly) const {
+    if ((int)poly.size() != N) throw std::invalid_argument("Plaintext has wrong length");
+
+    std::vector<ModInt> evals(N);
+    for (int i = 0; i < N; i++) {
+        ModInt v = poly[i] % t;
+        evals[i] = (v < 0) ? v + t : v;
+    }
+    ntt.forward(evals);
+
+    std::vector<ModInt> res(N);
+    for (int i = 0; i < N; i++) res[i] = evals[slot_to_ntt[i]];
+    return res;
+}
+
+} // namespace fhe_cpp
@@ -0,0 +1,45 @@
+/*
+ * BFV Batch Encoder
+ * CRT slot packing for a prime plaintext modulus t = 1 (mod 2N): the N slots are
+ * the evaluations of the plaintext polynomial at the primitive 2N-th roots of
+ * unity mod t, so slot-wise add/multiply of plaintexts is ring add/multiply and
+ * one ciphertext carries N values.
+ *
+ * Slots form a 2 x (N/2) matrix: row 0, column i is the root psi^(3^i), row 1
+ * is psi^(-3^i). The automorphism X -> X^(3^k) rotates both rows left by k
+ * and X -> X^(2N-1) swaps them.
+ */
+
+#ifndef FHE_BATCH_ENCODER_H
+#define FHE_BATCH_ENCODER_H
+
+#include "ntt.h"
+#include <vector>
+
+namespace fhe_cpp {
+
+class BatchEncoder {
+private:
+    NTT ntt;                            // Negacyclic NTT mod t
+    int N;
+    ModInt t;
+    std::vector<int> slot_to_ntt;       // Logical slot -> bit-reversed NTT position
+
+public:
+    // Throws std::invalid_argument unless t is a prime = 1 (mod 2N)
+    BatchEncoder(int N, ModInt t);
+
+    int slot_count() const { return N; }
+    int row_size() const { return N / 2; }
+    ModInt get_t() const { return t; }
+
+    // Up to N values (taken mod t, missing slots are 0) -> plaintext coefficients mod t
+    std::vector<ModInt> encode(const std::vector<ModInt>& values) const;
+
+    // Plaintext coefficients (any integers, taken mod t) -> N slot values in [0, t)
+    std::vector<ModInt> decode(const std::vector<ModInt>& poly) const;
+};
+
+} // namespace fhe_cpp
+
+#endif // FHE_BATCH_ENCODER_H
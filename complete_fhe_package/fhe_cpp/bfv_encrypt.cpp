@@ -0,0 +1,306 @@
+/*
+ * BFV Key Generation, Encryption and Decryption Implementation
+ */
+
+#include "bfv_encrypt.h"
+#include "galois.h"
+#include "sampling.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace fhe_cpp {
+
+BFVEncryptor::BFVEncryptor(int N, ModInt q, ModInt t, double sigma)
+    : ntt(N, q), N(N), q(q), t(t), sigma(sigma), q_mod((uint64_t)q) {
+    if (!ntt.is_valid()) throw std::runtime_error("NTT init failed");
+    if (t < 2 || t >= q) throw std::invalid_argument("Plaintext modulus must be in [2, q)");
+    if (sigma <= 0) throw std::invalid_argument("sigma must be positive");
+    delta = q / t;
+    noise_bound = 6 * (int64_t)sigma;
+}
+
+std::vector<ModInt> BFVEncryptor::to_ntt(const std::vector<ModInt>& a) const {
+    if ((int)a.size() != N) throw std::invalid_argument("Polynomial has wrong length");
+    std::vector<ModInt> res(N);
+    for (int i = 0; i < N; i++) {
+        ModInt r = a[i] % q;
+        res[i] = (r < 0) ? r + q : r;
+    }
+    ntt.forward(res);
+    return res;
+}
+
+std::vector<ModInt> BFVEncryptor::rlwe_sample(const std::vector<ModInt>& a) const {
+    std::vector<ModInt> e = sample_gaussian(N, sigma, noise_bound);
+
+    std::vector<ModInt> as = to_ntt(a);
+    ntt.pointwise_multiply_into(as.data(), s_ntt.data(), as.data(), N);
+    ntt.inverse(as);
+
+    std::vector<ModInt> b(N);
+    for (int i = 0; i < N; i++) {
+        ModInt v = as[i] + e[i];                 // in (-q, 2q)
+        if (v >= q) v -= q;
+        if (v < 0) v += q;
+        b[i] = (v == 0) ? 0 : q - v;
+    }
+    return b;
+}
+
+std::vector<std::vector<ModInt>> BFVEncryptor::keygen() {
+    std::vector<ModInt> s = sample_ternary(N);
+    s_ntt = to_ntt(s);
+
+    pk_seed = random_seed();
+    std::vector<ModInt> a = expand_uniform(pk_seed, 0, N, q);
+    std::vector<ModInt> b = rlwe_sample(a);
+    pk_b_ntt = to_ntt(b);
+    pk_a_ntt = to_ntt(a);
+    pk_seeded = true;
+    return {s, b, a};
+}
+
+void BFVEncryptor::set_secret_key(const std::vector<ModInt>& s) {
+    s_ntt = to_ntt(s);
+}
+
+void BFVEncryptor::set_public_key(const std::vector<ModInt>& b, const std::vector<ModInt>& a) {
+    pk_b_ntt = to_ntt(b);
+    pk_a_ntt = to_ntt(a);
+    pk_seeded = false;
+}
+
+void BFVEncryptor::set_public_key(const std::vector<ModInt>& b, const Seed& a_seed) {
+    pk_b_ntt = to_ntt(b);
+    pk_a_ntt = to_ntt(expand_uniform(a_seed, 0, N, q));
+    pk_seed = a_seed;
+    pk_seeded = true;
+}
+
+const Seed& BFVEncryptor::public_key_seed() const {
+    if (!pk_seeded) throw std::runtime_error("Public key has no seed");
+    return pk_seed;
+}
+
+int BFVEncryptor::gadget_digits(int base_bits) const {
+    if (base_bits < 1 || base_bits > 62) throw std::invalid_argument("base_bits must be in [1, 62]");
+
+    int q_bits = 0;
+    while (q_bits < 64 && ((uint64_t)(q - 1) >> q_bits) != 0) q_bits++;
+    return (q_bits + base_bits - 1) / base_bits;
+}
+
+void BFVEncryptor::switch_key_digit(const std::vector<ModInt>& target, int base_bits, int d, const Seed& seed,
+                                    std::vector<ModInt>& b, std::vector<ModInt>& a) const {
+    const uint64_t T_pow = q_mod.pow(q_mod.reduce(1ULL << base_bits), (uint64_t)d);
+    a = expand_uniform(seed, (uint64_t)d, N, q);
+    b = rlwe_sample(a);
+    for (int i = 0; i < N; i++) {
+        uint64_t v = (uint64_t)b[i] + q_mod.mul(T_pow, (uint64_t)target[i]);
+        b[i] = (ModInt)((v >= (uint64_t)q) ? v - q : v);
+    }
+}
+
+void BFVEncryptor::switch_keygen(const std::vector<ModInt>& target, int base_bits,
+                                 std::vector<std::vector<ModInt>>& key_b,
+                                 std::vector<std::vector<ModInt>>& key_a,
+                                 Seed* a_seed) const {
+    if (!has_secret_key()) throw std::runtime_error("Secret key not set");
+    const int num_digits = gadget_digits(base_bits);
+
+    const Seed seed = random_seed();
+    if (a_seed) *a_seed = seed;
+
+    // Digits are independent: the errors come from per-thread samplers
+    key_b.assign(num_digits, std::vector<ModInt>());
+    key_a.assign(num_digits, std::vector<ModInt>());
+    default_pool()->parallel_for((size_t)num_digits, [&](size_t d) {
+        switch_key_digit(target, base_bits, (int)d, seed, key_b[d], key_a[d]);
+    });
+}
+
+void BFVEncryptor::relin_keygen(int base_bits,
+                                std::vector<std::vector<ModInt>>& key_b,
+                                std::vector<std::vector<ModInt>>& key_a,
+                                Seed* a_seed) const {
+    if (!has_secret_key()) throw std::runtime_error("Secret key not set");
+
+    std::vector<ModInt> s2(N);
+    ntt.pointwise_multiply_into(s_ntt.data(), s_ntt.data(), s2.data(), N);
+    ntt.inverse(s2);
+    switch_keygen(s2, base_bits, key_b, key_a, a_seed);
+}
+
+void BFVEncryptor::galois_keygen(uint64_t galois_elt, int base_bits,
+                                 std::vector<std::vector<ModInt>>& key_b,
+                                 std::vector<std::vector<ModInt>>& key_a,
+                                 Seed* a_seed) const {
+    if (!has_secret_key()) throw std::runtime_error("Secret key not set");
+
+    std::vector<ModInt> s = s_ntt;
+    ntt.inverse(s);
+    switch_keygen(apply_galois(s, galois_elt, q), base_bits, key_b, key_a, a_seed);
+}
+
+KeyBundle BFVEncryptor::keygen_bundle(int base_bits, const std::vector<uint64_t>& galois_elts) {
+    const int num_digits = gadget_digits(base_bits);
+    for (uint64_t g : galois_elts) {
+        if ((g & 1) == 0 || g >= 2 * (uint64_t)N) throw std::invalid_argument("Galois element must be odd and below 2N");
+    }
+
+    KeyBundle bundle;
+    std::vector<std::vector<ModInt>> pk = keygen();
+    bundle.secret = std::move(pk[0]);
+    bundle.pk_b = std::move(pk[1]);
+    bundle.pk_a = std::move(pk[2]);
+    bundle.pk_seed = pk_seed;
+    bundle.galois_elts = galois_elts;
+    bundle.galois.resize(galois_elts.size());
+
+    // Key 0 switches from s^2, key 1 + j from s(X^g_j)
+    const size_t num_keys = 1 + galois_elts.size();
+    std::vector<SwitchKey*> keys(num_keys);
+    keys[0] = &bundle.relin;
+    for (size_t j = 0; j < galois_elts.size(); j++) keys[1 + j] = &bundle.galois[j];
+    for (SwitchKey* k : keys) {
+        k->seed = random_seed();
+        k->key_b.assign(num_digits, std::vector<ModInt>());
+        k->key_a.assign(num_digits, std::vector<ModInt>());
+    }
+
+    std::vector<ModInt> s(N);
+    for (int i = 0; i < N; i++) s[i] = (bundle.secret[i] < 0) ? bundle.secret[i] + q : bundle.secret[i];
+    std::vector<std::vector<ModInt>> targets(num_keys);
+    default_pool()->parallel_for(num_keys, [&](size_t k) {
+        if (k == 0) {
+            targets[0].resize(N);
+            ntt.pointwise_multiply_into(s_ntt.data(), s_ntt.data(), targets[0].data(), N);
+            ntt.inverse(targets[0]);
+        } else {
+            targets[k] = apply_galois(s, galois_elts[k - 1], q);
+        }
+    });
+
+    // One flat loop over every (key, digit) so the pool stays busy even for few keys
+    default_pool()->parallel_for(num_keys * (size_t)num_digits, [&](size_t task) {
+        const size_t k = task / num_digits;
+        const int d = (int)(task % num_digits);
+        switch_key_digit(targets[k], base_bits, d, keys[k]->seed, keys[k]->key_b[d], keys[k]->key_a[d]);
+    });
+    return bundle;
+}
+
+void BFVEncryptor::add_scaled_message(const std::vector<ModInt>& m, std::vector<ModInt>& e) const {
+    for (int i = 0; i < N; i++) {
+        ModInt mi = m[i] % t;
+        if (mi < 0) mi += t;
+        ModInt v = e[i] + (ModInt)q_mod.mul((uint64_t)delta, (uint64_t)mi);
+        if (v >= q) v -= q;
+        if (v < 0) v += q;
+        e[i] = v;
+    }
+}
+
+std::vector<std::vector<ModInt>> BFVEncryptor::encrypt(const std::vector<ModInt>& m, bool ntt_form) const {
+    if (!has_public_key()) throw std::runtime_error("Public key not set");
+    if ((int)m.size() != N) throw std::invalid_argument("Message has wrong length");
+
+    std::vector<ModInt> u = to_ntt(sample_ternary(N));
+    std::vector<ModInt> e1 = sample_gaussian(N, sigma, noise_bound);
+    std::vector<ModInt> e2 = sample_gaussian(N, sigma, noise_bound);
+
+    // e1 + delta m and e2, reduced mod q
+    add_scaled_message(m, e1);
+    for (int i = 0; i < N; i++) {
+        if (e2[i] < 0) e2[i] += q;
+    }
+
+    std::vector<ModInt> c0(N), c1(N);
+    ntt.pointwise_multiply_into(pk_b_ntt.data(), u.data(), c0.data(), N);
+    ntt.pointwise_multiply_into(pk_a_ntt.data(), u.data(), c1.data(), N);
+
+    // Add the errors in whichever domain the output is in
+    if (ntt_form) {
+        ntt.forward(e1);
+        ntt.forward(e2);
+    } else {
+        ntt.inverse(c0);
+        ntt.inverse(c1);
+    }
+    ntt.add_into(c0.data(), e1.data(), c0.data(), N);
+    ntt.add_into(c1.data(), e2.data(), c1.data(), N);
+    return {c0, c1};
+}
+
+std::vector<ModInt> BFVEncryptor::encrypt_symmetric(const std::vector<ModInt>& m, Seed& a_seed,
+                                                    bool ntt_form) const {
+    if (!has_secret_key()) throw std::runtime_error("Secret key not set");
+    if ((int)m.size() != N) throw std::invalid_argument("Message has wrong length");
+
+    a_seed = random_seed();
+    std::vector<ModInt> c0 = rlwe_sample(expand_uniform(a_seed, 0, N, q));
+
+    std::vector<ModInt> dm(N, 0);
+    add_scaled_message(m, dm);
+    ntt.add_into(c0.data(), dm.data(), c0.data(), N);
+    if (ntt_form) ntt.forward(c0);
+    return c0;
+}
+
+std::vector<ModInt> BFVEncryptor::phase(const std::vector<std::vector<ModInt>>& ct, bool ntt_form) const {
+    if (!has_secret_key()) throw std::runtime_error("Secret key not set");
+    if (ct.size() < 2) throw std::invalid_argument("Ciphertext needs at least two components");
+    for (const auto& c : ct) {
+        if ((int)c.size() != N) throw std::invalid_argument("Ciphertext component has wrong length");
+    }
+
+    // Horner in the NTT domain: ((c_k s + c_{k-1}) s + ...) s + c_0. A coefficient-form
+    // c_0 is added after the inverse, so it needs no transform.
+    const size_t k = ct.size() - 1;
+    std::vector<ModInt> acc = ct[k];
+    if (!ntt_form) ntt.forward(acc);
+    std::vector<ModInt> c;
+    for (size_t i = k; i-- > 0;) {
+        ntt.pointwise_multiply_into(acc.data(), s_ntt.data(), acc.data(), N);
+        if (i == 0 && !ntt_form) break;
+        c = ct[i];
+        if (!ntt_form) ntt.forward(c);
+        ntt.add_into(acc.data(), c.data(), acc.data(), N);
+    }
+    ntt.inverse(acc);
+    if (!ntt_form) ntt.add_into(acc.data(), ct[0].data(), acc.data(), N);
+    return acc;
+}
+
+std::vector<ModInt> BFVEncryptor::decrypt(const std::vector<std::vector<ModInt>>& ct, bool ntt_form) const {
+    const std::vector<ModInt> acc = phase(ct, ntt_form);
+
+    // m_i = floor((x t + q/2) / q) mod t; x t < q 2^64, so the 128-bit quotient fits a word
+    const uint64_t t_64 = (uint64_t)t;
+    std::vector<ModInt> m(N);
+    for (int i = 0; i < N; i++) {
+        uint128_w num = add128(mul64x64((uint64_t)acc[i], t_64), {(uint64_t)q / 2, 0});
+        uint64_t rem;
+        uint64_t quot = q_mod.divrem(num.high, num.low, rem);
+        m[i] = (ModInt)(quot % t_64);
+    }
+    return m;
+}
+
+int BFVEncryptor::noise_budget(const std::vector<std::vector<ModInt>>& ct, bool ntt_form) const {
+    const std::vector<ModInt> acc = phase(ct, ntt_form);
+
+    // t ct(s) = t e - (q mod t) m (mod q): the message drops out up to its rounding term
+    uint64_t norm = 0;
+    for (int i = 0; i < N; i++) {
+        uint64_t x = q_mod.mul((uint64_t)acc[i], (uint64_t)t);
+        norm = std::max(norm, std::min(x, (uint64_t)q - x));
+    }
+    if (norm == 0) norm = 1;
+    const double bits = std::log2((double)q) - std::log2(2.0 * (double)norm);
+    return bits > 0 ? (int)bits : 0;
+}
+
+} // namespace fhe_cpp
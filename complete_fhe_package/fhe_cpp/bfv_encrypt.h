@@ -0,0 +1,138 @@
+/*
+ * BFV Key Generation, Encryption and Decryption
+ * Native counterpart of custom_fhe.BFVScheme: every ring product goes through
+ * the NTT, and the keys are held in NTT form so each encryption costs one
+ * forward and two inverse transforms.
+ */
+
+#ifndef FHE_BFV_ENCRYPT_H
+#define FHE_BFV_ENCRYPT_H
+
+#include "ntt.h"
+#include "prng.h"
+#include "wide_arith.h"
+#include <vector>
+
+namespace fhe_cpp {
+
+// Key-switching key: b_i + a_i s = T^i target + e_i, a_i = expand_uniform(seed, i, N, q)
+struct SwitchKey {
+    std::vector<std::vector<ModInt>> key_b;
+    std::vector<std::vector<ModInt>> key_a;
+    Seed seed;
+};
+
+// Every key of a fresh context (BFVEncryptor::keygen_bundle)
+struct KeyBundle {
+    std::vector<ModInt> secret;         // Signed, in {-1, 0, 1}
+    std::vector<ModInt> pk_b;
+    std::vector<ModInt> pk_a;
+    Seed pk_seed;
+    SwitchKey relin;                    // From s^2
+    std::vector<uint64_t> galois_elts;
+    std::vector<SwitchKey> galois;      // galois[j] switches from s(X^galois_elts[j])
+};
+
+class BFVEncryptor {
+private:
+    NTT ntt;
+    int N;
+    ModInt q;
+    ModInt t;
+    ModInt delta;                       // floor(q / t)
+    double sigma;
+    int64_t noise_bound;                // Errors are clipped to 6 sigma
+    Modulus q_mod;
+
+    std::vector<ModInt> s_ntt;          // Secret key, NTT form
+    std::vector<ModInt> pk_b_ntt;       // Public key, NTT form
+    std::vector<ModInt> pk_a_ntt;
+    Seed pk_seed;                       // pk_a = expand_uniform(pk_seed, 0, N, q)
+    bool pk_seeded = false;
+
+    // Signed or reduced coefficients -> NTT form mod q
+    std::vector<ModInt> to_ntt(const std::vector<ModInt>& a) const;
+
+    // Coefficient-form -(a s + e) for a uniform coefficient-form a
+    std::vector<ModInt> rlwe_sample(const std::vector<ModInt>& a) const;
+
+    // Digits of q in base 2^base_bits
+    int gadget_digits(int base_bits) const;
+
+    // Digit d of the key for `target`, with a expanded from `seed`
+    void switch_key_digit(const std::vector<ModInt>& target, int base_bits, int d, const Seed& seed,
+                          std::vector<ModInt>& b, std::vector<ModInt>& a) const;
+
+    // Digits b_i + a_i s = T^i target + e_i for a coefficient-form target (s^2, s(X^g), ...),
+    // generated in parallel on the default pool
+    void switch_keygen(const std::vector<ModInt>& target, int base_bits,
+                       std::vector<std::vector<ModInt>>& key_b,
+                       std::vector<std::vector<ModInt>>& key_a,
+                       Seed* a_seed) const;
+
+    // m mod t scaled by delta, plus e, reduced into [0, q)
+    void add_scaled_message(const std::vector<ModInt>& m, std::vector<ModInt>& e) const;
+
+    // c0 + c1 s + c2 s^2 + ... mod q, coefficient form
+    std::vector<ModInt> phase(const std::vector<std::vector<ModInt>>& ct, bool ntt_form) const;
+
+public:
+    BFVEncryptor(int N, ModInt q, ModInt t, double sigma = 3.2);
+
+    ModInt get_delta() const { return delta; }
+    int get_N() const { return N; }
+
+    // Fresh ternary secret s and public key (b, a) with b = -(a s + e); both are kept.
+    // a is expanded from a fresh seed (public_key_seed). Returns {s, b, a}, s signed in {-1, 0, 1}.
+    std::vector<std::vector<ModInt>> keygen();
+
+    // Load existing keys (s signed or reduced mod q)
+    void set_secret_key(const std::vector<ModInt>& s);
+    void set_public_key(const std::vector<ModInt>& b, const std::vector<ModInt>& a);
+    void set_public_key(const std::vector<ModInt>& b, const Seed& a_seed);
+    bool has_secret_key() const { return !s_ntt.empty(); }
+    bool has_public_key() const { return !pk_b_ntt.empty(); }
+
+    // Seed of the current public key's a; throws if the key was loaded as a full polynomial
+    const Seed& public_key_seed() const;
+
+    // Digit i: b_i + a_i s = T^i s^2 + e_i with T = 2^base_bits, enough digits to cover q
+    // (BFVMultiplier::set_relin_key input). a_i = expand_uniform(seed, i, N, q); the seed
+    // is stored in a_seed when given.
+    void relin_keygen(int base_bits,
+                      std::vector<std::vector<ModInt>>& key_b,
+                      std::vector<std::vector<ModInt>>& key_a,
+                      Seed* a_seed = nullptr) const;
+
+    // Same gadget for s(X^g): switches a ciphertext under s(X^g) back to s
+    // (BFVMultiplier::set_galois_key input)
+    void galois_keygen(uint64_t galois_elt, int base_bits,
+                       std::vector<std::vector<ModInt>>& key_b,
+                       std::vector<std::vector<ModInt>>& key_a,
+                       Seed* a_seed = nullptr) const;
+
+    // keygen() followed by the relinearization key and one Galois key per element, all
+    // digits of all keys generated in one pass over the default pool
+    KeyBundle keygen_bundle(int base_bits, const std::vector<uint64_t>& galois_elts);
+
+    // (pk_b u + e1 + delta m, pk_a u + e2) for N coefficients m (taken mod t).
+    // Coefficient form unless ntt_form.
+    std::vector<std::vector<ModInt>> encrypt(const std::vector<ModInt>& m, bool ntt_form = false) const;
+
+    // Secret-key encryption (-(a s + e) + delta m, a) with a = expand_uniform(a_seed, 0, N, q):
+    // returns c0 and the seed, which stands in for c1 (half the ciphertext size).
+    // c0 is in NTT form if ntt_form; a is always expanded in coefficient form.
+    std::vector<ModInt> encrypt_symmetric(const std::vector<ModInt>& m, Seed& a_seed,
+                                          bool ntt_form = false) const;
+
+    // round(t/q * (c0 + c1 s + c2 s^2 + ...)) mod t; ntt_form gives the form of ct
+    std::vector<ModInt> decrypt(const std::vector<std::vector<ModInt>>& ct, bool ntt_form = false) const;
+
+    // Invariant noise budget in bits: log2(q / (2 ||[t ct(s)]_q||)), the headroom left
+    // before decryption fails (0 once it has). Needs the secret key.
+    int noise_budget(const std::vector<std::vector<ModInt>>& ct, bool ntt_form = false) const;
+};
+
+} // namespace fhe_cpp
+
+#endif // FHE_BFV_ENCRYPT_H
@@ -1,153 +1,487 @@
 /*
  * BFV Multiplier - FINAL FIXED VERSION
  * Fixed: div192_by_64_safe now preserves the full >64-bit quotient.
+ * Portable: all wide arithmetic goes through wide_arith.h (Barrett, no divides).
  */
 
 #include "bfv_mult.h"
+#include "arena.h"
+#include "galois.h"
+#include "gpu.h"
+#include "primes.h"
+#include "stats.h"
+#include "thread_pool.h"
 #include <vector>
 #include <algorithm>
 #include <stdexcept>
 
-#ifdef _MSC_VER
-#include <intrin.h>
-#pragma intrinsic(_umul128)
-#pragma intrinsic(_udiv128)
-#endif
-
 namespace fhe_cpp {
 
-struct uint128_w { unsigned __int64 low; unsigned __int64 high; };
-struct uint192_w { unsigned __int64 low; unsigned __int64 mid; unsigned __int64 high; };
+// floor(num / q) mod q: long division over the three words, then the
+// quotient q_2 * 2^128 + q_1 * 2^64 + q_0 is folded mod q by Horner
+uint64_t div192_by_64_modulo_q(uint192_w num, const Modulus& q) {
+    uint64_t rem_high;
+    uint64_t quot_top = q.divrem(0, num.high, rem_high);
+
+    uint64_t rem_mid;
+    uint64_t quot_high = q.divrem(rem_high, num.mid, rem_mid);
+
+    uint64_t rem_low;
+    uint64_t quot_low = q.divrem(rem_mid, num.low, rem_low);
 
-uint128_w add128(uint128_w a, uint128_w b) {
-    uint128_w res; res.low = a.low + b.low;
-    res.high = a.high + b.high + (res.low < a.low ? 1 : 0);
+    uint64_t res = q.reduce(quot_top);
+    res = q.reduce(res, quot_high);
+    res = q.reduce(res, quot_low);
     return res;
 }
 
-uint128_w sub128(uint128_w a, uint128_w b) {
-    uint128_w res; res.low = a.low - b.low;
-    unsigned __int64 borrow = (a.low < b.low) ? 1 : 0;
-    res.high = a.high - b.high - borrow;
-    return res;
+// Round(t * v / q) mod q for an exact coefficient v = (negative ? -mag : mag)
+ModInt scale_round_coeff(uint192_w mag, bool negative, const Modulus& q, uint64_t t_64) {
+    uint192_w num = mul192x64(mag, t_64);
+    num = add192_scalar(num, q.value() / 2);
+
+    uint64_t scaled = div192_by_64_modulo_q(num, q);
+    if (negative && scaled != 0) scaled = q.value() - scaled;
+    return (ModInt)scaled;
 }
 
-uint128_w mul64x64(unsigned __int64 a, unsigned __int64 b) {
-    uint128_w res;
-#ifdef _MSC_VER
-    res.low = _umul128(a, b, &res.high);
-#else
-    unsigned __int128 p = (unsigned __int128)a * b;
-    res.low = (unsigned __int64)p; res.high = (unsigned __int64)(p >> 64);
-#endif
-    return res;
+// Fixed-width little-endian multiword integer for CRT reconstruction
+static const int kMaxAuxPrimes = 4;
+typedef uint64_t Limbs[kMaxAuxPrimes];
+
+// v = v * m + a over n limbs
+void limbs_mul_add(Limbs v, int n, uint64_t m, uint64_t a) {
+    uint64_t carry = a;
+    for (int i = 0; i < n; i++) {
+        uint128_w p = mul64x64(v[i], m);
+        p.low += carry;
+        p.high += (p.low < carry) ? 1 : 0;
+        v[i] = p.low;
+        carry = p.high;
+    }
 }
 
-uint192_w mul128x64_full(uint128_w a, unsigned __int64 b) {
-    uint128_w p_low = mul64x64(a.low, b);
-    uint128_w p_high = mul64x64(a.high, b);
-    uint192_w res; res.low = p_low.low;
-    unsigned __int64 mid_sum = p_low.high + p_high.low;
-    unsigned __int64 carry_mid = (mid_sum < p_low.high) ? 1 : 0;
-    res.mid = mid_sum; res.high = p_high.high + carry_mid;
-    return res;
+// a > b over n limbs
+bool limbs_greater(const Limbs a, const std::vector<uint64_t>& b, int n) {
+    for (int i = n - 1; i >= 0; i--) {
+        if (a[i] != b[i]) return a[i] > b[i];
+    }
+    return false;
 }
 
-uint192_w add192_scalar(uint192_w a, unsigned __int64 b) {
-    uint192_w res = a; res.low += b;
-    if (res.low < b) { res.mid++; if (res.mid == 0) res.high++; }
-    return res;
+// a = b - a over n limbs (requires b >= a)
+void limbs_rsub(Limbs a, const std::vector<uint64_t>& b, int n) {
+    uint64_t borrow = 0;
+    for (int i = 0; i < n; i++) {
+        uint64_t bi = b[i];
+        uint64_t d = bi - a[i] - borrow;
+        borrow = (bi < a[i] || (bi == a[i] && borrow)) ? 1 : 0;
+        a[i] = d;
+    }
+}
+
+BFVMultiplier::BFVMultiplier(int N, ModInt q, ModInt t)
+    : ntt(N, q), N(N), q(q), t(t), delta(q / t), mode(TensorMode::NTT), q_mod((uint64_t)q) {
+    if (!ntt.is_valid()) throw std::runtime_error("NTT init failed");
+    init_aux_basis();
 }
 
-// Capture full quotient
-unsigned __int64 div192_by_64_modulo_q(uint192_w num, unsigned __int64 q) {
-#ifdef _MSC_VER
-    unsigned __int64 rem_high = 0;
-    if (num.high > 0) _udiv128(0, num.high, q, &rem_high);
+void BFVMultiplier::init_aux_basis() {
+    int log_n = 0;
+    while ((1 << log_n) < N) log_n++;
+    int q_bits = 0;
+    while (q_bits < 64 && ((uint64_t)(q - 1) >> q_bits) != 0) q_bits++;
+    int t_bits = 0;
+    while (t_bits < 64 && ((uint64_t)(t - 1) >> t_bits) != 0) t_bits++;
+
+    // |v| < N * q^2, and the basis must represent [-N q^2, N q^2)
+    int needed_bits = 2 * q_bits + log_n + 1;
+
+    // t * |v| + q/2 must fit the 192-bit scaling numerator
+    if (needed_bits - 1 + t_bits >= 192) {
+        throw std::invalid_argument("t * N * q^2 exceeds the 192-bit scaling range");
+    }
 
-    unsigned __int64 rem_mid;
-    unsigned __int64 quot_high = _udiv128(rem_high, num.mid, q, &rem_mid);
+    // Aux primes are > 2^60, so each contributes at least 60 bits
+    const int aux_bits = 61;
+    int k = (needed_bits + (aux_bits - 1) - 1) / (aux_bits - 1);
+    if (k > kMaxAuxPrimes) throw std::invalid_argument("Auxiliary basis too large");
 
-    unsigned __int64 rem_low;
-    unsigned __int64 quot_low = _udiv128(rem_mid, num.low, q, &rem_low);
+    std::vector<ModInt> primes = find_ntt_primes(N, aux_bits, k);
+    aux_ntt.reserve(k);
+    for (ModInt p : primes) {
+        aux_ntt.emplace_back(N, p);
+        if (!aux_ntt.back().is_valid()) throw std::runtime_error("Aux NTT init failed");
+        aux_mod.emplace_back((uint64_t)p);
+    }
 
-    // Combine High and Low parts modulo q
-    unsigned __int64 two_pow_64_mod_q;
-    _udiv128(1, 0, q, &two_pow_64_mod_q);
+    garner_inv.assign(k, std::vector<ModInt>(k, 0));
+    for (int i = 0; i < k; i++) {
+        const Modulus& p_i = aux_mod[i];
+        for (int j = 0; j < i; j++) {
+            garner_inv[i][j] = (ModInt)p_i.pow((uint64_t)primes[j], p_i.value() - 2);
+        }
+    }
 
-    unsigned __int64 high_prod_high;
-    unsigned __int64 high_prod_low = _umul128(quot_high, two_pow_64_mod_q, &high_prod_high);
-    unsigned __int64 term1;
-    _udiv128(high_prod_high, high_prod_low, q, &term1);
+    Limbs prod = {1, 0, 0, 0};
+    for (int i = 0; i < k; i++) limbs_mul_add(prod, k, (uint64_t)primes[i], 0);
+    aux_product.assign(prod, prod + k);
 
-    unsigned __int64 term2 = quot_low % q;
-    unsigned __int64 final_res = (term1 + term2);
-    if (final_res >= q) final_res -= q;
-    return final_res;
-#else
-    return 0;
-#endif
+    aux_half.assign(k, 0);
+    for (int i = 0; i < k; i++) {
+        uint64_t next = (i + 1 < k) ? aux_product[i + 1] : 0;
+        aux_half[i] = (aux_product[i] >> 1) | (next << 63);
+    }
 }
 
-BFVMultiplier::BFVMultiplier(int N, ModInt q, ModInt t)
-    : ntt(N, q), N(N), q(q), t(t) {
-    if (!ntt.is_valid()) throw std::runtime_error("NTT init failed");
+void BFVMultiplier::tensor_schoolbook_into(const ModInt* a, const ModInt* b, ModInt* res) const {
+    ScratchScope scratch;
+    uint128_w* acc = scratch.alloc<uint128_w>(2 * (size_t)N);
+    std::fill(acc, acc + 2 * N, uint128_w{0, 0});
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            uint128_w prod = mul64x64((uint64_t)a[i], (uint64_t)b[j]);
+            acc[i + j] = add128(acc[i + j], prod);
+        }
+    }
+    uint64_t t_64 = (uint64_t)t;
+
+    FHE_STAT_SCOPE(Stat::ScaleRound);
+    for (int i = 0; i < N; i++) {
+        uint128_w val_abs;
+        bool is_negative = false;
+        if (acc[i].high > acc[N+i].high || (acc[i].high == acc[N+i].high && acc[i].low >= acc[N+i].low)) {
+            val_abs = sub128(acc[i], acc[N+i]);
+        } else {
+            val_abs = sub128(acc[N+i], acc[i]);
+            is_negative = true;
+        }
+
+        uint192_w mag = {val_abs.low, val_abs.high, 0};
+        res[i] = scale_round_coeff(mag, is_negative, q_mod, t_64);
+    }
 }
 
-std::vector<std::vector<ModInt>> BFVMultiplier::multiply_ciphertexts(
-    const std::vector<ModInt>& c1_0, const std::vector<ModInt>& c1_1,
-    const std::vector<ModInt>& c2_0, const std::vector<ModInt>& c2_1) {
+void BFVMultiplier::tensor_ntt_into(const ModInt* a0, const ModInt* a1,
+                                    const ModInt* b0, const ModInt* b1,
+                                    ModInt* const out[4]) const {
+    const int k = (int)aux_ntt.size();
+    const size_t n = (size_t)N;
 
-    auto mul_scale = [&](const std::vector<ModInt>& a, const std::vector<ModInt>& b) {
-        std::vector<uint128_w> acc(2 * N, {0, 0});
-        for (int i = 0; i < N; i++) {
-            for (int j = 0; j < N; j++) {
-                uint128_w prod = mul64x64((unsigned __int64)a[i], (unsigned __int64)b[j]);
-                acc[i + j] = add128(acc[i + j], prod);
-            }
+    // residues[(c k + i) N + j] = coefficient j of the c-th product mod p_i
+    ScratchScope scratch;
+    ModInt* residues = scratch.alloc<ModInt>(4 * k * n);
+    ModInt* lifted = scratch.alloc<ModInt>(4 * n);
+    const ModInt* inputs[4] = {a0, a1, b0, b1};
+
+    for (int i = 0; i < k; i++) {
+        const NTT& aux = aux_ntt[i];
+        const ModInt p = aux.get_q();
+
+        for (int c = 0; c < 4; c++) {
+            ModInt* y = lifted + c * n;
+            for (size_t j = 0; j < n; j++) y[j] = inputs[c][j] % p;
+            aux.forward(y);
         }
-        std::vector<ModInt> res(N);
-        unsigned __int64 q_64 = (unsigned __int64)q;
-        unsigned __int64 t_64 = (unsigned __int64)t;
-
-        for (int i = 0; i < N; i++) {
-            uint128_w val_abs;
-            bool is_negative = false;
-            if (acc[i].high > acc[N+i].high || (acc[i].high == acc[N+i].high && acc[i].low >= acc[N+i].low)) {
-                val_abs = sub128(acc[i], acc[N+i]);
-            } else {
-                val_abs = sub128(acc[N+i], acc[i]);
-                is_negative = true;
+        const ModInt *A0 = lifted, *A1 = lifted + n, *B0 = lifted + 2 * n, *B1 = lifted + 3 * n;
+
+        aux.pointwise_multiply_into(A0, B0, residues + (0 * k + i) * n, n);
+        aux.pointwise_multiply_into(A0, B1, residues + (1 * k + i) * n, n);
+        aux.pointwise_multiply_into(A1, B0, residues + (2 * k + i) * n, n);
+        aux.pointwise_multiply_into(A1, B1, residues + (3 * k + i) * n, n);
+        for (int c = 0; c < 4; c++) aux.inverse(residues + (c * k + i) * n);
+    }
+
+    scale_round_residues(residues, out);
+}
+
+void BFVMultiplier::scale_round_residues(const ModInt* residues, ModInt* const out[4]) const {
+    const int k = (int)aux_ntt.size();
+    const size_t n = (size_t)N;
+    uint64_t t_64 = (uint64_t)t;
+
+    FHE_STAT_SCOPE(Stat::ScaleRound);
+    for (int c = 0; c < 4; c++) {
+        for (size_t j = 0; j < n; j++) {
+            // Garner: mixed-radix digits of the exact coefficient
+            uint64_t digit[kMaxAuxPrimes];
+            for (int i = 0; i < k; i++) {
+                const Modulus& p_i = aux_mod[i];
+                uint64_t x = (uint64_t)residues[(c * k + i) * n + j];
+                for (int l = 0; l < i; l++) {
+                    uint64_t d = p_i.reduce(digit[l]);
+                    x = (x >= d) ? x - d : x + p_i.value() - d;
+                    x = p_i.mul(x, (uint64_t)garner_inv[i][l]);
+                }
+                digit[i] = x;
             }
 
-            uint192_w num = mul128x64_full(val_abs, t_64);
-            num = add192_scalar(num, q_64 / 2);
+            // v = d0 + p0 * (d1 + p1 * (d2 + ...))
+            Limbs v = {0, 0, 0, 0};
+            for (int i = k - 1; i >= 0; i--) {
+                limbs_mul_add(v, k, (uint64_t)aux_ntt[i].get_q(), digit[i]);
+            }
 
-            // USE NEW FUNCTION HERE
-            unsigned __int64 scaled = div192_by_64_modulo_q(num, q_64);
+            // Centre into (-M/2, M/2]
+            bool is_negative = limbs_greater(v, aux_half, k);
+            if (is_negative) limbs_rsub(v, aux_product, k);
 
-            long long final_val = (long long)scaled;
-            if (is_negative) final_val = -final_val;
-            if (final_val < 0) final_val += q_64;
+            uint192_w mag = {v[0], k > 1 ? v[1] : 0, k > 2 ? v[2] : 0};
+            out[c][j] = scale_round_coeff(mag, is_negative, q_mod, t_64);
+        }
+    }
+}
 
-            res[i] = (ModInt)final_val;
+void BFVMultiplier::multiply_into(const ModInt* c1_0, const ModInt* c1_1,
+                                  const ModInt* c2_0, const ModInt* c2_1,
+                                  ModInt* d0, ModInt* d1, ModInt* d2) const {
+    FHE_STAT_SCOPE(Stat::Tensor);
+    ScratchScope scratch;
+    ModInt* d1_b = scratch.alloc<ModInt>((size_t)N);
+
+    if (mode == TensorMode::Schoolbook) {
+        tensor_schoolbook_into(c1_0, c2_0, d0);
+        tensor_schoolbook_into(c1_0, c2_1, d1);
+        tensor_schoolbook_into(c1_1, c2_0, d1_b);
+        tensor_schoolbook_into(c1_1, c2_1, d2);
+    } else {
+        ModInt* const out[4] = {d0, d1, d1_b, d2};
+        tensor_ntt_into(c1_0, c1_1, c2_0, c2_1, out);
+    }
+
+    for(int i=0; i<N; i++) {
+        uint64_t sum = (uint64_t)d1[i] + (uint64_t)d1_b[i];
+        d1[i] = (ModInt)((sum >= (uint64_t)q) ? sum - q : sum);
+    }
+}
+
+void BFVMultiplier::multiply_batch(const ModInt* a, const ModInt* b, ModInt* out, size_t count) const {
+    const size_t n = (size_t)N;
+    if (mode == TensorMode::NTT && gpu_offload(count * 4 * aux_ntt.size() * n)) {
+        multiply_batch_gpu(a, b, out, count);
+        return;
+    }
+    default_pool()->parallel_for(count, [&](size_t p) {
+        const ModInt* x = a + p * 2 * n;
+        const ModInt* y = b + p * 2 * n;
+        ModInt* d = out + p * 3 * n;
+        multiply_into(x, x + n, y, y + n, d, d + n, d + 2 * n);
+    });
+}
+
+// Pairs go over in groups of about 64 MB of device residues; each group makes one
+// round trip, and its scaling fans out over the thread pool
+void BFVMultiplier::multiply_batch_gpu(const ModInt* a, const ModInt* b, ModInt* out, size_t count) const {
+    FHE_STAT_SCOPE(Stat::Tensor);
+    const size_t n = (size_t)N;
+    const size_t k = aux_ntt.size();
+    std::vector<ModInt> primes(k);
+    for (size_t i = 0; i < k; i++) primes[i] = aux_ntt[i].get_q();
+    std::shared_ptr<const GpuNTT> gpu = shared_gpu_ntt(N, primes);
+
+    const size_t pair_bytes = 4 * k * n * sizeof(ModInt);
+    const size_t group = std::max<size_t>(1, std::min(count, ((size_t)64 << 20) / pair_bytes));
+
+    // Staged inputs (a0, a1, b0, b1) per pair, then the returned residues
+    std::vector<ModInt> staged(group * 4 * n);
+    std::vector<ModInt> residues(group * 4 * k * n);
+    DeviceBuffer inputs(group * 4, N);
+    DeviceBuffer lifted(group * 4 * k, N);
+
+    for (size_t first = 0; first < count; first += group) {
+        const size_t m = std::min(group, count - first);
+        for (size_t p = 0; p < m; p++) {
+            std::copy(a + (first + p) * 2 * n, a + (first + p + 1) * 2 * n, staged.begin() + p * 4 * n);
+            std::copy(b + (first + p) * 2 * n, b + (first + p + 1) * 2 * n, staged.begin() + p * 4 * n + 2 * n);
         }
-        return res;
-    };
 
-    std::vector<ModInt> d0 = mul_scale(c1_0, c2_0);
-    std::vector<ModInt> d1_a = mul_scale(c1_0, c2_1);
-    std::vector<ModInt> d1_b = mul_scale(c1_1, c2_0);
-    std::vector<ModInt> d1(N);
-    for(int i=0; i<N; i++) d1[i] = (d1_a[i] + d1_b[i]) % q;
-    std::vector<ModInt> d2 = mul_scale(c1_1, c2_1);
-    return {d0, d1, d2};
+        // The last group may be short: its buffers are sized to it
+        if (inputs.rows() != m * 4) {
+            inputs = DeviceBuffer(m * 4, N);
+            lifted = DeviceBuffer(m * 4 * k, N);
+        }
+        DeviceBuffer& in = inputs;
+        DeviceBuffer& lift = lifted;
+        in.upload(staged.data());
+        gpu->lift(in, lift);
+        gpu->forward(lift);
+        gpu->tensor_products(lift, lift);
+        gpu->inverse(lift);
+        lift.download(residues.data());
+
+        default_pool()->parallel_for(m, [&](size_t p) {
+            ModInt* d = out + (first + p) * 3 * n;
+            ScratchScope scratch;
+            ModInt* d1_b = scratch.alloc<ModInt>(n);
+            ModInt* const prods[4] = {d, d + n, d1_b, d + 2 * n};
+            scale_round_residues(residues.data() + p * 4 * k * n, prods);
+            for (size_t j = 0; j < n; j++) {
+                uint64_t sum = (uint64_t)d[n + j] + (uint64_t)d1_b[j];
+                d[n + j] = (ModInt)((sum >= (uint64_t)q) ? sum - q : sum);
+            }
+        });
+    }
+}
+
+std::vector<std::vector<ModInt>> BFVMultiplier::multiply_ciphertexts(
+    const std::vector<ModInt>& c1_0, const std::vector<ModInt>& c1_1,
+    const std::vector<ModInt>& c2_0, const std::vector<ModInt>& c2_1) const {
+    if ((int)c1_0.size() != N || (int)c1_1.size() != N || (int)c2_0.size() != N || (int)c2_1.size() != N) {
+        throw std::invalid_argument("Ciphertext component has wrong length");
+    }
+
+    std::vector<std::vector<ModInt>> d(3, std::vector<ModInt>(N));
+    multiply_into(c1_0.data(), c1_1.data(), c2_0.data(), c2_1.data(), d[0].data(), d[1].data(), d[2].data());
+    return d;
+}
+
+void BFVMultiplier::multiply(const FlatCiphertext& a, const FlatCiphertext& b, FlatCiphertext& out) const {
+    if (a.get_size() != 2 || b.get_size() != 2 || a.get_N() != N || b.get_N() != N) {
+        throw std::invalid_argument("Expected two size-2 ciphertexts of degree N");
+    }
+    if (a.ntt_form || b.ntt_form) throw std::invalid_argument("Tensor product takes coefficient-form inputs");
+    if (&out == &a || &out == &b) throw std::invalid_argument("Output must not alias an input");
+
+    out.resize(3, N);
+    out.ntt_form = false;
+    multiply_into(a.component(0), a.component(1), b.component(0), b.component(1),
+                  out.component(0), out.component(1), out.component(2));
+}
+
+void BFVMultiplier::set_relin_key(const std::vector<std::vector<ModInt>>& key_b,
+                                  const std::vector<std::vector<ModInt>>& key_a,
+                                  int base_bits) {
+    relin_key = make_switch_key(ntt, key_b, key_a, base_bits);
 }
 
 std::vector<std::vector<ModInt>> BFVMultiplier::relinearize(
-    const std::vector<ModInt>& d0, const std::vector<ModInt>& d1, const std::vector<ModInt>& d2,
-    const std::vector<std::vector<ModInt>>& relin_key) {
-    return {d0, d1};
+    const std::vector<ModInt>& d0, const std::vector<ModInt>& d1,
+    const std::vector<ModInt>& d2) const {
+    if (!has_relin_key()) throw std::runtime_error("Relinearization key not set");
+
+    std::vector<ModInt> ks0, ks1;
+    key_switch(ntt, d2, relin_key, ks0, ks1);
+    return {ntt.add(d0, ks0), ntt.add(d1, ks1)};
+}
+
+void BFVMultiplier::set_galois_key(uint64_t galois_elt,
+                                   const std::vector<std::vector<ModInt>>& key_b,
+                                   const std::vector<std::vector<ModInt>>& key_a,
+                                   int base_bits) {
+    if ((galois_elt & 1) == 0 || galois_elt >= 2 * (uint64_t)N) {
+        throw std::invalid_argument("Galois element must be odd and below 2N");
+    }
+    galois_keys[galois_elt] = make_switch_key(ntt, key_b, key_a, base_bits);
+    galois_perms[galois_elt] = galois_ntt_permutation(N, galois_elt);
+}
+
+std::vector<uint64_t> BFVMultiplier::galois_elements() const {
+    std::vector<uint64_t> res;
+    for (const auto& kv : galois_keys) res.push_back(kv.first);
+    return res;
+}
+
+const KeySwitchKey& BFVMultiplier::galois_key(uint64_t galois_elt) const {
+    auto it = galois_keys.find(galois_elt);
+    if (it == galois_keys.end()) throw std::runtime_error("Galois key not set for this element");
+    return it->second;
+}
+
+HoistedDigits BFVMultiplier::hoist_c1(const std::vector<ModInt>& c1, const KeySwitchKey& key, bool ntt_form) const {
+    if (!ntt_form) return hoist_digits(ntt, c1, key.base_bits, key.num_digits());
+    std::vector<ModInt> coeff = c1;
+    ntt.inverse(coeff);
+    return hoist_digits(ntt, coeff, key.base_bits, key.num_digits());
+}
+
+std::vector<std::vector<ModInt>> BFVMultiplier::galois_switch(const std::vector<ModInt>& c0,
+                                                              const HoistedDigits& digits,
+                                                              uint64_t galois_elt,
+                                                              bool ntt_form) const {
+    const std::vector<uint32_t>& perm = galois_perms.at(galois_elt);
+    std::vector<ModInt> ks0, ks1;
+    key_switch_hoisted(ntt, digits, perm.data(), galois_key(galois_elt), ks0, ks1, ntt_form);
+
+    std::vector<ModInt> r0(N);
+    if (ntt_form) {
+        apply_galois_ntt_into(c0.data(), perm.data(), N, r0.data());
+    } else {
+        apply_galois_into(c0.data(), N, galois_elt, q, r0.data());
+    }
+    for (int j = 0; j < N; j++) {
+        const ModInt v = r0[j] + ks0[j] - q;
+        r0[j] = v + (q & (v >> 63));
+    }
+    return {std::move(r0), std::move(ks1)};
+}
+
+std::vector<std::vector<ModInt>> BFVMultiplier::apply_galois(
+    const std::vector<ModInt>& c0, const std::vector<ModInt>& c1, uint64_t galois_elt, bool ntt_form) const {
+    const KeySwitchKey& key = galois_key(galois_elt);
+    if ((int)c0.size() != N || (int)c1.size() != N) throw std::invalid_argument("Ciphertext component has wrong length");
+
+    return galois_switch(c0, hoist_c1(c1, key, ntt_form), galois_elt, ntt_form);
+}
+
+std::vector<std::vector<std::vector<ModInt>>> BFVMultiplier::apply_galois_many(
+    const std::vector<ModInt>& c0, const std::vector<ModInt>& c1,
+    const std::vector<uint64_t>& galois_elts, bool ntt_form) const {
+    if ((int)c0.size() != N || (int)c1.size() != N) throw std::invalid_argument("Ciphertext component has wrong length");
+    if (galois_elts.empty()) return {};
+
+    const KeySwitchKey& first = galois_key(galois_elts[0]);
+    for (uint64_t g : galois_elts) {
+        const KeySwitchKey& key = galois_key(g);
+        if (key.base_bits != first.base_bits || key.num_digits() != first.num_digits()) {
+            throw std::invalid_argument("Hoisted rotations need Galois keys with one gadget base");
+        }
+    }
+
+    const HoistedDigits digits = hoist_c1(c1, first, ntt_form);
+    std::vector<std::vector<std::vector<ModInt>>> results(galois_elts.size());
+    default_pool()->parallel_for(galois_elts.size(), [&](size_t i) {
+        results[i] = galois_switch(c0, digits, galois_elts[i], ntt_form);
+    });
+    return results;
+}
+
+std::vector<std::vector<ModInt>> BFVMultiplier::rotate_rows(
+    const std::vector<ModInt>& c0, const std::vector<ModInt>& c1, int steps, bool ntt_form) const {
+    return apply_galois(c0, c1, galois_element(N, steps), ntt_form);
+}
+
+std::vector<std::vector<ModInt>> BFVMultiplier::rotate_columns(
+    const std::vector<ModInt>& c0, const std::vector<ModInt>& c1, bool ntt_form) const {
+    return apply_galois(c0, c1, galois_column_swap(N), ntt_form);
+}
+
+std::vector<std::vector<ModInt>> BFVMultiplier::rotate_and_sum(
+    const std::vector<ModInt>& c0, const std::vector<ModInt>& c1, bool ntt_form) const {
+    if ((int)c0.size() != N || (int)c1.size() != N) throw std::invalid_argument("Ciphertext component has wrong length");
+
+    std::vector<std::vector<ModInt>> acc = {c0, c1};
+    if (!ntt_form) {
+        ntt.forward(acc[0]);
+        ntt.forward(acc[1]);
+    }
+
+    auto accumulate = [&](uint64_t g) {
+        std::vector<std::vector<ModInt>> rot = apply_galois(acc[0], acc[1], g, true);
+        for (int k = 0; k < 2; k++) {
+            for (int j = 0; j < N; j++) {
+                const ModInt v = acc[k][j] + rot[k][j] - q;
+                acc[k][j] = v + (q & (v >> 63));
+            }
+        }
+    };
+    for (int step = N / 4; step >= 1; step /= 2) accumulate(galois_element(N, step));
+    accumulate(galois_column_swap(N));
+
+    if (!ntt_form) {
+        ntt.inverse(acc[0]);
+        ntt.inverse(acc[1]);
+    }
+    return acc;
 }
 
 } // namespace fhe_cpp
@@ -7,10 +7,20 @@
 #define FHE_BFV_MULT_H
 
 #include "ntt.h"
+#include "wide_arith.h"
+#include "keyswitch.h"
+#include "arena.h"
+#include <map>
 #include <vector>
 
 namespace fhe_cpp {
 
+// How the exact (un-reduced) tensor product is computed
+enum class TensorMode {
+    NTT,        // Lift into an auxiliary RNS basis, O(N log N)
+    Schoolbook  // O(N^2) reference path
+};
+
 class BFVMultiplier {
 private:
     NTT ntt;
@@ -18,28 +28,135 @@ private:
     ModInt q;
     ModInt t;
     ModInt delta;
+    TensorMode mode;
+    Modulus q_mod;
+
+    // Auxiliary basis: prod(p_i) > 2 * N * q^2 holds every exact coefficient
+    std::vector<NTT> aux_ntt;
+    std::vector<Modulus> aux_mod;
+    std::vector<std::vector<ModInt>> garner_inv;   // garner_inv[i][j] = p_j^-1 mod p_i
+    std::vector<uint64_t> aux_product;             // prod(p_i), little-endian limbs
+    std::vector<uint64_t> aux_half;                // floor(prod(p_i) / 2)
+
+    KeySwitchKey relin_key;                        // Encrypts T^i * s^2, NTT form
+    std::map<uint64_t, KeySwitchKey> galois_keys;  // By Galois element g: T^i * s(X^g), NTT form
+    std::map<uint64_t, std::vector<uint32_t>> galois_perms;  // NTT slot permutation per element
+
+    void init_aux_basis();
+
+    // Exact product of a and b scaled by t/q and rounded, into res (N values)
+    void tensor_schoolbook_into(const ModInt* a, const ModInt* b, ModInt* res) const;
+
+    // Scaled products {a0*b0, a0*b1, a1*b0, a1*b1} into out[0..3]
+    void tensor_ntt_into(const ModInt* a0, const ModInt* a1,
+                         const ModInt* b0, const ModInt* b1,
+                         ModInt* const out[4]) const;
+
+    // Garner, centring and t/q rounding of the four products' aux residues
+    // (4, k, N: product c mod p_i at row c k + i) into out[0..3]
+    void scale_round_residues(const ModInt* residues, ModInt* const out[4]) const;
+
+    // multiply_batch on the device: lift, transforms and products there, scaling here
+    void multiply_batch_gpu(const ModInt* a, const ModInt* b, ModInt* out, size_t count) const;
+
+    // Galois key-switching gadget; every loaded key must share it to be hoisted together
+    const KeySwitchKey& galois_key(uint64_t galois_elt) const;
+    HoistedDigits hoist_c1(const std::vector<ModInt>& c1, const KeySwitchKey& key, bool ntt_form) const;
+
+    // sigma_g(c0) + ks0, ks1 from already hoisted c1 digits, in the form of c0
+    std::vector<std::vector<ModInt>> galois_switch(const std::vector<ModInt>& c0,
+                                                   const HoistedDigits& digits,
+                                                   uint64_t galois_elt,
+                                                   bool ntt_form) const;
 
 public:
     BFVMultiplier(int N, ModInt q, ModInt t);
 
     // FIX: Added missing getter required by bindings.cpp
     ModInt get_delta() const { return delta; }
+    int get_N() const { return N; }
+
+    void set_tensor_mode(TensorMode m) { mode = m; }
+    TensorMode get_tensor_mode() const { return mode; }
+    int aux_basis_size() const { return (int)aux_ntt.size(); }
 
     // Returns {d0, d1, d2}
     std::vector<std::vector<ModInt>> multiply_ciphertexts(
         const std::vector<ModInt>& c1_0,
         const std::vector<ModInt>& c1_1,
         const std::vector<ModInt>& c2_0,
-        const std::vector<ModInt>& c2_1);
+        const std::vector<ModInt>& c2_1) const;
+
+    // Raw-buffer form: d0, d1, d2 are caller-owned N-value buffers that must not alias
+    // the inputs. Temporaries come from the calling thread's scratch arena, so repeated
+    // calls at one N do not touch the heap.
+    void multiply_into(const ModInt* c1_0, const ModInt* c1_1,
+                       const ModInt* c2_0, const ModInt* c2_1,
+                       ModInt* d0, ModInt* d1, ModInt* d2) const;
+
+    // Size-2 coefficient-form inputs; out becomes size 3, reusing its buffer when it can
+    void multiply(const FlatCiphertext& a, const FlatCiphertext& b, FlatCiphertext& out) const;
+
+    // count independent products: a and b hold count x 2 x N coefficient-form
+    // ciphertexts, out receives count x 3 x N. Large batches in NTT tensor mode run
+    // on the GPU when one is enabled (gpu.h), otherwise pairs fan out over the
+    // default thread pool; the results are identical.
+    void multiply_batch(const ModInt* a, const ModInt* b, ModInt* out, size_t count) const;
+
+    // Digit i: (key_b[i], key_a[i]) with key_b[i] + key_a[i] * s = T^i * s^2 + e_i, T = 2^base_bits
+    void set_relin_key(const std::vector<std::vector<ModInt>>& key_b,
+                       const std::vector<std::vector<ModInt>>& key_a,
+                       int base_bits);
+    bool has_relin_key() const { return !relin_key.empty(); }
 
     // Returns {c0, c1}
     std::vector<std::vector<ModInt>> relinearize(
         const std::vector<ModInt>& d0,
         const std::vector<ModInt>& d1,
-        const std::vector<ModInt>& d2,
-        const std::vector<std::vector<ModInt>>& relin_key);
+        const std::vector<ModInt>& d2) const;
+
+    // Galois key for X -> X^g: key_b[i] + key_a[i] * s = T^i * s(X^g) + e_i
+    void set_galois_key(uint64_t galois_elt,
+                        const std::vector<std::vector<ModInt>>& key_b,
+                        const std::vector<std::vector<ModInt>>& key_a,
+                        int base_bits);
+    bool has_galois_key(uint64_t galois_elt) const { return galois_keys.count(galois_elt) != 0; }
+    std::vector<uint64_t> galois_elements() const;
+
+    // (c0(X^g) + ks0, ks1) with (ks0, ks1) = key_switch(c1(X^g)): encrypts m(X^g) under s.
+    // Either form in and out (ntt_form); in NTT form sigma_g is a slot permutation and
+    // the key switch skips its inverse transforms. Returns {c0, c1}.
+    std::vector<std::vector<ModInt>> apply_galois(const std::vector<ModInt>& c0,
+                                                  const std::vector<ModInt>& c1,
+                                                  uint64_t galois_elt,
+                                                  bool ntt_form = false) const;
+
+    // Hoisted: c1 is decomposed and its digits transformed once, then each element
+    // costs one permuted multiply-accumulate (elements run on the default thread pool).
+    // Returns one {c0, c1} per element.
+    std::vector<std::vector<std::vector<ModInt>>> apply_galois_many(
+        const std::vector<ModInt>& c0,
+        const std::vector<ModInt>& c1,
+        const std::vector<uint64_t>& galois_elts,
+        bool ntt_form = false) const;
+
+    // Batched slots: both rows rotated left by steps (g = 3^steps), or the rows swapped
+    std::vector<std::vector<ModInt>> rotate_rows(const std::vector<ModInt>& c0,
+                                                 const std::vector<ModInt>& c1,
+                                                 int steps,
+                                                 bool ntt_form = false) const;
+    std::vector<std::vector<ModInt>> rotate_columns(const std::vector<ModInt>& c0,
+                                                    const std::vector<ModInt>& c1,
+                                                    bool ntt_form = false) const;
+
+    // Every slot gets the sum of all N slots: rotations by N/4, ..., 2, 1, each added
+    // back, then the row swap. Runs in NTT form throughout (one inverse transform per
+    // step for the decomposition); needs the keys for 3^(2^i) and 2N - 1.
+    std::vector<std::vector<ModInt>> rotate_and_sum(const std::vector<ModInt>& c0,
+                                                    const std::vector<ModInt>& c1,
+                                                    bool ntt_form = false) const;
 };
 
 } // namespace fhe_cpp
 
-#endif // FHE_BFV_MULT_H
\ No newline at end of file
+#endif // FHE_BFV_MULT_H
@@ -0,0 +1,179 @@
+/*
+ * RNS BFV Multiplier Implementation
+ */
+
+#include "bfv_rns.h"
+#include "primes.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace fhe_cpp {
+
+static int bit_length(uint64_t x) {
+    int bits = 0;
+    while (bits < 64 && (x >> bits) != 0) bits++;
+    return bits;
+}
+
+// Enough 61-bit primes (each > 2^60) for P > t * N * Q, skipping any prime of Q
+static std::vector<ModInt> choose_aux_primes(int N, const std::vector<ModInt>& q_primes, ModInt t) {
+    if (t < 2) throw std::invalid_argument("Plaintext modulus must be at least 2");
+
+    int log_n = bit_length((uint64_t)N) - 1;
+    int q_bits = 0;
+    for (ModInt q : q_primes) q_bits += bit_length((uint64_t)q);
+
+    int needed_bits = q_bits + bit_length((uint64_t)t) + log_n + 1;
+    int k = (needed_bits + 59) / 60;
+    if (k > RNSBaseConverter::kMaxLimbs) throw std::invalid_argument("Auxiliary basis too large");
+
+    std::vector<ModInt> candidates = find_ntt_primes(N, 61, k + (int)q_primes.size());
+    std::vector<ModInt> aux;
+    for (ModInt p : candidates) {
+        if ((int)aux.size() == k) break;
+        if (std::find(q_primes.begin(), q_primes.end(), p) == q_primes.end()) aux.push_back(p);
+    }
+    return aux;
+}
+
+static std::vector<ModInt> concat(const std::vector<ModInt>& a, const std::vector<ModInt>& b) {
+    std::vector<ModInt> res(a);
+    res.insert(res.end(), b.begin(), b.end());
+    return res;
+}
+
+RNSBFVMultiplier::RNSBFVMultiplier(int N, const std::vector<ModInt>& q_primes, ModInt t)
+    : N(N), t(t),
+      ctx_q(N, q_primes),
+      ctx_p(N, choose_aux_primes(N, q_primes, t)),
+      ctx_qp(N, concat(q_primes, ctx_p.get_primes())),
+      q_to_p(ctx_q, ctx_p),
+      p_to_q(ctx_p, ctx_q) {
+    const int k = ctx_q.size();
+    const int l = ctx_p.size();
+
+    // r_i = [t (Q/q_i)^-1]_{q_i}
+    std::vector<uint64_t> r(k);
+    scale_lambda.resize(k);
+    for (int i = 0; i < k; i++) {
+        const Modulus& q_i = ctx_q.modulus(i);
+        uint64_t q_hat = 1;
+        for (int m = 0; m < k; m++) {
+            if (m != i) q_hat = q_i.mul(q_hat, q_i.reduce((uint64_t)ctx_q.prime(m)));
+        }
+        uint64_t q_hat_inv = q_i.pow(q_hat, q_i.value() - 2);
+        r[i] = q_i.mul(q_i.reduce((uint64_t)t), q_hat_inv);
+        scale_lambda[i] = q_i.shoup(r[i]);
+    }
+
+    scale_omega.assign(l, std::vector<uint64_t>(k, 0));
+    scale_own.resize(l);
+    scale_own_shoup.resize(l);
+    for (int j = 0; j < l; j++) {
+        const Modulus& p_j = ctx_p.modulus(j);
+        uint64_t q_mod = 1;
+        for (int i = 0; i < k; i++) {
+            uint64_t q_i = p_j.reduce((uint64_t)ctx_q.prime(i));
+            uint64_t q_i_inv = p_j.pow(q_i, p_j.value() - 2);
+            uint64_t w = p_j.mul(p_j.reduce(r[i]), q_i_inv);
+            scale_omega[j][i] = (w == 0) ? 0 : p_j.value() - w;
+            q_mod = p_j.mul(q_mod, q_i);
+        }
+        uint64_t q_inv = p_j.pow(q_mod, p_j.value() - 2);
+        scale_own[j] = p_j.mul(p_j.reduce((uint64_t)t), q_inv);
+        scale_own_shoup[j] = p_j.shoup(scale_own[j]);
+    }
+}
+
+RNSPoly RNSBFVMultiplier::lift(const RNSPoly& a) const {
+    ctx_q.check(a);
+
+    RNSPoly res = a;
+    ctx_q.to_coeff(res);
+
+    RNSPoly ext;
+    q_to_p.convert(res, ext);
+    for (auto& limb : ext.limbs) res.limbs.push_back(std::move(limb));
+    ctx_qp.forward(res);
+    return res;
+}
+
+RNSPoly RNSBFVMultiplier::scale_round(const RNSPoly& x) const {
+    const int k = ctx_q.size();
+    const int l = ctx_p.size();
+    RNSPoly res(l, N);
+
+    for (int c = 0; c < N; c++) {
+        // sum_i x_i r_i / q_i in 64-bit fixed point; x_i < 2^61 and k <= 8 keep it in 128 bits
+        uint128_w frac = {0, 0};
+        for (int i = 0; i < k; i++) {
+            frac = add128(frac, mul64x64((uint64_t)x[i][c], scale_lambda[i]));
+        }
+        uint64_t rounded = frac.high + (frac.low >> 63);
+
+        for (int j = 0; j < l; j++) {
+            const Modulus& p_j = ctx_p.modulus(j);
+            const uint64_t p = p_j.value();
+            const std::vector<uint64_t>& omega = scale_omega[j];
+
+            uint128_w acc = {0, 0};
+            for (int i = 0; i < k; i++) acc = add128(acc, mul64x64((uint64_t)x[i][c], omega[i]));
+
+            uint64_t v = p_j.reduce(p_j.reduce(acc.high), acc.low);
+            uint64_t own = mul_shoup_lazy(scale_own[j], scale_own_shoup[j], (uint64_t)x[k + j][c], p);
+            if (own >= p) own -= p;
+
+            v += p_j.reduce(rounded);
+            if (v >= p) v -= p;
+            v += own;
+            if (v >= p) v -= p;
+            res[j][c] = (ModInt)v;
+        }
+    }
+    return res;
+}
+
+std::vector<RNSPoly> RNSBFVMultiplier::multiply_ciphertexts(
+    const RNSPoly& c1_0, const RNSPoly& c1_1,
+    const RNSPoly& c2_0, const RNSPoly& c2_1) const {
+
+    RNSPoly a0 = lift(c1_0), a1 = lift(c1_1);
+    RNSPoly b0 = lift(c2_0), b1 = lift(c2_1);
+
+    // Exact tensor over Q u P; d1 is summed before the inverse transform
+    std::vector<RNSPoly> prods;
+    prods.push_back(ctx_qp.pointwise_multiply(a0, b0));
+    prods.push_back(ctx_qp.add(ctx_qp.pointwise_multiply(a0, b1), ctx_qp.pointwise_multiply(a1, b0)));
+    prods.push_back(ctx_qp.pointwise_multiply(a1, b1));
+
+    std::vector<RNSPoly> out(3);
+    for (int c = 0; c < 3; c++) {
+        ctx_qp.inverse(prods[c]);
+        p_to_q.convert(scale_round(prods[c]), out[c]);
+    }
+    return out;
+}
+
+void RNSBFVMultiplier::set_relin_key(const std::vector<RNSPoly>& key_b,
+                                     const std::vector<RNSPoly>& key_a) {
+    relin_key = make_rns_switch_key(ctx_q, key_b, key_a);
+}
+
+std::vector<RNSPoly> RNSBFVMultiplier::relinearize(const RNSPoly& d0, const RNSPoly& d1,
+                                                   const RNSPoly& d2) const {
+    if (!has_relin_key()) throw std::runtime_error("Relinearization key not set");
+
+    // Evaluation-form d0, d1 keep the key-switch output in NTT form too
+    RNSPoly c0 = d0, c1 = d1;
+    const bool ntt_out = d0.ntt_form && d1.ntt_form;
+    if (!ntt_out) {
+        ctx_q.to_coeff(c0);
+        ctx_q.to_coeff(c1);
+    }
+
+    RNSPoly ks0, ks1;
+    rns_key_switch(ctx_q, d2, relin_key, ks0, ks1, ntt_out);
+    return {ctx_q.add(c0, ks0), ctx_q.add(c1, ks1)};
+}
+
+} // namespace fhe_cpp
@@ -0,0 +1,65 @@
+/*
+ * RNS BFV Multiplier
+ * Ciphertext modulus Q = q_0 * ... * q_{k-1} (q_i < 2^61), so Q is not limited
+ * to one machine word. The tensor product is taken over Q u P and scaled with
+ * the Halevi-Polyakov-Shoup scale-and-round; no multiprecision in any loop.
+ */
+
+#ifndef FHE_BFV_RNS_H
+#define FHE_BFV_RNS_H
+
+#include "rns.h"
+#include "keyswitch.h"
+#include <vector>
+
+namespace fhe_cpp {
+
+class RNSBFVMultiplier {
+private:
+    int N;
+    ModInt t;
+    RNSContext ctx_q;
+    RNSContext ctx_p;                  // P > t * N * Q, disjoint from Q
+    RNSContext ctx_qp;                 // Q primes followed by P primes
+    RNSBaseConverter q_to_p;
+    RNSBaseConverter p_to_q;
+
+    // round(t x / Q) mod p_j = [sum_i x_i omega[j][i] + round(sum_i x_i lambda_i)
+    //                          + x_{p_j} own_j]_{p_j}
+    // with r_i = [t (Q/q_i)^-1]_{q_i}, omega = -r_i q_i^-1, lambda_i = r_i / q_i
+    std::vector<std::vector<uint64_t>> scale_omega;
+    std::vector<uint64_t> scale_lambda;        // floor(r_i * 2^64 / q_i)
+    std::vector<uint64_t> scale_own;           // [t Q^-1]_{p_j}
+    std::vector<uint64_t> scale_own_shoup;
+
+    RNSKeySwitchKey relin_key;                 // Encrypts g_i * s^2, NTT form
+
+    // Q -> Q u P with a centred lift, NTT form (input in either form)
+    RNSPoly lift(const RNSPoly& a) const;
+
+    // round(t x / Q) over P, for coefficient-form x over Q u P
+    RNSPoly scale_round(const RNSPoly& x) const;
+
+public:
+    RNSBFVMultiplier(int N, const std::vector<ModInt>& q_primes, ModInt t);
+
+    const RNSContext& context() const { return ctx_q; }
+    ModInt get_t() const { return t; }
+    const std::vector<ModInt>& aux_primes() const { return ctx_p.get_primes(); }
+
+    // Returns {d0, d1, d2} over Q in coefficient form; inputs may be in either form
+    std::vector<RNSPoly> multiply_ciphertexts(const RNSPoly& c1_0, const RNSPoly& c1_1,
+                                              const RNSPoly& c2_0, const RNSPoly& c2_1) const;
+
+    // Digit i: (key_b[i], key_a[i]) with key_b[i] + key_a[i] * s = g_i * s^2 + e_i
+    void set_relin_key(const std::vector<RNSPoly>& key_b, const std::vector<RNSPoly>& key_a);
+    bool has_relin_key() const { return !relin_key.empty(); }
+
+    // Returns {c0, c1}, in NTT form when d0 and d1 both are
+    std::vector<RNSPoly> relinearize(const RNSPoly& d0, const RNSPoly& d1,
+                                     const RNSPoly& d2) const;
+};
+
+} // namespace fhe_cpp
+
+#endif // FHE_BFV_RNS_H
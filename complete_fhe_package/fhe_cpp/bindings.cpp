@@ -2,29 +2,173 @@
  * Python bindings for FHE C++ multiplication module
  * Uses pybind11 seamless Python/C++ integration
  * FIXED: Removed 'const' qualifiers for mutable BFVMultiplier methods
+ * Heavy calls drop the GIL once their arguments are converted; nothing inside
+ * a py::gil_scoped_release block may touch a Python object.
  */
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
 #include "ntt.h"
+#include "accumulator.h"
 #include "bfv_mult.h"
+#include "bfv_rns.h"
+#include "bfv_encrypt.h"
+#include "batch_encoder.h"
+#include "context.h"
+#include "pipeline.h"
+#include "plaintext.h"
+#include "galois.h"
+#include "gpu.h"
+#include "primes.h"
+#include "sampling.h"
+#include "scan.h"
+#include "serialize.h"
+#include "simd.h"
+#include "stats.h"
+#include "store.h"
+#include "thread_pool.h"
+#include <array>
 
 namespace py = pybind11;
 using namespace fhe_cpp;
 
+// Read-only int64 input: borrowed as-is when already C-contiguous int64,
+// converted (one copy) only for lists or other dtypes
+typedef py::array_t<int64_t, py::array::c_style | py::array::forcecast> Int64Array;
+
+// Checked length of a read-only input
+const ModInt* input_ptr(const Int64Array& arr, py::ssize_t n) {
+    if (arr.size() != n) throw std::invalid_argument("Array has wrong length");
+    return arr.data();
+}
+
+// Writable view of a caller-owned buffer; never converts, so writes are visible to Python
+ModInt* inplace_ptr(py::array& arr, py::ssize_t n) {
+    if (!py::isinstance<py::array_t<int64_t>>(arr)) throw py::type_error("In-place buffer must have dtype int64");
+    if (!(arr.flags() & py::array::c_style)) throw std::invalid_argument("In-place buffer must be C-contiguous");
+    if (!arr.writeable()) throw std::invalid_argument("In-place buffer is read-only");
+    if (arr.size() != n) throw std::invalid_argument("In-place buffer has wrong length");
+    return static_cast<ModInt*>(arr.mutable_data());
+}
+
+// Writable (rows, n) view of a caller-owned buffer, one polynomial per row
+ModInt* inplace_rows(py::array& arr, py::ssize_t n, size_t& rows) {
+    if (arr.ndim() != 2 || arr.shape(1) != n) throw std::invalid_argument("Batch must be a 2-D (rows, N) array");
+    rows = (size_t)arr.shape(0);
+    return inplace_ptr(arr, (py::ssize_t)rows * n);
+}
+
 // Helper to convert numpy arrays to std::vector
-std::vector<ModInt> numpy_to_vector(py::array_t<int64_t> arr) {
-    auto buf = arr.request();
-    int64_t* ptr = static_cast<int64_t*>(buf.ptr);
-    return std::vector<ModInt>(ptr, ptr + buf.size);
+std::vector<ModInt> numpy_to_vector(const Int64Array& arr) {
+    FHE_STAT_BYTES(Stat::NumpyCopy, arr.size() * sizeof(ModInt));
+    return std::vector<ModInt>(arr.data(), arr.data() + arr.size());
+}
+
+// Same, with a length check (the multipliers index up to N unchecked)
+std::vector<ModInt> numpy_to_vector(const Int64Array& arr, py::ssize_t n) {
+    const ModInt* p = input_ptr(arr, n);
+    FHE_STAT_BYTES(Stat::NumpyCopy, n * sizeof(ModInt));
+    return std::vector<ModInt>(p, p + n);
+}
+
+// Hands the vector's storage to NumPy without copying; the capsule frees it
+py::array_t<int64_t> vector_to_numpy(std::vector<ModInt>&& vec) {
+    auto* owner = new std::vector<ModInt>(std::move(vec));
+    py::capsule free_when_done(owner, [](void* p) {
+        delete static_cast<std::vector<ModInt>*>(p);
+    });
+    return py::array_t<int64_t>({(py::ssize_t)owner->size()}, {(py::ssize_t)sizeof(ModInt)},
+                                owner->data(), free_when_done);
+}
+
+// (limbs, N) residue matrix -> RNSPoly; NumPy arrays carry no form, callers say which
+RNSPoly numpy_to_rns(py::array_t<int64_t> arr, bool ntt_form = false) {
+    if (arr.ndim() != 2) throw std::invalid_argument("RNS polynomial must be a 2-D (limbs, N) array");
+    auto view = arr.unchecked<2>();
+    RNSPoly res((int)view.shape(0), (int)view.shape(1), ntt_form);
+    for (py::ssize_t i = 0; i < view.shape(0); i++) {
+        for (py::ssize_t j = 0; j < view.shape(1); j++) res[(int)i][(size_t)j] = view(i, j);
+    }
+    return res;
 }
 
-// Helper to convert std::vector to numpy array
-py::array_t<int64_t> vector_to_numpy(const std::vector<ModInt>& vec) {
-    return py::array_t<int64_t>(vec.size(), vec.data());
+// RNSPoly -> (limbs, N) residue matrix
+py::array_t<int64_t> rns_to_numpy(const RNSPoly& poly) {
+    py::ssize_t k = poly.num_limbs();
+    py::ssize_t n = k > 0 ? (py::ssize_t)poly[0].size() : 0;
+    py::array_t<int64_t> arr({k, n});
+    auto view = arr.mutable_unchecked<2>();
+    for (py::ssize_t i = 0; i < k; i++) {
+        for (py::ssize_t j = 0; j < n; j++) view(i, j) = poly[(int)i][(size_t)j];
+    }
+    return arr;
 }
 
+// Caller's output arena when given (checked like inplace_ptr), otherwise a fresh array of shape
+py::array arena_or_new(py::object out, const std::vector<py::ssize_t>& shape, ModInt*& data) {
+    py::ssize_t total = 1;
+    for (py::ssize_t d : shape) total *= d;
+    py::array arr = out.is_none() ? py::array(py::array_t<int64_t>(shape)) : out.cast<py::array>();
+    data = inplace_ptr(arr, total);
+    return arr;
+}
+
+// (count, size, N) ciphertext matrix as a 3-D C-contiguous int64 input
+const ModInt* ciphertext_matrix(const Int64Array& arr, py::ssize_t& count, py::ssize_t& size, py::ssize_t& n) {
+    if (arr.ndim() != 3) throw std::invalid_argument("Expected a (count, size, N) ciphertext array");
+    count = arr.shape(0);
+    size = arr.shape(1);
+    n = arr.shape(2);
+    return arr.data();
+}
+
+// 32-byte seeds travel as Python bytes
+Seed bytes_to_seed(const py::bytes& b) {
+    std::string str = b;
+    Seed seed;
+    if (str.size() != seed.size()) throw std::invalid_argument("Seed must be 32 bytes");
+    std::copy(str.begin(), str.end(), seed.begin());
+    return seed;
+}
+
+py::bytes seed_to_bytes(const Seed& seed) {
+    return py::bytes(reinterpret_cast<const char*>(seed.data()), seed.size());
+}
+
+// Plaintext operand: an EncodedPlaintext handle, an int constant, or coefficients
+// (taken mod t), the latter two through the evaluator's cache
+std::shared_ptr<const EncodedPlaintext> plain_operand(const PlaintextEvaluator& ev, py::handle pt) {
+    if (py::isinstance<EncodedPlaintext>(pt)) {
+        std::shared_ptr<const EncodedPlaintext> handle = pt.cast<std::shared_ptr<EncodedPlaintext>>();
+        ev.check_plaintext(*handle);    // A handle from an evaluator for another ring
+        return handle;
+    }
+    std::vector<ModInt> values;
+    if (py::isinstance<py::int_>(pt)) {
+        values.push_back(pt.cast<ModInt>());
+    } else {
+        values = numpy_to_vector(pt.cast<Int64Array>());
+    }
+    py::gil_scoped_release release;
+    return ev.encode(values.data(), values.size());
+}
+
+// (size, N) ciphertext input for a plaintext op
+const ModInt* plain_op_input(const PlaintextEvaluator& ev, const Int64Array& ct, py::ssize_t& size) {
+    if (ct.ndim() != 2 || ct.shape(1) != ev.get_N()) throw std::invalid_argument("Expected a (size, N) ciphertext");
+    size = ct.shape(0);
+    return ct.data();
+}
+
+// Deleted with the GIL released: a stage thread may be waiting for it to run a callback
+struct PipelineDeleter {
+    void operator()(SearchPipeline* p) const {
+        py::gil_scoped_release release;
+        delete p;
+    }
+};
+
 PYBIND11_MODULE(fhe_fast_mult, m) {
     m.doc() = "Fast FHE multiplication using NTT (C++ backend)";
 
@@ -34,46 +178,359 @@ PYBIND11_MODULE(fhe_fast_mult, m) {
              py::arg("N"), py::arg("q"),
              "Initialize NTT with polynomial degree N and modulus q")
 
-        .def("multiply", [](const NTT& ntt,
-                           py::array_t<int64_t> a,
-                           py::array_t<int64_t> b) {
-            auto vec_a = numpy_to_vector(a);
-            auto vec_b = numpy_to_vector(b);
-            auto result = ntt.multiply(vec_a, vec_b);
-            return vector_to_numpy(result);
+        .def("multiply", [](const NTT& ntt, Int64Array a, Int64Array b) {
+            const ModInt* pa = input_ptr(a, ntt.get_N());
+            const ModInt* pb = input_ptr(b, ntt.get_N());
+            std::vector<ModInt> result(ntt.get_N());
+            {
+                py::gil_scoped_release release;
+                ntt.multiply_into(pa, pb, result.data());
+            }
+            return vector_to_numpy(std::move(result));
         }, "Multiply two polynomials using NTT")
 
-        .def("add", [](const NTT& ntt,
-                      py::array_t<int64_t> a,
-                      py::array_t<int64_t> b) {
-            auto vec_a = numpy_to_vector(a);
-            auto vec_b = numpy_to_vector(b);
-            auto result = ntt.add(vec_a, vec_b);
-            return vector_to_numpy(result);
+        .def("multiply_into", [](const NTT& ntt, py::array out, Int64Array a, Int64Array b) {
+            const ModInt* pa = input_ptr(a, ntt.get_N());
+            const ModInt* pb = input_ptr(b, ntt.get_N());
+            ModInt* po = inplace_ptr(out, ntt.get_N());
+            py::gil_scoped_release release;
+            ntt.multiply_into(pa, pb, po);
+        }, py::arg("out"), py::arg("a"), py::arg("b"),
+           "Multiply two polynomials into a preallocated int64 buffer (may alias a or b)")
+
+        .def("forward_inplace", [](const NTT& ntt, py::array a) {
+            ModInt* p = inplace_ptr(a, ntt.get_N());
+            py::gil_scoped_release release;
+            ntt.forward(p);
+        }, py::arg("a"), "Forward negacyclic NTT of an int64 buffer in place")
+
+        .def("inverse_inplace", [](const NTT& ntt, py::array a) {
+            ModInt* p = inplace_ptr(a, ntt.get_N());
+            py::gil_scoped_release release;
+            ntt.inverse(p);
+        }, py::arg("a"), "Inverse negacyclic NTT of an int64 buffer in place")
+
+        .def("forward_batch", [](const NTT& ntt, py::array a) {
+            size_t rows;
+            ModInt* p = inplace_rows(a, ntt.get_N(), rows);
+            py::gil_scoped_release release;
+            ntt.forward_batch(p, rows);
+        }, py::arg("a"), "Forward NTT of every row of a (rows, N) int64 array in place, on the GPU "
+           "for large batches when enabled, otherwise across the thread pool")
+
+        .def("inverse_batch", [](const NTT& ntt, py::array a) {
+            size_t rows;
+            ModInt* p = inplace_rows(a, ntt.get_N(), rows);
+            py::gil_scoped_release release;
+            ntt.inverse_batch(p, rows);
+        }, py::arg("a"), "Inverse NTT of every row of a (rows, N) int64 array in place, on the GPU "
+           "for large batches when enabled, otherwise across the thread pool")
+
+        .def("pointwise_multiply", [](const NTT& ntt, Int64Array a, Int64Array b) {
+            const ModInt* pb = input_ptr(b, a.size());
+            std::vector<ModInt> result(a.size());
+            {
+                py::gil_scoped_release release;
+                ntt.pointwise_multiply_into(a.data(), pb, result.data(), result.size());
+            }
+            return vector_to_numpy(std::move(result));
+        }, "Element-wise product of two NTT-domain (evaluation form) polynomials")
+
+        .def("add", [](const NTT& ntt, Int64Array a, Int64Array b) {
+            const ModInt* pb = input_ptr(b, a.size());
+            std::vector<ModInt> result(a.size());
+            {
+                py::gil_scoped_release release;
+                ntt.add_into(a.data(), pb, result.data(), result.size());
+            }
+            return vector_to_numpy(std::move(result));
         }, "Add two polynomials")
 
-        .def("subtract", [](const NTT& ntt,
-                           py::array_t<int64_t> a,
-                           py::array_t<int64_t> b) {
-            auto vec_a = numpy_to_vector(a);
-            auto vec_b = numpy_to_vector(b);
-            auto result = ntt.subtract(vec_a, vec_b);
-            return vector_to_numpy(result);
+        .def("subtract", [](const NTT& ntt, Int64Array a, Int64Array b) {
+            const ModInt* pb = input_ptr(b, a.size());
+            std::vector<ModInt> result(a.size());
+            {
+                py::gil_scoped_release release;
+                ntt.subtract_into(a.data(), pb, result.data(), result.size());
+            }
+            return vector_to_numpy(std::move(result));
         }, "Subtract two polynomials")
 
-        .def("scalar_mul", [](const NTT& ntt,
-                             py::array_t<int64_t> a,
-                             int64_t scalar) {
-            auto vec_a = numpy_to_vector(a);
-            auto result = ntt.scalar_mul(vec_a, scalar);
-            return vector_to_numpy(result);
+        .def("scalar_mul", [](const NTT& ntt, Int64Array a, int64_t scalar) {
+            std::vector<ModInt> result(a.size());
+            {
+                py::gil_scoped_release release;
+                ntt.scalar_mul_into(a.data(), scalar, result.data(), result.size());
+            }
+            return vector_to_numpy(std::move(result));
         }, "Multiply polynomial by scalar")
 
         .def("is_valid", &NTT::is_valid,
              "Check if NTT is properly initialized")
 
         .def("get_N", &NTT::get_N, "Get polynomial degree")
-        .def("get_q", &NTT::get_q, "Get modulus");
+        .def("get_q", &NTT::get_q, "Get modulus")
+        .def("kernel_name", &NTT::kernel_name,
+             "Butterfly kernel used for this modulus at the active SIMD level");
+
+    py::enum_<SimdLevel>(m, "SimdLevel")
+        .value("SCALAR", SimdLevel::Scalar)
+        .value("AVX2", SimdLevel::AVX2)
+        .value("AVX512IFMA", SimdLevel::AVX512IFMA);
+
+    m.def("detect_simd_level", &detect_simd_level,
+          "Highest SIMD level supported by this CPU");
+    m.def("get_simd_level", &get_simd_level,
+          "SIMD level used by the NTT kernels");
+    m.def("set_simd_level", &set_simd_level, py::arg("level"),
+          "Cap the SIMD level (clamped to what the CPU supports)");
+    m.def("get_ntt_blocking_threshold", &get_ntt_blocking_threshold,
+          "Smallest N whose transforms run cache-blocked");
+    m.def("set_ntt_blocking_threshold", &set_ntt_blocking_threshold, py::arg("N"),
+          "Smallest N whose transforms run cache-blocked (<= 0 disables blocking)");
+
+    m.def("gpu_available", &gpu_available,
+          "A CUDA device is usable (False in builds without FHE_ENABLE_CUDA)");
+    m.def("gpu_device_name", &gpu_device_name,
+          "Name of the CUDA device, or an empty string");
+    m.def("gpu_enabled", &gpu_enabled,
+          "Large batch transforms and tensor products go to the GPU");
+    m.def("set_gpu_enabled", &set_gpu_enabled, py::arg("enabled"),
+          "Allow or forbid GPU offload in the batch APIs (no effect without a device)");
+
+    m.def("set_num_threads", &set_num_threads, py::arg("num_threads"),
+          "Size of the thread pool behind the batch APIs (<= 0: one per hardware thread)");
+    m.def("get_num_threads", &get_num_threads,
+          "Threads used by the batch APIs, including the caller");
+
+    m.def("sample_uniform", [](int n, ModInt q) {
+        std::vector<ModInt> res;
+        {
+            py::gil_scoped_release release;
+            res = sample_uniform(n, q);
+        }
+        return vector_to_numpy(std::move(res));
+    }, py::arg("n"), py::arg("q"), "n residues uniform in [0, q) (ChaCha20)");
+    m.def("sample_ternary", [](int n) {
+        std::vector<ModInt> res;
+        {
+            py::gil_scoped_release release;
+            res = sample_ternary(n);
+        }
+        return vector_to_numpy(std::move(res));
+    }, py::arg("n"), "n coefficients uniform in {-1, 0, 1} (ChaCha20)");
+    m.def("sample_gaussian", [](int n, double sigma, int64_t bound) {
+        std::vector<ModInt> res;
+        {
+            py::gil_scoped_release release;
+            res = sample_gaussian(n, sigma, bound);
+        }
+        return vector_to_numpy(std::move(res));
+    }, py::arg("n"), py::arg("sigma"), py::arg("bound"),
+       "round(N(0, sigma^2)) clipped to [-bound, bound], constant-time CDT sampler");
+    m.def("expand_uniform", [](py::bytes seed, int n, ModInt q, uint64_t stream) {
+        Seed sd = bytes_to_seed(seed);
+        std::vector<ModInt> res;
+        {
+            py::gil_scoped_release release;
+            res = expand_uniform(sd, stream, n, q);
+        }
+        return vector_to_numpy(std::move(res));
+    }, py::arg("seed"), py::arg("n"), py::arg("q"), py::arg("stream") = 0,
+       "Deterministic uniform polynomial in [0, q) from a 32-byte seed");
+    m.def("random_seed", []() { return seed_to_bytes(random_seed()); },
+          "32 bytes from the OS entropy source");
+
+    // Wire format: cts is a list of (components, is_ntt, c1_seed or None)
+    m.def("serialize_ciphertexts", [](py::list cts, int N, ModInt q, ModInt t) {
+        std::vector<Int64Array> keep;              // Holds converted inputs while the GIL is released
+        std::vector<WireCiphertext> wire(cts.size());
+        for (size_t r = 0; r < cts.size(); r++) {
+            py::tuple item = cts[r].cast<py::tuple>();
+            if (item.size() != 3) throw std::invalid_argument("Expected (components, is_ntt, c1_seed)");
+            WireCiphertext& w = wire[r];
+            w.ntt_form = item[1].cast<bool>();
+            w.seeded = !item[2].is_none();
+            if (w.seeded) w.c1_seed = bytes_to_seed(item[2].cast<py::bytes>());
+            py::list comps = item[0].cast<py::list>();
+            for (size_t c = 0; c < comps.size(); c++) {
+                if (w.seeded && c == 1) {
+                    w.components.push_back(nullptr);
+                    continue;
+                }
+                keep.push_back(comps[c].cast<Int64Array>());
+                w.components.push_back(input_ptr(keep.back(), N));
+            }
+        }
+        std::vector<uint8_t> buf;
+        {
+            py::gil_scoped_release release;
+            buf = serialize_ciphertexts(N, q, t, wire);
+        }
+        return py::bytes(reinterpret_cast<const char*>(buf.data()), buf.size());
+    }, py::arg("cts"), py::arg("N"), py::arg("q"), py::arg("t"),
+       "Pack ciphertexts [(components, is_ntt, c1_seed or None), ...] into one versioned batch; "
+       "a seeded c1 is written as its 32-byte seed");
+
+    m.def("serialize_ciphertext_array", [](Int64Array cts, ModInt q, ModInt t, bool ntt_form) {
+        py::ssize_t count, size, n;
+        const ModInt* p = ciphertext_matrix(cts, count, size, n);
+        std::vector<WireCiphertext> wire((size_t)count);
+        for (py::ssize_t r = 0; r < count; r++) {
+            wire[(size_t)r].ntt_form = ntt_form;
+            for (py::ssize_t c = 0; c < size; c++) wire[(size_t)r].components.push_back(p + (r * size + c) * n);
+        }
+        std::vector<uint8_t> buf;
+        {
+            py::gil_scoped_release release;
+            buf = serialize_ciphertexts((int)n, q, t, wire);
+        }
+        return py::bytes(reinterpret_cast<const char*>(buf.data()), buf.size());
+    }, py::arg("cts"), py::arg("q"), py::arg("t"), py::arg("ntt_form") = false,
+       "Pack a (count, size, N) ciphertext array (e.g. a scan_subtract arena) into one batch");
+
+    m.def("deserialize_ciphertexts", [](py::buffer data) {
+        py::buffer_info info = data.request();
+        if (info.ndim != 1 || info.itemsize != 1) throw std::invalid_argument("Expected a flat byte buffer");
+        const uint8_t* p = static_cast<const uint8_t*>(info.ptr);
+        const size_t len = (size_t)info.size;
+
+        WireBatch batch = parse_ciphertexts(p, len);
+        py::array_t<int64_t> rows({(py::ssize_t)batch.total_rows, (py::ssize_t)batch.N});
+        ModInt* out = rows.mutable_data();
+        {
+            py::gil_scoped_release release;
+            unpack_ciphertexts(p, batch, out);
+        }
+
+        py::list records;
+        for (const auto& rec : batch.records) {
+            py::object seed = rec.seeded ? py::object(seed_to_bytes(rec.c1_seed)) : py::object(py::none());
+            records.append(py::make_tuple(rec.row, rec.size, rec.ntt_form, seed));
+        }
+        return py::make_tuple(py::make_tuple(batch.N, batch.q, batch.t), rows, records);
+    }, py::arg("data"),
+       "Unpack a batch from any bytes-like object into one (rows, N) int64 array; returns "
+       "((N, q, t), rows, [(first_row, size, is_ntt, c1_seed or None), ...])");
+
+    m.def("ciphertext_batch_info", [](py::buffer data) {
+        py::buffer_info info = data.request();
+        if (info.ndim != 1 || info.itemsize != 1) throw std::invalid_argument("Expected a flat byte buffer");
+        WireBatch batch = parse_ciphertexts(static_cast<const uint8_t*>(info.ptr), (size_t)info.size);
+        return py::make_tuple(batch.N, batch.q, batch.t, batch.records.size());
+    }, py::arg("data"), "Validate a batch and return (N, q, t, count) without unpacking it");
+
+    m.def("slice_ciphertexts", [](py::buffer data, size_t begin, size_t end) {
+        py::buffer_info info = data.request();
+        if (info.ndim != 1 || info.itemsize != 1) throw std::invalid_argument("Expected a flat byte buffer");
+        std::vector<uint8_t> buf;
+        {
+            py::gil_scoped_release release;
+            buf = slice_ciphertexts(static_cast<const uint8_t*>(info.ptr), (size_t)info.size, begin, end);
+        }
+        return py::bytes(reinterpret_cast<const char*>(buf.data()), buf.size());
+    }, py::arg("data"), py::arg("begin"), py::arg("end"),
+       "Records [begin, end) of a batch as a batch of their own (one shard's rows)");
+
+    m.def("concat_ciphertexts", [](py::list parts) {
+        std::vector<py::buffer_info> views;         // Pin the batches while the GIL is released
+        std::vector<std::pair<const uint8_t*, size_t>> batches;
+        for (auto item : parts) {
+            views.push_back(item.cast<py::buffer>().request());
+            const py::buffer_info& info = views.back();
+            if (info.ndim != 1 || info.itemsize != 1) throw std::invalid_argument("Expected flat byte buffers");
+            batches.emplace_back(static_cast<const uint8_t*>(info.ptr), (size_t)info.size);
+        }
+        std::vector<uint8_t> buf;
+        {
+            py::gil_scoped_release release;
+            buf = concat_ciphertexts(batches);
+        }
+        return py::bytes(reinterpret_cast<const char*>(buf.data()), buf.size());
+    }, py::arg("parts"), "Join batches over one (N, q, t) in order, e.g. per-shard scan results");
+
+    m.def("scan_subtract", [](Int64Array db, Int64Array queries, ModInt q, py::object out) {
+        py::ssize_t rows, size, n, num_queries, qsize, qn;
+        const ModInt* pd = ciphertext_matrix(db, rows, size, n);
+        const ModInt* pq = ciphertext_matrix(queries, num_queries, qsize, qn);
+        if (qsize != size || qn != n) throw std::invalid_argument("Queries must match the database's (size, N)");
+        ModInt* po;
+        py::array res = arena_or_new(out, {rows, num_queries, size, n}, po);
+        {
+            py::gil_scoped_release release;
+            scan_subtract(pd, (size_t)rows, pq, (size_t)num_queries, (size_t)(size * n), q, po);
+        }
+        return res;
+    }, py::arg("db"), py::arg("queries"), py::arg("q"), py::arg("out") = py::none(),
+       "out[r, j] = db[r] - queries[j] mod q for (rows, size, N) db and (targets, size, N) queries "
+       "(same form); writes into out (rows, targets, size, N) when given");
+
+    // Lazy accumulation: one reduction per headroom instead of per operation
+    py::class_<LazyAccumulator>(m, "LazyAccumulator")
+        .def(py::init<int, ModInt, int>(), py::arg("N"), py::arg("q"), py::arg("size") = 2,
+             "Accumulator for size x N residues mod q (a ciphertext, or size=1 for a polynomial)")
+        .def("add", [](LazyAccumulator& acc, Int64Array a) {
+            const ModInt* p = input_ptr(a, (py::ssize_t)acc.get_size() * acc.get_N());
+            py::gil_scoped_release release;
+            acc.add(p);
+        }, py::arg("a"), "acc += a for a (size, N) array (or flat) in [0, q)")
+        .def("sub", [](LazyAccumulator& acc, Int64Array a) {
+            const ModInt* p = input_ptr(a, (py::ssize_t)acc.get_size() * acc.get_N());
+            py::gil_scoped_release release;
+            acc.sub(p);
+        }, py::arg("a"), "acc -= a")
+        .def("fma", [](LazyAccumulator& acc, Int64Array a, Int64Array b) {
+            const ModInt* pa = input_ptr(a, (py::ssize_t)acc.get_size() * acc.get_N());
+            const ModInt* pb = input_ptr(b, acc.get_N());
+            py::gil_scoped_release release;
+            acc.fma(pa, pb);
+        }, py::arg("a"), py::arg("b"),
+           "acc[c] += a[c] * b slot-wise: a (size, N) NTT-form ciphertext, b N-slot NTT-form plaintext")
+        .def("result", [](const LazyAccumulator& acc) {
+            py::array_t<int64_t> out({(py::ssize_t)acc.get_size(), (py::ssize_t)acc.get_N()});
+            ModInt* p = out.mutable_data();
+            {
+                py::gil_scoped_release release;
+                acc.result_into(p);
+            }
+            return out;
+        }, "Reduced (size, N) sum in [0, q)")
+        .def("reset", &LazyAccumulator::reset)
+        .def("pending_additions", &LazyAccumulator::pending_additions)
+        .def("pending_products", &LazyAccumulator::pending_products);
+
+    m.def("sum_ciphertexts", [](Int64Array cts, ModInt q) {
+        py::ssize_t count, size, n;
+        const ModInt* p = ciphertext_matrix(cts, count, size, n);
+        py::array_t<int64_t> out({size, n});
+        ModInt* po = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            sum_rows(p, (size_t)count, (size_t)(size * n), q, po);
+        }
+        return out;
+    }, py::arg("cts"), py::arg("q"),
+       "Sum of a (count, size, N) ciphertext array, either form, as one (size, N) array");
+
+    m.def("dot_product", [](Int64Array cts, Int64Array pts, ModInt q) {
+        py::ssize_t count, size, n;
+        const ModInt* pc = ciphertext_matrix(cts, count, size, n);
+        if (pts.ndim() != 2 || pts.shape(0) != count || pts.shape(1) != n) {
+            throw std::invalid_argument("Plaintexts must be a (count, N) array matching the ciphertexts");
+        }
+        py::array_t<int64_t> out({size, n});
+        ModInt* po = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            dot_product(pc, pts.data(), (size_t)count, (int)size, (int)n, q, po);
+        }
+        return out;
+    }, py::arg("cts"), py::arg("pts"), py::arg("q"),
+       "sum_i cts[i] * pts[i] for NTT-form (count, size, N) ciphertexts and (count, N) plaintexts");
+
+    py::enum_<TensorMode>(m, "TensorMode")
+        .value("NTT", TensorMode::NTT)
+        .value("SCHOOLBOOK", TensorMode::Schoolbook);
 
     // BFVMultiplier class bindings
     py::class_<BFVMultiplier>(m, "BFVMultiplier")
@@ -81,74 +538,797 @@ PYBIND11_MODULE(fhe_fast_mult, m) {
              py::arg("N"), py::arg("q"), py::arg("t"),
              "Initialize BFV multiplier with N, q (ciphertext modulus), t (plaintext modulus)")
 
-        // FIXED: Removed 'const' from BFVMultiplier& mult
-        .def("multiply_ciphertexts", [](BFVMultiplier& mult,
-                                        py::array_t<int64_t> c1_0,
-                                        py::array_t<int64_t> c1_1,
-                                        py::array_t<int64_t> c2_0,
-                                        py::array_t<int64_t> c2_1) {
-            auto result = mult.multiply_ciphertexts(
-                numpy_to_vector(c1_0),
-                numpy_to_vector(c1_1),
-                numpy_to_vector(c2_0),
-                numpy_to_vector(c2_1)
-            );
+        .def("multiply_ciphertexts", [](const BFVMultiplier& mult,
+                                        Int64Array c1_0,
+                                        Int64Array c1_1,
+                                        Int64Array c2_0,
+                                        Int64Array c2_1) {
+            // Reads the input buffers in place and writes straight into the result arrays
+            const py::ssize_t n = mult.get_N();
+            const ModInt *a0 = input_ptr(c1_0, n), *a1 = input_ptr(c1_1, n);
+            const ModInt *b0 = input_ptr(c2_0, n), *b1 = input_ptr(c2_1, n);
+            py::array_t<int64_t> d0(n), d1(n), d2(n);
+            ModInt *p0 = d0.mutable_data(), *p1 = d1.mutable_data(), *p2 = d2.mutable_data();
+            {
+                py::gil_scoped_release release;
+                mult.multiply_into(a0, a1, b0, b1, p0, p1, p2);
+            }
 
             // Return tuple of 3 numpy arrays
-            return py::make_tuple(
-                vector_to_numpy(result[0]),
-                vector_to_numpy(result[1]),
-                vector_to_numpy(result[2])
-            );
+            return py::make_tuple(d0, d1, d2);
         }, "Multiply two ciphertexts (returns d0, d1, d2)")
 
-        // FIXED: Removed 'const' from BFVMultiplier& mult
-        .def("relinearize", [](BFVMultiplier& mult,
-                              py::array_t<int64_t> d0,
-                              py::array_t<int64_t> d1,
-                              py::array_t<int64_t> d2,
-                              py::array_t<int64_t> rk0,
-                              py::array_t<int64_t> rk1) {
-            std::vector<std::vector<ModInt>> relin_key = {
-                numpy_to_vector(rk0),
-                numpy_to_vector(rk1)
-            };
+        .def("multiply_many", [](const BFVMultiplier& mult,
+                                 const std::vector<std::pair<std::pair<Int64Array, Int64Array>,
+                                                             std::pair<Int64Array, Int64Array>>>& pairs) {
+            const py::ssize_t n = mult.get_N();
+            std::vector<std::array<const ModInt*, 4>> inputs;
+            std::vector<std::array<ModInt*, 3>> outputs;
+            py::list out;
+            for (const auto& p : pairs) {
+                inputs.push_back({input_ptr(p.first.first, n), input_ptr(p.first.second, n),
+                                  input_ptr(p.second.first, n), input_ptr(p.second.second, n)});
+                py::array_t<int64_t> d0(n), d1(n), d2(n);
+                outputs.push_back({d0.mutable_data(), d1.mutable_data(), d2.mutable_data()});
+                out.append(py::make_tuple(d0, d1, d2));
+            }
 
-            auto result = mult.relinearize(
-                numpy_to_vector(d0),
-                numpy_to_vector(d1),
-                numpy_to_vector(d2),
-                relin_key
-            );
+            {
+                py::gil_scoped_release release;
+                default_pool()->parallel_for(inputs.size(), [&](size_t i) {
+                    const auto& in = inputs[i];
+                    const auto& o = outputs[i];
+                    mult.multiply_into(in[0], in[1], in[2], in[3], o[0], o[1], o[2]);
+                });
+            }
+            return out;
+        }, py::arg("pairs"),
+           "Multiply a list of ((c1_0, c1_1), (c2_0, c2_1)) pairs across the thread pool; "
+           "returns a list of (d0, d1, d2)")
+
+        .def("multiply_batch", [](const BFVMultiplier& mult, Int64Array a, Int64Array b, py::object out) {
+            py::ssize_t count, size, n, b_count, b_size, b_n;
+            const ModInt* pa = ciphertext_matrix(a, count, size, n);
+            const ModInt* pb = ciphertext_matrix(b, b_count, b_size, b_n);
+            if (size != 2 || b_size != 2 || n != mult.get_N() || b_n != n || b_count != count) {
+                throw std::invalid_argument("Expected two (count, 2, N) ciphertext arrays of one shape");
+            }
+            ModInt* po;
+            py::array res = arena_or_new(out, {count, 3, n}, po);
+            {
+                py::gil_scoped_release release;
+                mult.multiply_batch(pa, pb, po, (size_t)count);
+            }
+            return res;
+        }, py::arg("a"), py::arg("b"), py::arg("out") = py::none(),
+           "Row-wise tensor product of (count, 2, N) coefficient-form ciphertext arrays into a "
+           "(count, 3, N) array (out when given); large batches run on the GPU when enabled")
+
+        .def("set_relin_key", [](BFVMultiplier& mult,
+                                 std::vector<Int64Array> key_b,
+                                 std::vector<Int64Array> key_a,
+                                 int base_bits) {
+            std::vector<std::vector<ModInt>> vec_b, vec_a;
+            for (auto& k : key_b) vec_b.push_back(numpy_to_vector(k));
+            for (auto& k : key_a) vec_a.push_back(numpy_to_vector(k));
+            mult.set_relin_key(vec_b, vec_a, base_bits);
+        }, py::arg("key_b"), py::arg("key_a"), py::arg("base_bits"),
+           "Load relinearization key digits (b_i, a_i) for base T = 2^base_bits; stored in NTT form")
+
+        .def("has_relin_key", &BFVMultiplier::has_relin_key,
+             "Check if a relinearization key is loaded")
+
+        .def("relinearize", [](const BFVMultiplier& mult,
+                              Int64Array d0,
+                              Int64Array d1,
+                              Int64Array d2) {
+            const py::ssize_t n = mult.get_N();
+            std::vector<ModInt> v0 = numpy_to_vector(d0, n), v1 = numpy_to_vector(d1, n);
+            std::vector<ModInt> v2 = numpy_to_vector(d2, n);
+            std::vector<std::vector<ModInt>> result;
+            {
+                py::gil_scoped_release release;
+                result = mult.relinearize(v0, v1, v2);
+            }
 
             return py::make_tuple(
-                vector_to_numpy(result[0]),
-                vector_to_numpy(result[1])
+                vector_to_numpy(std::move(result[0])),
+                vector_to_numpy(std::move(result[1]))
             );
-        }, "Relinearize (d0, d1, d2) to (c0, c1)")
+        }, "Relinearize (d0, d1, d2) to (c0, c1) with the loaded key")
+
+        .def("set_galois_key", [](BFVMultiplier& mult, uint64_t galois_elt,
+                                  std::vector<Int64Array> key_b, std::vector<Int64Array> key_a,
+                                  int base_bits) {
+            std::vector<std::vector<ModInt>> kb, ka;
+            for (auto& k : key_b) kb.push_back(numpy_to_vector(k, mult.get_N()));
+            for (auto& k : key_a) ka.push_back(numpy_to_vector(k, mult.get_N()));
+            mult.set_galois_key(galois_elt, kb, ka, base_bits);
+        }, py::arg("galois_elt"), py::arg("key_b"), py::arg("key_a"), py::arg("base_bits"),
+           "Load the key-switching key for X -> X^galois_elt (BFVEncryptor.galois_keygen output)")
+        .def("has_galois_key", &BFVMultiplier::has_galois_key, py::arg("galois_elt"))
+        .def("galois_elements", &BFVMultiplier::galois_elements,
+             "Galois elements with a loaded key")
+
+        .def("apply_galois", [](const BFVMultiplier& mult, Int64Array c0, Int64Array c1,
+                                uint64_t galois_elt, bool ntt_form) {
+            const py::ssize_t n = mult.get_N();
+            std::vector<ModInt> v0 = numpy_to_vector(c0, n), v1 = numpy_to_vector(c1, n);
+            std::vector<std::vector<ModInt>> result;
+            {
+                py::gil_scoped_release release;
+                result = mult.apply_galois(v0, v1, galois_elt, ntt_form);
+            }
+            return py::make_tuple(vector_to_numpy(std::move(result[0])), vector_to_numpy(std::move(result[1])));
+        }, py::arg("c0"), py::arg("c1"), py::arg("galois_elt"), py::arg("ntt_form") = false,
+           "Apply X -> X^galois_elt to (c0, c1) and switch back to s with the loaded key")
+
+        .def("apply_galois_many", [](const BFVMultiplier& mult, Int64Array c0, Int64Array c1,
+                                     std::vector<uint64_t> galois_elts, bool ntt_form) {
+            const py::ssize_t n = mult.get_N();
+            std::vector<ModInt> v0 = numpy_to_vector(c0, n), v1 = numpy_to_vector(c1, n);
+            std::vector<std::vector<std::vector<ModInt>>> results;
+            {
+                py::gil_scoped_release release;
+                results = mult.apply_galois_many(v0, v1, galois_elts, ntt_form);
+            }
+            py::list out;
+            for (auto& r : results) {
+                out.append(py::make_tuple(vector_to_numpy(std::move(r[0])), vector_to_numpy(std::move(r[1]))));
+            }
+            return out;
+        }, py::arg("c0"), py::arg("c1"), py::arg("galois_elts"), py::arg("ntt_form") = false,
+           "Hoisted automorphisms of one ciphertext: c1 is decomposed once for every element; "
+           "returns [(c0, c1)] in element order")
+
+        .def("rotate_rows", [](const BFVMultiplier& mult, Int64Array c0, Int64Array c1, int steps, bool ntt_form) {
+            const py::ssize_t n = mult.get_N();
+            std::vector<ModInt> v0 = numpy_to_vector(c0, n), v1 = numpy_to_vector(c1, n);
+            std::vector<std::vector<ModInt>> result;
+            {
+                py::gil_scoped_release release;
+                result = mult.rotate_rows(v0, v1, steps, ntt_form);
+            }
+            return py::make_tuple(vector_to_numpy(std::move(result[0])), vector_to_numpy(std::move(result[1])));
+        }, py::arg("c0"), py::arg("c1"), py::arg("steps"), py::arg("ntt_form") = false,
+           "Rotate both batching rows left by steps (needs the key for galois_element(N, steps))")
+
+        .def("rotate_columns", [](const BFVMultiplier& mult, Int64Array c0, Int64Array c1, bool ntt_form) {
+            const py::ssize_t n = mult.get_N();
+            std::vector<ModInt> v0 = numpy_to_vector(c0, n), v1 = numpy_to_vector(c1, n);
+            std::vector<std::vector<ModInt>> result;
+            {
+                py::gil_scoped_release release;
+                result = mult.rotate_columns(v0, v1, ntt_form);
+            }
+            return py::make_tuple(vector_to_numpy(std::move(result[0])), vector_to_numpy(std::move(result[1])));
+        }, py::arg("c0"), py::arg("c1"), py::arg("ntt_form") = false,
+           "Swap the two batching rows (needs the key for galois_column_swap(N))")
+
+        .def("rotate_and_sum", [](const BFVMultiplier& mult, Int64Array c0, Int64Array c1, bool ntt_form) {
+            const py::ssize_t n = mult.get_N();
+            std::vector<ModInt> v0 = numpy_to_vector(c0, n), v1 = numpy_to_vector(c1, n);
+            std::vector<std::vector<ModInt>> result;
+            {
+                py::gil_scoped_release release;
+                result = mult.rotate_and_sum(v0, v1, ntt_form);
+            }
+            return py::make_tuple(vector_to_numpy(std::move(result[0])), vector_to_numpy(std::move(result[1])));
+        }, py::arg("c0"), py::arg("c1"), py::arg("ntt_form") = false,
+           "Every slot set to the sum of all slots (keys for 3^(2^i) and the row swap)")
 
         .def("get_delta", &BFVMultiplier::get_delta,
-             "Get delta = floor(q/t)");
+             "Get delta = floor(q/t)")
 
-    // Utility functions
-    m.def("find_ntt_prime", [](int N) -> int64_t {
-        // Find a prime q such that q = 1 (mod 2N)
-        int64_t q = 2 * N + 1;
+        .def("set_tensor_mode", &BFVMultiplier::set_tensor_mode,
+             py::arg("mode"),
+             "Select NTT (default) or SCHOOLBOOK reference tensor product")
+        .def("get_tensor_mode", &BFVMultiplier::get_tensor_mode,
+             "Get the active tensor product mode")
+        .def("aux_basis_size", &BFVMultiplier::aux_basis_size,
+             "Number of auxiliary primes used by the NTT tensor product");
+
+    // Native key generation / encryption / decryption over one NTT prime
+    py::class_<BFVEncryptor>(m, "BFVEncryptor")
+        .def(py::init<int, ModInt, ModInt, double>(),
+             py::arg("N"), py::arg("q"), py::arg("t"), py::arg("sigma") = 3.2,
+             "Initialize BFV encryption with N, NTT-friendly q, plaintext modulus t and error width sigma")
 
-        auto is_prime = [](int64_t n) {
-            if (n < 2) return false;
-            if (n == 2) return true;
-            if (n % 2 == 0) return false;
-            for (int64_t i = 3; i * i <= n; i += 2) {
-                if (n % i == 0) return false;
+        .def("keygen", [](BFVEncryptor& enc) {
+            std::vector<std::vector<ModInt>> keys;
+            {
+                py::gil_scoped_release release;
+                keys = enc.keygen();
+            }
+            return py::make_tuple(vector_to_numpy(std::move(keys[0])),
+                                  vector_to_numpy(std::move(keys[1])),
+                                  vector_to_numpy(std::move(keys[2])));
+        }, "Generate and keep a secret key and public key; returns (s, pk_b, pk_a)")
+
+        .def("set_secret_key", [](BFVEncryptor& enc, Int64Array s) {
+            enc.set_secret_key(numpy_to_vector(s, enc.get_N()));
+        }, py::arg("s"), "Load a secret key (signed or reduced mod q)")
+
+        .def("set_public_key", [](BFVEncryptor& enc, Int64Array b, Int64Array a) {
+            enc.set_public_key(numpy_to_vector(b, enc.get_N()), numpy_to_vector(a, enc.get_N()));
+        }, py::arg("b"), py::arg("a"), "Load a public key (b, a) with b = -(a s + e)")
+
+        .def("set_public_key_seeded", [](BFVEncryptor& enc, Int64Array b, py::bytes a_seed) {
+            enc.set_public_key(numpy_to_vector(b, enc.get_N()), bytes_to_seed(a_seed));
+        }, py::arg("b"), py::arg("a_seed"),
+           "Load a public key from b and the 32-byte seed that a expands from")
+
+        .def("public_key_seed", [](const BFVEncryptor& enc) {
+            return seed_to_bytes(enc.public_key_seed());
+        }, "32-byte seed of the public key's a (keys made by keygen or set_public_key_seeded)")
+
+        .def("has_secret_key", &BFVEncryptor::has_secret_key)
+        .def("has_public_key", &BFVEncryptor::has_public_key)
+
+        .def("relin_keygen", [](const BFVEncryptor& enc, int base_bits, bool return_seed) -> py::tuple {
+            std::vector<std::vector<ModInt>> key_b, key_a;
+            Seed seed;
+            {
+                py::gil_scoped_release release;
+                enc.relin_keygen(base_bits, key_b, key_a, &seed);
+            }
+            py::list out_b, out_a;
+            for (auto& k : key_b) out_b.append(vector_to_numpy(std::move(k)));
+            for (auto& k : key_a) out_a.append(vector_to_numpy(std::move(k)));
+            if (return_seed) return py::make_tuple(out_b, out_a, seed_to_bytes(seed));
+            return py::make_tuple(out_b, out_a);
+        }, py::arg("base_bits"), py::arg("return_seed") = false,
+           "Relinearization key digits (key_b, key_a) for base T = 2^base_bits, as taken by "
+           "BFVMultiplier.set_relin_key; key_a[i] = expand_uniform(seed, N, q, i), and "
+           "return_seed appends the seed")
+
+        .def("galois_keygen", [](const BFVEncryptor& enc, uint64_t galois_elt, int base_bits,
+                                 bool return_seed) -> py::tuple {
+            std::vector<std::vector<ModInt>> key_b, key_a;
+            Seed seed;
+            {
+                py::gil_scoped_release release;
+                enc.galois_keygen(galois_elt, base_bits, key_b, key_a, &seed);
+            }
+            py::list out_b, out_a;
+            for (auto& k : key_b) out_b.append(vector_to_numpy(std::move(k)));
+            for (auto& k : key_a) out_a.append(vector_to_numpy(std::move(k)));
+            if (return_seed) return py::make_tuple(out_b, out_a, seed_to_bytes(seed));
+            return py::make_tuple(out_b, out_a);
+        }, py::arg("galois_elt"), py::arg("base_bits"), py::arg("return_seed") = false,
+           "Key-switching digits (key_b, key_a) from s(X^galois_elt) to s, as taken by "
+           "BFVMultiplier.set_galois_key")
+
+        .def("keygen_bundle", [](BFVEncryptor& enc, int base_bits, std::vector<uint64_t> galois_elts) {
+            KeyBundle bundle;
+            {
+                py::gil_scoped_release release;
+                bundle = enc.keygen_bundle(base_bits, galois_elts);
+            }
+            auto switch_key = [](SwitchKey& k) {
+                py::list out_b, out_a;
+                for (auto& v : k.key_b) out_b.append(vector_to_numpy(std::move(v)));
+                for (auto& v : k.key_a) out_a.append(vector_to_numpy(std::move(v)));
+                return py::make_tuple(out_b, out_a, seed_to_bytes(k.seed));
+            };
+            py::dict galois;
+            for (size_t j = 0; j < bundle.galois_elts.size(); j++) {
+                galois[py::int_(bundle.galois_elts[j])] = switch_key(bundle.galois[j]);
             }
-            return true;
-        };
+            py::dict out;
+            out["secret"] = vector_to_numpy(std::move(bundle.secret));
+            out["public"] = py::make_tuple(vector_to_numpy(std::move(bundle.pk_b)),
+                                           vector_to_numpy(std::move(bundle.pk_a)),
+                                           seed_to_bytes(bundle.pk_seed));
+            out["relin"] = switch_key(bundle.relin);
+            out["galois"] = galois;
+            return out;
+        }, py::arg("base_bits"), py::arg("galois_elts") = std::vector<uint64_t>(),
+           "keygen plus the relinearization key and a Galois key per element, every digit "
+           "generated in parallel; returns {'secret': s, 'public': (b, a, seed), "
+           "'relin': (key_b, key_a, seed), 'galois': {g: (key_b, key_a, seed)}}")
 
-        while (!is_prime(q)) {
-            q += 2 * N;
+        .def("encrypt", [](const BFVEncryptor& enc, Int64Array m, bool ntt_form) {
+            std::vector<ModInt> msg = numpy_to_vector(m, enc.get_N());
+            std::vector<std::vector<ModInt>> ct;
+            {
+                py::gil_scoped_release release;
+                ct = enc.encrypt(msg, ntt_form);
+            }
+            return py::make_tuple(vector_to_numpy(std::move(ct[0])), vector_to_numpy(std::move(ct[1])));
+        }, py::arg("m"), py::arg("ntt_form") = false,
+           "Encrypt N plaintext coefficients with the public key; returns (c0, c1)")
+
+        .def("encrypt_many", [](const BFVEncryptor& enc, Int64Array messages, bool ntt_form) {
+            if (messages.ndim() != 2 || messages.shape(1) != enc.get_N()) {
+                throw std::invalid_argument("Messages must be a 2-D (rows, N) array");
+            }
+            const size_t rows = (size_t)messages.shape(0);
+            const size_t n = (size_t)enc.get_N();
+            const ModInt* p = messages.data();
+
+            std::vector<std::vector<std::vector<ModInt>>> cts(rows);
+            {
+                py::gil_scoped_release release;
+                default_pool()->parallel_for(rows, [&](size_t r) {
+                    cts[r] = enc.encrypt(std::vector<ModInt>(p + r * n, p + (r + 1) * n), ntt_form);
+                });
+            }
+
+            py::list out;
+            for (auto& ct : cts) {
+                out.append(py::make_tuple(vector_to_numpy(std::move(ct[0])), vector_to_numpy(std::move(ct[1]))));
+            }
+            return out;
+        }, py::arg("messages"), py::arg("ntt_form") = false,
+           "Encrypt every row of a (rows, N) array across the thread pool; returns a list of (c0, c1)")
+
+        .def("encrypt_symmetric", [](const BFVEncryptor& enc, Int64Array m, bool ntt_form) {
+            std::vector<ModInt> msg = numpy_to_vector(m, enc.get_N());
+            std::vector<ModInt> c0;
+            Seed seed;
+            {
+                py::gil_scoped_release release;
+                c0 = enc.encrypt_symmetric(msg, seed, ntt_form);
+            }
+            return py::make_tuple(vector_to_numpy(std::move(c0)), seed_to_bytes(seed));
+        }, py::arg("m"), py::arg("ntt_form") = false,
+           "Encrypt with the secret key; returns (c0, seed) where c1 = expand_uniform(seed, N, q) "
+           "in coefficient form")
+
+        .def("decrypt", [](const BFVEncryptor& enc, std::vector<Int64Array> components, bool ntt_form) {
+            std::vector<std::vector<ModInt>> ct;
+            for (auto& c : components) ct.push_back(numpy_to_vector(c, enc.get_N()));
+            std::vector<ModInt> msg;
+            {
+                py::gil_scoped_release release;
+                msg = enc.decrypt(ct, ntt_form);
+            }
+            return vector_to_numpy(std::move(msg));
+        }, py::arg("components"), py::arg("ntt_form") = false,
+           "Decrypt (c0, c1[, c2, ...]) with the secret key; returns coefficients mod t")
+
+        .def("noise_budget", [](const BFVEncryptor& enc, std::vector<Int64Array> components, bool ntt_form) {
+            std::vector<std::vector<ModInt>> ct;
+            for (auto& c : components) ct.push_back(numpy_to_vector(c, enc.get_N()));
+            py::gil_scoped_release release;
+            return enc.noise_budget(ct, ntt_form);
+        }, py::arg("components"), py::arg("ntt_form") = false,
+           "Exact invariant noise budget in bits (0 = no longer decryptable); needs the secret key")
+
+        .def("get_delta", &BFVEncryptor::get_delta, "Get delta = floor(q/t)");
+
+    // Slot batching for prime t = 1 (mod 2N); slots are a 2 x (N/2) matrix
+    py::class_<BatchEncoder>(m, "BatchEncoder")
+        .def(py::init<int, ModInt>(), py::arg("N"), py::arg("t"),
+             "Initialize slot packing for degree N and a prime plaintext modulus t = 1 (mod 2N)")
+        .def("encode", [](const BatchEncoder& enc, Int64Array values) {
+            std::vector<ModInt> v = numpy_to_vector(values);
+            std::vector<ModInt> res;
+            {
+                py::gil_scoped_release release;
+                res = enc.encode(v);
+            }
+            return vector_to_numpy(std::move(res));
+        }, py::arg("values"), "Up to N slot values -> plaintext polynomial mod t")
+        .def("decode", [](const BatchEncoder& enc, Int64Array poly) {
+            std::vector<ModInt> p = numpy_to_vector(poly, enc.slot_count());
+            std::vector<ModInt> res;
+            {
+                py::gil_scoped_release release;
+                res = enc.decode(p);
+            }
+            return vector_to_numpy(std::move(res));
+        }, py::arg("poly"), "Plaintext polynomial -> N slot values in [0, t)")
+        .def("slot_count", &BatchEncoder::slot_count)
+        .def("row_size", &BatchEncoder::row_size);
+
+    // Plaintext-ciphertext operations with an LRU cache of encoded plaintexts
+    py::class_<EncodedPlaintext, std::shared_ptr<EncodedPlaintext>>(m, "EncodedPlaintext")
+        .def_property_readonly("values", [](const EncodedPlaintext& pt) {
+            return py::array_t<int64_t>((py::ssize_t)pt.values.size(), pt.values.data());
+        }, "Coefficients mod t, trailing zeros trimmed")
+        .def_property_readonly("scaled_ntt", [](const EncodedPlaintext& pt) {
+            return py::array_t<int64_t>((py::ssize_t)pt.scaled_ntt.size(), pt.scaled_ntt.data());
+        }, "delta m in NTT form")
+        .def_property_readonly("lifted_ntt", [](const EncodedPlaintext& pt) {
+            return py::array_t<int64_t>((py::ssize_t)pt.lifted_ntt.size(), pt.lifted_ntt.data());
+        }, "m centred into (-t/2, t/2] in NTT form, e.g. as dot_product weights");
+
+    py::class_<PlaintextEvaluator>(m, "PlaintextEvaluator")
+        .def(py::init<int, ModInt, ModInt, size_t>(), py::arg("N"), py::arg("q"), py::arg("t"),
+             py::arg("capacity") = 256,
+             "Plaintext-ciphertext operations; keeps up to capacity encoded plaintexts (LRU)")
+        .def("encode", [](const PlaintextEvaluator& ev, py::object values) {
+            return std::const_pointer_cast<EncodedPlaintext>(plain_operand(ev, values));
+        }, py::arg("values"), "int constant or up to N coefficients -> cached EncodedPlaintext")
+        .def("add_plain", [](const PlaintextEvaluator& ev, Int64Array ct, py::object pt, bool ntt_form) {
+            py::ssize_t size;
+            const ModInt* pc = plain_op_input(ev, ct, size);
+            std::shared_ptr<const EncodedPlaintext> m = plain_operand(ev, pt);
+            py::array_t<int64_t> out({size, (py::ssize_t)ev.get_N()});
+            ModInt* po = out.mutable_data();
+            {
+                py::gil_scoped_release release;
+                ev.add_plain_into(pc, (int)size, ntt_form, *m, po);
+            }
+            return out;
+        }, py::arg("ct"), py::arg("pt"), py::arg("ntt_form") = false,
+           "ct + m: c0 += delta m for a (size, N) ciphertext in the given form")
+        .def("sub_plain", [](const PlaintextEvaluator& ev, Int64Array ct, py::object pt, bool ntt_form) {
+            py::ssize_t size;
+            const ModInt* pc = plain_op_input(ev, ct, size);
+            std::shared_ptr<const EncodedPlaintext> m = plain_operand(ev, pt);
+            py::array_t<int64_t> out({size, (py::ssize_t)ev.get_N()});
+            ModInt* po = out.mutable_data();
+            {
+                py::gil_scoped_release release;
+                ev.sub_plain_into(pc, (int)size, ntt_form, *m, po);
+            }
+            return out;
+        }, py::arg("ct"), py::arg("pt"), py::arg("ntt_form") = false,
+           "ct - m: c0 -= delta m for a (size, N) ciphertext in the given form")
+        .def("multiply_plain", [](const PlaintextEvaluator& ev, Int64Array ct, py::object pt, bool ntt_form) {
+            py::ssize_t size;
+            const ModInt* pc = plain_op_input(ev, ct, size);
+            std::shared_ptr<const EncodedPlaintext> m = plain_operand(ev, pt);
+            py::array_t<int64_t> out({size, (py::ssize_t)ev.get_N()});
+            ModInt* po = out.mutable_data();
+            {
+                py::gil_scoped_release release;
+                ev.multiply_plain_into(pc, (int)size, ntt_form, *m, po);
+            }
+            return out;
+        }, py::arg("ct"), py::arg("pt"), py::arg("ntt_form") = false,
+           "ct * m with m centred into (-t/2, t/2] for a (size, N) ciphertext in the given form")
+        .def("scan_subtract_plain", [](const PlaintextEvaluator& ev, Int64Array db, py::list targets, bool ntt_form,
+                                       py::object out) {
+            py::ssize_t rows, size, n;
+            const ModInt* pd = ciphertext_matrix(db, rows, size, n);
+            if (n != ev.get_N()) throw std::invalid_argument("Database rows have the wrong N");
+            std::vector<std::shared_ptr<const EncodedPlaintext>> pts;
+            for (py::handle pt : targets) pts.push_back(plain_operand(ev, pt));
+            ModInt* po;
+            py::array res = arena_or_new(out, {rows, (py::ssize_t)pts.size(), size, n}, po);
+            {
+                py::gil_scoped_release release;
+                ev.scan_subtract_plain(pd, (size_t)rows, (int)size, ntt_form, pts, po);
+            }
+            return res;
+        }, py::arg("db"), py::arg("targets"), py::arg("ntt_form") = false, py::arg("out") = py::none(),
+           "out[r, j] = db[r] - targets[j] for (rows, size, N) db and plaintext targets (ints, "
+           "coefficient arrays or EncodedPlaintext); writes into out (rows, targets, size, N) when given")
+        .def("cache_size", &PlaintextEvaluator::cache_size)
+        .def("cache_capacity", &PlaintextEvaluator::cache_capacity)
+        .def("set_cache_capacity", &PlaintextEvaluator::set_cache_capacity, py::arg("capacity"))
+        .def("cache_hits", &PlaintextEvaluator::cache_hits)
+        .def("cache_misses", &PlaintextEvaluator::cache_misses)
+        .def("clear_cache", &PlaintextEvaluator::clear_cache, "Drop every entry and zero the hit/miss counts")
+        .def("get_N", &PlaintextEvaluator::get_N)
+        .def("get_q", &PlaintextEvaluator::get_q)
+        .def("get_t", &PlaintextEvaluator::get_t);
+
+    m.def("galois_element", &galois_element, py::arg("N"), py::arg("steps"),
+          "3^steps mod 2N: the automorphism that rotates batching rows left by steps");
+    m.def("galois_column_swap", &galois_column_swap, py::arg("N"),
+          "2N - 1: the automorphism that swaps the two batching rows");
+    m.def("apply_galois", [](Int64Array a, uint64_t galois_elt, ModInt q) {
+        std::vector<ModInt> v = numpy_to_vector(a);
+        std::vector<ModInt> res;
+        {
+            py::gil_scoped_release release;
+            res = apply_galois(v, galois_elt, q);
+        }
+        return vector_to_numpy(std::move(res));
+    }, py::arg("a"), py::arg("galois_elt"), py::arg("q"),
+       "a(X) -> a(X^galois_elt) mod (X^N + 1, q), coefficient form");
+    m.def("apply_galois_ntt", [](Int64Array a, uint64_t galois_elt) {
+        std::vector<ModInt> v = numpy_to_vector(a);
+        std::vector<ModInt> res;
+        {
+            py::gil_scoped_release release;
+            res = apply_galois_ntt(v, galois_elt);
         }
+        return vector_to_numpy(std::move(res));
+    }, py::arg("a"), py::arg("galois_elt"),
+       "The same automorphism on NTT-form data: a slot permutation, no modulus needed");
+
+    // Memory-mapped ciphertext store; columns come back as read-only views of the mapping.
+    // Shared ownership: pipelined searches keep the mapping alive until they finish.
+    py::class_<CiphertextStore, std::shared_ptr<CiphertextStore>>(m, "CiphertextStore")
+        .def(py::init<const std::string&>(), py::arg("path"),
+             "Map an existing store file read-only")
 
-        return q;
-    }, "Find a prime suitable for NTT with given N");
+        .def_static("build", [](const std::string& path, py::dict columns, bool ntt_form) {
+            std::vector<std::string> names;
+            std::vector<py::buffer_info> views;     // Pin the batches while the GIL is released
+            std::vector<std::pair<const uint8_t*, size_t>> batches;
+            for (auto item : columns) {
+                names.push_back(item.first.cast<std::string>());
+                views.push_back(item.second.cast<py::buffer>().request());
+                const py::buffer_info& info = views.back();
+                if (info.ndim != 1 || info.itemsize != 1) throw std::invalid_argument("Expected flat byte buffers");
+                batches.emplace_back(static_cast<const uint8_t*>(info.ptr), (size_t)info.size);
+            }
+            py::gil_scoped_release release;
+            CiphertextStore::build(path, names, batches, ntt_form);
+        }, py::arg("path"), py::arg("columns"), py::arg("ntt_form") = true,
+           "Write a store from {column name: serialize_ciphertexts batch}; rows are converted "
+           "to NTT form unless ntt_form=False")
+
+        .def("get_N", &CiphertextStore::get_N)
+        .def("get_q", &CiphertextStore::get_q)
+        .def("get_t", &CiphertextStore::get_t)
+        .def("num_rows", &CiphertextStore::num_rows)
+        .def("is_ntt", &CiphertextStore::is_ntt)
+        .def("column_names", &CiphertextStore::column_names)
+
+        .def("column", [](py::object self, const std::string& name) {
+            const CiphertextStore& st = self.cast<const CiphertextStore&>();
+            const ModInt* data = st.column_data(st.column_index(name));
+            const py::ssize_t n = st.get_N();
+            const py::ssize_t w = (py::ssize_t)sizeof(ModInt);
+            // The view keeps the store (and so the mapping) alive
+            py::array_t<int64_t> arr({(py::ssize_t)st.num_rows(), (py::ssize_t)2, n},
+                                     {2 * n * w, n * w, w}, data, self);
+            arr.attr("setflags")(false);
+            return arr;
+        }, py::arg("name"),
+           "Read-only (rows, 2, N) int64 view of a column; row r is (c0, c1)")
+
+        .def("scan_subtract", [](const CiphertextStore& st, const std::string& name, Int64Array queries,
+                                 py::object out) {
+            py::ssize_t num_queries, size, n;
+            const ModInt* pq = ciphertext_matrix(queries, num_queries, size, n);
+            if (size != 2 || n != st.get_N()) throw std::invalid_argument("Queries must be (targets, 2, N)");
+            const int column = st.column_index(name);
+            ModInt* po;
+            py::array res = arena_or_new(out, {(py::ssize_t)st.num_rows(), num_queries, 2, n}, po);
+            {
+                py::gil_scoped_release release;
+                scan_subtract(st, column, pq, (size_t)num_queries, po);
+            }
+            return res;
+        }, py::arg("name"), py::arg("queries"), py::arg("out") = py::none(),
+           "Stream a column against (targets, 2, N) queries in the store's form; returns "
+           "(rows, targets, 2, N) differences, written into out when given")
+
+        .def("release_rows", [](const CiphertextStore& st, const std::string& name, size_t begin, size_t end) {
+            st.release_rows(st.column_index(name), begin, end);
+        }, py::arg("name"), py::arg("begin"), py::arg("end"),
+           "Let the OS drop the pages of rows [begin, end) after a scan");
+
+    // Pipelined searches: stage threads call back into Python, so every blocking call
+    // here drops the GIL first
+    py::class_<SearchJob, std::shared_ptr<SearchJob>>(m, "SearchJob")
+        .def("done", &SearchJob::done)
+        .def("wait", [](SearchJob& job, py::object timeout) {
+            if (timeout.is_none()) {
+                py::gil_scoped_release release;
+                job.wait();
+                return true;
+            }
+            const double seconds = timeout.cast<double>();
+            py::gil_scoped_release release;
+            return job.wait_for(seconds);
+        }, py::arg("timeout") = py::none(),
+           "Block until the search finishes; False if timeout (seconds) expires first")
+        .def("result", [](SearchJob& job) {
+            const std::vector<uint8_t>* payload;
+            {
+                py::gil_scoped_release release;
+                payload = &job.result();
+            }
+            return py::bytes(reinterpret_cast<const char*>(payload->data()), payload->size());
+        }, "Serialized (rows * targets) difference batch; raises the search's error")
+        .def("add_done_callback", [](SearchJob& job, py::function fn) {
+            // Copied and destroyed only under the GIL, whichever thread drops it last
+            std::shared_ptr<py::function> held(new py::function(std::move(fn)), [](py::function* f) {
+                py::gil_scoped_acquire acquire;
+                delete f;
+            });
+            job.add_done_callback([held] {
+                py::gil_scoped_acquire acquire;
+                try {
+                    (*held)();
+                } catch (py::error_already_set& e) {
+                    e.discard_as_unraisable("SearchJob done callback");
+                }
+            });
+        }, py::arg("fn"),
+           "Call fn() once the search is done, on a pipeline thread (or now, if it already is); "
+           "fn must be quick, e.g. loop.call_soon_threadsafe");
+
+    py::class_<SearchPipeline, std::unique_ptr<SearchPipeline, PipelineDeleter>>(m, "SearchPipeline")
+        .def(py::init<size_t, size_t, size_t>(),
+             py::arg("max_pending") = 64, py::arg("chunk_bytes") = 2 << 20, py::arg("depth") = 2,
+             "Decode / scan / encode stage threads; max_pending requests may wait to start, "
+             "depth chunks of about chunk_bytes differences sit between two stages")
+        .def("try_submit", [](SearchPipeline& pl, std::shared_ptr<CiphertextStore> store,
+                              const std::string& column, py::buffer query) {
+            py::buffer_info info = query.request();
+            if (info.ndim != 1 || info.itemsize != 1) throw std::invalid_argument("Expected a flat byte buffer");
+            const uint8_t* p = static_cast<const uint8_t*>(info.ptr);
+            std::vector<uint8_t> bytes(p, p + info.size);
+            return pl.try_submit(std::move(store), column, std::move(bytes));
+        }, py::arg("store"), py::arg("column"), py::arg("query"),
+           "Queue a search of a store column for a serialized query batch (any form); "
+           "returns a SearchJob, or None when max_pending searches are already waiting")
+        .def("pending", &SearchPipeline::pending, "Searches waiting for the decode stage")
+        .def("shutdown", [](SearchPipeline& pl) {
+            py::gil_scoped_release release;
+            pl.shutdown();
+        }, "Finish every queued search and stop the stage threads");
+
+    // RNS (multi-prime) ring and BFV multiplier; polynomials are (limbs, N) residue arrays
+    py::class_<RNSContext>(m, "RNSContext")
+        .def(py::init<int, const std::vector<ModInt>&>(),
+             py::arg("N"), py::arg("primes"),
+             "Initialize an RNS basis Q = prod(primes) over distinct NTT primes < 2^61")
+
+        .def("multiply", [](const RNSContext& ctx,
+                           py::array_t<int64_t> a,
+                           py::array_t<int64_t> b) {
+            RNSPoly pa = numpy_to_rns(a), pb = numpy_to_rns(b), res;
+            {
+                py::gil_scoped_release release;
+                res = ctx.multiply(pa, pb);
+            }
+            return rns_to_numpy(res);
+        }, "Multiply two RNS polynomials (negacyclic, per limb)")
+
+        .def("to_ntt", [](const RNSContext& ctx, py::array_t<int64_t> a) {
+            RNSPoly p = numpy_to_rns(a);
+            {
+                py::gil_scoped_release release;
+                ctx.forward(p);
+            }
+            return rns_to_numpy(p);
+        }, "Coefficient form -> evaluation (NTT) form")
+
+        .def("to_coeff", [](const RNSContext& ctx, py::array_t<int64_t> a) {
+            RNSPoly p = numpy_to_rns(a, true);
+            {
+                py::gil_scoped_release release;
+                ctx.inverse(p);
+            }
+            return rns_to_numpy(p);
+        }, "Evaluation (NTT) form -> coefficient form")
+
+        .def("pointwise_multiply", [](const RNSContext& ctx,
+                                     py::array_t<int64_t> a,
+                                     py::array_t<int64_t> b) {
+            RNSPoly pa = numpy_to_rns(a, true), pb = numpy_to_rns(b, true), res;
+            {
+                py::gil_scoped_release release;
+                res = ctx.pointwise_multiply(pa, pb);
+            }
+            return rns_to_numpy(res);
+        }, "Element-wise product of two evaluation-form RNS polynomials")
+
+        .def("add", [](const RNSContext& ctx,
+                      py::array_t<int64_t> a,
+                      py::array_t<int64_t> b) {
+            return rns_to_numpy(ctx.add(numpy_to_rns(a), numpy_to_rns(b)));
+        }, "Add two RNS polynomials")
+
+        .def("subtract", [](const RNSContext& ctx,
+                           py::array_t<int64_t> a,
+                           py::array_t<int64_t> b) {
+            return rns_to_numpy(ctx.subtract(numpy_to_rns(a), numpy_to_rns(b)));
+        }, "Subtract two RNS polynomials")
+
+        .def("get_N", &RNSContext::get_N, "Get polynomial degree")
+        .def("get_primes", &RNSContext::get_primes, "Get the primes q_i of Q")
+        .def("modulus_bits", &RNSContext::modulus_bits, "Upper bound on log2(Q)");
+
+    py::class_<RNSBFVMultiplier>(m, "RNSBFVMultiplier")
+        .def(py::init<int, const std::vector<ModInt>&, ModInt>(),
+             py::arg("N"), py::arg("q_primes"), py::arg("t"),
+             "Initialize BFV multiplication over Q = prod(q_primes) with plaintext modulus t")
+
+        .def("multiply_ciphertexts", [](const RNSBFVMultiplier& mult,
+                                        py::array_t<int64_t> c1_0,
+                                        py::array_t<int64_t> c1_1,
+                                        py::array_t<int64_t> c2_0,
+                                        py::array_t<int64_t> c2_1,
+                                        bool ntt_form) {
+            RNSPoly a0 = numpy_to_rns(c1_0, ntt_form), a1 = numpy_to_rns(c1_1, ntt_form);
+            RNSPoly b0 = numpy_to_rns(c2_0, ntt_form), b1 = numpy_to_rns(c2_1, ntt_form);
+            std::vector<RNSPoly> result;
+            {
+                py::gil_scoped_release release;
+                result = mult.multiply_ciphertexts(a0, a1, b0, b1);
+            }
+            return py::make_tuple(rns_to_numpy(result[0]),
+                                  rns_to_numpy(result[1]),
+                                  rns_to_numpy(result[2]));
+        }, py::arg("c1_0"), py::arg("c1_1"), py::arg("c2_0"), py::arg("c2_1"), py::arg("ntt_form") = false,
+           "Multiply two ciphertexts given in coefficient or NTT form (returns d0, d1, d2, coefficient form)")
+
+        .def("set_relin_key", [](RNSBFVMultiplier& mult,
+                                 std::vector<py::array_t<int64_t>> key_b,
+                                 std::vector<py::array_t<int64_t>> key_a) {
+            std::vector<RNSPoly> vec_b, vec_a;
+            for (auto& k : key_b) vec_b.push_back(numpy_to_rns(k));
+            for (auto& k : key_a) vec_a.push_back(numpy_to_rns(k));
+            mult.set_relin_key(vec_b, vec_a);
+        }, py::arg("key_b"), py::arg("key_a"),
+           "Load one relinearization digit per prime: key_b[i] + key_a[i] * s = g_i * s^2 + e_i")
+
+        .def("has_relin_key", &RNSBFVMultiplier::has_relin_key,
+             "Check if a relinearization key is loaded")
+
+        .def("relinearize", [](const RNSBFVMultiplier& mult,
+                              py::array_t<int64_t> d0,
+                              py::array_t<int64_t> d1,
+                              py::array_t<int64_t> d2,
+                              bool ntt_form) {
+            RNSPoly v0 = numpy_to_rns(d0, ntt_form), v1 = numpy_to_rns(d1, ntt_form);
+            RNSPoly v2 = numpy_to_rns(d2, ntt_form);
+            std::vector<RNSPoly> result;
+            {
+                py::gil_scoped_release release;
+                result = mult.relinearize(v0, v1, v2);
+            }
+            return py::make_tuple(rns_to_numpy(result[0]), rns_to_numpy(result[1]));
+        }, py::arg("d0"), py::arg("d1"), py::arg("d2"), py::arg("ntt_form") = false,
+           "Relinearize (d0, d1, d2) to (c0, c1) with the loaded key; NTT-form input gives NTT-form output")
+
+        .def("get_primes", [](const RNSBFVMultiplier& mult) {
+            return mult.context().get_primes();
+        }, "Get the ciphertext primes q_i")
+        .def("aux_primes", &RNSBFVMultiplier::aux_primes,
+             "Auxiliary primes P used by the tensor product");
+
+    // Utility functions
+    m.def("is_prime", &is_prime, py::arg("n"),
+          "Deterministic Miller-Rabin for 0 <= n < 2^64");
+
+    m.def("find_ntt_primes", &find_ntt_primes,
+          py::arg("N"), py::arg("bits"), py::arg("count"),
+          "Largest `count` primes below 2^bits with p = 1 (mod 2N), descending");
+
+    m.def("find_ntt_prime_chain", &find_ntt_prime_chain,
+          py::arg("N"), py::arg("bit_sizes"), py::arg("exclude") = std::vector<ModInt>(),
+          "Distinct primes p = 1 (mod 2N) with 2^(bits-1) < p < 2^bits, one per entry of "
+          "bit_sizes and none in `exclude`; e.g. [60, 40, 40, 60] for an RNS chain");
+
+    m.def("find_ntt_prime", [](int N, int bits) -> int64_t {
+        return find_ntt_primes(N, bits, 1)[0];
+    }, py::arg("N"), py::arg("bits") = 60,
+       "Largest prime below 2^bits with q = 1 (mod 2N) (deterministic Miller-Rabin)");
+
+    // Shared NTT tables: every NTT / multiplier / encryptor over one (N, q) uses one copy
+    m.def("set_ntt_cache_dir", [](const std::string& dir) {
+        ContextRegistry::instance().set_cache_dir(dir);
+    }, py::arg("dir"),
+       "Cache NTT tables as files in dir (must exist) so new processes skip building them; "
+       "\"\" disables. Defaults to $FHE_NTT_CACHE_DIR.");
+    m.def("get_ntt_cache_dir", []() { return ContextRegistry::instance().get_cache_dir(); });
+    m.def("ntt_registry_size", []() { return ContextRegistry::instance().size(); },
+          "Number of (N, q) rings with tables held by the registry");
+    m.def("clear_ntt_registry", []() { ContextRegistry::instance().clear(); },
+          "Drop the registry's tables; live objects keep theirs");
+
+    // Hot-path instrumentation
+    m.def("stats", []() {
+        std::vector<StatTotals> totals = snapshot_stats();
+        const double hz = stat_ticks_per_second();
+        py::dict res;
+        for (int s = 0; s < (int)Stat::Count; s++) {
+            py::dict entry;
+            entry["calls"] = totals[s].calls;
+            entry["cycles"] = totals[s].cycles;
+            entry["seconds"] = (double)totals[s].cycles / hz;
+            entry["bytes"] = totals[s].bytes;
+            res[stat_name((Stat)s)] = entry;
+        }
+        res["enabled"] = stats_enabled();
+        res["ticks_per_second"] = hz;
+        return res;
+    }, "Per-operation totals since the last reset_stats(), summed over threads: "
+       "{name: {calls, cycles, seconds, bytes}}, plus 'enabled' and 'ticks_per_second'. "
+       "Times are inclusive (key_switch includes its NTTs).");
+    m.def("reset_stats", &reset_stats, "Zero the counters reported by stats()");
 }
@@ -0,0 +1,178 @@
+/*
+ * Context Registry Implementation
+ */
+
+#include "context.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace fhe_cpp {
+
+static const uint8_t kTableMagic[4] = {'F', 'H', 'E', 'T'};
+static const uint16_t kTableVersion = 1;
+static const size_t kTableHeaderBytes = 40;
+
+// FNV-1a with 64-bit words as the input symbols
+static uint64_t fnv1a(const std::vector<uint64_t>* tabs[4]) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (int k = 0; k < 4; k++) {
+        for (uint64_t w : *tabs[k]) {
+            h ^= w;
+            h *= 0x100000001b3ULL;
+        }
+    }
+    return h;
+}
+
+static uint64_t pow_mod(uint64_t b, uint64_t e, const Modulus& q) {
+    uint64_t r = 1;
+    for (; e; e >>= 1) {
+        if (e & 1) r = q.mul(r, b);
+        b = q.mul(b, b);
+    }
+    return r;
+}
+
+// Tables are written in host byte order; the header's N and q double as a
+// byte-order check, since a foreign file never matches the requested ring
+static void write_tables(const std::string& path, const NTTTables& tab) {
+    const std::vector<uint64_t>* tabs[4] = {&tab.psi_rev, &tab.psi_inv_rev,
+                                            &tab.psi_rev_shoup, &tab.psi_inv_rev_shoup};
+    uint8_t header[kTableHeaderBytes] = {0};
+    const uint32_t n = (uint32_t)tab.N;
+    const uint64_t q = (uint64_t)tab.q, psi = (uint64_t)tab.psi, sum = fnv1a(tabs);
+    std::memcpy(header, kTableMagic, 4);
+    std::memcpy(header + 4, &kTableVersion, 2);
+    std::memcpy(header + 8, &n, 4);
+    std::memcpy(header + 12, &q, 8);
+    std::memcpy(header + 20, &psi, 8);
+    std::memcpy(header + 28, &sum, 8);
+
+    // Unique temporary name, then rename: readers never see a partial file
+    const std::string tmp = path + ".tmp" +
+        std::to_string((unsigned long long)std::chrono::steady_clock::now().time_since_epoch().count() ^
+                       (unsigned long long)(uintptr_t)&tab);
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return;
+    bool ok = std::fwrite(header, 1, kTableHeaderBytes, f) == kTableHeaderBytes;
+    for (int k = 0; k < 4 && ok; k++) {
+        ok = std::fwrite(tabs[k]->data(), sizeof(uint64_t), tabs[k]->size(), f) == tabs[k]->size();
+    }
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) std::remove(tmp.c_str());
+}
+
+static std::shared_ptr<NTTTables> read_tables(const std::string& path, int N, ModInt q) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return nullptr;
+
+    auto tab = std::make_shared<NTTTables>();
+    uint8_t header[kTableHeaderBytes];
+    bool ok = std::fread(header, 1, kTableHeaderBytes, f) == kTableHeaderBytes;
+
+    uint16_t version = 0;
+    uint32_t n = 0;
+    uint64_t file_q = 0, psi = 0, sum = 0;
+    if (ok) {
+        std::memcpy(&version, header + 4, 2);
+        std::memcpy(&n, header + 8, 4);
+        std::memcpy(&file_q, header + 12, 8);
+        std::memcpy(&psi, header + 20, 8);
+        std::memcpy(&sum, header + 28, 8);
+        ok = std::memcmp(header, kTableMagic, 4) == 0 && version == kTableVersion &&
+             n == (uint32_t)N && file_q == (uint64_t)q;
+    }
+    std::vector<uint64_t>* tabs[4] = {&tab->psi_rev, &tab->psi_inv_rev,
+                                      &tab->psi_rev_shoup, &tab->psi_inv_rev_shoup};
+    for (int k = 0; k < 4 && ok; k++) {
+        tabs[k]->resize(N);
+        ok = std::fread(tabs[k]->data(), sizeof(uint64_t), N, f) == (size_t)N;
+    }
+    std::fclose(f);
+    if (!ok) return nullptr;
+
+    const std::vector<uint64_t>* ctabs[4] = {tabs[0], tabs[1], tabs[2], tabs[3]};
+    const Modulus q_mod((uint64_t)q);
+    if (fnv1a(ctabs) != sum || psi == 0 || psi >= (uint64_t)q) return nullptr;
+    if (pow_mod(psi, (uint64_t)N, q_mod) != (uint64_t)q - 1) return nullptr;
+    if (tab->psi_rev[0] != 1 || (N > 1 && tab->psi_rev[N / 2] != psi)) return nullptr;
+
+    // Scalars are cheap to rederive and pinned to the loaded psi
+    tab->N = N;
+    tab->q = q;
+    tab->psi = (ModInt)psi;
+    tab->psi_inv = (ModInt)pow_mod(psi, 2 * (uint64_t)N - 1, q_mod);
+    tab->N_inv = (ModInt)pow_mod((uint64_t)N, (uint64_t)q - 2, q_mod);
+    if (q_mod.mul(psi, (uint64_t)tab->psi_inv) != 1 || q_mod.mul((uint64_t)N, (uint64_t)tab->N_inv) != 1) {
+        return nullptr;
+    }
+    if (N > 1 && tab->psi_inv_rev[N / 2] != (uint64_t)tab->psi_inv) return nullptr;
+    tab->inv_last_n = (uint64_t)tab->N_inv;
+    tab->inv_last_w = q_mod.mul((uint64_t)tab->N_inv, tab->psi_inv_rev[N > 1 ? 1 : 0]);
+    tab->inv_last_n_shoup = q_mod.shoup(tab->inv_last_n);
+    tab->inv_last_w_shoup = q_mod.shoup(tab->inv_last_w);
+    return tab;
+}
+
+ContextRegistry::ContextRegistry() {
+    const char* dir = std::getenv("FHE_NTT_CACHE_DIR");
+    if (dir) cache_dir = dir;
+}
+
+ContextRegistry& ContextRegistry::instance() {
+    static ContextRegistry registry;
+    return registry;
+}
+
+std::string ContextRegistry::cache_path(int N, ModInt q) const {
+    std::string dir = get_cache_dir();
+    if (dir.empty()) return dir;
+    if (dir.back() != '/' && dir.back() != '\\') dir += '/';
+    return dir + "ntt_" + std::to_string(N) + "_" + std::to_string((long long)q) + ".bin";
+}
+
+std::shared_ptr<const NTTTables> ContextRegistry::ntt_tables(int N, ModInt q) {
+    const std::pair<int, ModInt> key(N, q);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = ntt_cache.find(key);
+        if (it != ntt_cache.end()) return it->second;
+    }
+
+    // Built outside the lock so first uses of different rings do not serialize
+    const std::string path = cache_path(N, q);
+    std::shared_ptr<const NTTTables> tab;
+    if (!path.empty() && (N & (N - 1)) == 0 && N > 0) tab = read_tables(path, N, q);
+    if (!tab) {
+        std::shared_ptr<NTTTables> built = build_ntt_tables(N, q);
+        if (!path.empty()) write_tables(path, *built);
+        tab = built;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    return ntt_cache.emplace(key, tab).first->second;
+}
+
+void ContextRegistry::set_cache_dir(const std::string& dir) {
+    std::lock_guard<std::mutex> lock(mtx);
+    cache_dir = dir;
+}
+
+std::string ContextRegistry::get_cache_dir() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return cache_dir;
+}
+
+size_t ContextRegistry::size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return ntt_cache.size();
+}
+
+void ContextRegistry::clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    ntt_cache.clear();
+}
+
+} // namespace fhe_cpp
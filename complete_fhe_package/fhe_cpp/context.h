@@ -0,0 +1,65 @@
+/*
+ * Context Registry
+ * Process-wide, thread-safe cache of NTT tables keyed by (N, q). Every NTT built
+ * over a ring shares one immutable NTTTables through shared_ptr, so the
+ * multiplier, encryptor, store and the Python-side NTT of one scheme (and every
+ * worker thread) pay the root search and table construction once. Tables can
+ * additionally be cached on disk so new processes skip the construction too.
+ *
+ *   cache file: "FHET"  u16 version  u16 reserved  u32 N  u64 q  u64 psi
+ *               u64 checksum (FNV-1a over the table words)
+ *               psi_rev  psi_inv_rev  psi_rev_shoup  psi_inv_rev_shoup  (N x u64 each)
+ */
+
+#ifndef FHE_CONTEXT_H
+#define FHE_CONTEXT_H
+
+#include "ntt.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace fhe_cpp {
+
+class ContextRegistry {
+private:
+    mutable std::mutex mtx;
+    std::map<std::pair<int, ModInt>, std::shared_ptr<const NTTTables>> ntt_cache;
+    std::string cache_dir;              // Empty: no on-disk cache
+
+    ContextRegistry();
+
+    std::string cache_path(int N, ModInt q) const;
+
+public:
+    // Starts with the on-disk cache at $FHE_NTT_CACHE_DIR if that is set
+    static ContextRegistry& instance();
+
+    ContextRegistry(const ContextRegistry&) = delete;
+    ContextRegistry& operator=(const ContextRegistry&) = delete;
+
+    // Shared tables for (N, q): from memory, else from the disk cache, else built
+    // (and written back to the disk cache). Concurrent first requests may both
+    // build; one result wins and every caller gets it.
+    std::shared_ptr<const NTTTables> ntt_tables(int N, ModInt q);
+
+    // Directory for cached tables (created by the caller); "" turns the disk cache off.
+    // Unreadable or corrupt cache files are ignored and rebuilt.
+    void set_cache_dir(const std::string& dir);
+    std::string get_cache_dir() const;
+
+    size_t size() const;
+
+    // Drops the registry's references; live NTTs keep their tables
+    void clear();
+};
+
+inline std::shared_ptr<const NTTTables> get_ntt_tables(int N, ModInt q) {
+    return ContextRegistry::instance().ntt_tables(N, q);
+}
+
+} // namespace fhe_cpp
+
+#endif // FHE_CONTEXT_H
@@ -0,0 +1,262 @@
+/*
+ * Native Micro-Benchmarks (google-benchmark)
+ * NTT transforms and products, ciphertext multiplication and relinearization
+ * over N = 2^10 .. 2^15 and several modulus sizes. Besides time per op, each
+ * benchmark reports:
+ *   cycles/butterfly  TSC cycles per radix-2 butterfly (N/2 log N per transform)
+ *   bytes_per_second  modelled memory traffic: every stage reads and writes the
+ *                     N-word array once, plus the twiddle and Shoup tables
+ * Build with -DFHE_BUILD_BENCH=ON; run e.g. ./fhe_bench --benchmark_filter=NTT
+ */
+
+#include "ntt.h"
+#include "simd.h"
+#include "simd_target.h"
+#include "primes.h"
+#include "bfv_mult.h"
+#include "bfv_encrypt.h"
+#include "thread_pool.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+using namespace fhe_cpp;
+
+namespace {
+
+const ModInt kPlainModulus = 65537;
+const int kRelinBaseBits = 16;
+
+std::vector<ModInt> random_poly(int N, ModInt q, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<ModInt> a(N);
+    for (auto& x : a) x = (ModInt)(rng() % (uint64_t)q);
+    return a;
+}
+
+int log2_int(int N) {
+    int log_n = 0;
+    while ((1 << log_n) < N) log_n++;
+    return log_n;
+}
+
+uint64_t read_tsc() {
+#ifdef FHE_X86_64
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Runs the transforms blocked (from the default threshold) or stage by stage
+class BlockingScope {
+private:
+    int saved;
+
+public:
+    explicit BlockingScope(bool blocked) : saved(get_ntt_blocking_threshold()) {
+        if (!blocked) set_ntt_blocking_threshold(0);
+    }
+    ~BlockingScope() { set_ntt_blocking_threshold(saved); }
+};
+
+// Caps the kernels at the benchmark's SIMD level; skips levels the CPU lacks
+class SimdScope {
+private:
+    SimdLevel saved;
+
+public:
+    SimdScope(benchmark::State& state, SimdLevel level) : saved(get_simd_level()) {
+        if ((int)level > (int)detect_simd_level()) {
+            state.SkipWithError("SIMD level not supported by this CPU");
+        }
+        set_simd_level(level);
+        state.SetLabel(simd_level_name(get_simd_level()));
+    }
+    ~SimdScope() { set_simd_level(saved); }
+};
+
+// Bytes moved by `transforms` NTTs of size N under the model above
+double ntt_bytes(int N, int transforms) {
+    const double stages = log2_int(N);
+    return transforms * (stages * 2.0 * N * sizeof(ModInt) + 2.0 * N * sizeof(uint64_t));
+}
+
+void set_ntt_counters(benchmark::State& state, int N, int transforms, uint64_t cycles) {
+    if (state.iterations() == 0) return;  // Skipped
+    const double butterflies = (double)state.iterations() * transforms * (N / 2) * log2_int(N);
+#ifdef FHE_X86_64
+    state.counters["cycles/butterfly"] = benchmark::Counter((double)cycles / butterflies);
+#else
+    (void)cycles;
+    (void)butterflies;
+#endif
+    state.SetBytesProcessed((int64_t)(state.iterations() * ntt_bytes(N, transforms)));
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Args: log N, modulus bits, SIMD level, cache blocking (0 = off)
+void BM_NTTForward(benchmark::State& state) {
+    const int N = 1 << state.range(0);
+    SimdScope simd(state, (SimdLevel)state.range(2));
+    BlockingScope blocking(state.range(3) != 0);
+    const ModInt q = find_ntt_primes(N, (int)state.range(1), 1)[0];
+    NTT ntt(N, q);
+    std::vector<ModInt> a = random_poly(N, q, 1);
+
+    const uint64_t start = read_tsc();
+    for (auto _ : state) {
+        ntt.forward(a.data());
+        benchmark::DoNotOptimize(a.data());
+        benchmark::ClobberMemory();
+    }
+    set_ntt_counters(state, N, 1, read_tsc() - start);
+}
+
+void BM_NTTInverse(benchmark::State& state) {
+    const int N = 1 << state.range(0);
+    SimdScope simd(state, (SimdLevel)state.range(2));
+    BlockingScope blocking(state.range(3) != 0);
+    const ModInt q = find_ntt_primes(N, (int)state.range(1), 1)[0];
+    NTT ntt(N, q);
+    std::vector<ModInt> a = random_poly(N, q, 2);
+
+    const uint64_t start = read_tsc();
+    for (auto _ : state) {
+        ntt.inverse(a.data());
+        benchmark::DoNotOptimize(a.data());
+        benchmark::ClobberMemory();
+    }
+    set_ntt_counters(state, N, 1, read_tsc() - start);
+}
+
+// Negacyclic product: two forward transforms and one inverse
+void BM_NTTMultiply(benchmark::State& state) {
+    const int N = 1 << state.range(0);
+    SimdScope simd(state, (SimdLevel)state.range(2));
+    BlockingScope blocking(state.range(3) != 0);
+    const ModInt q = find_ntt_primes(N, (int)state.range(1), 1)[0];
+    NTT ntt(N, q);
+    std::vector<ModInt> a = random_poly(N, q, 3), b = random_poly(N, q, 4), out(N);
+
+    const uint64_t start = read_tsc();
+    for (auto _ : state) {
+        ntt.multiply_into(a.data(), b.data(), out.data());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    set_ntt_counters(state, N, 3, read_tsc() - start);
+}
+
+// Args: log N, modulus bits, TensorMode (0 = NTT, 1 = Schoolbook)
+void BM_MultiplyCiphertexts(benchmark::State& state) {
+    const int N = 1 << state.range(0);
+    const ModInt q = find_ntt_primes(N, (int)state.range(1), 1)[0];
+    const TensorMode mode = state.range(2) == 0 ? TensorMode::NTT : TensorMode::Schoolbook;
+    BFVMultiplier mult(N, q, kPlainModulus);
+    mult.set_tensor_mode(mode);
+    state.SetLabel(mode == TensorMode::NTT ? "ntt" : "schoolbook");
+
+    std::vector<ModInt> a0 = random_poly(N, q, 5), a1 = random_poly(N, q, 6);
+    std::vector<ModInt> b0 = random_poly(N, q, 7), b1 = random_poly(N, q, 8);
+    std::vector<ModInt> d0(N), d1(N), d2(N);
+
+    const uint64_t start = read_tsc();
+    for (auto _ : state) {
+        mult.multiply_into(a0.data(), a1.data(), b0.data(), b1.data(), d0.data(), d1.data(), d2.data());
+        benchmark::DoNotOptimize(d2.data());
+        benchmark::ClobberMemory();
+    }
+    const uint64_t cycles = read_tsc() - start;
+
+    // NTT mode: 4 forward + 4 inverse transforms per auxiliary prime
+    const int transforms = 8 * mult.aux_basis_size();
+    if (mode == TensorMode::NTT) {
+        set_ntt_counters(state, N, transforms, cycles);
+    } else {
+        state.SetBytesProcessed(state.iterations() * 7 * (int64_t)N * (int64_t)sizeof(ModInt));
+        state.SetItemsProcessed(state.iterations());
+    }
+    state.counters["aux_primes"] = mult.aux_basis_size();
+}
+
+// Args: log N, modulus bits
+void BM_Relinearize(benchmark::State& state) {
+    const int N = 1 << state.range(0);
+    const ModInt q = find_ntt_primes(N, (int)state.range(1), 1)[0];
+    BFVEncryptor enc(N, q, kPlainModulus);
+    enc.keygen();
+    std::vector<std::vector<ModInt>> key_b, key_a;
+    enc.relin_keygen(kRelinBaseBits, key_b, key_a);
+
+    BFVMultiplier mult(N, q, kPlainModulus);
+    mult.set_relin_key(key_b, key_a, kRelinBaseBits);
+
+    std::vector<ModInt> d0 = random_poly(N, q, 9), d1 = random_poly(N, q, 10), d2 = random_poly(N, q, 11);
+
+    const uint64_t start = read_tsc();
+    for (auto _ : state) {
+        auto ct = mult.relinearize(d0, d1, d2);
+        benchmark::DoNotOptimize(ct.data());
+    }
+    const uint64_t cycles = read_tsc() - start;
+
+    // One forward per digit, two inverses
+    const int digits = (int)key_b.size();
+    set_ntt_counters(state, N, digits + 2, cycles);
+    state.counters["digits"] = digits;
+}
+
+const int kMinLogN = 10;
+const int kMaxLogN = 15;
+const int kModulusBits[] = {30, 50, 60};
+const SimdLevel kLevels[] = {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512IFMA};
+
+void ntt_args(benchmark::internal::Benchmark* b) {
+    for (int log_n = kMinLogN; log_n <= kMaxLogN; log_n++) {
+        for (int bits : kModulusBits) {
+            for (SimdLevel level : kLevels) {
+                // IFMA kernels only cover q < 2^50
+                if (level == SimdLevel::AVX512IFMA && bits > 50) continue;
+                b->Args({log_n, bits, (int)level, 1});
+                // Blocking on vs off where it applies
+                if ((1 << log_n) >= get_ntt_blocking_threshold()) b->Args({log_n, bits, (int)level, 0});
+            }
+        }
+    }
+}
+
+void multiply_args(benchmark::internal::Benchmark* b) {
+    for (int log_n = kMinLogN; log_n <= kMaxLogN; log_n++) {
+        for (int bits : kModulusBits) {
+            b->Args({log_n, bits, 0});
+            // O(N^2): only the small sizes finish in reasonable time
+            if (log_n <= 11) b->Args({log_n, bits, 1});
+        }
+    }
+}
+
+void relin_args(benchmark::internal::Benchmark* b) {
+    for (int log_n = kMinLogN; log_n <= kMaxLogN; log_n++) {
+        for (int bits : kModulusBits) b->Args({log_n, bits});
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_NTTForward)->Apply(ntt_args)->ArgNames({"logN", "qbits", "simd", "blocked"});
+BENCHMARK(BM_NTTInverse)->Apply(ntt_args)->ArgNames({"logN", "qbits", "simd", "blocked"});
+BENCHMARK(BM_NTTMultiply)->Apply(ntt_args)->ArgNames({"logN", "qbits", "simd", "blocked"});
+BENCHMARK(BM_MultiplyCiphertexts)->Apply(multiply_args)->ArgNames({"logN", "qbits", "schoolbook"})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Relinearize)->Apply(relin_args)->ArgNames({"logN", "qbits"})->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char** argv) {
+    // Single-threaded numbers, so the per-butterfly counters stay meaningful
+    set_num_threads(1);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
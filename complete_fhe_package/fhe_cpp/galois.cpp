@@ -0,0 +1,84 @@
+/*
+ * Galois Automorphisms Implementation
+ */
+
+#include "galois.h"
+#include <stdexcept>
+
+namespace fhe_cpp {
+
+static void check_element(int N, uint64_t g) {
+    if ((g & 1) == 0 || g >= 2 * (uint64_t)N) throw std::invalid_argument("Galois element must be odd and below 2N");
+}
+
+static uint32_t bit_reverse(uint32_t x, int log_n) {
+    uint32_t r = 0;
+    for (int i = 0; i < log_n; i++) {
+        r = (r << 1) | (x & 1);
+        x >>= 1;
+    }
+    return r;
+}
+
+uint64_t galois_element(int N, int steps) {
+    if (N < 4 || (N & (N - 1)) != 0) throw std::invalid_argument("N must be a power of two >= 4");
+    const uint64_t m = 2 * (uint64_t)N;
+    const int64_t order = N / 2;
+    int64_t k = steps % order;
+    if (k < 0) k += order;
+
+    uint64_t g = 1;
+    for (int64_t i = 0; i < k; i++) g = g * 3 % m;
+    return g;
+}
+
+void apply_galois_into(const ModInt* a, int N, uint64_t g, ModInt q, ModInt* out) {
+    const uint64_t m = 2 * (uint64_t)N;
+    check_element(N, g);
+
+    uint64_t idx = 0;                   // i g mod 2N, stepped incrementally
+    for (int i = 0; i < N; i++) {
+        const ModInt v = a[i];
+        if (idx < (uint64_t)N) {
+            out[idx] = v;
+        } else {
+            out[idx - N] = (v == 0) ? 0 : q - v;
+        }
+        idx += g;
+        if (idx >= m) idx -= m;
+    }
+}
+
+std::vector<ModInt> apply_galois(const std::vector<ModInt>& a, uint64_t g, ModInt q) {
+    std::vector<ModInt> out(a.size());
+    apply_galois_into(a.data(), (int)a.size(), g, q, out.data());
+    return out;
+}
+
+std::vector<uint32_t> galois_ntt_permutation(int N, uint64_t g) {
+    if (N < 2 || (N & (N - 1)) != 0) throw std::invalid_argument("N must be a power of two");
+    check_element(N, g);
+    int log_n = 0;
+    while ((1 << log_n) < N) log_n++;
+
+    const uint64_t mask = 2 * (uint64_t)N - 1;
+    std::vector<uint32_t> perm(N);
+    for (int k = 0; k < N; k++) {
+        const uint64_t e = 2 * (uint64_t)bit_reverse((uint32_t)k, log_n) + 1;
+        perm[k] = bit_reverse((uint32_t)(((e * g) & mask) >> 1), log_n);
+    }
+    return perm;
+}
+
+void apply_galois_ntt_into(const ModInt* a, const uint32_t* perm, int N, ModInt* out) {
+    for (int k = 0; k < N; k++) out[k] = a[perm[k]];
+}
+
+std::vector<ModInt> apply_galois_ntt(const std::vector<ModInt>& a, uint64_t g) {
+    const std::vector<uint32_t> perm = galois_ntt_permutation((int)a.size(), g);
+    std::vector<ModInt> out(a.size());
+    apply_galois_ntt_into(a.data(), perm.data(), (int)a.size(), out.data());
+    return out;
+}
+
+} // namespace fhe_cpp
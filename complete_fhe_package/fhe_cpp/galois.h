@@ -0,0 +1,37 @@
+/*
+ * Galois Automorphisms
+ * sigma_g: a(X) -> a(X^g) for odd g in Z_2N^*, the ring maps behind slot
+ * rotations. With batching, g = 3^k rotates both slot rows left by k and
+ * g = 2N - 1 swaps the rows (see BatchEncoder). In NTT form the map is a
+ * pure slot permutation, since slot k holds a(psi^(2 bitrev(k) + 1)).
+ */
+
+#ifndef FHE_GALOIS_H
+#define FHE_GALOIS_H
+
+#include "ntt.h"
+#include <vector>
+#include <cstdint>
+
+namespace fhe_cpp {
+
+// 3^steps mod 2N; negative steps use the inverse (3 has order N/2)
+uint64_t galois_element(int N, int steps);
+
+// 2N - 1: X -> X^-1, swaps the two slot rows
+inline uint64_t galois_column_swap(int N) { return 2 * (uint64_t)N - 1; }
+
+// Coefficient form: coefficient i moves to i g mod 2N, negated past N (X^N = -1).
+// a holds N residues mod q; out must not alias a.
+void apply_galois_into(const ModInt* a, int N, uint64_t g, ModInt q, ModInt* out);
+std::vector<ModInt> apply_galois(const std::vector<ModInt>& a, uint64_t g, ModInt q);
+
+// NTT form: out[k] = a[perm[k]] where 2 bitrev(perm[k]) + 1 = g (2 bitrev(k) + 1) mod 2N.
+// Build the permutation once per element and reuse it; out must not alias a.
+std::vector<uint32_t> galois_ntt_permutation(int N, uint64_t g);
+void apply_galois_ntt_into(const ModInt* a, const uint32_t* perm, int N, ModInt* out);
+std::vector<ModInt> apply_galois_ntt(const std::vector<ModInt>& a, uint64_t g);
+
+} // namespace fhe_cpp
+
+#endif // FHE_GALOIS_H
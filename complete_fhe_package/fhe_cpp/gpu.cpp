@@ -0,0 +1,41 @@
+/*
+ * GPU Backend - Device-Independent Parts
+ * Offload switch and the shared device contexts; gpu_cuda.cu or gpu_stub.cpp
+ * supplies the device types.
+ */
+
+#include "gpu.h"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace fhe_cpp {
+
+static std::atomic<bool> offload_enabled{true};
+
+void set_gpu_enabled(bool enabled) { offload_enabled.store(enabled, std::memory_order_relaxed); }
+
+bool gpu_enabled() { return offload_enabled.load(std::memory_order_relaxed) && gpu_available(); }
+
+bool gpu_offload(size_t coefficients) {
+    return coefficients >= kGpuMinCoefficients && gpu_enabled();
+}
+
+std::shared_ptr<const GpuNTT> shared_gpu_ntt(int N, const std::vector<ModInt>& moduli) {
+    static std::mutex mtx;
+    static std::map<std::pair<int, std::vector<ModInt>>, std::shared_ptr<const GpuNTT>> contexts;
+
+    auto key = std::make_pair(N, moduli);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = contexts.find(key);
+        if (it != contexts.end()) return it->second;
+    }
+    // Built outside the lock (table builds and uploads are slow); the first insert wins
+    std::shared_ptr<const GpuNTT> ctx = std::make_shared<GpuNTT>(N, moduli);
+    std::lock_guard<std::mutex> lock(mtx);
+    return contexts.emplace(std::move(key), std::move(ctx)).first->second;
+}
+
+} // namespace fhe_cpp
@@ -0,0 +1,120 @@
+/*
+ * GPU (CUDA) Backend
+ * Batched negacyclic NTTs over many polynomials and RNS limbs in one launch per
+ * stage, on device-resident buffers. Host <-> device copies happen only in
+ * DeviceBuffer::upload / download, so a chain of device operations moves data
+ * once each way. Transforms use the registry's tables and produce exactly the
+ * CPU kernels' output (same bit-reversed NTT order, residues in [0, q)).
+ *
+ * Optional at build time (CMake option FHE_ENABLE_CUDA, defines FHE_CUDA): CPU-only
+ * builds link gpu_stub.cpp, where gpu_available() is false and the device types
+ * throw std::runtime_error. NTT::forward_batch / inverse_batch and
+ * BFVMultiplier::multiply_batch pick the device on their own when it pays off.
+ */
+
+#ifndef FHE_GPU_H
+#define FHE_GPU_H
+
+#include "ntt.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace fhe_cpp {
+
+// A CUDA device is usable (always false in CPU-only builds)
+bool gpu_available();
+std::string gpu_device_name();
+
+// Runtime switch for the automatic offload in the batch APIs (on by default when
+// available); explicit device types keep working either way
+void set_gpu_enabled(bool enabled);
+bool gpu_enabled();
+
+// Smallest batch (rows x N coefficients) the batch APIs send to the device: below
+// it the launches and PCIe copies cost more than the CPU kernels
+const size_t kGpuMinCoefficients = (size_t)1 << 18;
+
+// True when a batch of `coefficients` values should go to the device: CUDA build,
+// device present, offload enabled and the batch at least kGpuMinCoefficients
+bool gpu_offload(size_t coefficients);
+
+class GpuNTT;
+
+// Process-wide device contexts by (N, moduli), built on first use so the twiddle
+// tables are uploaded once per ring rather than per call
+std::shared_ptr<const GpuNTT> shared_gpu_ntt(int N, const std::vector<ModInt>& moduli);
+
+// Batch of rows x N device-resident residues (64-bit words)
+class DeviceBuffer {
+private:
+    uint64_t* ptr;
+    size_t num_rows;
+    int N;
+
+public:
+    DeviceBuffer(size_t rows, int N);
+    ~DeviceBuffer();
+
+    DeviceBuffer(DeviceBuffer&& other) noexcept;
+    DeviceBuffer& operator=(DeviceBuffer&& other) noexcept;
+    DeviceBuffer(const DeviceBuffer&) = delete;
+    DeviceBuffer& operator=(const DeviceBuffer&) = delete;
+
+    // Rows [row, row + rows) from / to host memory (rows x N values)
+    void upload(const ModInt* host, size_t rows, size_t row = 0);
+    void download(ModInt* host, size_t rows, size_t row = 0) const;
+    void upload(const ModInt* host) { upload(host, num_rows); }
+    void download(ModInt* host) const { download(host, num_rows); }
+
+    size_t rows() const { return num_rows; }
+    int get_N() const { return N; }
+    uint64_t* data() { return ptr; }
+    const uint64_t* data() const { return ptr; }
+};
+
+// Negacyclic NTT of degree N over k moduli: row r of a buffer is reduced mod
+// moduli[r % k], so (count, k, N) RNS polynomials and plain (count, N) batches
+// (k = 1) run in one launch per stage. Every modulus must be below 2^62.
+class GpuNTT {
+private:
+    struct DeviceTables;                // Twiddles, Shoup companions and constants per modulus
+    std::unique_ptr<DeviceTables> dev;
+    int N;
+    std::vector<ModInt> moduli;
+
+public:
+    GpuNTT(int N, const std::vector<ModInt>& moduli);
+    ~GpuNTT();
+
+    GpuNTT(const GpuNTT&) = delete;
+    GpuNTT& operator=(const GpuNTT&) = delete;
+
+    int get_N() const { return N; }
+    const std::vector<ModInt>& get_moduli() const { return moduli; }
+
+    // In place over every row; inputs in [0, q), outputs in [0, q)
+    void forward(DeviceBuffer& a) const;
+    void inverse(DeviceBuffer& a) const;
+
+    // out = a * b row by row (out may alias a or b)
+    void pointwise_multiply(const DeviceBuffer& a, const DeviceBuffer& b, DeviceBuffer& out) const;
+
+    // Lift into the RNS basis: row (i k + l) of out = row i of a mod moduli[l], for
+    // a holding residues below 2^63 (e.g. mod a larger q)
+    void lift(const DeviceBuffer& a, DeviceBuffer& out) const;
+
+    // BFV tensor residues for count ciphertext pairs: in holds (count, 4, k, N) lifted
+    // NTT-form rows (a0, a1, b0, b1 per pair); out gets (count, 4, k, N) products
+    // a0 b0, a0 b1, a1 b0, a1 b1
+    void tensor_products(const DeviceBuffer& in, DeviceBuffer& out) const;
+
+    // Blocks until every queued launch has finished; rethrows device errors
+    void synchronize() const;
+};
+
+} // namespace fhe_cpp
+
+#endif // FHE_GPU_H
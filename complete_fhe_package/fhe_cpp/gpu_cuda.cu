@@ -0,0 +1,471 @@
+/*
+ * GPU (CUDA) Backend Implementation
+ * One thread per butterfly. Stages wider than a 2048-value chunk run as one
+ * global-memory launch each; the narrow ones run back to back in shared memory,
+ * one thread block per chunk, mirroring the CPU's cache-blocked order.
+ */
+
+#include "gpu.h"
+#include "context.h"
+#include <cuda_runtime.h>
+#include <stdexcept>
+#include <string>
+
+namespace fhe_cpp {
+
+#define FHE_CUDA_CHECK(call)                                                                \
+    do {                                                                                    \
+        cudaError_t err_ = (call);                                                          \
+        if (err_ != cudaSuccess) {                                                          \
+            throw std::runtime_error(std::string("CUDA error: ") + cudaGetErrorString(err_)); \
+        }                                                                                   \
+    } while (0)
+
+static const int kChunk = 2048;             // Values per shared-memory block (16 KB)
+static const int kThreads = 256;            // Block size of the global-memory kernels
+
+// Per-modulus constants
+struct DeviceModulus {
+    uint64_t q;
+    uint64_t n_inv, n_inv_shoup;            // Last inverse stage: N^-1 ...
+    uint64_t w_last, w_last_shoup;          // ... and N^-1 * psi_inv_rev[1]
+    uint64_t ratio_lo, ratio_hi;            // floor(2^128 / q)
+};
+
+struct GpuNTT::DeviceTables {
+    // k * N twiddles each: modulus l at offset l * N
+    uint64_t* psi_rev = nullptr;
+    uint64_t* psi_rev_shoup = nullptr;
+    uint64_t* psi_inv_rev = nullptr;
+    uint64_t* psi_inv_rev_shoup = nullptr;
+    DeviceModulus* mods = nullptr;
+
+    ~DeviceTables() {
+        cudaFree(psi_rev);
+        cudaFree(psi_rev_shoup);
+        cudaFree(psi_inv_rev);
+        cudaFree(psi_inv_rev_shoup);
+        cudaFree(mods);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Device arithmetic (same formulas as wide_arith.h)
+// ---------------------------------------------------------------------------
+
+// w * y mod q in [0, 2q)
+__device__ __forceinline__ uint64_t mul_shoup_lazy_dev(uint64_t w, uint64_t w_shoup, uint64_t y, uint64_t q) {
+    return w * y - __umul64hi(w_shoup, y) * q;
+}
+
+// (hi : lo) mod q for hi < q: Barrett with one conditional subtraction
+__device__ __forceinline__ uint64_t barrett_reduce_dev(uint64_t hi, uint64_t lo, const DeviceModulus& m) {
+    uint64_t ll_hi = __umul64hi(lo, m.ratio_lo);
+    uint64_t lh_lo = lo * m.ratio_hi, lh_hi = __umul64hi(lo, m.ratio_hi);
+    uint64_t hl_lo = hi * m.ratio_lo, hl_hi = __umul64hi(hi, m.ratio_lo);
+
+    uint64_t col = ll_hi + lh_lo;
+    uint64_t carry = col < lh_lo;
+    col += hl_lo;
+    carry += col < hl_lo;
+
+    uint64_t quot = hi * m.ratio_hi + lh_hi + hl_hi + carry;
+    uint64_t r = lo - quot * m.q;
+    return (r >= m.q) ? r - m.q : r;
+}
+
+__device__ __forceinline__ uint64_t mul_mod_dev(uint64_t a, uint64_t b, const DeviceModulus& m) {
+    return barrett_reduce_dev(__umul64hi(a, b), a * b, m);
+}
+
+// Lazy butterflies: CT keeps [0, 4q), GS keeps [0, 2q)
+__device__ __forceinline__ void ct_butterfly_dev(uint64_t& x, uint64_t& y, uint64_t w, uint64_t ws, uint64_t q) {
+    const uint64_t two_q = 2 * q;
+    uint64_t t = mul_shoup_lazy_dev(w, ws, y, q);
+    uint64_t u = x;
+    if (u >= two_q) u -= two_q;
+    x = u + t;
+    y = u + two_q - t;
+}
+
+__device__ __forceinline__ void gs_butterfly_dev(uint64_t& x, uint64_t& y, uint64_t w, uint64_t ws, uint64_t q) {
+    const uint64_t two_q = 2 * q;
+    uint64_t u = x, v = y;
+    uint64_t sum = u + v;
+    x = (sum >= two_q) ? sum - two_q : sum;
+    y = mul_shoup_lazy_dev(w, ws, u + two_q - v, q);
+}
+
+__device__ __forceinline__ uint64_t reduce_4q(uint64_t x, uint64_t q) {
+    if (x >= 2 * q) x -= 2 * q;
+    return (x >= q) ? x - q : x;
+}
+
+// ---------------------------------------------------------------------------
+// Transform kernels. Row r of a buffer uses modulus r % k.
+// ---------------------------------------------------------------------------
+
+// One forward stage of half-size t (m = N / 2t blocks) over every row
+__global__ void forward_stage_kernel(uint64_t* data, size_t butterflies, int log_n, int k, int m, int t,
+                                     const uint64_t* psi_rev, const uint64_t* psi_rev_shoup,
+                                     const DeviceModulus* mods) {
+    size_t g = (size_t)blockIdx.x * blockDim.x + threadIdx.x;
+    if (g >= butterflies) return;
+    const int N = 1 << log_n;
+    const size_t row = g >> (log_n - 1);
+    const int j = (int)(g & ((N >> 1) - 1));
+    const int l = (int)(row % k);
+    const int i = j / t;
+    uint64_t* x = data + row * N + 2 * i * t + (j - i * t);
+    const size_t w = (size_t)l * N + m + i;
+    ct_butterfly_dev(x[0], x[t], psi_rev[w], psi_rev_shoup[w], mods[l].q);
+}
+
+// Forward stages t = chunk / 2 .. 1 of one chunk per thread block, plus the final
+// reduction to [0, q); blockDim.x = chunk / 2
+__global__ void forward_tail_kernel(uint64_t* data, int log_n, int log_chunk, int k,
+                                    const uint64_t* psi_rev, const uint64_t* psi_rev_shoup,
+                                    const DeviceModulus* mods) {
+    extern __shared__ uint64_t sh[];
+    const int N = 1 << log_n, chunk = 1 << log_chunk;
+    const int per_row = N >> log_chunk;
+    const size_t row = blockIdx.x / per_row;
+    const int c = blockIdx.x % per_row;
+    const int l = (int)(row % k);
+    const uint64_t q = mods[l].q;
+    const uint64_t* w_rev = psi_rev + (size_t)l * N;
+    const uint64_t* ws_rev = psi_rev_shoup + (size_t)l * N;
+    uint64_t* x = data + row * N + (size_t)c * chunk;
+
+    const int j = threadIdx.x;
+    sh[j] = x[j];
+    sh[j + (chunk >> 1)] = x[j + (chunk >> 1)];
+    __syncthreads();
+
+    for (int t = chunk >> 1, m = N / chunk; t >= 1; t >>= 1, m <<= 1) {
+        const int i = j / t;
+        const int idx = 2 * i * t + (j - i * t);
+        const int w = m + c * (chunk / (2 * t)) + i;
+        ct_butterfly_dev(sh[idx], sh[idx + t], w_rev[w], ws_rev[w], q);
+        __syncthreads();
+    }
+
+    x[j] = reduce_4q(sh[j], q);
+    x[j + (chunk >> 1)] = reduce_4q(sh[j + (chunk >> 1)], q);
+}
+
+// Inverse stages t = 1 .. t_end of one chunk per thread block; blockDim.x = chunk / 2
+__global__ void inverse_head_kernel(uint64_t* data, int log_n, int log_chunk, int t_end, int k,
+                                    const uint64_t* psi_inv_rev, const uint64_t* psi_inv_rev_shoup,
+                                    const DeviceModulus* mods) {
+    extern __shared__ uint64_t sh[];
+    const int N = 1 << log_n, chunk = 1 << log_chunk;
+    const int per_row = N >> log_chunk;
+    const size_t row = blockIdx.x / per_row;
+    const int c = blockIdx.x % per_row;
+    const int l = (int)(row % k);
+    const uint64_t q = mods[l].q;
+    const uint64_t* w_rev = psi_inv_rev + (size_t)l * N;
+    const uint64_t* ws_rev = psi_inv_rev_shoup + (size_t)l * N;
+    uint64_t* x = data + row * N + (size_t)c * chunk;
+
+    const int j = threadIdx.x;
+    sh[j] = x[j];
+    sh[j + (chunk >> 1)] = x[j + (chunk >> 1)];
+    __syncthreads();
+
+    for (int t = 1, h = N >> 1; t <= t_end; t <<= 1, h >>= 1) {
+        const int i = j / t;
+        const int idx = 2 * i * t + (j - i * t);
+        const int w = h + c * (chunk / (2 * t)) + i;
+        gs_butterfly_dev(sh[idx], sh[idx + t], w_rev[w], ws_rev[w], q);
+        __syncthreads();
+    }
+
+    x[j] = sh[j];
+    x[j + (chunk >> 1)] = sh[j + (chunk >> 1)];
+}
+
+// One inverse stage of half-size t (h = N / 2t blocks) over every row
+__global__ void inverse_stage_kernel(uint64_t* data, size_t butterflies, int log_n, int k, int h, int t,
+                                     const uint64_t* psi_inv_rev, const uint64_t* psi_inv_rev_shoup,
+                                     const DeviceModulus* mods) {
+    size_t g = (size_t)blockIdx.x * blockDim.x + threadIdx.x;
+    if (g >= butterflies) return;
+    const int N = 1 << log_n;
+    const size_t row = g >> (log_n - 1);
+    const int j = (int)(g & ((N >> 1) - 1));
+    const int l = (int)(row % k);
+    const int i = j / t;
+    uint64_t* x = data + row * N + 2 * i * t + (j - i * t);
+    const size_t w = (size_t)l * N + h + i;
+    gs_butterfly_dev(x[0], x[t], psi_inv_rev[w], psi_inv_rev_shoup[w], mods[l].q);
+}
+
+// Last inverse stage (t = N/2) with the N^-1 scaling, outputs in [0, q)
+__global__ void inverse_last_kernel(uint64_t* data, size_t butterflies, int log_n, int k,
+                                    const DeviceModulus* mods) {
+    size_t g = (size_t)blockIdx.x * blockDim.x + threadIdx.x;
+    if (g >= butterflies) return;
+    const int N = 1 << log_n;
+    const size_t row = g >> (log_n - 1);
+    const int j = (int)(g & ((N >> 1) - 1));
+    const DeviceModulus& m = mods[row % k];
+    uint64_t* x = data + row * N;
+
+    uint64_t u = x[j], v = x[j + (N >> 1)];
+    uint64_t a = mul_shoup_lazy_dev(m.n_inv, m.n_inv_shoup, u + v, m.q);
+    uint64_t b = mul_shoup_lazy_dev(m.w_last, m.w_last_shoup, u + 2 * m.q - v, m.q);
+    x[j] = (a >= m.q) ? a - m.q : a;
+    x[j + (N >> 1)] = (b >= m.q) ? b - m.q : b;
+}
+
+// ---------------------------------------------------------------------------
+// Element-wise kernels
+// ---------------------------------------------------------------------------
+
+__global__ void pointwise_kernel(const uint64_t* a, const uint64_t* b, uint64_t* out, size_t n,
+                                 int log_n, int k, const DeviceModulus* mods) {
+    size_t g = (size_t)blockIdx.x * blockDim.x + threadIdx.x;
+    if (g >= n) return;
+    out[g] = mul_mod_dev(a[g], b[g], mods[(g >> log_n) % k]);
+}
+
+// out row (i k + l) = a row i mod modulus l
+__global__ void lift_kernel(const uint64_t* a, uint64_t* out, size_t n, int log_n, int k,
+                            const DeviceModulus* mods) {
+    size_t g = (size_t)blockIdx.x * blockDim.x + threadIdx.x;
+    if (g >= n) return;
+    const size_t N = (size_t)1 << log_n;
+    const size_t row = g >> log_n, j = g & (N - 1);
+    const uint64_t v = a[g];
+    for (int l = 0; l < k; l++) {
+        out[(row * k + l) * N + j] = barrett_reduce_dev(0, v, mods[l]);
+    }
+}
+
+// Per pair p, limb l, slot j: the four rows (a0, a1, b0, b1) in, the tensor
+// products (a0 b0, a0 b1, a1 b0, a1 b1) out; each thread reads before it writes
+__global__ void tensor_kernel(const uint64_t* in, uint64_t* out, size_t n, int log_n, int k,
+                              const DeviceModulus* mods) {
+    size_t g = (size_t)blockIdx.x * blockDim.x + threadIdx.x;
+    if (g >= n) return;
+    const size_t N = (size_t)1 << log_n;
+    const size_t limb_rows = (size_t)k * N;
+    const size_t p = g / limb_rows, rem = g - p * limb_rows;
+    const DeviceModulus& m = mods[rem >> log_n];
+
+    const size_t base = p * 4 * limb_rows + rem;
+    const uint64_t a0 = in[base], a1 = in[base + limb_rows];
+    const uint64_t b0 = in[base + 2 * limb_rows], b1 = in[base + 3 * limb_rows];
+    out[base] = mul_mod_dev(a0, b0, m);
+    out[base + limb_rows] = mul_mod_dev(a0, b1, m);
+    out[base + 2 * limb_rows] = mul_mod_dev(a1, b0, m);
+    out[base + 3 * limb_rows] = mul_mod_dev(a1, b1, m);
+}
+
+static unsigned grid_for(size_t n) {
+    return (unsigned)((n + kThreads - 1) / kThreads);
+}
+
+// ---------------------------------------------------------------------------
+// Device queries
+// ---------------------------------------------------------------------------
+
+bool gpu_available() {
+    static const bool available = [] {
+        int count = 0;
+        return cudaGetDeviceCount(&count) == cudaSuccess && count > 0;
+    }();
+    return available;
+}
+
+std::string gpu_device_name() {
+    if (!gpu_available()) return "";
+    int dev = 0;
+    cudaDeviceProp prop;
+    FHE_CUDA_CHECK(cudaGetDevice(&dev));
+    FHE_CUDA_CHECK(cudaGetDeviceProperties(&prop, dev));
+    return prop.name;
+}
+
+// ---------------------------------------------------------------------------
+// DeviceBuffer
+// ---------------------------------------------------------------------------
+
+DeviceBuffer::DeviceBuffer(size_t rows, int N) : ptr(nullptr), num_rows(rows), N(N) {
+    if (N <= 0) throw std::invalid_argument("N must be positive");
+    if (rows > 0) FHE_CUDA_CHECK(cudaMalloc(&ptr, rows * (size_t)N * sizeof(uint64_t)));
+}
+
+DeviceBuffer::~DeviceBuffer() {
+    cudaFree(ptr);
+}
+
+DeviceBuffer::DeviceBuffer(DeviceBuffer&& other) noexcept
+    : ptr(other.ptr), num_rows(other.num_rows), N(other.N) {
+    other.ptr = nullptr;
+    other.num_rows = 0;
+}
+
+DeviceBuffer& DeviceBuffer::operator=(DeviceBuffer&& other) noexcept {
+    if (this != &other) {
+        cudaFree(ptr);
+        ptr = other.ptr;
+        num_rows = other.num_rows;
+        N = other.N;
+        other.ptr = nullptr;
+        other.num_rows = 0;
+    }
+    return *this;
+}
+
+void DeviceBuffer::upload(const ModInt* host, size_t rows, size_t row) {
+    if (row + rows > num_rows) throw std::invalid_argument("Upload past the end of the device buffer");
+    FHE_CUDA_CHECK(cudaMemcpy(ptr + row * (size_t)N, host, rows * (size_t)N * sizeof(uint64_t),
+                              cudaMemcpyHostToDevice));
+}
+
+void DeviceBuffer::download(ModInt* host, size_t rows, size_t row) const {
+    if (row + rows > num_rows) throw std::invalid_argument("Download past the end of the device buffer");
+    FHE_CUDA_CHECK(cudaMemcpy(host, ptr + row * (size_t)N, rows * (size_t)N * sizeof(uint64_t),
+                              cudaMemcpyDeviceToHost));
+}
+
+// ---------------------------------------------------------------------------
+// GpuNTT
+// ---------------------------------------------------------------------------
+
+static int log2_exact(int N) {
+    int log_n = 0;
+    while ((1 << log_n) < N) log_n++;
+    return log_n;
+}
+
+template <typename T>
+static T* upload_array(const T* host, size_t n) {
+    T* dev = nullptr;
+    FHE_CUDA_CHECK(cudaMalloc(&dev, n * sizeof(T)));
+    FHE_CUDA_CHECK(cudaMemcpy(dev, host, n * sizeof(T), cudaMemcpyHostToDevice));
+    return dev;
+}
+
+GpuNTT::GpuNTT(int N, const std::vector<ModInt>& moduli) : dev(new DeviceTables), N(N), moduli(moduli) {
+    if (N < 4 || (N & (N - 1)) != 0) throw std::invalid_argument("N must be a power of two >= 4");
+    if (moduli.empty()) throw std::invalid_argument("Need at least one modulus");
+    if (!gpu_available()) throw std::runtime_error("No CUDA device available");
+
+    const size_t k = moduli.size(), n = (size_t)N;
+    std::vector<uint64_t> w(k * n), ws(k * n), wi(k * n), wis(k * n);
+    std::vector<DeviceModulus> mods(k);
+    for (size_t l = 0; l < k; l++) {
+        if (moduli[l] < 2 || ((uint64_t)moduli[l] >> 62) != 0) {
+            throw std::invalid_argument("GPU moduli must be in [2, 2^62)");
+        }
+        std::shared_ptr<const NTTTables> tab = get_ntt_tables(N, moduli[l]);
+        std::copy(tab->psi_rev.begin(), tab->psi_rev.end(), w.begin() + l * n);
+        std::copy(tab->psi_rev_shoup.begin(), tab->psi_rev_shoup.end(), ws.begin() + l * n);
+        std::copy(tab->psi_inv_rev.begin(), tab->psi_inv_rev.end(), wi.begin() + l * n);
+        std::copy(tab->psi_inv_rev_shoup.begin(), tab->psi_inv_rev_shoup.end(), wis.begin() + l * n);
+
+        uint128_w ratio = Modulus((uint64_t)moduli[l]).barrett_ratio();
+        mods[l] = {(uint64_t)moduli[l], tab->inv_last_n, tab->inv_last_n_shoup,
+                   tab->inv_last_w, tab->inv_last_w_shoup, ratio.low, ratio.high};
+    }
+
+    dev->psi_rev = upload_array(w.data(), w.size());
+    dev->psi_rev_shoup = upload_array(ws.data(), ws.size());
+    dev->psi_inv_rev = upload_array(wi.data(), wi.size());
+    dev->psi_inv_rev_shoup = upload_array(wis.data(), wis.size());
+    dev->mods = upload_array(mods.data(), mods.size());
+}
+
+GpuNTT::~GpuNTT() = default;
+
+static void check_shape(const DeviceBuffer& a, int N) {
+    if (a.get_N() != N) throw std::invalid_argument("Device buffer has the wrong degree");
+}
+
+void GpuNTT::forward(DeviceBuffer& a) const {
+    check_shape(a, N);
+    if (a.rows() == 0) return;
+    const int log_n = log2_exact(N), k = (int)moduli.size();
+    const int chunk = N < kChunk ? N : kChunk;
+    const int log_chunk = log2_exact(chunk);
+    const size_t butterflies = a.rows() * (size_t)(N / 2);
+
+    int m = 1;
+    for (int t = N >> 1; t >= chunk; t >>= 1, m <<= 1) {
+        forward_stage_kernel<<<grid_for(butterflies), kThreads>>>(
+            a.data(), butterflies, log_n, k, m, t, dev->psi_rev, dev->psi_rev_shoup, dev->mods);
+    }
+    const size_t blocks = a.rows() * (size_t)(N / chunk);
+    forward_tail_kernel<<<(unsigned)blocks, chunk / 2, chunk * sizeof(uint64_t)>>>(
+        a.data(), log_n, log_chunk, k, dev->psi_rev, dev->psi_rev_shoup, dev->mods);
+    FHE_CUDA_CHECK(cudaGetLastError());
+}
+
+void GpuNTT::inverse(DeviceBuffer& a) const {
+    check_shape(a, N);
+    if (a.rows() == 0) return;
+    const int log_n = log2_exact(N), k = (int)moduli.size();
+    const int chunk = N < kChunk ? N : kChunk;
+    const int log_chunk = log2_exact(chunk);
+    const size_t butterflies = a.rows() * (size_t)(N / 2);
+
+    // Every stage but the last fits in a chunk up to t = chunk / 2
+    const int t_end = (chunk / 2 < N / 4) ? chunk / 2 : N / 4;
+    const size_t blocks = a.rows() * (size_t)(N / chunk);
+    inverse_head_kernel<<<(unsigned)blocks, chunk / 2, chunk * sizeof(uint64_t)>>>(
+        a.data(), log_n, log_chunk, t_end, k, dev->psi_inv_rev, dev->psi_inv_rev_shoup, dev->mods);
+
+    for (int t = 2 * t_end, h = N / (4 * t_end); t < N / 2; t <<= 1, h >>= 1) {
+        inverse_stage_kernel<<<grid_for(butterflies), kThreads>>>(
+            a.data(), butterflies, log_n, k, h, t, dev->psi_inv_rev, dev->psi_inv_rev_shoup, dev->mods);
+    }
+    inverse_last_kernel<<<grid_for(butterflies), kThreads>>>(a.data(), butterflies, log_n, k, dev->mods);
+    FHE_CUDA_CHECK(cudaGetLastError());
+}
+
+void GpuNTT::pointwise_multiply(const DeviceBuffer& a, const DeviceBuffer& b, DeviceBuffer& out) const {
+    check_shape(a, N);
+    if (b.get_N() != N || out.get_N() != N || b.rows() != a.rows() || out.rows() != a.rows()) {
+        throw std::invalid_argument("Device buffers have mismatched shapes");
+    }
+    const size_t n = a.rows() * (size_t)N;
+    if (n == 0) return;
+    pointwise_kernel<<<grid_for(n), kThreads>>>(a.data(), b.data(), out.data(), n, log2_exact(N),
+                                                (int)moduli.size(), dev->mods);
+    FHE_CUDA_CHECK(cudaGetLastError());
+}
+
+void GpuNTT::lift(const DeviceBuffer& a, DeviceBuffer& out) const {
+    check_shape(a, N);
+    const size_t k = moduli.size();
+    if (out.get_N() != N || out.rows() != a.rows() * k) {
+        throw std::invalid_argument("Lift output needs rows x k rows");
+    }
+    if (a.data() == out.data() && k > 1) throw std::invalid_argument("Lift output must not alias its input");
+    const size_t n = a.rows() * (size_t)N;
+    if (n == 0) return;
+    lift_kernel<<<grid_for(n), kThreads>>>(a.data(), out.data(), n, log2_exact(N), (int)k, dev->mods);
+    FHE_CUDA_CHECK(cudaGetLastError());
+}
+
+void GpuNTT::tensor_products(const DeviceBuffer& in, DeviceBuffer& out) const {
+    check_shape(in, N);
+    const size_t k = moduli.size();
+    if (in.rows() % (4 * k) != 0 || out.get_N() != N || out.rows() != in.rows()) {
+        throw std::invalid_argument("Tensor buffers must hold (count, 4, k, N) rows");
+    }
+    const size_t n = in.rows() / 4 * (size_t)N;
+    if (n == 0) return;
+    tensor_kernel<<<grid_for(n), kThreads>>>(in.data(), out.data(), n, log2_exact(N), (int)k, dev->mods);
+    FHE_CUDA_CHECK(cudaGetLastError());
+}
+
+void GpuNTT::synchronize() const {
+    FHE_CUDA_CHECK(cudaDeviceSynchronize());
+}
+
+} // namespace fhe_cpp
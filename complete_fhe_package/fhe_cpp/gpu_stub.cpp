@@ -0,0 +1,51 @@
+/*
+ * GPU Backend - CPU-Only Build
+ * Linked when FHE_ENABLE_CUDA is off: no device is ever available, so the batch
+ * APIs stay on the CPU and explicit device use fails loudly.
+ */
+
+#include "gpu.h"
+#include <stdexcept>
+
+namespace fhe_cpp {
+
+static void no_cuda() {
+    throw std::runtime_error("Built without CUDA support (configure with -DFHE_ENABLE_CUDA=ON)");
+}
+
+bool gpu_available() { return false; }
+
+std::string gpu_device_name() { return ""; }
+
+DeviceBuffer::DeviceBuffer(size_t rows, int N) : ptr(nullptr), num_rows(rows), N(N) { no_cuda(); }
+DeviceBuffer::~DeviceBuffer() = default;
+
+DeviceBuffer::DeviceBuffer(DeviceBuffer&& other) noexcept
+    : ptr(other.ptr), num_rows(other.num_rows), N(other.N) {
+    other.ptr = nullptr;
+}
+
+DeviceBuffer& DeviceBuffer::operator=(DeviceBuffer&& other) noexcept {
+    ptr = other.ptr;
+    num_rows = other.num_rows;
+    N = other.N;
+    other.ptr = nullptr;
+    return *this;
+}
+
+void DeviceBuffer::upload(const ModInt*, size_t, size_t) { no_cuda(); }
+void DeviceBuffer::download(ModInt*, size_t, size_t) const { no_cuda(); }
+
+struct GpuNTT::DeviceTables {};
+
+GpuNTT::GpuNTT(int N, const std::vector<ModInt>& moduli) : N(N), moduli(moduli) { no_cuda(); }
+GpuNTT::~GpuNTT() = default;
+
+void GpuNTT::forward(DeviceBuffer&) const { no_cuda(); }
+void GpuNTT::inverse(DeviceBuffer&) const { no_cuda(); }
+void GpuNTT::pointwise_multiply(const DeviceBuffer&, const DeviceBuffer&, DeviceBuffer&) const { no_cuda(); }
+void GpuNTT::lift(const DeviceBuffer&, DeviceBuffer&) const { no_cuda(); }
+void GpuNTT::tensor_products(const DeviceBuffer&, DeviceBuffer&) const { no_cuda(); }
+void GpuNTT::synchronize() const { no_cuda(); }
+
+} // namespace fhe_cpp
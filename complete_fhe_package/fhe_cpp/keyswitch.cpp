@@ -0,0 +1,225 @@
+/*
+ * Key Switching Implementation
+ */
+
+#include "keyswitch.h"
+#include "arena.h"
+#include "stats.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace fhe_cpp {
+
+// Products of values < q that fit an un-reduced 128-bit sum:
+// 16 when q < 2^62, 4 for any q < 2^63
+static int lazy_terms(uint64_t q) {
+    return (q >> 62) == 0 ? 16 : 4;
+}
+
+// RNS primes are < 2^61, so 64 products fit an un-reduced 128-bit sum
+static const int kRNSLazyTerms = 64;
+
+GadgetDecomposer::GadgetDecomposer(int base_bits, int num_digits)
+    : base_bits(base_bits), num_digits(num_digits) {
+    if (base_bits < 1 || base_bits > 62) throw std::invalid_argument("base_bits must be in [1, 62]");
+    if (num_digits < 1) throw std::invalid_argument("num_digits must be positive");
+}
+
+std::vector<std::vector<ModInt>> GadgetDecomposer::decompose(const std::vector<ModInt>& a) const {
+    const uint64_t mask = (1ULL << base_bits) - 1;
+    std::vector<std::vector<ModInt>> digits(num_digits, std::vector<ModInt>(a.size()));
+
+    for (size_t j = 0; j < a.size(); j++) {
+        uint64_t x = (uint64_t)a[j];
+        for (int i = 0; i < num_digits - 1; i++) {
+            digits[i][j] = (ModInt)(x & mask);
+            x >>= base_bits;
+        }
+        digits[num_digits - 1][j] = (ModInt)x;
+    }
+    return digits;
+}
+
+KeySwitchKey make_switch_key(const NTT& ntt,
+                             const std::vector<std::vector<ModInt>>& key_b,
+                             const std::vector<std::vector<ModInt>>& key_a,
+                             int base_bits) {
+    if (key_b.empty() || key_b.size() != key_a.size()) {
+        throw std::invalid_argument("Switching key needs matching, non-empty b and a components");
+    }
+
+    KeySwitchKey key;
+    key.base_bits = base_bits;
+    key.b_ntt = key_b;
+    key.a_ntt = key_a;
+    for (size_t i = 0; i < key_b.size(); i++) {
+        if ((int)key_b[i].size() != ntt.get_N() || (int)key_a[i].size() != ntt.get_N()) {
+            throw std::invalid_argument("Switching key component has wrong length");
+        }
+        ntt.forward(key.b_ntt[i]);
+        ntt.forward(key.a_ntt[i]);
+    }
+    return key;
+}
+
+HoistedDigits hoist_digits(const NTT& ntt, const std::vector<ModInt>& c, int base_bits, int num_digits) {
+    if ((int)c.size() != ntt.get_N()) throw std::invalid_argument("Polynomial has wrong length");
+
+    HoistedDigits hoisted;
+    hoisted.base_bits = base_bits;
+    hoisted.digits_ntt = GadgetDecomposer(base_bits, num_digits).decompose(c);
+    for (auto& d : hoisted.digits_ntt) ntt.forward(d);
+    return hoisted;
+}
+
+void key_switch_hoisted(const NTT& ntt,
+                        const HoistedDigits& digits,
+                        const uint32_t* perm,
+                        const KeySwitchKey& key,
+                        std::vector<ModInt>& out0,
+                        std::vector<ModInt>& out1,
+                        bool ntt_out) {
+    FHE_STAT_SCOPE(Stat::KeySwitch);
+    if (key.empty()) throw std::runtime_error("Switching key not set");
+    if (key.base_bits != digits.base_bits || key.num_digits() != digits.num_digits()) {
+        throw std::invalid_argument("Hoisted digits do not match the switching key's gadget");
+    }
+
+    const int N = ntt.get_N();
+    const Modulus q((uint64_t)ntt.get_q());
+
+    ScratchScope scratch;
+    uint128_w* acc0 = scratch.alloc<uint128_w>((size_t)N);
+    uint128_w* acc1 = scratch.alloc<uint128_w>((size_t)N);
+    std::fill(acc0, acc0 + N, uint128_w{0, 0});
+    std::fill(acc1, acc1 + N, uint128_w{0, 0});
+
+    auto fold = [&](uint128_w* acc) {
+        for (int j = 0; j < N; j++) {
+            acc[j] = {q.reduce(q.reduce(acc[j].high), acc[j].low), 0};
+        }
+    };
+
+    // One gather pass per digit keeps the inner loop contiguous
+    ModInt* permuted = perm ? scratch.alloc<ModInt>((size_t)N) : nullptr;
+
+    const int terms = lazy_terms(q.value());
+    for (int i = 0; i < key.num_digits(); i++) {
+        if (i > 0 && i % terms == 0) { fold(acc0); fold(acc1); }
+
+        const ModInt* d = digits.digits_ntt[i].data();
+        if (perm) {
+            for (int j = 0; j < N; j++) permuted[j] = d[perm[j]];
+            d = permuted;
+        }
+        const std::vector<ModInt>& kb = key.b_ntt[i];
+        const std::vector<ModInt>& ka = key.a_ntt[i];
+        for (int j = 0; j < N; j++) {
+            acc0[j] = add128(acc0[j], mul64x64((uint64_t)d[j], (uint64_t)kb[j]));
+            acc1[j] = add128(acc1[j], mul64x64((uint64_t)d[j], (uint64_t)ka[j]));
+        }
+    }
+
+    out0.resize(N);
+    out1.resize(N);
+    for (int j = 0; j < N; j++) {
+        out0[j] = (ModInt)q.reduce(q.reduce(acc0[j].high), acc0[j].low);
+        out1[j] = (ModInt)q.reduce(q.reduce(acc1[j].high), acc1[j].low);
+    }
+    if (!ntt_out) {
+        ntt.inverse(out0);
+        ntt.inverse(out1);
+    }
+}
+
+void key_switch(const NTT& ntt,
+                const std::vector<ModInt>& c,
+                const KeySwitchKey& key,
+                std::vector<ModInt>& out0,
+                std::vector<ModInt>& out1) {
+    if (key.empty()) throw std::runtime_error("Switching key not set");
+    key_switch_hoisted(ntt, hoist_digits(ntt, c, key.base_bits, key.num_digits()), nullptr, key, out0, out1);
+}
+
+RNSKeySwitchKey make_rns_switch_key(const RNSContext& ctx,
+                                    const std::vector<RNSPoly>& key_b,
+                                    const std::vector<RNSPoly>& key_a) {
+    if ((int)key_b.size() != ctx.size() || key_a.size() != key_b.size()) {
+        throw std::invalid_argument("RNS switching key needs one (b, a) digit per prime");
+    }
+
+    RNSKeySwitchKey key;
+    key.b_ntt = key_b;
+    key.a_ntt = key_a;
+    for (int i = 0; i < ctx.size(); i++) {
+        ctx.to_ntt(key.b_ntt[i]);
+        ctx.to_ntt(key.a_ntt[i]);
+    }
+    return key;
+}
+
+void rns_key_switch(const RNSContext& ctx,
+                    const RNSPoly& c,
+                    const RNSKeySwitchKey& key,
+                    RNSPoly& out0,
+                    RNSPoly& out1,
+                    bool ntt_out) {
+    if (key.empty()) throw std::runtime_error("Switching key not set");
+    if (key.num_digits() != ctx.size() || c.num_limbs() != ctx.size()) {
+        throw std::invalid_argument("RNS polynomial does not match the switching key");
+    }
+    if (c.ntt_form) {
+        // Digits are coefficient residues
+        RNSPoly coeff = c;
+        ctx.inverse(coeff);
+        rns_key_switch(ctx, coeff, key, out0, out1, ntt_out);
+        return;
+    }
+
+    FHE_STAT_SCOPE(Stat::KeySwitch);
+    const int N = ctx.get_N();
+    const int k = ctx.size();
+    out0 = RNSPoly(k, N, ntt_out);
+    out1 = RNSPoly(k, N, ntt_out);
+
+    std::vector<uint128_w> acc0(N), acc1(N);
+    std::vector<ModInt> d(N);
+
+    for (int l = 0; l < k; l++) {
+        const NTT& ntt = ctx.ntt(l);
+        const Modulus& q = ctx.modulus(l);
+        std::fill(acc0.begin(), acc0.end(), uint128_w{0, 0});
+        std::fill(acc1.begin(), acc1.end(), uint128_w{0, 0});
+
+        for (int i = 0; i < k; i++) {
+            if (i > 0 && i % kRNSLazyTerms == 0) {
+                for (int j = 0; j < N; j++) {
+                    acc0[j] = {q.reduce(q.reduce(acc0[j].high), acc0[j].low), 0};
+                    acc1[j] = {q.reduce(q.reduce(acc1[j].high), acc1[j].low), 0};
+                }
+            }
+
+            // Digit i lifted into limb l
+            for (int j = 0; j < N; j++) d[j] = (ModInt)q.reduce((uint64_t)c[i][j]);
+            ntt.forward(d);
+
+            const std::vector<ModInt>& kb = key.b_ntt[i][l];
+            const std::vector<ModInt>& ka = key.a_ntt[i][l];
+            for (int j = 0; j < N; j++) {
+                acc0[j] = add128(acc0[j], mul64x64((uint64_t)d[j], (uint64_t)kb[j]));
+                acc1[j] = add128(acc1[j], mul64x64((uint64_t)d[j], (uint64_t)ka[j]));
+            }
+        }
+
+        for (int j = 0; j < N; j++) {
+            out0[l][j] = (ModInt)q.reduce(q.reduce(acc0[j].high), acc0[j].low);
+            out1[l][j] = (ModInt)q.reduce(q.reduce(acc1[j].high), acc1[j].low);
+        }
+        if (!ntt_out) {
+            ntt.inverse(out0[l]);
+            ntt.inverse(out1[l]);
+        }
+    }
+}
+
+} // namespace fhe_cpp
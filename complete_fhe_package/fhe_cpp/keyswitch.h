@@ -0,0 +1,109 @@
+/*
+ * Key Switching - Gadget Decomposition with NTT-form Keys
+ * Shared core for relinearization (s^2 -> s) and other key switches
+ */
+
+#ifndef FHE_KEYSWITCH_H
+#define FHE_KEYSWITCH_H
+
+#include "ntt.h"
+#include "rns.h"
+#include "wide_arith.h"
+#include <vector>
+#include <cstdint>
+
+namespace fhe_cpp {
+
+// Base T = 2^w gadget: x = sum_i digit_i * T^i.
+// The last digit keeps all remaining high bits, matching BFVScheme.relinearize.
+class GadgetDecomposer {
+private:
+    int base_bits;
+    int num_digits;
+
+public:
+    GadgetDecomposer(int base_bits, int num_digits);
+
+    int get_base_bits() const { return base_bits; }
+    int get_num_digits() const { return num_digits; }
+
+    std::vector<std::vector<ModInt>> decompose(const std::vector<ModInt>& a) const;
+};
+
+// Digit i satisfies b_i + a_i * s = T^i * s' + e_i; both halves kept in NTT form
+struct KeySwitchKey {
+    int base_bits = 0;
+    std::vector<std::vector<ModInt>> b_ntt;
+    std::vector<std::vector<ModInt>> a_ntt;
+
+    int num_digits() const { return (int)b_ntt.size(); }
+    bool empty() const { return b_ntt.empty(); }
+};
+
+// Transforms coefficient-form key components (b_i, a_i) into a KeySwitchKey
+KeySwitchKey make_switch_key(const NTT& ntt,
+                             const std::vector<std::vector<ModInt>>& key_b,
+                             const std::vector<std::vector<ModInt>>& key_a,
+                             int base_bits);
+
+// out0 = sum_i D_i(c) * b_i, out1 = sum_i D_i(c) * a_i (coefficient form).
+// Products are accumulated un-reduced in 128 bits with one inverse NTT per output.
+void key_switch(const NTT& ntt,
+                const std::vector<ModInt>& c,
+                const KeySwitchKey& key,
+                std::vector<ModInt>& out0,
+                std::vector<ModInt>& out1);
+
+// Hoisted key switching: the gadget digits of c, forward-transformed once, serve
+// every key applied to c and every automorphism of c. sigma_g permutes NTT slots,
+// and sigma_g(D_i(c)) is still a digit vector of sigma_g(c) (entries in (-T, T)),
+// so each further key costs the multiply-accumulate and two inverse NTTs.
+struct HoistedDigits {
+    int base_bits = 0;
+    std::vector<std::vector<ModInt>> digits_ntt;
+
+    int num_digits() const { return (int)digits_ntt.size(); }
+};
+
+// c in coefficient form
+HoistedDigits hoist_digits(const NTT& ntt, const std::vector<ModInt>& c, int base_bits, int num_digits);
+
+// key_switch from hoisted digits. With perm (see galois_ntt_permutation) the digits are
+// read through the slot permutation, switching sigma_g(c) instead of c; ntt_out leaves
+// the outputs in evaluation form. The key must use the digits' base and count.
+void key_switch_hoisted(const NTT& ntt,
+                        const HoistedDigits& digits,
+                        const uint32_t* perm,
+                        const KeySwitchKey& key,
+                        std::vector<ModInt>& out0,
+                        std::vector<ModInt>& out1,
+                        bool ntt_out = false);
+
+// RNS gadget: digit i of c is its residue [c]_{q_i}, and digit i of the key satisfies
+// b_i + a_i * s = g_i * s' + e_i with g_i = 1 (mod q_i), 0 (mod q_l, l != i). NTT form.
+struct RNSKeySwitchKey {
+    std::vector<RNSPoly> b_ntt;
+    std::vector<RNSPoly> a_ntt;
+
+    int num_digits() const { return (int)b_ntt.size(); }
+    bool empty() const { return b_ntt.empty(); }
+};
+
+// Transforms coefficient-form key digits (one per prime of ctx) into an RNSKeySwitchKey
+RNSKeySwitchKey make_rns_switch_key(const RNSContext& ctx,
+                                    const std::vector<RNSPoly>& key_b,
+                                    const std::vector<RNSPoly>& key_a);
+
+// out0 = sum_i [c]_{q_i} * b_i, out1 = sum_i [c]_{q_i} * a_i, c in either form.
+// Each limb accumulates all digits un-reduced before its single inverse NTT;
+// ntt_out skips that inverse and leaves the outputs in evaluation form.
+void rns_key_switch(const RNSContext& ctx,
+                    const RNSPoly& c,
+                    const RNSKeySwitchKey& key,
+                    RNSPoly& out0,
+                    RNSPoly& out1,
+                    bool ntt_out = false);
+
+} // namespace fhe_cpp
+
+#endif // FHE_KEYSWITCH_H
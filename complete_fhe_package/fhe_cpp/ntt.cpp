@@ -1,20 +1,21 @@
 /*
  * NTT Implementation - Corrected for BFV Negacyclic Ring (X^N + 1)
  * Windows-Compatible
+ * Twiddles use Shoup multiplication; pointwise products use Barrett.
  */
 
 #include "ntt.h"
+#include "arena.h"
+#include "context.h"
+#include "simd.h"
+#include "gpu.h"
+#include "stats.h"
+#include "thread_pool.h"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <iostream>
 
-// Windows Intrinsics
-#ifdef _MSC_VER
-#include <intrin.h>
-#pragma intrinsic(_umul128)
-#pragma intrinsic(_udiv128)
-#endif
-
 namespace fhe_cpp {
 
 ModInt extended_gcd(ModInt a, ModInt b, ModInt& x, ModInt& y) {
@@ -30,193 +31,581 @@ ModInt extended_gcd(ModInt a, ModInt b, ModInt& x, ModInt& y) {
     return gcd;
 }
 
-NTT::NTT(int N, ModInt q) : N(N), q(q) {
-    if ((N & (N - 1)) != 0) throw std::invalid_argument("N must be power of 2");
-    if ((q - 1) % (2 * N) != 0) throw std::invalid_argument("q must be 1 (mod 2N)");
+static ModInt mod_exp(ModInt base, ModInt exp, const Modulus& q) {
+    uint64_t res = 1;
+    uint64_t b = (uint64_t)base % q.value();
+    while (exp > 0) {
+        if (exp & 1) res = q.mul(res, b);
+        b = q.mul(b, b);
+        exp >>= 1;
+    }
+    return (ModInt)res;
+}
+
+static ModInt mod_inv(ModInt a, ModInt q) {
+    ModInt x, y;
+    extended_gcd(a, q, x, y);
+    return (x % q + q) % q;
+}
+
+static int bit_reverse(int x, int log_n) {
+    int res = 0;
+    for (int i = 0; i < log_n; i++) {
+        res = (res << 1) | (x & 1);
+        x >>= 1;
+    }
+    return res;
+}
+
+// g^((q-1)/2N) has order dividing 2N, a power of two, so it is primitive exactly
+// when its N-th power is -1
+static ModInt find_primitive_root(int N, ModInt q, const Modulus& q_mod) {
+    const ModInt exp = (q - 1) / (2 * (ModInt)N);
+    for (ModInt g = 2; g < q; g++) {
+        ModInt val = mod_exp(g, exp, q_mod);
+        if (mod_exp(val, N, q_mod) == q - 1) return val;
+    }
+    return 0;
+}
+
+std::shared_ptr<NTTTables> build_ntt_tables(int N, ModInt q) {
+    if (N < 1 || (N & (N - 1)) != 0) throw std::invalid_argument("N must be power of 2");
+    if (q < 3 || (q - 1) % (2 * N) != 0) throw std::invalid_argument("q must be 1 (mod 2N)");
 
-    // 1. Find 2N-th root of unity (psi)
-    ModInt root = find_primitive_root();
-    psi = mod_exp(root, (q - 1) / (2 * N));
-    psi_inv = mod_inv(psi);
+    const Modulus q_mod((uint64_t)q);
+    auto tab = std::make_shared<NTTTables>();
+    tab->N = N;
+    tab->q = q;
 
-    // 2. Compute N-th root (omega = psi^2) for the standard NTT core
-    omega = mod_mul(psi, psi);
-    omega_inv = mod_inv(omega);
-    N_inv = mod_inv(N);
+    // 1. Find primitive 2N-th root of unity (psi)
+    tab->psi = find_primitive_root(N, q, q_mod);
+    if (tab->psi == 0) throw std::invalid_argument("q has no primitive 2N-th root of unity");
+    tab->psi_inv = mod_inv(tab->psi, q);
+    tab->N_inv = mod_inv(N, q);
 
-    // 3. Precompute tables
-    psi_powers.resize(N);
-    psi_inv_powers.resize(N);
-    omega_powers.resize(N);
-    omega_inv_powers.resize(N);
+    // 2. Powers of psi and psi^-1 stored at bit-reversed positions
+    int log_n = 0;
+    while ((1 << log_n) < N) log_n++;
 
-    ModInt curr_psi = 1;
-    ModInt curr_psi_inv = 1;
-    ModInt curr_omega = 1;
-    ModInt curr_omega_inv = 1;
+    tab->psi_rev.resize(N);
+    tab->psi_inv_rev.resize(N);
 
+    uint64_t curr_psi = 1;
+    uint64_t curr_psi_inv = 1;
     for (int i = 0; i < N; i++) {
-        psi_powers[i] = curr_psi;
-        psi_inv_powers[i] = curr_psi_inv;
-        omega_powers[i] = curr_omega;
-        omega_inv_powers[i] = curr_omega_inv;
+        int rev = bit_reverse(i, log_n);
+        tab->psi_rev[rev] = curr_psi;
+        tab->psi_inv_rev[rev] = curr_psi_inv;
+
+        curr_psi = q_mod.mul(curr_psi, (uint64_t)tab->psi);
+        curr_psi_inv = q_mod.mul(curr_psi_inv, (uint64_t)tab->psi_inv);
+    }
 
-        curr_psi = mod_mul(curr_psi, psi);
-        curr_psi_inv = mod_mul(curr_psi_inv, psi_inv);
-        curr_omega = mod_mul(curr_omega, omega);
-        curr_omega_inv = mod_mul(curr_omega_inv, omega_inv);
+    // 3. Shoup companions, and the N^-1 fold for the last inverse stage
+    tab->psi_rev_shoup.resize(N);
+    tab->psi_inv_rev_shoup.resize(N);
+    for (int i = 0; i < N; i++) {
+        tab->psi_rev_shoup[i] = q_mod.shoup(tab->psi_rev[i]);
+        tab->psi_inv_rev_shoup[i] = q_mod.shoup(tab->psi_inv_rev[i]);
     }
+
+    tab->inv_last_n = (uint64_t)tab->N_inv;
+    tab->inv_last_w = q_mod.mul((uint64_t)tab->N_inv, tab->psi_inv_rev[N > 1 ? 1 : 0]);
+    tab->inv_last_n_shoup = q_mod.shoup(tab->inv_last_n);
+    tab->inv_last_w_shoup = q_mod.shoup(tab->inv_last_w);
+    return tab;
+}
+
+NTT::NTT(int N, ModInt q) : NTT(get_ntt_tables(N, q)) {}
+
+NTT::NTT(std::shared_ptr<const NTTTables> tab)
+    : N(tab->N), log_n(0), q(tab->q), q_mod((uint64_t)tab->q), lazy(((uint64_t)tab->q >> 62) == 0),
+      tables(std::move(tab)) {
+    while ((1 << log_n) < N) log_n++;
 }
 
 ModInt NTT::mod_add(ModInt a, ModInt b) const {
-    ModInt res = (a + b);
-    return (res >= q) ? res - q : res;
+    uint64_t res = (uint64_t)a + (uint64_t)b;
+    return (ModInt)((res >= (uint64_t)q) ? res - q : res);
 }
 
 ModInt NTT::mod_sub(ModInt a, ModInt b) const {
-    return (a >= b) ? a - b : a - b + q;
+    return (a >= b) ? a - b : (ModInt)((uint64_t)a + (uint64_t)q - (uint64_t)b);
 }
 
 ModInt NTT::mod_mul(ModInt a, ModInt b) const {
-#ifdef _MSC_VER
-    unsigned __int64 high, rem;
-    unsigned __int64 low = _umul128((unsigned __int64)a, (unsigned __int64)b, &high);
-    _udiv128(high, low, (unsigned __int64)q, &rem);
-    return (ModInt)rem;
-#else
-    unsigned __int128 res = (unsigned __int128)a * b;
-    return (ModInt)(res % q);
-#endif
-}
-
-ModInt NTT::mod_exp(ModInt base, ModInt exp) const {
-    ModInt res = 1;
-    base %= q;
-    while (exp > 0) {
-        if (exp % 2 == 1) res = mod_mul(res, base);
-        base = mod_mul(base, base);
-        exp /= 2;
+    return (ModInt)q_mod.mul((uint64_t)a, (uint64_t)b);
+}
+
+// Cooley-Tukey butterfly: Lazy keeps [0, 4q) -> [0, 4q) (needs 4q < 2^64),
+// otherwise [0, q) -> [0, q)
+template <bool Lazy>
+static inline void ct_butterfly(uint64_t& x, uint64_t& y, uint64_t w, uint64_t w_shoup,
+                                uint64_t q) {
+    uint64_t t = mul_shoup_lazy(w, w_shoup, y, q);
+    uint64_t u = x;
+
+    if (Lazy) {
+        const uint64_t two_q = 2 * q;
+        if (u >= two_q) u -= two_q;
+        x = u + t;
+        y = u + two_q - t;
+    } else {
+        if (t >= q) t -= q;
+        uint64_t sum = u + t;
+        x = (sum >= q) ? sum - q : sum;
+        y = (u >= t) ? u - t : u + q - t;
     }
-    return res;
 }
 
-ModInt NTT::mod_inv(ModInt a) const {
-    ModInt x, y;
-    extended_gcd(a, q, x, y);
-    return (x % q + q) % q;
+// Gentleman-Sande butterfly: Lazy keeps [0, 2q) -> [0, 2q), otherwise [0, q) -> [0, q)
+template <bool Lazy>
+static inline void gs_butterfly(uint64_t& x, uint64_t& y, uint64_t w, uint64_t w_shoup,
+                                uint64_t q) {
+    uint64_t u = x, v = y;
+
+    if (Lazy) {
+        const uint64_t two_q = 2 * q;
+        uint64_t sum = u + v;
+        x = (sum >= two_q) ? sum - two_q : sum;
+        y = mul_shoup_lazy(w, w_shoup, u + two_q - v, q);
+    } else {
+        uint64_t sum = u + v;
+        x = (sum >= q) ? sum - q : sum;
+        uint64_t t = mul_shoup_lazy(w, w_shoup, u + q - v, q);
+        y = (t >= q) ? t - q : t;
+    }
 }
 
-ModInt NTT::find_primitive_root() {
-    ModInt phi = q - 1;
-    ModInt target_order = 2 * N;
-    for (ModInt g = 2; g < q; g++) {
-        ModInt val = mod_exp(g, phi / target_order);
-        if (mod_exp(val, target_order) == 1 && mod_exp(val, N) != 1) return val;
+// Natural order in, bit-reversed out. Stage with half-size t has N/(2t) blocks;
+// block i uses psi_rev[m + i]. The last stage (t = 1) also settles [0, 4q) -> [0, q).
+template <bool Lazy>
+static void forward_stages(uint64_t* x, int N, uint64_t q, const uint64_t* w_rev,
+                           const uint64_t* ws_rev, const NTTKernels* kern) {
+    int m = 1;
+    for (int t = N >> 1; t > 1; t >>= 1, m <<= 1) {
+        for (int i = 0; i < m; i++) {
+            uint64_t* xi = x + 2 * i * t;
+            uint64_t w = w_rev[m + i], ws = ws_rev[m + i];
+
+            if (kern && t >= kern->width) {
+                kern->ct_butterfly(xi, xi + t, w, ws, t, q);
+            } else {
+                for (int j = 0; j < t; j++) ct_butterfly<Lazy>(xi[j], xi[j + t], w, ws, q);
+            }
+        }
+    }
+
+    if (N < 2) return;
+    const uint64_t two_q = 2 * q;
+    for (int i = 0; i < m; i++) {
+        uint64_t& u = x[2 * i];
+        uint64_t& v = x[2 * i + 1];
+        ct_butterfly<Lazy>(u, v, w_rev[m + i], ws_rev[m + i], q);
+        if (Lazy) {
+            if (u >= two_q) u -= two_q;
+            if (u >= q) u -= q;
+            if (v >= two_q) v -= two_q;
+            if (v >= q) v -= q;
+        }
     }
-    return 0;
 }
 
-int NTT::bit_reverse(int x, int log_n) const {
-    int res = 0;
-    for (int i = 0; i < log_n; i++) {
-        res = (res << 1) | (x & 1);
-        x >>= 1;
+// Bit-reversed in, natural out. Stage with half-size t has h = N/(2t) blocks;
+// block i uses psi_inv_rev[h + i]. The last stage (t = N/2) multiplies by N^-1.
+template <bool Lazy>
+static void inverse_stages(uint64_t* x, int N, uint64_t q, const uint64_t* w_rev,
+                           const uint64_t* ws_rev, uint64_t n_inv, uint64_t n_inv_shoup,
+                           uint64_t w_last, uint64_t w_last_shoup, const NTTKernels* kern) {
+    int t = 1;
+    for (int h = N >> 1; h > 1; h >>= 1, t <<= 1) {
+        for (int i = 0; i < h; i++) {
+            uint64_t* xi = x + 2 * i * t;
+            uint64_t w = w_rev[h + i], ws = ws_rev[h + i];
+
+            if (kern && t >= kern->width) {
+                kern->gs_butterfly(xi, xi + t, w, ws, t, q);
+            } else {
+                for (int j = 0; j < t; j++) gs_butterfly<Lazy>(xi[j], xi[j + t], w, ws, q);
+            }
+        }
+    }
+
+    if (N < 2) return;
+    if (kern && t >= kern->width) {
+        kern->gs_butterfly_last(x, x + t, n_inv, n_inv_shoup, w_last, w_last_shoup, t, q);
+        return;
+    }
+    for (int j = 0; j < t; j++) {
+        uint64_t u = x[j], v = x[j + t];
+        uint64_t sum = u + v;
+        uint64_t diff = Lazy ? u + 2 * q - v : u + q - v;
+        uint64_t a = mul_shoup_lazy(n_inv, n_inv_shoup, sum, q);
+        uint64_t b = mul_shoup_lazy(w_last, w_last_shoup, diff, q);
+        x[j] = (a >= q) ? a - q : a;
+        x[j + t] = (b >= q) ? b - q : b;
     }
-    return res;
 }
 
-void NTT::bit_reverse_copy(std::vector<ModInt>& a) const {
-    int log_n = 0;
-    int temp = N;
-    while (temp > 1) { log_n++; temp >>= 1; }
+// Fixed-size transforms for the lazy path: N, and with it every stage's block
+// count and half-size, are compile-time constants, so the butterfly loops
+// unroll and the twiddle offsets fold. The three stages with the smallest
+// half-size (t = 4, 2, 1) run fused over 8-value blocks kept in registers.
+//
+// Large N runs cache-blocked: stages whose blocks span more than one chunk of
+// 2^kBlockLogN values pass over the whole array; every narrower stage then
+// runs chunk by chunk, so a chunk (16 KB) and its twiddles stay in L1 across
+// all of them. Each stage's twiddles are the contiguous run psi_rev[m, 2m).
+static const int kMinFixedLogN = 10;
+static const int kMaxFixedLogN = 16;
+static const int kBlockLogN = 11;
+
+// Measured with fhe_bench (BM_NTTForward / BM_NTTInverse, blocked vs not): neutral
+// at N = 8192, up to ~15% faster from 16384 on, where the array outgrows L1 by 3x
+static std::atomic<int> blocking_threshold{16384};
+
+void set_ntt_blocking_threshold(int N) { blocking_threshold.store(N, std::memory_order_relaxed); }
+int get_ntt_blocking_threshold() { return blocking_threshold.load(std::memory_order_relaxed); }
+
+static bool use_blocking(int N) {
+    const int threshold = get_ntt_blocking_threshold();
+    return threshold > 0 && N >= threshold && N > (1 << kBlockLogN);
+}
 
-    for (int i = 0; i < N; i++) {
-        int rev = bit_reverse(i, log_n);
-        if (i < rev) std::swap(a[i], a[rev]);
+// Forward stages S in [S, End): m = 2^S blocks of half-size t = N / 2^(S+1), of which
+// chunk c of `chunks` equal slices of the array holds m / chunks
+template <int LogN, int S, int End>
+static inline void forward_range(uint64_t* x, uint64_t q, const uint64_t* w_rev,
+                                 const uint64_t* ws_rev, const NTTKernels* kern,
+                                 int chunk, int chunks) {
+    if constexpr (S < End) {
+        constexpr int N = 1 << LogN;
+        constexpr int m = 1 << S;
+        constexpr int t = N >> (S + 1);
+        const int per_chunk = m / chunks;
+
+        for (int i = chunk * per_chunk; i < (chunk + 1) * per_chunk; i++) {
+            uint64_t* xi = x + 2 * i * t;
+            const uint64_t w = w_rev[m + i], ws = ws_rev[m + i];
+            if (kern && t >= kern->width) {
+                kern->ct_butterfly(xi, xi + t, w, ws, t, q);
+            } else {
+                for (int j = 0; j < t; j++) ct_butterfly<true>(xi[j], xi[j + t], w, ws, q);
+            }
+        }
+        forward_range<LogN, S + 1, End>(x, q, w_rev, ws_rev, kern, chunk, chunks);
     }
 }
 
-// Standard Cooley-Tukey Butterfly
-void NTT::ntt_core(std::vector<ModInt>& a, const std::vector<ModInt>& roots) const {
-    bit_reverse_copy(a);
+// Forward stages t = 4, 2, 1 over the 8-value blocks of one chunk, then [0, 4q) -> [0, q)
+template <int N>
+static inline void forward_radix8_tail(uint64_t* x, uint64_t q, const uint64_t* w_rev,
+                                       const uint64_t* ws_rev, int chunk, int chunks) {
+    const uint64_t two_q = 2 * q;
+    const int per_chunk = N / 8 / chunks;
+    for (int b = chunk * per_chunk; b < (chunk + 1) * per_chunk; b++) {
+        uint64_t* xb = x + 8 * b;
+        uint64_t v[8];
+        for (int k = 0; k < 8; k++) v[k] = xb[k];
+
+        const int i4 = N / 8 + b;
+        for (int j = 0; j < 4; j++) ct_butterfly<true>(v[j], v[j + 4], w_rev[i4], ws_rev[i4], q);
+        for (int h = 0; h < 2; h++) {
+            const int i2 = N / 4 + 2 * b + h;
+            for (int j = 0; j < 2; j++) {
+                ct_butterfly<true>(v[4 * h + j], v[4 * h + j + 2], w_rev[i2], ws_rev[i2], q);
+            }
+        }
+        for (int h = 0; h < 4; h++) {
+            const int i1 = N / 2 + 4 * b + h;
+            ct_butterfly<true>(v[2 * h], v[2 * h + 1], w_rev[i1], ws_rev[i1], q);
+        }
 
-    for (int s = 1; s <= std::log2(N); s++) {
-        int m = 1 << s;
-        int m2 = m >> 1;
+        for (int k = 0; k < 8; k++) {
+            uint64_t u = v[k];
+            if (u >= two_q) u -= two_q;
+            if (u >= q) u -= q;
+            xb[k] = u;
+        }
+    }
+}
 
-        // Stride through the precomputed roots (Cooley-Tukey optimization)
-        int root_step = N / m;
+// Inverse stages t = 1, 2, 4 over the 8-value blocks of one chunk
+// ([0, q) or [0, 2q) in, [0, 2q) out)
+template <int N>
+static inline void inverse_radix8_head(uint64_t* x, uint64_t q, const uint64_t* w_rev,
+                                       const uint64_t* ws_rev, int chunk, int chunks) {
+    const int per_chunk = N / 8 / chunks;
+    for (int b = chunk * per_chunk; b < (chunk + 1) * per_chunk; b++) {
+        uint64_t* xb = x + 8 * b;
+        uint64_t v[8];
+        for (int k = 0; k < 8; k++) v[k] = xb[k];
+
+        for (int h = 0; h < 4; h++) {
+            const int i1 = N / 2 + 4 * b + h;
+            gs_butterfly<true>(v[2 * h], v[2 * h + 1], w_rev[i1], ws_rev[i1], q);
+        }
+        for (int h = 0; h < 2; h++) {
+            const int i2 = N / 4 + 2 * b + h;
+            for (int j = 0; j < 2; j++) {
+                gs_butterfly<true>(v[4 * h + j], v[4 * h + j + 2], w_rev[i2], ws_rev[i2], q);
+            }
+        }
+        const int i4 = N / 8 + b;
+        for (int j = 0; j < 4; j++) gs_butterfly<true>(v[j], v[j + 4], w_rev[i4], ws_rev[i4], q);
 
-        for (int k = 0; k < N; k += m) {
-            for (int j = 0; j < m2; j++) {
-                ModInt w = roots[j * root_step];
-                ModInt t = mod_mul(w, a[k + j + m2]);
-                ModInt u = a[k + j];
+        for (int k = 0; k < 8; k++) xb[k] = v[k];
+    }
+}
 
-                a[k + j] = mod_add(u, t);
-                a[k + j + m2] = mod_sub(u, t);
+// Inverse stages S in [S, End): half-size t = 2^S, h = N / 2^(S+1) blocks, h / chunks per chunk
+template <int LogN, int S, int End>
+static inline void inverse_range(uint64_t* x, uint64_t q, const uint64_t* w_rev,
+                                 const uint64_t* ws_rev, const NTTKernels* kern,
+                                 int chunk, int chunks) {
+    if constexpr (S < End) {
+        constexpr int N = 1 << LogN;
+        constexpr int t = 1 << S;
+        constexpr int h = N >> (S + 1);
+        const int per_chunk = h / chunks;
+
+        for (int i = chunk * per_chunk; i < (chunk + 1) * per_chunk; i++) {
+            uint64_t* xi = x + 2 * i * t;
+            const uint64_t w = w_rev[h + i], ws = ws_rev[h + i];
+            if (kern && t >= kern->width) {
+                kern->gs_butterfly(xi, xi + t, w, ws, t, q);
+            } else {
+                for (int j = 0; j < t; j++) gs_butterfly<true>(xi[j], xi[j + t], w, ws, q);
             }
         }
+        inverse_range<LogN, S + 1, End>(x, q, w_rev, ws_rev, kern, chunk, chunks);
     }
 }
 
-void NTT::forward(std::vector<ModInt>& a) const {
-    // Negacyclic Pre-processing: Multiply by psi^i
-    for (int i = 0; i < N; i++) {
-        a[i] = mod_mul(a[i], psi_powers[i]);
+// Last inverse stage (t = N/2) with N^-1 folded in
+template <int LogN>
+static inline void inverse_last(uint64_t* x, uint64_t q, const NTTTables& tab, const NTTKernels* kern) {
+    constexpr int t = 1 << (LogN - 1);
+    if (kern && t >= kern->width) {
+        kern->gs_butterfly_last(x, x + t, tab.inv_last_n, tab.inv_last_n_shoup,
+                                tab.inv_last_w, tab.inv_last_w_shoup, t, q);
+        return;
+    }
+    for (int j = 0; j < t; j++) {
+        uint64_t a = mul_shoup_lazy(tab.inv_last_n, tab.inv_last_n_shoup, x[j] + x[j + t], q);
+        uint64_t b = mul_shoup_lazy(tab.inv_last_w, tab.inv_last_w_shoup, x[j] + 2 * q - x[j + t], q);
+        x[j] = (a >= q) ? a - q : a;
+        x[j + t] = (b >= q) ? b - q : b;
     }
+}
 
-    // Standard NTT
-    ntt_core(a, omega_powers);
+template <int LogN>
+static void forward_fixed_n(uint64_t* x, uint64_t q, const NTTTables& tab, const NTTKernels* kern) {
+    constexpr int N = 1 << LogN;
+    constexpr int tail = LogN - 3;                      // First stage of the radix-8 tail
+    const uint64_t* w = tab.psi_rev.data();
+    const uint64_t* ws = tab.psi_rev_shoup.data();
+
+    if constexpr (LogN > kBlockLogN) {
+        if (use_blocking(N)) {
+            constexpr int split = LogN - kBlockLogN;    // First stage inside one chunk
+            constexpr int chunks = 1 << split;
+            forward_range<LogN, 0, split>(x, q, w, ws, kern, 0, 1);
+            for (int c = 0; c < chunks; c++) {
+                forward_range<LogN, split, tail>(x, q, w, ws, kern, c, chunks);
+                forward_radix8_tail<N>(x, q, w, ws, c, chunks);
+            }
+            return;
+        }
+    }
+    forward_range<LogN, 0, tail>(x, q, w, ws, kern, 0, 1);
+    forward_radix8_tail<N>(x, q, w, ws, 0, 1);
+}
+
+template <int LogN>
+static void inverse_fixed_n(uint64_t* x, uint64_t q, const NTTTables& tab, const NTTKernels* kern) {
+    constexpr int N = 1 << LogN;
+    const uint64_t* w = tab.psi_inv_rev.data();
+    const uint64_t* ws = tab.psi_inv_rev_shoup.data();
+
+    if constexpr (LogN > kBlockLogN) {
+        if (use_blocking(N)) {
+            constexpr int chunks = 1 << (LogN - kBlockLogN);
+            for (int c = 0; c < chunks; c++) {
+                inverse_radix8_head<N>(x, q, w, ws, c, chunks);
+                inverse_range<LogN, 3, kBlockLogN>(x, q, w, ws, kern, c, chunks);
+            }
+            inverse_range<LogN, kBlockLogN, LogN - 1>(x, q, w, ws, kern, 0, 1);
+            inverse_last<LogN>(x, q, tab, kern);
+            return;
+        }
+    }
+    inverse_radix8_head<N>(x, q, w, ws, 0, 1);
+    inverse_range<LogN, 3, LogN - 1>(x, q, w, ws, kern, 0, 1);
+    inverse_last<LogN>(x, q, tab, kern);
+}
+
+typedef void (*FixedTransform)(uint64_t*, uint64_t, const NTTTables&, const NTTKernels*);
+
+static const FixedTransform kFixedForward[] = {
+    forward_fixed_n<10>, forward_fixed_n<11>, forward_fixed_n<12>,
+    forward_fixed_n<13>, forward_fixed_n<14>, forward_fixed_n<15>, forward_fixed_n<16>
+};
+static const FixedTransform kFixedInverse[] = {
+    inverse_fixed_n<10>, inverse_fixed_n<11>, inverse_fixed_n<12>,
+    inverse_fixed_n<13>, inverse_fixed_n<14>, inverse_fixed_n<15>, inverse_fixed_n<16>
+};
+
+void NTT::forward(std::vector<ModInt>& a) const {
+    forward(a.data());
 }
 
 void NTT::inverse(std::vector<ModInt>& a) const {
-    // Standard Inverse NTT
-    ntt_core(a, omega_inv_powers);
+    inverse(a.data());
+}
 
-    // Scale by N^-1 and Post-process (Multiply by psi^-i)
-    for (int i = 0; i < N; i++) {
-        ModInt val = mod_mul(a[i], N_inv);
-        a[i] = mod_mul(val, psi_inv_powers[i]);
+void NTT::forward(ModInt* a) const {
+    FHE_STAT_SCOPE(Stat::NTTForward);
+    uint64_t* x = reinterpret_cast<uint64_t*>(a);
+    const uint64_t q_u = (uint64_t)q;
+    const NTTTables& tab = *tables;
+
+    if (lazy) {
+        const NTTKernels* kern = select_ntt_kernels(q_u);
+        if (log_n >= kMinFixedLogN && log_n <= kMaxFixedLogN) {
+            kFixedForward[log_n - kMinFixedLogN](x, q_u, tab, kern);
+            return;
+        }
+        forward_stages<true>(x, N, q_u, tab.psi_rev.data(), tab.psi_rev_shoup.data(), kern);
+    } else {
+        forward_stages<false>(x, N, q_u, tab.psi_rev.data(), tab.psi_rev_shoup.data(), nullptr);
     }
 }
 
-std::vector<ModInt> NTT::multiply(const std::vector<ModInt>& a,
-                                   const std::vector<ModInt>& b) const {
-    std::vector<ModInt> a_ntt = a;
-    std::vector<ModInt> b_ntt = b;
+void NTT::inverse(ModInt* a) const {
+    FHE_STAT_SCOPE(Stat::NTTInverse);
+    uint64_t* x = reinterpret_cast<uint64_t*>(a);
+    const uint64_t q_u = (uint64_t)q;
+    const NTTTables& tab = *tables;
+
+    if (lazy) {
+        const NTTKernels* kern = select_ntt_kernels(q_u);
+        if (log_n >= kMinFixedLogN && log_n <= kMaxFixedLogN) {
+            kFixedInverse[log_n - kMinFixedLogN](x, q_u, tab, kern);
+            return;
+        }
+        inverse_stages<true>(x, N, q_u, tab.psi_inv_rev.data(), tab.psi_inv_rev_shoup.data(),
+                             tab.inv_last_n, tab.inv_last_n_shoup, tab.inv_last_w, tab.inv_last_w_shoup,
+                             kern);
+    } else {
+        inverse_stages<false>(x, N, q_u, tab.psi_inv_rev.data(), tab.psi_inv_rev_shoup.data(),
+                              tab.inv_last_n, tab.inv_last_n_shoup, tab.inv_last_w, tab.inv_last_w_shoup,
+                              nullptr);
+    }
+}
+
+void NTT::forward_batch(ModInt* a, size_t rows) const {
+    const size_t n = (size_t)N;
+    if (lazy && gpu_offload(rows * n)) {
+        std::shared_ptr<const GpuNTT> gpu = shared_gpu_ntt(N, {q});
+        DeviceBuffer buf(rows, N);
+        buf.upload(a);
+        gpu->forward(buf);
+        buf.download(a);
+        return;
+    }
+    default_pool()->parallel_for(rows, [&](size_t r) { forward(a + r * n); });
+}
 
-    forward(a_ntt);
+void NTT::inverse_batch(ModInt* a, size_t rows) const {
+    const size_t n = (size_t)N;
+    if (lazy && gpu_offload(rows * n)) {
+        std::shared_ptr<const GpuNTT> gpu = shared_gpu_ntt(N, {q});
+        DeviceBuffer buf(rows, N);
+        buf.upload(a);
+        gpu->inverse(buf);
+        buf.download(a);
+        return;
+    }
+    default_pool()->parallel_for(rows, [&](size_t r) { inverse(a + r * n); });
+}
+
+void NTT::multiply_into(const ModInt* a, const ModInt* b, ModInt* out) const {
+    // Copy b first: out may alias it
+    ScratchScope scratch;
+    ModInt* b_ntt = scratch.alloc<ModInt>((size_t)N);
+    std::copy(b, b + N, b_ntt);
+    if (out != a) std::copy(a, a + N, out);
+
+    forward(out);
     forward(b_ntt);
+    pointwise_multiply_into(out, b_ntt, out, N);
+    inverse(out);
+}
 
-    for (int i = 0; i < N; i++) {
-        a_ntt[i] = mod_mul(a_ntt[i], b_ntt[i]);
+void NTT::pointwise_multiply_into(const ModInt* a, const ModInt* b, ModInt* out, size_t n) const {
+    FHE_STAT_SCOPE(Stat::PointwiseMultiply);
+    for (size_t i = 0; i < n; i++) out[i] = mod_mul(a[i], b[i]);
+}
+
+void NTT::add_into(const ModInt* a, const ModInt* b, ModInt* out, size_t n) const {
+    for (size_t i = 0; i < n; i++) out[i] = mod_add(a[i], b[i]);
+}
+
+void NTT::subtract_into(const ModInt* a, const ModInt* b, ModInt* out, size_t n) const {
+    for (size_t i = 0; i < n; i++) out[i] = mod_sub(a[i], b[i]);
+}
+
+void NTT::scalar_mul_into(const ModInt* a, ModInt scalar, ModInt* out, size_t n) const {
+    uint64_t w = (uint64_t)(((scalar % q) + q) % q);
+    uint64_t w_shoup = q_mod.shoup(w);
+    const uint64_t q_u = (uint64_t)q;
+
+    for (size_t i = 0; i < n; i++) {
+        uint64_t v = mul_shoup_lazy(w, w_shoup, (uint64_t)a[i], q_u);
+        out[i] = (ModInt)((v >= q_u) ? v - q_u : v);
     }
+}
 
-    inverse(a_ntt);
-    return a_ntt;
+std::vector<ModInt> NTT::multiply(const std::vector<ModInt>& a,
+                                   const std::vector<ModInt>& b) const {
+    std::vector<ModInt> res(N);
+    multiply_into(a.data(), b.data(), res.data());
+    return res;
+}
+
+std::vector<ModInt> NTT::pointwise_multiply(const std::vector<ModInt>& a,
+                                             const std::vector<ModInt>& b) const {
+    std::vector<ModInt> res(a.size());
+    pointwise_multiply_into(a.data(), b.data(), res.data(), a.size());
+    return res;
 }
 
 std::vector<ModInt> NTT::add(const std::vector<ModInt>& a, const std::vector<ModInt>& b) const {
     std::vector<ModInt> res(a.size());
-    for (size_t i = 0; i < a.size(); i++) res[i] = mod_add(a[i], b[i]);
+    add_into(a.data(), b.data(), res.data(), a.size());
     return res;
 }
 
 std::vector<ModInt> NTT::subtract(const std::vector<ModInt>& a, const std::vector<ModInt>& b) const {
     std::vector<ModInt> res(a.size());
-    for (size_t i = 0; i < a.size(); i++) res[i] = mod_sub(a[i], b[i]);
+    subtract_into(a.data(), b.data(), res.data(), a.size());
     return res;
 }
 
 std::vector<ModInt> NTT::scalar_mul(const std::vector<ModInt>& a, ModInt scalar) const {
     std::vector<ModInt> res(a.size());
-    for (size_t i = 0; i < a.size(); i++) res[i] = mod_mul(a[i], scalar);
+    scalar_mul_into(a.data(), scalar, res.data(), a.size());
     return res;
 }
 
 bool NTT::is_valid() const {
-    return psi != 0 && N > 0;
+    return tables && tables->psi != 0 && N > 0;
+}
+
+const char* NTT::kernel_name() const {
+    const NTTKernels* kern = lazy ? select_ntt_kernels((uint64_t)q) : nullptr;
+    return simd_level_name(kern ? kern->level : SimdLevel::Scalar);
 }
 
 } // namespace fhe_cpp
\ No newline at end of file
@@ -6,6 +6,8 @@
 #ifndef FHE_NTT_H
 #define FHE_NTT_H
 
+#include "wide_arith.h"
+#include <memory>
 #include <vector>
 #include <cstdint>
 #include <stdexcept>
@@ -14,50 +16,93 @@ namespace fhe_cpp {
 
 typedef int64_t ModInt;
 
+// Immutable transform tables for one (N, q). Every NTT over the same ring shares
+// one copy through the process-wide registry (context.h), so copies of an NTT and
+// the several objects a scheme builds over one modulus cost a pointer each.
+struct NTTTables {
+    int N = 0;
+    ModInt q = 0;
+    ModInt psi = 0;                 // 2N-th primitive root
+    ModInt psi_inv = 0;             // Inverse of psi
+    ModInt N_inv = 0;
+
+    // Merged negacyclic twiddles: entry k is psi^bitrev(k) (resp. psi^-bitrev(k)),
+    // so the psi^i twist rides inside the butterflies and no permutation pass is needed
+    std::vector<uint64_t> psi_rev;
+    std::vector<uint64_t> psi_inv_rev;
+
+    // Shoup companions floor(w * 2^64 / q) of the twiddle tables
+    std::vector<uint64_t> psi_rev_shoup;
+    std::vector<uint64_t> psi_inv_rev_shoup;
+
+    // Last inverse stage scales both outputs: N^-1 and N^-1 * psi_inv_rev[1]
+    uint64_t inv_last_n = 0, inv_last_n_shoup = 0;
+    uint64_t inv_last_w = 0, inv_last_w_shoup = 0;
+};
+
+// Root search and table construction from scratch; throws std::invalid_argument
+// unless N is a power of two and q = 1 (mod 2N) admits a 2N-th root. Callers
+// normally go through get_ntt_tables (context.h) instead.
+std::shared_ptr<NTTTables> build_ntt_tables(int N, ModInt q);
+
+// Transforms of N >= threshold (and N > 2048) run cache-blocked: stages narrower
+// than a 2048-value chunk finish one chunk at a time while it sits in L1.
+// <= 0 disables blocking, e.g. to benchmark against the stage-by-stage order.
+void set_ntt_blocking_threshold(int N);
+int get_ntt_blocking_threshold();
+
 class NTT {
 private:
     int N;
+    int log_n;                      // Picks the fixed-size kernels (N = 2^10 .. 2^16)
     ModInt q;
-    ModInt psi;                     // 2N-th primitive root
-    ModInt psi_inv;                 // Inverse of psi
-    ModInt omega;                   // N-th root (psi^2)
-    ModInt omega_inv;               // Inverse of omega
-    ModInt N_inv;
-
-    // Precomputed tables
-    std::vector<ModInt> omega_powers;
-    std::vector<ModInt> omega_inv_powers;
-
-    // Tables for Negacyclic wrapper (psi^i)
-    std::vector<ModInt> psi_powers;
-    std::vector<ModInt> psi_inv_powers;
+    Modulus q_mod;                  // Barrett reducer for general products
+    bool lazy;                      // Butterflies stay in [0, 4q); needs q < 2^62
+    std::shared_ptr<const NTTTables> tables;
 
     // Helpers
     ModInt mod_add(ModInt a, ModInt b) const;
     ModInt mod_sub(ModInt a, ModInt b) const;
     ModInt mod_mul(ModInt a, ModInt b) const;
-    ModInt mod_exp(ModInt base, ModInt exp) const;
-    ModInt mod_inv(ModInt a) const;
-    ModInt find_primitive_root();
-
-    int bit_reverse(int x, int log_n) const;
-    void bit_reverse_copy(std::vector<ModInt>& a) const;
 
 public:
+    // Tables come from the registry: built on first use of (N, q), shared afterwards
     NTT(int N, ModInt q);
+    explicit NTT(std::shared_ptr<const NTTTables> tables);
     ~NTT() = default;
 
-    // Core transforms (Cyclic)
-    void ntt_core(std::vector<ModInt>& a, const std::vector<ModInt>& roots) const;
-
-    // Wrapper transforms (Negacyclic X^N+1)
+    // Negacyclic transforms (X^N+1): Cooley-Tukey forward, Gentleman-Sande inverse.
+    // The NTT domain is in bit-reversed order: slot k holds a(psi^(2 bitrev(k) + 1)).
     void forward(std::vector<ModInt>& a) const;
     void inverse(std::vector<ModInt>& a) const;
 
+    // Raw-buffer variants: a points at N contiguous coefficients, transformed in place
+    void forward(ModInt* a) const;
+    void inverse(ModInt* a) const;
+
+    // Raw-buffer element-wise operations over n values; out may alias an input
+    void add_into(const ModInt* a, const ModInt* b, ModInt* out, size_t n) const;
+    void subtract_into(const ModInt* a, const ModInt* b, ModInt* out, size_t n) const;
+    void scalar_mul_into(const ModInt* a, ModInt scalar, ModInt* out, size_t n) const;
+    void pointwise_multiply_into(const ModInt* a, const ModInt* b, ModInt* out, size_t n) const;
+
+    // Negacyclic product of two length-N buffers into out (may alias a or b)
+    void multiply_into(const ModInt* a, const ModInt* b, ModInt* out) const;
+
+    // rows contiguous length-N buffers transformed in place: on the GPU (gpu.h) for
+    // large lazy-path batches, otherwise row by row on the default thread pool.
+    // Same output either way.
+    void forward_batch(ModInt* a, size_t rows) const;
+    void inverse_batch(ModInt* a, size_t rows) const;
+
     // High-level operations
     std::vector<ModInt> multiply(const std::vector<ModInt>& a,
                                   const std::vector<ModInt>& b) const;
 
+    // Element-wise product of two NTT-domain vectors
+    std::vector<ModInt> pointwise_multiply(const std::vector<ModInt>& a,
+                                           const std::vector<ModInt>& b) const;
+
     std::vector<ModInt> add(const std::vector<ModInt>& a,
                             const std::vector<ModInt>& b) const;
 
@@ -68,8 +113,12 @@ public:
                                     ModInt scalar) const;
 
     bool is_valid() const;
+
+    // Kernel family the transforms use for this modulus at the current SIMD level
+    const char* kernel_name() const;
     int get_N() const { return N; }
     ModInt get_q() const { return q; }
+    const std::shared_ptr<const NTTTables>& get_tables() const { return tables; }
 };
 
 } // namespace fhe_cpp
@@ -0,0 +1,289 @@
+/*
+ * SIMD NTT Kernels - AVX2 and AVX-512 IFMA52
+ * Each kernel carries its own target attribute, so this file builds without
+ * -mavx2/-mavx512*; CPUID decides which one runs.
+ */
+
+#include "simd.h"
+#include "simd_target.h"
+#include <atomic>
+
+namespace fhe_cpp {
+
+// ---------------------------------------------------------------------------
+// CPU detection
+// ---------------------------------------------------------------------------
+
+#ifdef FHE_X86_64
+static void cpuid(unsigned leaf, unsigned sub, unsigned regs[4]) {
+#ifdef _MSC_VER
+    int r[4];
+    __cpuidex(r, (int)leaf, (int)sub);
+    for (int i = 0; i < 4; i++) regs[i] = (unsigned)r[i];
+#else
+    __cpuid_count(leaf, sub, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static uint64_t xgetbv0() {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+#endif
+}
+#endif
+
+SimdLevel detect_simd_level() {
+#ifdef FHE_X86_64
+    unsigned r[4];
+    cpuid(0, 0, r);
+    if (r[0] < 7) return SimdLevel::Scalar;
+
+    cpuid(1, 0, r);
+    bool osxsave = (r[2] >> 27) & 1;
+    bool avx = (r[2] >> 28) & 1;
+    if (!osxsave || !avx) return SimdLevel::Scalar;
+
+    uint64_t xcr0 = xgetbv0();
+    bool ymm_state = (xcr0 & 0x6) == 0x6;
+    bool zmm_state = (xcr0 & 0xE6) == 0xE6;
+
+    cpuid(7, 0, r);
+    bool avx2 = (r[1] >> 5) & 1;
+    bool avx512f = (r[1] >> 16) & 1;
+    bool avx512ifma = (r[1] >> 21) & 1;
+
+    if (zmm_state && avx512f && avx512ifma) return SimdLevel::AVX512IFMA;
+    if (ymm_state && avx2) return SimdLevel::AVX2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+static std::atomic<int> active_level(-1);
+
+SimdLevel get_simd_level() {
+    int level = active_level.load(std::memory_order_relaxed);
+    if (level < 0) {
+        level = (int)detect_simd_level();
+        active_level.store(level, std::memory_order_relaxed);
+    }
+    return (SimdLevel)level;
+}
+
+void set_simd_level(SimdLevel level) {
+    int detected = (int)detect_simd_level();
+    int requested = (int)level;
+    active_level.store(requested < detected ? requested : detected, std::memory_order_relaxed);
+}
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX512IFMA: return "avx512ifma";
+        case SimdLevel::AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+#ifdef FHE_X86_64
+
+// ---------------------------------------------------------------------------
+// AVX2: 4 lanes, 64-bit products emulated with _mm256_mul_epu32 (q < 2^62)
+// ---------------------------------------------------------------------------
+
+FHE_TARGET("avx2")
+static inline __m256i mul_hi_epu64_avx2(__m256i a, __m256i b) {
+    const __m256i mask32 = _mm256_set1_epi64x(0xFFFFFFFFLL);
+    __m256i a_hi = _mm256_srli_epi64(a, 32);
+    __m256i b_hi = _mm256_srli_epi64(b, 32);
+
+    __m256i ll = _mm256_mul_epu32(a, b);
+    __m256i lh = _mm256_mul_epu32(a, b_hi);
+    __m256i hl = _mm256_mul_epu32(a_hi, b);
+    __m256i hh = _mm256_mul_epu32(a_hi, b_hi);
+
+    // Carry out of bits 32..63; each term is < 2^32 so the sum cannot overflow
+    __m256i mid = _mm256_add_epi64(_mm256_srli_epi64(ll, 32), _mm256_and_si256(lh, mask32));
+    mid = _mm256_add_epi64(mid, _mm256_and_si256(hl, mask32));
+
+    __m256i hi = _mm256_add_epi64(hh, _mm256_srli_epi64(lh, 32));
+    hi = _mm256_add_epi64(hi, _mm256_srli_epi64(hl, 32));
+    return _mm256_add_epi64(hi, _mm256_srli_epi64(mid, 32));
+}
+
+FHE_TARGET("avx2")
+static inline __m256i mul_lo_epu64_avx2(__m256i a, __m256i b) {
+    __m256i ll = _mm256_mul_epu32(a, b);
+    __m256i lh = _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32));
+    __m256i hl = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b);
+    return _mm256_add_epi64(ll, _mm256_slli_epi64(_mm256_add_epi64(lh, hl), 32));
+}
+
+// x >= m ? x - m : x, unsigned (sign-biased signed compare)
+FHE_TARGET("avx2")
+static inline __m256i csub_avx2(__m256i x, __m256i m) {
+    const __m256i bias = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+    __m256i lt = _mm256_cmpgt_epi64(_mm256_xor_si256(m, bias), _mm256_xor_si256(x, bias));
+    return _mm256_sub_epi64(x, _mm256_andnot_si256(lt, m));
+}
+
+FHE_TARGET("avx2")
+static inline __m256i shoup_avx2(__m256i w, __m256i w_shoup, __m256i y, __m256i vq) {
+    __m256i quot = mul_hi_epu64_avx2(w_shoup, y);
+    return _mm256_sub_epi64(mul_lo_epu64_avx2(w, y), mul_lo_epu64_avx2(quot, vq));
+}
+
+FHE_TARGET("avx2")
+static void ct_butterfly_avx2(uint64_t* x, uint64_t* y, uint64_t w, uint64_t w_shoup,
+                              size_t len, uint64_t q) {
+    const __m256i vq = _mm256_set1_epi64x((long long)q);
+    const __m256i v2q = _mm256_set1_epi64x((long long)(2 * q));
+    const __m256i vw = _mm256_set1_epi64x((long long)w);
+    const __m256i vws = _mm256_set1_epi64x((long long)w_shoup);
+    for (size_t i = 0; i < len; i += 4) {
+        __m256i u = _mm256_loadu_si256((const __m256i*)(x + i));
+        __m256i v = _mm256_loadu_si256((const __m256i*)(y + i));
+
+        u = csub_avx2(u, v2q);
+        __m256i t = shoup_avx2(vw, vws, v, vq);
+        _mm256_storeu_si256((__m256i*)(x + i), _mm256_add_epi64(u, t));
+        _mm256_storeu_si256((__m256i*)(y + i), _mm256_sub_epi64(_mm256_add_epi64(u, v2q), t));
+    }
+}
+
+FHE_TARGET("avx2")
+static void gs_butterfly_avx2(uint64_t* x, uint64_t* y, uint64_t w, uint64_t w_shoup,
+                              size_t len, uint64_t q) {
+    const __m256i vq = _mm256_set1_epi64x((long long)q);
+    const __m256i v2q = _mm256_set1_epi64x((long long)(2 * q));
+    const __m256i vw = _mm256_set1_epi64x((long long)w);
+    const __m256i vws = _mm256_set1_epi64x((long long)w_shoup);
+    for (size_t i = 0; i < len; i += 4) {
+        __m256i u = _mm256_loadu_si256((const __m256i*)(x + i));
+        __m256i v = _mm256_loadu_si256((const __m256i*)(y + i));
+
+        __m256i diff = _mm256_sub_epi64(_mm256_add_epi64(u, v2q), v);
+        _mm256_storeu_si256((__m256i*)(x + i), csub_avx2(_mm256_add_epi64(u, v), v2q));
+        _mm256_storeu_si256((__m256i*)(y + i), shoup_avx2(vw, vws, diff, vq));
+    }
+}
+
+FHE_TARGET("avx2")
+static void gs_butterfly_last_avx2(uint64_t* x, uint64_t* y, uint64_t n, uint64_t n_shoup,
+                                   uint64_t w, uint64_t w_shoup, size_t len, uint64_t q) {
+    const __m256i vq = _mm256_set1_epi64x((long long)q);
+    const __m256i v2q = _mm256_set1_epi64x((long long)(2 * q));
+    const __m256i vn = _mm256_set1_epi64x((long long)n);
+    const __m256i vns = _mm256_set1_epi64x((long long)n_shoup);
+    const __m256i vw = _mm256_set1_epi64x((long long)w);
+    const __m256i vws = _mm256_set1_epi64x((long long)w_shoup);
+    for (size_t i = 0; i < len; i += 4) {
+        __m256i u = _mm256_loadu_si256((const __m256i*)(x + i));
+        __m256i v = _mm256_loadu_si256((const __m256i*)(y + i));
+
+        __m256i sum = _mm256_add_epi64(u, v);
+        __m256i diff = _mm256_sub_epi64(_mm256_add_epi64(u, v2q), v);
+        _mm256_storeu_si256((__m256i*)(x + i), csub_avx2(shoup_avx2(vn, vns, sum, vq), vq));
+        _mm256_storeu_si256((__m256i*)(y + i), csub_avx2(shoup_avx2(vw, vws, diff, vq), vq));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// AVX-512 IFMA52: 8 lanes, native 52x52->104 products (q < 2^50 so 4q < 2^52)
+// Shoup companions are taken at 52-bit precision: floor(w 2^52 / q) = w_shoup >> 12
+// ---------------------------------------------------------------------------
+
+FHE_TARGET("avx512f,avx512ifma")
+static inline __m512i shoup_ifma(__m512i w, __m512i w_shoup, __m512i y, __m512i vq) {
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i mask52 = _mm512_set1_epi64((1LL << 52) - 1);
+    __m512i quot = _mm512_madd52hi_epu64(zero, _mm512_srli_epi64(w_shoup, 12), y);
+    __m512i wy = _mm512_madd52lo_epu64(zero, w, y);
+    __m512i qq = _mm512_madd52lo_epu64(zero, quot, vq);
+    return _mm512_and_si512(_mm512_sub_epi64(wy, qq), mask52);
+}
+
+FHE_TARGET("avx512f,avx512ifma")
+static inline __m512i csub_ifma(__m512i x, __m512i m) {
+    return _mm512_min_epu64(x, _mm512_sub_epi64(x, m));
+}
+
+FHE_TARGET("avx512f,avx512ifma")
+static void ct_butterfly_ifma(uint64_t* x, uint64_t* y, uint64_t w, uint64_t w_shoup,
+                              size_t len, uint64_t q) {
+    const __m512i vq = _mm512_set1_epi64((long long)q);
+    const __m512i v2q = _mm512_set1_epi64((long long)(2 * q));
+    const __m512i vw = _mm512_set1_epi64((long long)w);
+    const __m512i vws = _mm512_set1_epi64((long long)w_shoup);
+    for (size_t i = 0; i < len; i += 8) {
+        __m512i u = _mm512_loadu_si512((const void*)(x + i));
+        __m512i v = _mm512_loadu_si512((const void*)(y + i));
+
+        u = csub_ifma(u, v2q);
+        __m512i t = shoup_ifma(vw, vws, v, vq);
+        _mm512_storeu_si512((void*)(x + i), _mm512_add_epi64(u, t));
+        _mm512_storeu_si512((void*)(y + i), _mm512_sub_epi64(_mm512_add_epi64(u, v2q), t));
+    }
+}
+
+FHE_TARGET("avx512f,avx512ifma")
+static void gs_butterfly_ifma(uint64_t* x, uint64_t* y, uint64_t w, uint64_t w_shoup,
+                              size_t len, uint64_t q) {
+    const __m512i vq = _mm512_set1_epi64((long long)q);
+    const __m512i v2q = _mm512_set1_epi64((long long)(2 * q));
+    const __m512i vw = _mm512_set1_epi64((long long)w);
+    const __m512i vws = _mm512_set1_epi64((long long)w_shoup);
+    for (size_t i = 0; i < len; i += 8) {
+        __m512i u = _mm512_loadu_si512((const void*)(x + i));
+        __m512i v = _mm512_loadu_si512((const void*)(y + i));
+
+        __m512i diff = _mm512_sub_epi64(_mm512_add_epi64(u, v2q), v);
+        _mm512_storeu_si512((void*)(x + i), csub_ifma(_mm512_add_epi64(u, v), v2q));
+        _mm512_storeu_si512((void*)(y + i), shoup_ifma(vw, vws, diff, vq));
+    }
+}
+
+FHE_TARGET("avx512f,avx512ifma")
+static void gs_butterfly_last_ifma(uint64_t* x, uint64_t* y, uint64_t n, uint64_t n_shoup,
+                                   uint64_t w, uint64_t w_shoup, size_t len, uint64_t q) {
+    const __m512i vq = _mm512_set1_epi64((long long)q);
+    const __m512i v2q = _mm512_set1_epi64((long long)(2 * q));
+    const __m512i vn = _mm512_set1_epi64((long long)n);
+    const __m512i vns = _mm512_set1_epi64((long long)n_shoup);
+    const __m512i vw = _mm512_set1_epi64((long long)w);
+    const __m512i vws = _mm512_set1_epi64((long long)w_shoup);
+    for (size_t i = 0; i < len; i += 8) {
+        __m512i u = _mm512_loadu_si512((const void*)(x + i));
+        __m512i v = _mm512_loadu_si512((const void*)(y + i));
+
+        __m512i sum = _mm512_add_epi64(u, v);
+        __m512i diff = _mm512_sub_epi64(_mm512_add_epi64(u, v2q), v);
+        _mm512_storeu_si512((void*)(x + i), csub_ifma(shoup_ifma(vn, vns, sum, vq), vq));
+        _mm512_storeu_si512((void*)(y + i), csub_ifma(shoup_ifma(vw, vws, diff, vq), vq));
+    }
+}
+
+static const NTTKernels avx2_kernels = {
+    SimdLevel::AVX2, 4, ct_butterfly_avx2, gs_butterfly_avx2, gs_butterfly_last_avx2
+};
+
+static const NTTKernels ifma_kernels = {
+    SimdLevel::AVX512IFMA, 8, ct_butterfly_ifma, gs_butterfly_ifma, gs_butterfly_last_ifma
+};
+
+#endif // FHE_X86_64
+
+const NTTKernels* select_ntt_kernels(uint64_t q) {
+#ifdef FHE_X86_64
+    SimdLevel level = get_simd_level();
+    if (level >= SimdLevel::AVX512IFMA && (q >> 50) == 0) return &ifma_kernels;
+    if (level >= SimdLevel::AVX2 && (q >> 62) == 0) return &avx2_kernels;
+#else
+    (void)q;
+#endif
+    return nullptr;
+}
+
+} // namespace fhe_cpp
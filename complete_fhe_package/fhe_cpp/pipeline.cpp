@@ -0,0 +1,254 @@
+/*
+ * Pipelined Search Requests Implementation
+ */
+
+#include "pipeline.h"
+#include "scan.h"
+#include "serialize.h"
+#include "stats.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace fhe_cpp {
+
+// ---------------------------------------------------------------------------
+// SearchJob
+// ---------------------------------------------------------------------------
+
+SearchJob::SearchJob(std::shared_ptr<const CiphertextStore> store, int column, std::vector<uint8_t> query)
+    : store(std::move(store)), column(column), query(std::move(query)) {}
+
+bool SearchJob::failed() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return error != nullptr;
+}
+
+void SearchJob::fail(std::exception_ptr err) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!error) error = err;
+}
+
+// Called once, by the last stage to touch the job
+void SearchJob::finish() {
+    std::vector<std::function<void()>> run;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        finished = true;
+        if (error) std::vector<uint8_t>().swap(payload);
+        run.swap(callbacks);
+    }
+    // The mapping and the decoded query are no longer needed, however long the caller keeps the job
+    store.reset();
+    std::vector<ModInt>().swap(targets);
+    cv.notify_all();
+
+    // A throwing callback must not take the stage thread down with it
+    for (auto& fn : run) {
+        try {
+            fn();
+        } catch (...) {
+        }
+    }
+}
+
+bool SearchJob::done() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return finished;
+}
+
+void SearchJob::wait() {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [this] { return finished; });
+}
+
+bool SearchJob::wait_for(double seconds) {
+    std::unique_lock<std::mutex> lock(mtx);
+    return cv.wait_for(lock, std::chrono::duration<double>(seconds), [this] { return finished; });
+}
+
+const std::vector<uint8_t>& SearchJob::result() {
+    wait();
+    if (error) std::rethrow_exception(error);
+    return payload;
+}
+
+void SearchJob::add_done_callback(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!finished) {
+            callbacks.push_back(std::move(fn));
+            return;
+        }
+    }
+    fn();
+}
+
+// ---------------------------------------------------------------------------
+// SearchPipeline
+// ---------------------------------------------------------------------------
+
+SearchPipeline::SearchPipeline(size_t max_pending, size_t chunk_bytes, size_t depth)
+    : chunk_bytes(chunk_bytes), jobs(max_pending), to_scan(depth), to_encode(depth), buffers(depth + 2) {
+    if (max_pending == 0 || chunk_bytes == 0 || depth == 0) {
+        throw std::invalid_argument("Pipeline sizes must be positive");
+    }
+    for (size_t i = 0; i < depth + 2; i++) buffers.push(std::vector<ModInt>());
+
+    decode_thread = std::thread(&SearchPipeline::decode_loop, this);
+    scan_thread = std::thread(&SearchPipeline::scan_loop, this);
+    encode_thread = std::thread(&SearchPipeline::encode_loop, this);
+}
+
+SearchPipeline::~SearchPipeline() {
+    shutdown();
+}
+
+// Each queue closes only once its producer has exited, so no push is ever refused
+void SearchPipeline::shutdown() {
+    std::call_once(stopped, [this] {
+        jobs.close();
+        decode_thread.join();
+        to_scan.close();
+        scan_thread.join();
+        to_encode.close();
+        encode_thread.join();
+        buffers.close();
+    });
+}
+
+std::shared_ptr<SearchJob> SearchPipeline::try_submit(std::shared_ptr<const CiphertextStore> store,
+                                                      const std::string& column, std::vector<uint8_t> query) {
+    if (!store) throw std::invalid_argument("Search needs a store");
+    const int index = store->column_index(column);
+    auto job = std::make_shared<SearchJob>(std::move(store), index, std::move(query));
+    std::shared_ptr<SearchJob> queued = job;
+    if (!jobs.try_push(queued)) return nullptr;
+    return job;
+}
+
+// Query batch -> targets in the store's form, plus the result header and chunking
+void SearchPipeline::decode(SearchJob& job) {
+    FHE_STAT_SCOPE(Stat::PipelineDecode);
+    const CiphertextStore& st = *job.store;
+    const int N = st.get_N();
+    const ModInt q = st.get_q();
+
+    WireBatch batch = parse_ciphertexts(job.query.data(), job.query.size());
+    if (batch.N != N || batch.q != q) throw std::invalid_argument("Query does not match the store's (N, q)");
+    for (const auto& rec : batch.records) {
+        if (rec.size != 2) throw std::invalid_argument("Queries must be size-2 ciphertexts");
+    }
+
+    // Records are consecutive (c0, c1) rows, i.e. already num_targets x 2 x N
+    job.num_targets = batch.records.size();
+    job.targets.resize(batch.total_rows * (size_t)N);
+    unpack_ciphertexts(job.query.data(), batch, job.targets.data());
+    std::vector<uint8_t>().swap(job.query);
+
+    std::unique_ptr<NTT> ntt;
+    for (size_t r = 0; r < batch.records.size(); r++) {
+        if (batch.records[r].ntt_form == st.is_ntt()) continue;
+        if (!ntt) ntt.reset(new NTT(N, q));
+        for (int c = 0; c < 2; c++) {
+            ModInt* poly = job.targets.data() + (2 * r + (size_t)c) * (size_t)N;
+            if (st.is_ntt()) {
+                ntt->forward(poly);
+            } else {
+                ntt->inverse(poly);
+            }
+        }
+    }
+
+    const size_t rows = st.num_rows();
+    const size_t count = rows * job.num_targets;
+    job.payload.reserve(kWireHeaderBytes + count * wire_record_bytes(N, q, 2));
+    write_wire_header(job.payload, N, q, st.get_t(), count);
+
+    const size_t row_bytes = job.num_targets * 2 * (size_t)N * sizeof(ModInt);
+    job.rows_per_chunk = std::max<size_t>(1, row_bytes ? chunk_bytes / row_bytes : rows);
+    job.chunks = count ? (rows + job.rows_per_chunk - 1) / job.rows_per_chunk : 0;
+}
+
+void SearchPipeline::decode_loop() {
+    std::shared_ptr<SearchJob> job;
+    while (jobs.pop(job)) {
+        try {
+            decode(*job);
+        } catch (...) {
+            job->fail(std::current_exception());
+        }
+        if (job->failed() || job->chunks == 0) {
+            job->finish();
+            continue;
+        }
+
+        const size_t rows = job->store->num_rows();
+        for (size_t c = 0; c < job->chunks; c++) {
+            Chunk chunk;
+            chunk.job = job;
+            chunk.begin = c * job->rows_per_chunk;
+            chunk.end = std::min(rows, chunk.begin + job->rows_per_chunk);
+            to_scan.push(std::move(chunk));
+        }
+        job.reset();
+    }
+}
+
+void SearchPipeline::scan_loop() {
+    Chunk chunk;
+    while (to_scan.pop(chunk)) {
+        SearchJob& job = *chunk.job;
+        buffers.pop(chunk.diffs);
+        if (!job.failed()) {
+            try {
+                FHE_STAT_SCOPE(Stat::PipelineScan);
+                const CiphertextStore& st = *job.store;
+                const size_t comp_len = 2 * (size_t)st.get_N();
+                const size_t n = chunk.end - chunk.begin;
+
+                // Same paging as the store scan: read the next chunk ahead, drop this one after
+                if (chunk.begin == 0) st.advise_sequential(job.column);
+                st.prefetch_rows(job.column, chunk.end, chunk.end + n);
+                chunk.diffs.resize(n * job.num_targets * comp_len);
+                scan_subtract(st.row(job.column, chunk.begin), n, job.targets.data(), job.num_targets,
+                              comp_len, st.get_q(), chunk.diffs.data());
+                st.release_rows(job.column, chunk.begin, chunk.end);
+            } catch (...) {
+                job.fail(std::current_exception());
+            }
+        }
+        to_encode.push(std::move(chunk));
+    }
+}
+
+void SearchPipeline::encode_loop() {
+    Chunk chunk;
+    while (to_encode.pop(chunk)) {
+        SearchJob& job = *chunk.job;
+        if (!job.failed()) {
+            try {
+                FHE_STAT_SCOPE(Stat::PipelineEncode);
+                const CiphertextStore& st = *job.store;
+                const size_t N = (size_t)st.get_N();
+                const size_t count = (chunk.end - chunk.begin) * job.num_targets;
+
+                std::vector<WireCiphertext> wire(count);
+                for (size_t i = 0; i < count; i++) {
+                    const ModInt* ct = chunk.diffs.data() + i * 2 * N;
+                    wire[i].ntt_form = st.is_ntt();
+                    wire[i].components = {ct, ct + N};
+                }
+                append_ciphertexts(job.payload, (int)N, st.get_q(), wire);
+            } catch (...) {
+                job.fail(std::current_exception());
+            }
+        }
+        // Buffers keep their size, so the next resize to the same shape is free
+        buffers.push(std::move(chunk.diffs));
+        if (++job.chunks_encoded == job.chunks) job.finish();
+        chunk.job.reset();
+    }
+}
+
+} // namespace fhe_cpp
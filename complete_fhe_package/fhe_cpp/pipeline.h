@@ -0,0 +1,186 @@
+/*
+ * Pipelined Search Requests
+ * Three stage threads joined by bounded queues, so one request's stages overlap
+ * with its neighbours' and with each other on streaming row chunks:
+ *
+ *   decode : parse and unpack the query batch, bring it into the store's form,
+ *            write the result header and split the scan into row chunks
+ *   scan   : db[rows] - query[j] for one chunk into a pooled buffer (the
+ *            kernels themselves still fan out over the default thread pool)
+ *   encode : pack the chunk's differences onto the result batch, then hand the
+ *            buffer back to the pool
+ *
+ * A fixed set of chunk buffers bounds the memory in flight; the job queue bounds
+ * the requests waiting to start (try_submit refuses more). Each request is a
+ * SearchJob: a future that callers wait on or attach completion callbacks to.
+ */
+
+#ifndef FHE_PIPELINE_H
+#define FHE_PIPELINE_H
+
+#include "ntt.h"
+#include "store.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace fhe_cpp {
+
+// Multi-producer, multi-consumer FIFO of at most `capacity` items
+template <typename T>
+class BoundedQueue {
+private:
+    std::deque<T> items;
+    size_t capacity;
+    bool closed;
+    std::mutex mtx;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity), closed(false) {}
+
+    // Blocks while full; false (item dropped) once closed
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mtx);
+        not_full.wait(lock, [this] { return closed || items.size() < capacity; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    // Never blocks: false when full or closed, leaving item with the caller
+    bool try_push(T& item) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (closed || items.size() >= capacity) return false;
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    // Blocks while empty; false once closed and drained
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mtx);
+        not_empty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    // Wakes every waiter; pops still drain what was queued
+    void close() {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return items.size();
+    }
+};
+
+// One request's future: rows x targets differences of a store column against a
+// serialized query batch, as one serialized batch (row-major, the store's form)
+class SearchJob {
+private:
+    friend class SearchPipeline;
+
+    // Request
+    std::shared_ptr<const CiphertextStore> store;
+    int column;
+    std::vector<uint8_t> query;
+
+    // Filled by the decode stage; read-only afterwards
+    std::vector<ModInt> targets;        // num_targets x 2 x N, in the store's form
+    size_t num_targets = 0;
+    size_t rows_per_chunk = 0;
+    size_t chunks = 0;
+    size_t chunks_encoded = 0;          // Encode stage only
+
+    // Outcome
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool finished = false;
+    std::exception_ptr error;
+    std::vector<uint8_t> payload;
+    std::vector<std::function<void()>> callbacks;
+
+    bool failed();
+    void fail(std::exception_ptr err);
+    void finish();
+
+public:
+    SearchJob(std::shared_ptr<const CiphertextStore> store, int column, std::vector<uint8_t> query);
+
+    bool done();
+    void wait();
+    // false on timeout
+    bool wait_for(double seconds);
+
+    // Waits, then rethrows the request's error or returns the batch
+    const std::vector<uint8_t>& result();
+
+    // Runs fn once the job is done: on the finishing stage thread, or right away
+    // if it already is. fn must not block on the pipeline.
+    void add_done_callback(std::function<void()> fn);
+};
+
+class SearchPipeline {
+private:
+    struct Chunk {
+        std::shared_ptr<SearchJob> job;
+        size_t begin = 0, end = 0;      // Rows
+        std::vector<ModInt> diffs;      // (end - begin) x targets x 2N, from the buffer pool
+    };
+
+    size_t chunk_bytes;
+    BoundedQueue<std::shared_ptr<SearchJob>> jobs;
+    BoundedQueue<Chunk> to_scan;
+    BoundedQueue<Chunk> to_encode;
+    BoundedQueue<std::vector<ModInt>> buffers;
+    std::once_flag stopped;
+    std::thread decode_thread, scan_thread, encode_thread;
+
+    void decode_loop();
+    void scan_loop();
+    void encode_loop();
+    void decode(SearchJob& job);
+
+public:
+    // max_pending: requests queued ahead of the decode stage; chunk_bytes: target
+    // size of one chunk's differences; depth: chunks queued between two stages
+    // (depth + 2 buffers in all, one being scanned and one being encoded)
+    explicit SearchPipeline(size_t max_pending = 64, size_t chunk_bytes = 2 << 20, size_t depth = 2);
+    ~SearchPipeline();
+
+    SearchPipeline(const SearchPipeline&) = delete;
+    SearchPipeline& operator=(const SearchPipeline&) = delete;
+
+    // Queues a search of `column`; nullptr when max_pending requests are already
+    // waiting or the pipeline is shut down. Errors in the query surface through the job.
+    std::shared_ptr<SearchJob> try_submit(std::shared_ptr<const CiphertextStore> store,
+                                          const std::string& column, std::vector<uint8_t> query);
+
+    // Requests waiting for the decode stage
+    size_t pending() { return jobs.size(); }
+
+    // Finishes every queued request, then joins the stage threads; idempotent
+    void shutdown();
+};
+
+} // namespace fhe_cpp
+
+#endif // FHE_PIPELINE_H
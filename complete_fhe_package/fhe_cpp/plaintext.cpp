@@ -0,0 +1,194 @@
+/*
+ * Plaintext-Ciphertext Operations Implementation
+ */
+
+#include "plaintext.h"
+#include "stats.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace fhe_cpp {
+
+size_t PlaintextEvaluator::KeyHash::operator()(const std::vector<ModInt>& key) const {
+    // FNV-1a over 64-bit words, finished with a murmur-style mix
+    uint64_t h = 0xcbf29ce484222325ULL ^ key.size();
+    for (ModInt v : key) {
+        h ^= (uint64_t)v;
+        h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+PlaintextEvaluator::PlaintextEvaluator(int N, ModInt q, ModInt t, size_t capacity)
+    : ntt(N, q), N(N), q(q), t(t), delta(0), q_mod((uint64_t)q), capacity(capacity) {
+    if (!ntt.is_valid()) throw std::runtime_error("NTT init failed");
+    if (t < 2 || t >= q) throw std::invalid_argument("Plaintext modulus must be in [2, q)");
+    delta = q / t;
+}
+
+std::shared_ptr<const EncodedPlaintext> PlaintextEvaluator::build(std::vector<ModInt> key) const {
+    FHE_STAT_SCOPE(Stat::PlainEncode);
+    auto pt = std::make_shared<EncodedPlaintext>();
+    pt->N = N;
+    pt->q = q;
+    pt->t = t;
+    pt->scaled.assign((size_t)N, 0);
+    pt->lifted_ntt.assign((size_t)N, 0);
+
+    const ModInt half_t = t / 2;
+    for (size_t i = 0; i < key.size(); i++) {
+        const ModInt m = key[i];
+        pt->scaled[i] = (ModInt)q_mod.mul((uint64_t)delta, (uint64_t)m);
+        pt->lifted_ntt[i] = (m > half_t) ? m - t + q : m;
+    }
+    pt->scaled_ntt = pt->scaled;
+    ntt.forward(pt->scaled_ntt);
+    ntt.forward(pt->lifted_ntt);
+    pt->values = std::move(key);
+    return pt;
+}
+
+std::shared_ptr<const EncodedPlaintext> PlaintextEvaluator::encode(const ModInt* values, size_t count) const {
+    if (count > (size_t)N) throw std::invalid_argument("Plaintext has more than N coefficients");
+
+    std::vector<ModInt> key(values, values + count);
+    for (ModInt& v : key) {
+        v %= t;
+        if (v < 0) v += t;
+    }
+    while (!key.empty() && key.back() == 0) key.pop_back();
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            hits++;
+            lru.splice(lru.begin(), lru, it->second);
+            return *it->second;
+        }
+        misses++;
+    }
+
+    // Encoded outside the lock; a concurrent miss on the same key keeps the first insert
+    std::shared_ptr<const EncodedPlaintext> pt = build(std::move(key));
+    std::lock_guard<std::mutex> lock(mtx);
+    if (capacity == 0) return pt;
+    auto it = index.find(pt->values);
+    if (it != index.end()) return *it->second;
+
+    lru.push_front(pt);
+    index.emplace(pt->values, lru.begin());
+    while (lru.size() > capacity) {
+        index.erase(lru.back()->values);
+        lru.pop_back();
+    }
+    return pt;
+}
+
+void PlaintextEvaluator::check_ciphertext(int size) const {
+    if (size < 1) throw std::invalid_argument("Ciphertext needs at least one component");
+}
+
+void PlaintextEvaluator::check_plaintext(const EncodedPlaintext& pt) const {
+    // A handle from another evaluator would be read past its end (smaller N) or be
+    // scaled for the wrong ring
+    if (pt.N != N || pt.q != q || pt.t != t || pt.scaled.size() != (size_t)N ||
+        pt.scaled_ntt.size() != (size_t)N || pt.lifted_ntt.size() != (size_t)N) {
+        throw std::invalid_argument("Plaintext was encoded for a different (N, q, t)");
+    }
+}
+
+void PlaintextEvaluator::add_plain_into(const ModInt* ct, int size, bool ntt_form, const EncodedPlaintext& pt,
+                                        ModInt* out) const {
+    check_ciphertext(size);
+    check_plaintext(pt);
+    const size_t n = (size_t)N;
+    const std::vector<ModInt>& m = ntt_form ? pt.scaled_ntt : pt.scaled;
+    ntt.add_into(ct, m.data(), out, n);
+    if (out != ct) std::copy(ct + n, ct + (size_t)size * n, out + n);
+}
+
+void PlaintextEvaluator::sub_plain_into(const ModInt* ct, int size, bool ntt_form, const EncodedPlaintext& pt,
+                                        ModInt* out) const {
+    check_ciphertext(size);
+    check_plaintext(pt);
+    const size_t n = (size_t)N;
+    const std::vector<ModInt>& m = ntt_form ? pt.scaled_ntt : pt.scaled;
+    ntt.subtract_into(ct, m.data(), out, n);
+    if (out != ct) std::copy(ct + n, ct + (size_t)size * n, out + n);
+}
+
+void PlaintextEvaluator::multiply_plain_into(const ModInt* ct, int size, bool ntt_form,
+                                             const EncodedPlaintext& pt, ModInt* out) const {
+    check_ciphertext(size);
+    check_plaintext(pt);
+    const size_t n = (size_t)N;
+    if (out != ct) std::copy(ct, ct + (size_t)size * n, out);
+    for (int c = 0; c < size; c++) {
+        ModInt* comp = out + (size_t)c * n;
+        if (!ntt_form) ntt.forward(comp);
+        ntt.pointwise_multiply_into(comp, pt.lifted_ntt.data(), comp, n);
+        if (!ntt_form) ntt.inverse(comp);
+    }
+}
+
+void PlaintextEvaluator::scan_subtract_plain(const ModInt* db, size_t rows, int size, bool ntt_form,
+                                             const std::vector<std::shared_ptr<const EncodedPlaintext>>& targets,
+                                             ModInt* out) const {
+    check_ciphertext(size);
+    for (const auto& pt : targets) {
+        if (!pt) throw std::invalid_argument("Null plaintext target");
+        check_plaintext(*pt);
+    }
+    const size_t comp_len = (size_t)size * N;
+    const size_t num_targets = targets.size();
+
+    default_pool()->parallel_for(rows, [&](size_t r) {
+        const ModInt* row = db + r * comp_len;
+        for (size_t j = 0; j < num_targets; j++) {
+            sub_plain_into(row, size, ntt_form, *targets[j], out + (r * num_targets + j) * comp_len);
+        }
+    });
+}
+
+size_t PlaintextEvaluator::cache_size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return lru.size();
+}
+
+size_t PlaintextEvaluator::cache_capacity() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return capacity;
+}
+
+void PlaintextEvaluator::set_cache_capacity(size_t new_capacity) {
+    std::lock_guard<std::mutex> lock(mtx);
+    capacity = new_capacity;
+    while (lru.size() > capacity) {
+        index.erase(lru.back()->values);
+        lru.pop_back();
+    }
+}
+
+uint64_t PlaintextEvaluator::cache_hits() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return hits;
+}
+
+uint64_t PlaintextEvaluator::cache_misses() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return misses;
+}
+
+void PlaintextEvaluator::clear_cache() {
+    std::lock_guard<std::mutex> lock(mtx);
+    lru.clear();
+    index.clear();
+    hits = misses = 0;
+}
+
+} // namespace fhe_cpp
@@ -0,0 +1,103 @@
+/*
+ * Plaintext-Ciphertext Operations
+ * ct + m, ct - m and ct * m for a plaintext m known to the evaluator, without
+ * encrypting m: add/sub touch only c0 (by delta m) and add no noise beyond the
+ * message rounding, multiply scales each component by m lifted into (-t/2, t/2].
+ *
+ * Encoded plaintexts are kept in an LRU cache keyed by their values mod t, so a
+ * repeated constant (a search target, a mask) costs one hash lookup instead of
+ * the scaling and the forward NTTs.
+ */
+
+#ifndef FHE_PLAINTEXT_H
+#define FHE_PLAINTEXT_H
+
+#include "ntt.h"
+#include "wide_arith.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace fhe_cpp {
+
+// One plaintext in the forms the operations consume, N residues mod q each
+struct EncodedPlaintext {
+    int N = 0;                          // Ring it was encoded for; the evaluator
+    ModInt q = 0;                       // refuses plaintexts from any other
+    ModInt t = 0;
+    std::vector<ModInt> values;         // Coefficients mod t, trailing zeros trimmed (the cache key)
+    std::vector<ModInt> scaled;         // delta m, coefficient form
+    std::vector<ModInt> scaled_ntt;     // delta m, NTT form
+    std::vector<ModInt> lifted_ntt;     // m centred into (-t/2, t/2], NTT form
+};
+
+class PlaintextEvaluator {
+private:
+    struct KeyHash {
+        size_t operator()(const std::vector<ModInt>& key) const;
+    };
+    typedef std::list<std::shared_ptr<const EncodedPlaintext>> LruList;
+
+    NTT ntt;
+    int N;
+    ModInt q;
+    ModInt t;
+    ModInt delta;                       // floor(q / t), as in BFVEncryptor
+    Modulus q_mod;
+
+    // Most recently used first
+    mutable std::mutex mtx;
+    mutable LruList lru;
+    mutable std::unordered_map<std::vector<ModInt>, LruList::iterator, KeyHash> index;
+    size_t capacity;
+    mutable uint64_t hits = 0, misses = 0;
+
+    std::shared_ptr<const EncodedPlaintext> build(std::vector<ModInt> key) const;
+    void check_ciphertext(int size) const;
+
+public:
+    // capacity: encoded plaintexts kept (3 N residues each); 0 disables caching
+    PlaintextEvaluator(int N, ModInt q, ModInt t, size_t capacity = 256);
+
+    int get_N() const { return N; }
+    ModInt get_q() const { return q; }
+    ModInt get_t() const { return t; }
+
+    // Plaintext with coefficients values[0..count) (any integers, taken mod t; the
+    // rest 0), from the cache when seen before. count <= N.
+    std::shared_ptr<const EncodedPlaintext> encode(const ModInt* values, size_t count) const;
+    std::shared_ptr<const EncodedPlaintext> encode(ModInt value) const { return encode(&value, 1); }
+
+    // Throws std::invalid_argument unless pt was encoded for this (N, q, t); the
+    // operations below run it on every plaintext they are given
+    void check_plaintext(const EncodedPlaintext& pt) const;
+
+    // ct (size x N, either form) op m into out (may alias ct); the form is kept
+    void add_plain_into(const ModInt* ct, int size, bool ntt_form, const EncodedPlaintext& pt, ModInt* out) const;
+    void sub_plain_into(const ModInt* ct, int size, bool ntt_form, const EncodedPlaintext& pt, ModInt* out) const;
+    void multiply_plain_into(const ModInt* ct, int size, bool ntt_form, const EncodedPlaintext& pt,
+                             ModInt* out) const;
+
+    // Range / equality search against known targets: out[r][j] = db[r] - m_j for db
+    // rows x size x N (either form) and out rows x targets x size x N (caller-owned,
+    // not aliasing db). Only c0 changes; rows run on the default thread pool.
+    void scan_subtract_plain(const ModInt* db, size_t rows, int size, bool ntt_form,
+                             const std::vector<std::shared_ptr<const EncodedPlaintext>>& targets,
+                             ModInt* out) const;
+
+    // Cache
+    size_t cache_size() const;
+    size_t cache_capacity() const;
+    void set_cache_capacity(size_t capacity);
+    uint64_t cache_hits() const;
+    uint64_t cache_misses() const;
+    void clear_cache();
+};
+
+} // namespace fhe_cpp
+
+#endif // FHE_PLAINTEXT_H
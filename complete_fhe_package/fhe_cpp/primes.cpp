@@ -0,0 +1,241 @@
+/*
+ * Prime utilities - Miller-Rabin with a fixed witness set
+ * (Sinclair's 7 bases are sufficient for every n < 2^64)
+ *
+ * Witness powers run in Montgomery form (two multiplies per product, no
+ * division), and candidate runs p = 1 (mod 2N) are sieved by the small odd
+ * primes first, so only about one candidate in six reaches Miller-Rabin.
+ */
+
+#include "primes.h"
+#include "thread_pool.h"
+#include "wide_arith.h"
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#pragma intrinsic(_umul128)
+#pragma intrinsic(_udiv128)
+#endif
+
+namespace fhe_cpp {
+
+static uint64_t mulmod_u64(uint64_t a, uint64_t b, uint64_t m) {
+#ifdef _MSC_VER
+    unsigned __int64 high, rem;
+    unsigned __int64 low = _umul128(a, b, &high);
+    _udiv128(high, low, m, &rem);
+    return rem;
+#else
+    return (uint64_t)(((unsigned __int128)a * b) % m);
+#endif
+}
+
+// Montgomery arithmetic mod an odd n, R = 2^64
+struct Montgomery {
+    uint64_t n;
+    uint64_t n_neg_inv;                 // -n^-1 mod 2^64
+    uint64_t one;                       // R mod n
+    uint64_t r2;                        // R^2 mod n
+
+    explicit Montgomery(uint64_t n) : n(n) {
+        uint64_t inv = n;               // Newton: 5 steps from 3 correct bits
+        for (int i = 0; i < 5; i++) inv *= 2 - n * inv;
+        n_neg_inv = 0 - inv;
+        one = (0 - n) % n;
+        r2 = mulmod_u64(one, one, n);
+    }
+
+    // a b / R mod n for a, b < n
+    inline uint64_t mul(uint64_t a, uint64_t b) const {
+        uint128_w t = mul64x64(a, b);
+        uint128_w mn = mul64x64(t.low * n_neg_inv, n);
+        // t.low + mn.low = 0 (mod 2^64): it carries unless both are zero
+        uint64_t hi = t.high + mn.high;
+        bool over = hi < t.high;
+        uint64_t res = hi + (t.low != 0);
+        over |= res < hi;
+        return (over || res >= n) ? res - n : res;
+    }
+
+    uint64_t to_mont(uint64_t a) const { return mul(a % n, r2); }
+
+    uint64_t pow(uint64_t base_m, uint64_t exp) const {
+        uint64_t res = one;
+        while (exp > 0) {
+            if (exp & 1) res = mul(res, base_m);
+            base_m = mul(base_m, base_m);
+            exp >>= 1;
+        }
+        return res;
+    }
+};
+
+static const uint64_t kSmallPrimes[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+static const uint64_t kWitnesses[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+
+// Miller-Rabin proper, for odd n > 37 with no small prime factor
+static bool miller_rabin(uint64_t n) {
+    const Montgomery mont(n);
+    const uint64_t minus_one = n - mont.one;
+
+    // n - 1 = d * 2^r with d odd
+    uint64_t d = n - 1;
+    int r = 0;
+    while ((d & 1) == 0) { d >>= 1; r++; }
+
+    for (uint64_t a : kWitnesses) {
+        if (a % n == 0) continue;       // Only for n below the larger bases
+        uint64_t x = mont.pow(mont.to_mont(a), d);
+        if (x == mont.one || x == minus_one) continue;
+
+        bool composite = true;
+        for (int i = 1; i < r; i++) {
+            x = mont.mul(x, x);
+            if (x == minus_one) { composite = false; break; }
+        }
+        if (composite) return false;
+    }
+    return true;
+}
+
+bool is_prime(uint64_t n) {
+    if (n < 2) return false;
+    for (uint64_t p : kSmallPrimes) {
+        if (n % p == 0) return n == p;
+    }
+    return miller_rabin(n);
+}
+
+// Odd primes below 2^10 for the candidate sieve
+static const std::vector<uint32_t>& sieve_primes() {
+    static const std::vector<uint32_t> primes = [] {
+        const uint32_t limit = 1024;
+        std::vector<bool> composite(limit, false);
+        std::vector<uint32_t> res;
+        for (uint32_t i = 3; i < limit; i += 2) {
+            if (composite[i]) continue;
+            res.push_back(i);
+            for (uint32_t j = i * i; j < limit; j += 2 * i) composite[j] = true;
+        }
+        return res;
+    }();
+    return primes;
+}
+
+static uint64_t inv_mod_small(uint64_t a, uint64_t p) {
+    // a^(p-2) mod p; p < 2^10 so products fit easily
+    uint64_t res = 1, e = p - 2;
+    a %= p;
+    while (e > 0) {
+        if (e & 1) res = res * a % p;
+        a = a * a % p;
+        e >>= 1;
+    }
+    return res;
+}
+
+// The first `count` primes in start, start - step, ... that are above `floor`
+// and not in `skip`, in that (descending) order. Candidates go in windows: the
+// sieve strikes every multiple of a small prime, then the survivors run
+// Miller-Rabin on the default thread pool.
+static std::vector<ModInt> scan_primes_down(uint64_t start, uint64_t step, uint64_t floor, int count,
+                                            const std::set<ModInt>& skip) {
+    const std::vector<uint32_t>& small = sieve_primes();
+
+    // Candidate i is divisible by p iff i = start * step^-1 (mod p)
+    std::vector<uint32_t> step_inv(small.size());
+    for (size_t k = 0; k < small.size(); k++) {
+        const uint64_t p = small[k];
+        step_inv[k] = (step % p == 0) ? 0 : (uint32_t)inv_mod_small(step % p, p);
+    }
+
+    std::vector<ModInt> primes;
+    uint64_t cand = start;
+    std::vector<uint8_t> sieved, prime;
+    std::vector<uint64_t> survivors;
+
+    while ((int)primes.size() < count) {
+        if (cand <= floor) throw std::runtime_error("Not enough NTT-friendly primes of this size");
+        const uint64_t available = (cand - floor - 1) / step + 1;
+        const size_t window = (size_t)std::min<uint64_t>(
+            available, std::max<uint64_t>(64, std::min<uint64_t>(4096, 32 * (uint64_t)(count - primes.size()))));
+
+        sieved.assign(window, 0);
+        for (size_t k = 0; k < small.size(); k++) {
+            const uint64_t p = small[k];
+            if (step_inv[k] == 0) continue;
+            uint64_t i = (cand % p) * step_inv[k] % p;
+            for (; i < window; i += p) {
+                if (cand - i * step != p) sieved[i] = 1;
+            }
+        }
+
+        survivors.clear();
+        for (size_t i = 0; i < window; i++) {
+            if (!sieved[i]) survivors.push_back(cand - i * step);
+        }
+        prime.assign(survivors.size(), 0);
+        default_pool()->parallel_for(survivors.size(), [&](size_t i) {
+            prime[i] = is_prime(survivors[i]) ? 1 : 0;
+        });
+
+        for (size_t i = 0; i < survivors.size() && (int)primes.size() < count; i++) {
+            if (prime[i] && !skip.count((ModInt)survivors[i])) primes.push_back((ModInt)survivors[i]);
+        }
+        if (window >= available) {
+            if ((int)primes.size() < count) throw std::runtime_error("Not enough NTT-friendly primes of this size");
+            break;
+        }
+        cand -= window * step;
+    }
+    return primes;
+}
+
+// Largest candidate below 2^bits that is 1 (mod 2N)
+static uint64_t top_candidate(int N, int bits) {
+    if (bits < 2 || bits > 62) throw std::invalid_argument("bits must be in [2, 62]");
+    if (N < 1) throw std::invalid_argument("N must be positive");
+    const uint64_t m = 2 * (uint64_t)N;
+    const uint64_t upper = 1ULL << bits;
+    uint64_t cand = ((upper - 1) / m) * m + 1;
+    if (cand >= upper) cand -= m;
+    return cand;
+}
+
+std::vector<ModInt> find_ntt_primes(int N, int bits, int count) {
+    const uint64_t cand = top_candidate(N, bits);
+    if (count <= 0) return {};
+    return scan_primes_down(cand, 2 * (uint64_t)N, 2 * (uint64_t)N, count, std::set<ModInt>());
+}
+
+std::vector<ModInt> find_ntt_prime_chain(int N, const std::vector<int>& bit_sizes,
+                                         const std::vector<ModInt>& exclude) {
+    const std::set<ModInt> skip(exclude.begin(), exclude.end());
+
+    // One descending scan per distinct size, handed out in the order sizes appear
+    std::vector<ModInt> chain(bit_sizes.size());
+    std::vector<bool> done(bit_sizes.size(), false);
+    for (size_t i = 0; i < bit_sizes.size(); i++) {
+        if (done[i]) continue;
+        const int bits = bit_sizes[i];
+        const int count = (int)std::count(bit_sizes.begin() + i, bit_sizes.end(), bits);
+
+        const uint64_t cand = top_candidate(N, bits);
+        const uint64_t floor = std::max<uint64_t>(2 * (uint64_t)N, 1ULL << (bits - 1));
+        std::vector<ModInt> primes = scan_primes_down(cand, 2 * (uint64_t)N, floor, count, skip);
+
+        size_t next = 0;
+        for (size_t j = i; j < bit_sizes.size(); j++) {
+            if (bit_sizes[j] == bits) {
+                chain[j] = primes[next++];
+                done[j] = true;
+            }
+        }
+    }
+    return chain;
+}
+
+} // namespace fhe_cpp
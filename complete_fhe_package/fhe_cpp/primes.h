@@ -0,0 +1,30 @@
+/*
+ * Prime utilities for NTT-friendly moduli
+ * Deterministic Miller-Rabin for 64-bit integers
+ */
+
+#ifndef FHE_PRIMES_H
+#define FHE_PRIMES_H
+
+#include "ntt.h"
+#include <vector>
+#include <cstdint>
+
+namespace fhe_cpp {
+
+// Deterministic for all n < 2^64
+bool is_prime(uint64_t n);
+
+// Largest `count` primes p < 2^bits with p = 1 (mod 2N), in descending order
+std::vector<ModInt> find_ntt_primes(int N, int bits, int count);
+
+// One distinct prime p = 1 (mod 2N) per entry of bit_sizes, with
+// 2^(bits-1) < p < 2^bits, none of them in `exclude`. Equal sizes get
+// successively smaller primes, so {60, 40, 40, 60} gives the SEAL-style chain
+// q0 > q3 ~ 2^60 and q1 > q2 ~ 2^40.
+std::vector<ModInt> find_ntt_prime_chain(int N, const std::vector<int>& bit_sizes,
+                                         const std::vector<ModInt>& exclude = {});
+
+} // namespace fhe_cpp
+
+#endif // FHE_PRIMES_H
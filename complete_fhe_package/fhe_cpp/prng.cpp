@@ -0,0 +1,234 @@
+/*
+ * ChaCha20 Stream Generator Implementation
+ * Eight blocks per refill: AVX2 when the active SIMD level allows it, SSE2
+ * (baseline on x86-64) otherwise, and a scalar core elsewhere.
+ */
+
+#include "prng.h"
+#include "simd.h"
+#include "simd_target.h"
+#include <random>
+
+namespace fhe_cpp {
+
+static const uint32_t kSigma[4] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};  // "expand 32-byte k"
+
+// x[i][l] = word i of block counter + l
+typedef uint32_t BlockWords[16][8];
+
+static inline void init_state(const uint32_t key[8], uint64_t ctr, uint64_t stream, uint32_t x[16]) {
+    for (int i = 0; i < 4; i++) x[i] = kSigma[i];
+    for (int i = 0; i < 8; i++) x[4 + i] = key[i];
+    x[12] = (uint32_t)ctr;
+    x[13] = (uint32_t)(ctr >> 32);
+    x[14] = (uint32_t)stream;
+    x[15] = (uint32_t)(stream >> 32);
+}
+
+// ---------------------------------------------------------------------------
+// Scalar core
+// ---------------------------------------------------------------------------
+
+static inline uint32_t rotl(uint32_t x, int r) { return (x << r) | (x >> (32 - r)); }
+
+#define FHE_QR(a, b, c, d)                         \
+    a += b; d = rotl(d ^ a, 16);                   \
+    c += d; b = rotl(b ^ c, 12);                   \
+    a += b; d = rotl(d ^ a, 8);                    \
+    c += d; b = rotl(b ^ c, 7);
+
+static void block_scalar(const uint32_t key[8], uint64_t ctr, uint64_t stream, uint32_t out[16]) {
+    uint32_t in[16];
+    init_state(key, ctr, stream, in);
+
+    uint32_t x0 = in[0], x1 = in[1], x2 = in[2], x3 = in[3];
+    uint32_t x4 = in[4], x5 = in[5], x6 = in[6], x7 = in[7];
+    uint32_t x8 = in[8], x9 = in[9], x10 = in[10], x11 = in[11];
+    uint32_t x12 = in[12], x13 = in[13], x14 = in[14], x15 = in[15];
+    for (int round = 0; round < 10; round++) {
+        FHE_QR(x0, x4, x8, x12)
+        FHE_QR(x1, x5, x9, x13)
+        FHE_QR(x2, x6, x10, x14)
+        FHE_QR(x3, x7, x11, x15)
+        FHE_QR(x0, x5, x10, x15)
+        FHE_QR(x1, x6, x11, x12)
+        FHE_QR(x2, x7, x8, x13)
+        FHE_QR(x3, x4, x9, x14)
+    }
+    out[0] = x0 + in[0];    out[1] = x1 + in[1];    out[2] = x2 + in[2];    out[3] = x3 + in[3];
+    out[4] = x4 + in[4];    out[5] = x5 + in[5];    out[6] = x6 + in[6];    out[7] = x7 + in[7];
+    out[8] = x8 + in[8];    out[9] = x9 + in[9];    out[10] = x10 + in[10]; out[11] = x11 + in[11];
+    out[12] = x12 + in[12]; out[13] = x13 + in[13]; out[14] = x14 + in[14]; out[15] = x15 + in[15];
+}
+
+#undef FHE_QR
+
+#ifndef FHE_X86_64
+static void blocks8_scalar(const uint32_t key[8], uint64_t ctr, uint64_t stream, BlockWords x) {
+    uint32_t out[16];
+    for (int l = 0; l < 8; l++) {
+        block_scalar(key, ctr + (uint64_t)l, stream, out);
+        for (int i = 0; i < 16; i++) x[i][l] = out[i];
+    }
+}
+#endif
+
+#ifdef FHE_X86_64
+
+// ---------------------------------------------------------------------------
+// Vertical SIMD cores: register i holds word i of consecutive blocks
+// ---------------------------------------------------------------------------
+
+#define FHE_QR_V(ADD, XOR, ROT, a, b, c, d)                    \
+    a = ADD(a, b); d = ROT(XOR(d, a), 16);                     \
+    c = ADD(c, d); b = ROT(XOR(b, c), 12);                     \
+    a = ADD(a, b); d = ROT(XOR(d, a), 8);                      \
+    c = ADD(c, d); b = ROT(XOR(b, c), 7);
+
+#define FHE_DOUBLE_ROUND(ADD, XOR, ROT, v)                     \
+    FHE_QR_V(ADD, XOR, ROT, v[0], v[4], v[8], v[12])           \
+    FHE_QR_V(ADD, XOR, ROT, v[1], v[5], v[9], v[13])           \
+    FHE_QR_V(ADD, XOR, ROT, v[2], v[6], v[10], v[14])          \
+    FHE_QR_V(ADD, XOR, ROT, v[3], v[7], v[11], v[15])          \
+    FHE_QR_V(ADD, XOR, ROT, v[0], v[5], v[10], v[15])          \
+    FHE_QR_V(ADD, XOR, ROT, v[1], v[6], v[11], v[12])          \
+    FHE_QR_V(ADD, XOR, ROT, v[2], v[7], v[8], v[13])           \
+    FHE_QR_V(ADD, XOR, ROT, v[3], v[4], v[9], v[14])
+
+static inline __m128i rotl_sse2(__m128i x, int r) {
+    return _mm_or_si128(_mm_slli_epi32(x, r), _mm_srli_epi32(x, 32 - r));
+}
+
+// Four blocks ctr .. ctr + 3 into lanes [lane0, lane0 + 4) of x
+static void blocks4_sse2(const uint32_t key[8], uint64_t ctr, uint64_t stream, BlockWords x, int lane0) {
+    uint32_t in[16];
+    init_state(key, ctr, stream, in);
+
+    __m128i v[16], start[16];
+    for (int i = 0; i < 16; i++) v[i] = _mm_set1_epi32((int)in[i]);
+    // 64-bit counters per lane: low word + l, carried into the high word
+    uint32_t lo[4], hi[4];
+    for (int l = 0; l < 4; l++) {
+        uint64_t c = ctr + (uint64_t)l;
+        lo[l] = (uint32_t)c;
+        hi[l] = (uint32_t)(c >> 32);
+    }
+    v[12] = _mm_loadu_si128((const __m128i*)lo);
+    v[13] = _mm_loadu_si128((const __m128i*)hi);
+    for (int i = 0; i < 16; i++) start[i] = v[i];
+
+    for (int round = 0; round < 10; round++) {
+        FHE_DOUBLE_ROUND(_mm_add_epi32, _mm_xor_si128, rotl_sse2, v)
+    }
+
+    alignas(16) uint32_t tmp[4];
+    for (int i = 0; i < 16; i++) {
+        _mm_store_si128((__m128i*)tmp, _mm_add_epi32(v[i], start[i]));
+        for (int l = 0; l < 4; l++) x[i][lane0 + l] = tmp[l];
+    }
+}
+
+FHE_TARGET("avx2")
+static inline __m256i rotl_avx2(__m256i x, int r) {
+    // Byte-aligned rotations are a single shuffle
+    if (r == 16) {
+        const __m256i rot16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                               2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+        return _mm256_shuffle_epi8(x, rot16);
+    }
+    if (r == 8) {
+        const __m256i rot8 = _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                                              3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+        return _mm256_shuffle_epi8(x, rot8);
+    }
+    return _mm256_or_si256(_mm256_slli_epi32(x, r), _mm256_srli_epi32(x, 32 - r));
+}
+
+FHE_TARGET("avx2")
+static void blocks8_avx2(const uint32_t key[8], uint64_t ctr, uint64_t stream, BlockWords x) {
+    uint32_t in[16];
+    init_state(key, ctr, stream, in);
+
+    __m256i v[16], start[16];
+    for (int i = 0; i < 16; i++) v[i] = _mm256_set1_epi32((int)in[i]);
+    uint32_t lo[8], hi[8];
+    for (int l = 0; l < 8; l++) {
+        uint64_t c = ctr + (uint64_t)l;
+        lo[l] = (uint32_t)c;
+        hi[l] = (uint32_t)(c >> 32);
+    }
+    v[12] = _mm256_loadu_si256((const __m256i*)lo);
+    v[13] = _mm256_loadu_si256((const __m256i*)hi);
+    for (int i = 0; i < 16; i++) start[i] = v[i];
+
+    for (int round = 0; round < 10; round++) {
+        FHE_DOUBLE_ROUND(_mm256_add_epi32, _mm256_xor_si256, rotl_avx2, v)
+    }
+
+    for (int i = 0; i < 16; i++) {
+        _mm256_storeu_si256((__m256i*)x[i], _mm256_add_epi32(v[i], start[i]));
+    }
+}
+
+#undef FHE_DOUBLE_ROUND
+#undef FHE_QR_V
+
+#endif // FHE_X86_64
+
+static void blocks8(const uint32_t key[8], uint64_t ctr, uint64_t stream, BlockWords x) {
+#ifdef FHE_X86_64
+    if (get_simd_level() >= SimdLevel::AVX2) {
+        blocks8_avx2(key, ctr, stream, x);
+    } else {
+        blocks4_sse2(key, ctr, stream, x, 0);
+        blocks4_sse2(key, ctr + 4, stream, x, 4);
+    }
+#else
+    blocks8_scalar(key, ctr, stream, x);
+#endif
+}
+
+Seed random_seed() {
+    std::random_device rd;
+    Seed seed;
+    for (size_t i = 0; i < seed.size(); i += 4) {
+        uint32_t w = rd();
+        for (int b = 0; b < 4; b++) seed[i + b] = (uint8_t)(w >> (8 * b));
+    }
+    return seed;
+}
+
+ChaCha20::ChaCha20(const Seed& seed, uint64_t stream) : stream(stream), counter(0), pos(kLanes * 8) {
+    for (int i = 0; i < 8; i++) {
+        key[i] = (uint32_t)seed[4 * i] | ((uint32_t)seed[4 * i + 1] << 8) |
+                 ((uint32_t)seed[4 * i + 2] << 16) | ((uint32_t)seed[4 * i + 3] << 24);
+    }
+}
+
+void ChaCha20::refill() {
+    BlockWords x;
+    blocks8(key, counter, stream, x);
+    counter += kLanes;
+
+    // Block-major little-endian keystream, as a byte-serial ChaCha20 would emit it
+    for (int l = 0; l < kLanes; l++) {
+        for (int w = 0; w < 8; w++) {
+            buf[l * 8 + w] = (uint64_t)x[2 * w][l] | ((uint64_t)x[2 * w + 1][l] << 32);
+        }
+    }
+    pos = 0;
+}
+
+void ChaCha20::fill(uint64_t* out, size_t n) {
+    size_t i = 0;
+    while (i < n) {
+        if (pos == kLanes * 8) refill();
+        while (pos < kLanes * 8 && i < n) out[i++] = buf[pos++];
+    }
+}
+
+void ChaCha20::block(const uint32_t key[8], uint64_t counter, uint64_t stream, uint32_t out[16]) {
+    block_scalar(key, counter, stream, out);
+}
+
+} // namespace fhe_cpp
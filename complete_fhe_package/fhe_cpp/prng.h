@@ -0,0 +1,50 @@
+/*
+ * ChaCha20 Stream Generator
+ * 20-round ChaCha keyed by a 32-byte seed, with a 64-bit block counter and a
+ * 64-bit stream id. Keystream is produced eight blocks at a time with the
+ * SSE2/AVX2 kernels in prng.cpp; the output is identical on every path.
+ */
+
+#ifndef FHE_PRNG_H
+#define FHE_PRNG_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace fhe_cpp {
+
+typedef std::array<uint8_t, 32> Seed;
+
+// 32 bytes from the OS entropy source (std::random_device)
+Seed random_seed();
+
+class ChaCha20 {
+private:
+    static const int kLanes = 8;
+
+    uint32_t key[8];
+    uint64_t stream;
+    uint64_t counter;                   // Next block number
+    uint64_t buf[kLanes * 8];           // kLanes blocks of keystream
+    int pos;
+
+    void refill();
+
+public:
+    explicit ChaCha20(const Seed& seed, uint64_t stream = 0);
+
+    uint64_t next() {
+        if (pos == kLanes * 8) refill();
+        return buf[pos++];
+    }
+
+    void fill(uint64_t* out, size_t n);
+
+    // One raw block (for test vectors): words 12-13 = counter, 14-15 = stream
+    static void block(const uint32_t key[8], uint64_t counter, uint64_t stream, uint32_t out[16]);
+};
+
+} // namespace fhe_cpp
+
+#endif // FHE_PRNG_H
@@ -0,0 +1,231 @@
+/*
+ * RNS Polynomial Implementation
+ */
+
+#include "rns.h"
+#include "primes.h"
+#include <stdexcept>
+
+namespace fhe_cpp {
+
+RNSContext::RNSContext(int N, const std::vector<ModInt>& primes) : N(N), primes(primes) {
+    if (primes.empty()) throw std::invalid_argument("RNS basis needs at least one prime");
+
+    for (size_t i = 0; i < primes.size(); i++) {
+        uint64_t p = (uint64_t)primes[i];
+        if (primes[i] < 2 || (p >> 61) != 0) throw std::invalid_argument("RNS primes must be in [2, 2^61)");
+        if (!is_prime(p)) throw std::invalid_argument("RNS modulus is not prime");
+        for (size_t j = 0; j < i; j++) {
+            if (primes[j] == primes[i]) throw std::invalid_argument("RNS primes must be distinct");
+        }
+    }
+
+    ntts.reserve(primes.size());
+    mods.reserve(primes.size());
+    for (ModInt p : primes) {
+        ntts.emplace_back(N, p);
+        if (!ntts.back().is_valid()) throw std::runtime_error("NTT init failed");
+        mods.emplace_back((uint64_t)p);
+    }
+}
+
+void RNSContext::check(const RNSPoly& a) const {
+    if (a.num_limbs() != size()) throw std::invalid_argument("RNS polynomial has wrong number of limbs");
+    for (const auto& limb : a.limbs) {
+        if ((int)limb.size() != N) throw std::invalid_argument("RNS limb has wrong length");
+    }
+}
+
+int RNSContext::modulus_bits() const {
+    int bits = 0;
+    for (ModInt p : primes) {
+        int b = 0;
+        while (b < 64 && ((uint64_t)p >> b) != 0) b++;
+        bits += b;
+    }
+    return bits;
+}
+
+RNSPoly RNSContext::from_signed(const std::vector<int64_t>& coeffs) const {
+    if ((int)coeffs.size() != N) throw std::invalid_argument("Polynomial has wrong length");
+
+    RNSPoly res(size(), N);
+    for (int i = 0; i < size(); i++) {
+        ModInt p = primes[i];
+        for (int j = 0; j < N; j++) {
+            ModInt r = coeffs[j] % p;
+            res[i][j] = (r < 0) ? r + p : r;
+        }
+    }
+    return res;
+}
+
+static void check_same_form(const RNSPoly& a, const RNSPoly& b) {
+    if (a.ntt_form != b.ntt_form) throw std::invalid_argument("RNS polynomials are in different forms");
+}
+
+void RNSContext::forward(RNSPoly& a) const {
+    check(a);
+    if (a.ntt_form) throw std::invalid_argument("RNS polynomial is already in NTT form");
+    for (int i = 0; i < size(); i++) ntts[i].forward(a[i]);
+    a.ntt_form = true;
+}
+
+void RNSContext::inverse(RNSPoly& a) const {
+    check(a);
+    if (!a.ntt_form) throw std::invalid_argument("RNS polynomial is already in coefficient form");
+    for (int i = 0; i < size(); i++) ntts[i].inverse(a[i]);
+    a.ntt_form = false;
+}
+
+void RNSContext::to_ntt(RNSPoly& a) const {
+    if (!a.ntt_form) forward(a);
+}
+
+void RNSContext::to_coeff(RNSPoly& a) const {
+    if (a.ntt_form) inverse(a);
+}
+
+RNSPoly RNSContext::add(const RNSPoly& a, const RNSPoly& b) const {
+    check(a); check(b);
+    check_same_form(a, b);
+    RNSPoly res;
+    res.ntt_form = a.ntt_form;
+    res.limbs.reserve(size());
+    for (int i = 0; i < size(); i++) res.limbs.push_back(ntts[i].add(a[i], b[i]));
+    return res;
+}
+
+RNSPoly RNSContext::subtract(const RNSPoly& a, const RNSPoly& b) const {
+    check(a); check(b);
+    check_same_form(a, b);
+    RNSPoly res;
+    res.ntt_form = a.ntt_form;
+    res.limbs.reserve(size());
+    for (int i = 0; i < size(); i++) res.limbs.push_back(ntts[i].subtract(a[i], b[i]));
+    return res;
+}
+
+RNSPoly RNSContext::negate(const RNSPoly& a) const {
+    check(a);
+    RNSPoly res(size(), N, a.ntt_form);
+    for (int i = 0; i < size(); i++) {
+        ModInt p = primes[i];
+        for (int j = 0; j < N; j++) res[i][j] = (a[i][j] == 0) ? 0 : p - a[i][j];
+    }
+    return res;
+}
+
+RNSPoly RNSContext::scalar_mul(const RNSPoly& a, ModInt scalar) const {
+    check(a);
+    RNSPoly res;
+    res.ntt_form = a.ntt_form;
+    res.limbs.reserve(size());
+    for (int i = 0; i < size(); i++) res.limbs.push_back(ntts[i].scalar_mul(a[i], scalar));
+    return res;
+}
+
+RNSPoly RNSContext::multiply(const RNSPoly& a, const RNSPoly& b) const {
+    check(a); check(b);
+    if (a.ntt_form || b.ntt_form) {
+        if (a.ntt_form && b.ntt_form) return pointwise_multiply(a, b);
+        RNSPoly c = a.ntt_form ? b : a;
+        forward(c);
+        return pointwise_multiply(a.ntt_form ? a : b, c);
+    }
+
+    RNSPoly res;
+    res.limbs.reserve(size());
+    for (int i = 0; i < size(); i++) res.limbs.push_back(ntts[i].multiply(a[i], b[i]));
+    return res;
+}
+
+RNSPoly RNSContext::pointwise_multiply(const RNSPoly& a, const RNSPoly& b) const {
+    check(a); check(b);
+    if (!a.ntt_form || !b.ntt_form) throw std::invalid_argument("Pointwise product needs NTT-form operands");
+    RNSPoly res;
+    res.ntt_form = true;
+    res.limbs.reserve(size());
+    for (int i = 0; i < size(); i++) res.limbs.push_back(ntts[i].pointwise_multiply(a[i], b[i]));
+    return res;
+}
+
+RNSBaseConverter::RNSBaseConverter(const RNSContext& from, const RNSContext& to)
+    : N(from.get_N()) {
+    if (to.get_N() != N) throw std::invalid_argument("RNS bases have different ring degrees");
+    if (from.size() > kMaxLimbs) throw std::invalid_argument("Source RNS basis too large for base conversion");
+
+    const int k = from.size();
+    const int l = to.size();
+    for (int i = 0; i < k; i++) from_mods.push_back(from.modulus(i));
+    for (int j = 0; j < l; j++) to_mods.push_back(to.modulus(j));
+
+    // (Q/q_i)^-1 mod q_i
+    q_hat_inv.resize(k);
+    q_hat_inv_shoup.resize(k);
+    for (int i = 0; i < k; i++) {
+        const Modulus& q_i = from_mods[i];
+        uint64_t q_hat = 1;
+        for (int m = 0; m < k; m++) {
+            if (m != i) q_hat = q_i.mul(q_hat, q_i.reduce(from_mods[m].value()));
+        }
+        q_hat_inv[i] = q_i.pow(q_hat, q_i.value() - 2);
+        q_hat_inv_shoup[i] = q_i.shoup(q_hat_inv[i]);
+    }
+
+    // Q/q_i and Q mod p_j
+    q_hat_mod_p.assign(l, std::vector<uint64_t>(k, 0));
+    q_mod_p.resize(l);
+    for (int j = 0; j < l; j++) {
+        const Modulus& p_j = to_mods[j];
+        uint64_t prod = 1;
+        for (int i = 0; i < k; i++) {
+            uint64_t q_hat = 1;
+            for (int m = 0; m < k; m++) {
+                if (m != i) q_hat = p_j.mul(q_hat, p_j.reduce(from_mods[m].value()));
+            }
+            q_hat_mod_p[j][i] = q_hat;
+            prod = p_j.mul(prod, p_j.reduce(from_mods[i].value()));
+        }
+        q_mod_p[j] = prod;
+    }
+}
+
+void RNSBaseConverter::convert(const RNSPoly& in, RNSPoly& out) const {
+    const int k = (int)from_mods.size();
+    const int l = (int)to_mods.size();
+    if (in.num_limbs() != k) throw std::invalid_argument("RNS polynomial has wrong number of limbs");
+    if (in.ntt_form) throw std::invalid_argument("Base conversion needs coefficient form");
+
+    out.limbs.assign(l, std::vector<ModInt>(N));
+    uint64_t y[kMaxLimbs];
+
+    for (int c = 0; c < N; c++) {
+        // y_i = [x_i (Q/q_i)^-1]_{q_i}; frac = sum_i y_i / q_i in 64-bit fixed point
+        uint128_w frac = {0, 0};
+        for (int i = 0; i < k; i++) {
+            const Modulus& q_i = from_mods[i];
+            uint64_t v = mul_shoup_lazy(q_hat_inv[i], q_hat_inv_shoup[i], (uint64_t)in[i][c], q_i.value());
+            if (v >= q_i.value()) v -= q_i.value();
+            y[i] = v;
+            frac = add128(frac, {q_i.shoup(v), 0});
+        }
+        // Multiple of Q to remove: round(frac)
+        uint64_t v = frac.high + (frac.low >> 63);
+
+        for (int j = 0; j < l; j++) {
+            const Modulus& p_j = to_mods[j];
+            const std::vector<uint64_t>& q_hat = q_hat_mod_p[j];
+
+            // y_i < 2^61, k <= 8: the un-reduced sum stays below 2^128
+            uint128_w acc = {0, 0};
+            for (int i = 0; i < k; i++) acc = add128(acc, mul64x64(y[i], q_hat[i]));
+
+            uint64_t r = p_j.reduce(p_j.reduce(acc.high), acc.low);
+            uint64_t vq = p_j.mul(p_j.reduce(v), q_mod_p[j]);
+            out[j][c] = (ModInt)((r >= vq) ? r - vq : r + p_j.value() - vq);
+        }
+    }
+}
+
+} // namespace fhe_cpp
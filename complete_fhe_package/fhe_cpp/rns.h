@@ -0,0 +1,111 @@
+/*
+ * RNS (Residue Number System) Polynomials
+ * Q = q_0 * q_1 * ... * q_{k-1} over NTT-friendly word-sized primes.
+ * Every ring operation runs limb by limb; only base conversion mixes limbs.
+ */
+
+#ifndef FHE_RNS_H
+#define FHE_RNS_H
+
+#include "ntt.h"
+#include "wide_arith.h"
+#include <vector>
+#include <cstdint>
+
+namespace fhe_cpp {
+
+// Polynomial over Z_Q: limbs[i][j] = coefficient j mod q_i, or NTT slot j mod q_i
+// in evaluation form. The flag travels with the data, so a reused operand is
+// transformed once and only converted back when an operation needs coefficients.
+struct RNSPoly {
+    std::vector<std::vector<ModInt>> limbs;
+    bool ntt_form = false;
+
+    RNSPoly() = default;
+    RNSPoly(int num_limbs, int N, bool ntt_form = false)
+        : limbs(num_limbs, std::vector<ModInt>(N, 0)), ntt_form(ntt_form) {}
+
+    int num_limbs() const { return (int)limbs.size(); }
+    std::vector<ModInt>& operator[](int i) { return limbs[i]; }
+    const std::vector<ModInt>& operator[](int i) const { return limbs[i]; }
+};
+
+// A chain of distinct primes q_i = 1 (mod 2N), q_i < 2^61, each with its own NTT tables
+class RNSContext {
+private:
+    int N;
+    std::vector<ModInt> primes;
+    std::vector<NTT> ntts;
+    std::vector<Modulus> mods;
+
+public:
+    RNSContext(int N, const std::vector<ModInt>& primes);
+
+    // Throws unless a has one length-N limb per prime
+    void check(const RNSPoly& a) const;
+
+    int get_N() const { return N; }
+    int size() const { return (int)primes.size(); }
+    ModInt prime(int i) const { return primes[i]; }
+    const std::vector<ModInt>& get_primes() const { return primes; }
+    const NTT& ntt(int i) const { return ntts[i]; }
+    const Modulus& modulus(int i) const { return mods[i]; }
+
+    // Sum of the prime bit lengths (an upper bound on log2 Q)
+    int modulus_bits() const;
+
+    // Residues of small signed coefficients (messages, secrets, errors)
+    RNSPoly from_signed(const std::vector<int64_t>& coeffs) const;
+
+    // Per-limb negacyclic transforms; throw if a is already in the target form
+    void forward(RNSPoly& a) const;
+    void inverse(RNSPoly& a) const;
+
+    // Same, but a no-op when a is already in the target form
+    void to_ntt(RNSPoly& a) const;
+    void to_coeff(RNSPoly& a) const;
+
+    // Element-wise in either form; add and subtract need both operands in the same one
+    RNSPoly add(const RNSPoly& a, const RNSPoly& b) const;
+    RNSPoly subtract(const RNSPoly& a, const RNSPoly& b) const;
+    RNSPoly negate(const RNSPoly& a) const;
+    RNSPoly scalar_mul(const RNSPoly& a, ModInt scalar) const;
+
+    // Negacyclic product. Two coefficient-form operands give a coefficient-form
+    // result; otherwise the coefficient-form operand is transformed and the
+    // product stays in evaluation form.
+    RNSPoly multiply(const RNSPoly& a, const RNSPoly& b) const;
+
+    // Element-wise product of two NTT-domain polynomials
+    RNSPoly pointwise_multiply(const RNSPoly& a, const RNSPoly& b) const;
+};
+
+/*
+ * Fast base conversion Q -> P (Halevi-Polyakov-Shoup):
+ *   x = sum_i [x_i (Q/q_i)^-1]_{q_i} * (Q/q_i) - v Q
+ * with v = round(sum_i [x_i (Q/q_i)^-1]_{q_i} / q_i) taken in 64-bit fixed point,
+ * so the output is the centred lift of x in [-Q/2, Q/2) reduced mod every p_j.
+ * The source basis has at most kMaxLimbs primes.
+ */
+class RNSBaseConverter {
+private:
+    int N;
+    std::vector<Modulus> from_mods;
+    std::vector<Modulus> to_mods;
+    std::vector<uint64_t> q_hat_inv;                   // [(Q/q_i)^-1]_{q_i}
+    std::vector<uint64_t> q_hat_inv_shoup;
+    std::vector<std::vector<uint64_t>> q_hat_mod_p;    // [j][i] = [Q/q_i]_{p_j}
+    std::vector<uint64_t> q_mod_p;                     // [Q]_{p_j}
+
+public:
+    static const int kMaxLimbs = 8;
+
+    RNSBaseConverter(const RNSContext& from, const RNSContext& to);
+
+    // Coefficient-form input over the source basis; out gets one limb per target prime
+    void convert(const RNSPoly& in, RNSPoly& out) const;
+};
+
+} // namespace fhe_cpp
+
+#endif // FHE_RNS_H
@@ -0,0 +1,126 @@
+/*
+ * Polynomial Sampling Implementation
+ */
+
+#include "sampling.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace fhe_cpp {
+
+static const int kBatch = 64;           // Keystream words fetched per fill
+
+static ChaCha20& engine() {
+    thread_local ChaCha20 gen(random_seed());
+    return gen;
+}
+
+static void uniform_into(ChaCha20& gen, ModInt* out, int n, ModInt q) {
+    if (q < 2) throw std::invalid_argument("Modulus must be at least 2");
+
+    // Rejection on the smallest covering power of two: exact and at most 2 draws on average.
+    // Every word is written and the index only advances on acceptance, so the loop has no
+    // data-dependent branch; words are consumed strictly in order, independent of batching.
+    uint64_t mask = (uint64_t)q - 1;
+    for (int s = 1; s < 64; s <<= 1) mask |= mask >> s;
+
+    uint64_t buf[kBatch];
+    int i = 0;
+    while (i < n) {
+        const int want = std::min(kBatch, n - i);
+        gen.fill(buf, (size_t)want);
+        for (int j = 0; j < want; j++) {
+            uint64_t r = buf[j] & mask;
+            out[i] = (ModInt)r;
+            i += (r < (uint64_t)q);
+        }
+    }
+}
+
+std::vector<ModInt> sample_uniform(int n, ModInt q) {
+    std::vector<ModInt> res(n);
+    uniform_into(engine(), res.data(), n, q);
+    return res;
+}
+
+std::vector<ModInt> expand_uniform(const Seed& seed, uint64_t stream, int n, ModInt q) {
+    ChaCha20 gen(seed, stream);
+    std::vector<ModInt> res(n);
+    uniform_into(gen, res.data(), n, q);
+    return res;
+}
+
+std::vector<ModInt> sample_ternary(int n) {
+    // 32 two-bit draws per word; the value 3 is rejected, leaving {0, 1, 2} - 1
+    ChaCha20& gen = engine();
+    std::vector<ModInt> res(n);
+    uint64_t buf[kBatch];
+    int i = 0;
+    while (i < n) {
+        // 3/4 acceptance: ask for enough words that one fill usually finishes
+        const int want = std::min(kBatch, (n - i + 23) / 24);
+        gen.fill(buf, (size_t)want);
+        for (int j = 0; j < want && i < n; j++) {
+            uint64_t w = buf[j];
+            for (int k = 0; k < 32 && i < n; k++, w >>= 2) {
+                int r = (int)(w & 3);
+                res[i] = r - 1;
+                i += (r != 3);
+            }
+        }
+    }
+    return res;
+}
+
+// CDT over |x| in [0, bound]: cdt[k] = 2^63 P(|x| <= k), with the mass beyond bound
+// folded into the last entry (clipping) so that cdt[bound] = 2^63
+static std::vector<uint64_t> build_cdt(double sigma, int64_t bound) {
+    // P(round(X) = k) for X ~ N(0, sigma^2), via erfc to keep the tail accurate
+    auto tail = [sigma](double x) { return 0.5 * std::erfc(x / (sigma * std::sqrt(2.0))); };
+
+    std::vector<uint64_t> cdt((size_t)bound + 1);
+    const double scale = 9223372036854775808.0;                 // 2^63
+    double cum = 0.0;
+    for (int64_t k = 0; k < bound; k++) {
+        cum += (k == 0) ? 1.0 - 2.0 * tail(0.5) : 2.0 * (tail(k - 0.5) - tail(k + 0.5));
+        cdt[(size_t)k] = (cum >= 1.0) ? (1ULL << 63) : (uint64_t)(cum * scale);
+    }
+    cdt[(size_t)bound] = 1ULL << 63;
+    return cdt;
+}
+
+std::vector<ModInt> sample_gaussian(int n, double sigma, int64_t bound) {
+    if (sigma <= 0) throw std::invalid_argument("sigma must be positive");
+    if (bound < 0 || bound > (1 << 16)) throw std::invalid_argument("bound must be in [0, 65536]");
+
+    // One table per thread, rebuilt only when the parameters change
+    thread_local double cached_sigma = 0.0;
+    thread_local int64_t cached_bound = -1;
+    thread_local std::vector<uint64_t> cdt;
+    if (sigma != cached_sigma || bound != cached_bound) {
+        cdt = build_cdt(sigma, bound);
+        cached_sigma = sigma;
+        cached_bound = bound;
+    }
+
+    ChaCha20& gen = engine();
+    std::vector<ModInt> res(n);
+    uint64_t buf[kBatch];
+    const int64_t entries = bound;                              // cdt[bound] never counts
+    for (int i = 0; i < n; i += kBatch) {
+        const int cnt = std::min(kBatch, n - i);
+        gen.fill(buf, (size_t)cnt);
+        for (int j = 0; j < cnt; j++) {
+            // Low 63 bits pick |x| by a full scan (no early exit), the top bit the sign
+            const uint64_t r = buf[j] & ((1ULL << 63) - 1);
+            int64_t mag = 0;
+            for (int64_t k = 0; k < entries; k++) mag += (int64_t)(r >= cdt[(size_t)k]);
+            const int64_t neg = -(int64_t)(buf[j] >> 63);       // 0 or -1
+            res[i + j] = (mag ^ neg) - neg;
+        }
+    }
+    return res;
+}
+
+} // namespace fhe_cpp
@@ -0,0 +1,34 @@
+/*
+ * Polynomial Sampling
+ * Uniform, ternary and discrete-Gaussian coefficients for key generation and
+ * encryption, drawn from ChaCha20 keystream. Each thread owns a generator keyed
+ * from std::random_device, so samplers are safe to call from the thread pool.
+ */
+
+#ifndef FHE_SAMPLING_H
+#define FHE_SAMPLING_H
+
+#include "ntt.h"
+#include "prng.h"
+#include <vector>
+#include <cstdint>
+
+namespace fhe_cpp {
+
+// n residues uniform in [0, q)
+std::vector<ModInt> sample_uniform(int n, ModInt q);
+
+// n coefficients uniform in {-1, 0, 1}
+std::vector<ModInt> sample_ternary(int n);
+
+// round(N(0, sigma^2)) clipped to [-bound, bound], as DiscreteGaussian.sample_bounded.
+// Sampled by a constant-time scan of a 63-bit cumulative table.
+std::vector<ModInt> sample_gaussian(int n, double sigma, int64_t bound);
+
+// Deterministic uniform polynomial: the same (seed, stream, n, q) always gives the
+// same residues, so a uniform "a" can travel as its 32-byte seed
+std::vector<ModInt> expand_uniform(const Seed& seed, uint64_t stream, int n, ModInt q);
+
+} // namespace fhe_cpp
+
+#endif // FHE_SAMPLING_H
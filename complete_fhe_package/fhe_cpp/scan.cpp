@@ -0,0 +1,75 @@
+/*
+ * Blind Search Scan Kernels Implementation
+ */
+
+#include "scan.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace fhe_cpp {
+
+static const size_t kRowsPerTask = 16;          // Rows per pool task
+static const size_t kTileBytes = 16 * 1024;     // db tile + query tiles kept under ~L1/L2
+static const size_t kStreamRows = 1024;         // Rows per paging step for store scans
+
+// out[i] = a[i] - b[i] mod q, branch-free so the loop vectorizes
+static inline void sub_mod(const ModInt* a, const ModInt* b, ModInt* out, size_t n, ModInt q) {
+    for (size_t i = 0; i < n; i++) {
+        const ModInt d = a[i] - b[i];
+        out[i] = d + (q & (d >> 63));
+    }
+}
+
+// Rows [begin, end) against every query
+static void scan_rows(const ModInt* db, size_t begin, size_t end,
+                      const ModInt* queries, size_t num_queries,
+                      size_t comp_len, ModInt q, ModInt* out) {
+    // Tile width: one db tile plus num_queries query tiles fit kTileBytes (at least 256 values)
+    size_t tile = kTileBytes / (sizeof(ModInt) * (num_queries + 1));
+    tile = std::max<size_t>(256, tile / 8 * 8);
+    tile = std::min(tile, comp_len);
+
+    for (size_t r = begin; r < end; r++) {
+        const ModInt* row = db + r * comp_len;
+        ModInt* out_row = out + r * num_queries * comp_len;
+        for (size_t k = 0; k < comp_len; k += tile) {
+            const size_t len = std::min(tile, comp_len - k);
+            for (size_t j = 0; j < num_queries; j++) {
+                sub_mod(row + k, queries + j * comp_len + k, out_row + j * comp_len + k, len, q);
+            }
+        }
+    }
+}
+
+void scan_subtract(const ModInt* db, size_t rows,
+                   const ModInt* queries, size_t num_queries,
+                   size_t comp_len, ModInt q, ModInt* out) {
+    if (q < 2) throw std::invalid_argument("Modulus must be at least 2");
+    if (rows == 0 || num_queries == 0 || comp_len == 0) return;
+
+    const size_t blocks = (rows + kRowsPerTask - 1) / kRowsPerTask;
+    default_pool()->parallel_for(blocks, [&](size_t b) {
+        const size_t begin = b * kRowsPerTask;
+        scan_rows(db, begin, std::min(rows, begin + kRowsPerTask), queries, num_queries, comp_len, q, out);
+    });
+}
+
+void scan_subtract(const CiphertextStore& store, int column,
+                   const ModInt* queries, size_t num_queries, ModInt* out) {
+    const ModInt* db = store.column_data(column);
+    const size_t rows = store.num_rows();
+    const size_t comp_len = 2 * (size_t)store.get_N();
+    if (rows == 0 || num_queries == 0) return;
+
+    store.advise_sequential(column);
+    for (size_t begin = 0; begin < rows; begin += kStreamRows) {
+        const size_t end = std::min(rows, begin + kStreamRows);
+        store.prefetch_rows(column, end, end + kStreamRows);
+        scan_subtract(db + begin * comp_len, end - begin, queries, num_queries, comp_len, store.get_q(),
+                      out + begin * num_queries * comp_len);
+        store.release_rows(column, begin, end);
+    }
+}
+
+} // namespace fhe_cpp
@@ -0,0 +1,36 @@
+/*
+ * Blind Search Scan Kernels
+ * Row-by-target homomorphic subtraction over a contiguous ciphertext matrix:
+ * out[r][j] = db[r] - query[j], component-wise mod q. An encrypted equality
+ * test decrypts each difference and checks for zero; a range query is a set of
+ * targets. Subtraction is linear, so it holds in either form as long as the
+ * database and the queries share one.
+ */
+
+#ifndef FHE_SCAN_H
+#define FHE_SCAN_H
+
+#include "ntt.h"
+#include "store.h"
+#include <cstddef>
+
+namespace fhe_cpp {
+
+// db: rows x comp_len residues in [0, q), queries: num_queries x comp_len, with
+// comp_len = size * N for size-component ciphertexts. out (rows x num_queries x
+// comp_len) is caller-owned and must not alias the inputs. Row blocks run on the
+// default thread pool; within a block, coefficient tiles keep one db row tile and
+// every query tile cache-resident.
+void scan_subtract(const ModInt* db, size_t rows,
+                   const ModInt* queries, size_t num_queries,
+                   size_t comp_len, ModInt q, ModInt* out);
+
+// Same over a store column (size-2 rows, queries in the store's form), streamed in
+// blocks of rows: the next block is prefetched and finished blocks are released, so
+// resident memory does not grow with the table
+void scan_subtract(const CiphertextStore& store, int column,
+                   const ModInt* queries, size_t num_queries, ModInt* out);
+
+} // namespace fhe_cpp
+
+#endif // FHE_SCAN_H
@@ -0,0 +1,304 @@
+/*
+ * Binary Ciphertext Serialization Implementation
+ */
+
+#include "serialize.h"
+#include "sampling.h"
+#include "thread_pool.h"
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace fhe_cpp {
+
+static const uint8_t kMagic[4] = {'F', 'H', 'E', 'B'};
+static const size_t kRecordHeaderBytes = 8;        // body_bytes, size, flags, reserved
+static const size_t kRecordFixedBytes = 4;         // Counted in body_bytes
+
+// ---------------------------------------------------------------------------
+// Little-endian field access (memcpy keeps unaligned reads well-defined)
+// ---------------------------------------------------------------------------
+
+template <typename T>
+static inline T load_le(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    T r = 0;
+    for (size_t i = 0; i < sizeof(T); i++) r = (T)((r << 8) | ((v >> (8 * i)) & 0xff));
+    v = r;
+#endif
+    return v;
+}
+
+template <typename T>
+static inline void store_le(uint8_t* p, T v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    T r = 0;
+    for (size_t i = 0; i < sizeof(T); i++) r = (T)((r << 8) | ((v >> (8 * i)) & 0xff));
+    v = r;
+#endif
+    std::memcpy(p, &v, sizeof(T));
+}
+
+// Bytes of one packed polynomial, padded to whole words
+static inline size_t packed_bytes(int n, int bits) {
+    return (((size_t)n * (size_t)bits + 63) / 64) * 8;
+}
+
+// ---------------------------------------------------------------------------
+// Bit packing: coefficient i occupies bits [i bits, (i + 1) bits) of the word stream
+// ---------------------------------------------------------------------------
+
+static void pack_poly(const ModInt* a, int n, int bits, uint64_t q, uint8_t* out) {
+    uint64_t acc = 0;
+    int fill = 0;
+    for (int i = 0; i < n; i++) {
+        const uint64_t v = (uint64_t)a[i];
+        if (v >= q) throw std::invalid_argument("Coefficient out of range [0, q)");
+        acc |= v << fill;
+        fill += bits;
+        if (fill >= 64) {
+            store_le<uint64_t>(out, acc);
+            out += 8;
+            fill -= 64;
+            acc = fill ? v >> (bits - fill) : 0;
+        }
+    }
+    if (fill) store_le<uint64_t>(out, acc);
+}
+
+static void unpack_poly(const uint8_t* in, int n, int bits, uint64_t q, ModInt* out) {
+    const uint64_t mask = (1ULL << bits) - 1;
+    uint64_t acc = 0;
+    int avail = 0;
+    uint64_t bad = 0;                   // Checked once at the end: no branch per coefficient
+    for (int i = 0; i < n; i++) {
+        uint64_t v;
+        if (avail >= bits) {
+            v = acc & mask;
+            acc >>= bits;
+            avail -= bits;
+        } else {
+            const uint64_t next = load_le<uint64_t>(in);
+            in += 8;
+            v = (acc | (next << avail)) & mask;
+            acc = next >> (bits - avail);
+            avail += 64 - bits;
+        }
+        out[i] = (ModInt)v;
+        bad |= (uint64_t)(v >= q);
+    }
+    if (bad) throw std::invalid_argument("Serialized coefficient out of range [0, q)");
+}
+
+int wire_coeff_bits(ModInt q) {
+    if (q < 2) throw std::invalid_argument("Modulus must be at least 2");
+    int bits = 0;
+    while (((uint64_t)(q - 1) >> bits) != 0) bits++;
+    return bits;
+}
+
+void write_wire_header(std::vector<uint8_t>& out, int N, ModInt q, ModInt t, size_t count) {
+    if (N <= 0) throw std::invalid_argument("N must be positive");
+    if (count > UINT32_MAX) throw std::invalid_argument("Too many ciphertexts for one batch");
+    const int bits = wire_coeff_bits(q);
+
+    const size_t pos = out.size();
+    out.resize(pos + kWireHeaderBytes, 0);
+    uint8_t* p = out.data() + pos;
+    std::memcpy(p, kMagic, 4);
+    store_le<uint16_t>(p + 4, kWireVersion);
+    p[6] = (uint8_t)bits;
+    store_le<uint32_t>(p + 8, (uint32_t)N);
+    store_le<uint64_t>(p + 12, (uint64_t)q);
+    store_le<uint64_t>(p + 20, (uint64_t)t);
+    store_le<uint32_t>(p + 28, (uint32_t)count);
+}
+
+void append_ciphertexts(std::vector<uint8_t>& out, int N, ModInt q, const std::vector<WireCiphertext>& cts) {
+    if (N <= 0) throw std::invalid_argument("N must be positive");
+    const int bits = wire_coeff_bits(q);
+    const size_t comp_bytes = packed_bytes(N, bits);
+
+    // Record offsets first, so the packing below can run in parallel
+    std::vector<size_t> offsets(cts.size());
+    size_t total = out.size();
+    for (size_t r = 0; r < cts.size(); r++) {
+        const WireCiphertext& ct = cts[r];
+        const int size = (int)ct.components.size();
+        if (size < 1 || size > kWireMaxSize) throw std::invalid_argument("Ciphertext size out of range");
+        if (ct.seeded && size < 2) throw std::invalid_argument("Seeded ciphertext needs a c1");
+        offsets[r] = total;
+        total += wire_record_bytes(N, q, size, ct.seeded);
+    }
+    out.resize(total, 0);
+
+    default_pool()->parallel_for(cts.size(), [&](size_t r) {
+        const WireCiphertext& ct = cts[r];
+        const int size = (int)ct.components.size();
+        uint8_t* rec = out.data() + offsets[r];
+        const size_t body = (r + 1 < cts.size() ? offsets[r + 1] : total) - offsets[r] - 4;
+        store_le<uint32_t>(rec, (uint32_t)body);
+        rec[4] = (uint8_t)size;
+        rec[5] = (uint8_t)((ct.ntt_form ? kWireNTT : 0) | (ct.seeded ? kWireSeededC1 : 0));
+        rec += kRecordHeaderBytes;
+        if (ct.seeded) {
+            std::memcpy(rec, ct.c1_seed.data(), ct.c1_seed.size());
+            rec += ct.c1_seed.size();
+        }
+        for (int c = 0; c < size; c++) {
+            if (ct.seeded && c == 1) continue;
+            pack_poly(ct.components[c], N, bits, (uint64_t)q, rec);
+            rec += comp_bytes;
+        }
+    });
+}
+
+size_t wire_record_bytes(int N, ModInt q, int size, bool seeded) {
+    const int stored = size - (seeded ? 1 : 0);
+    return kRecordHeaderBytes + (seeded ? Seed().size() : 0) + (size_t)stored * packed_bytes(N, wire_coeff_bits(q));
+}
+
+std::vector<uint8_t> serialize_ciphertexts(int N, ModInt q, ModInt t, const std::vector<WireCiphertext>& cts) {
+    std::vector<uint8_t> out;
+    write_wire_header(out, N, q, t, cts.size());
+    append_ciphertexts(out, N, q, cts);
+    return out;
+}
+
+WireBatch parse_ciphertexts(const uint8_t* data, size_t len) {
+    if (len < kWireHeaderBytes || std::memcmp(data, kMagic, 4) != 0) {
+        throw std::invalid_argument("Not a serialized ciphertext batch");
+    }
+    if (load_le<uint16_t>(data + 4) != kWireVersion) {
+        throw std::invalid_argument("Unsupported ciphertext format version");
+    }
+
+    WireBatch batch;
+    const uint32_t N = load_le<uint32_t>(data + 8);
+    const uint64_t q = load_le<uint64_t>(data + 12);
+    const uint64_t t = load_le<uint64_t>(data + 20);
+    const uint32_t count = load_le<uint32_t>(data + 28);
+    if (N == 0 || (N & (N - 1)) != 0 || N > (1u << 20)) throw std::invalid_argument("Invalid N in header");
+    if (q < 2 || q >= (1ULL << 63) || t < 2 || t >= q) throw std::invalid_argument("Invalid moduli in header");
+    batch.N = (int)N;
+    batch.q = (ModInt)q;
+    batch.t = (ModInt)t;
+    batch.coeff_bits = wire_coeff_bits(batch.q);
+    if (data[6] != batch.coeff_bits) throw std::invalid_argument("Coefficient width does not match q");
+
+    const size_t comp_bytes = packed_bytes(batch.N, batch.coeff_bits);
+    size_t pos = kWireHeaderBytes;
+    batch.records.reserve(count);
+    for (uint32_t r = 0; r < count; r++) {
+        if (len - pos < kRecordHeaderBytes) throw std::invalid_argument("Truncated ciphertext record");
+        const uint32_t body = load_le<uint32_t>(data + pos);
+        const int size = data[pos + 4];
+        const uint8_t flags = data[pos + 5];
+
+        WireBatch::Record rec;
+        rec.size = size;
+        rec.ntt_form = (flags & kWireNTT) != 0;
+        rec.seeded = (flags & kWireSeededC1) != 0;
+        if (size < 1 || size > kWireMaxSize || (flags & ~(kWireNTT | kWireSeededC1)) != 0 ||
+            (rec.seeded && size < 2)) {
+            throw std::invalid_argument("Invalid ciphertext record header");
+        }
+
+        const int stored = size - (rec.seeded ? 1 : 0);
+        const size_t seed_bytes = rec.seeded ? rec.c1_seed.size() : 0;
+        if ((size_t)body != kRecordFixedBytes + seed_bytes + (size_t)stored * comp_bytes) {
+            throw std::invalid_argument("Ciphertext record length mismatch");
+        }
+        if (len - pos - 4 < (size_t)body) throw std::invalid_argument("Truncated ciphertext record");
+
+        if (rec.seeded) std::memcpy(rec.c1_seed.data(), data + pos + kRecordHeaderBytes, seed_bytes);
+        rec.data_offset = pos + kRecordHeaderBytes + seed_bytes;
+        rec.row = batch.total_rows;
+        batch.total_rows += (size_t)size;
+        batch.records.push_back(rec);
+        pos += 4 + (size_t)body;
+    }
+    if (pos != len) throw std::invalid_argument("Trailing bytes after ciphertext batch");
+    return batch;
+}
+
+// Byte offset where record r starts (its u32 body_bytes field)
+static size_t record_start(const WireBatch::Record& rec) {
+    return rec.data_offset - kRecordHeaderBytes - (rec.seeded ? rec.c1_seed.size() : 0);
+}
+
+std::vector<uint8_t> slice_ciphertexts(const uint8_t* data, size_t len, size_t begin, size_t end) {
+    WireBatch batch = parse_ciphertexts(data, len);
+    if (begin > end || end > batch.records.size()) throw std::invalid_argument("Record range out of bounds");
+
+    const size_t from = begin < batch.records.size() ? record_start(batch.records[begin]) : len;
+    const size_t to = end < batch.records.size() ? record_start(batch.records[end]) : len;
+    std::vector<uint8_t> out(kWireHeaderBytes + (to - from));
+    std::memcpy(out.data(), data, kWireHeaderBytes);
+    store_le<uint32_t>(out.data() + 28, (uint32_t)(end - begin));
+    std::memcpy(out.data() + kWireHeaderBytes, data + from, to - from);
+    return out;
+}
+
+std::vector<uint8_t> concat_ciphertexts(const std::vector<std::pair<const uint8_t*, size_t>>& batches) {
+    if (batches.empty()) throw std::invalid_argument("Nothing to concatenate");
+
+    size_t count = 0, total = kWireHeaderBytes;
+    WireBatch first;
+    for (size_t i = 0; i < batches.size(); i++) {
+        WireBatch batch = parse_ciphertexts(batches[i].first, batches[i].second);
+        if (i == 0) {
+            first = std::move(batch);
+        } else if (batch.N != first.N || batch.q != first.q || batch.t != first.t) {
+            throw std::invalid_argument("Batches do not share (N, q, t)");
+        }
+        count += i == 0 ? first.records.size() : batch.records.size();
+        total += batches[i].second - kWireHeaderBytes;
+    }
+    if (count > UINT32_MAX) throw std::invalid_argument("Too many ciphertexts for one batch");
+
+    std::vector<uint8_t> out(total);
+    std::memcpy(out.data(), batches[0].first, kWireHeaderBytes);
+    store_le<uint32_t>(out.data() + 28, (uint32_t)count);
+    size_t pos = kWireHeaderBytes;
+    for (const auto& b : batches) {
+        std::memcpy(out.data() + pos, b.first + kWireHeaderBytes, b.second - kWireHeaderBytes);
+        pos += b.second - kWireHeaderBytes;
+    }
+    return out;
+}
+
+void unpack_ciphertexts(const uint8_t* data, const WireBatch& batch, ModInt* out) {
+    const int N = batch.N;
+    const size_t comp_bytes = packed_bytes(N, batch.coeff_bits);
+
+    // Seeded NTT-form records need c1 transformed after expansion
+    std::unique_ptr<NTT> ntt;
+    for (const auto& rec : batch.records) {
+        if (rec.seeded && rec.ntt_form) {
+            ntt.reset(new NTT(N, batch.q));
+            if (!ntt->is_valid()) throw std::invalid_argument("Seeded NTT-form record needs an NTT-friendly q");
+            break;
+        }
+    }
+
+    default_pool()->parallel_for(batch.records.size(), [&](size_t r) {
+        const WireBatch::Record& rec = batch.records[r];
+        const uint8_t* src = data + rec.data_offset;
+        for (int c = 0; c < rec.size; c++) {
+            ModInt* row = out + (rec.row + (size_t)c) * (size_t)N;
+            if (rec.seeded && c == 1) {
+                std::vector<ModInt> a = expand_uniform(rec.c1_seed, 0, N, batch.q);
+                if (rec.ntt_form) ntt->forward(a);
+                std::memcpy(row, a.data(), (size_t)N * sizeof(ModInt));
+                continue;
+            }
+            unpack_poly(src, N, batch.coeff_bits, (uint64_t)batch.q, row);
+            src += comp_bytes;
+        }
+    });
+}
+
+} // namespace fhe_cpp
@@ -0,0 +1,96 @@
+/*
+ * Binary Ciphertext Serialization
+ * Versioned little-endian wire format for batches of ciphertexts that share one
+ * (N, q, t). Coefficients are bit-packed to ceil(log2 q) bits and a seeded c1
+ * travels as its 32-byte seed. Decoding is split into a header pass and an
+ * unpack pass, so callers can allocate one (rows, N) buffer and fill it directly.
+ *
+ *   batch  : "FHEB"  u16 version  u8 coeff_bits  u8 reserved
+ *            u32 N  u64 q  u64 t  u32 count  u32 reserved
+ *            count x record
+ *   record : u32 body_bytes  u8 size  u8 flags  u16 reserved
+ *            [32-byte seed if flags & kWireSeededC1]
+ *            one packed polynomial per stored component, as whole u64 words
+ */
+
+#ifndef FHE_SERIALIZE_H
+#define FHE_SERIALIZE_H
+
+#include "ntt.h"
+#include "prng.h"
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace fhe_cpp {
+
+const uint16_t kWireVersion = 1;
+const size_t kWireHeaderBytes = 36;
+const int kWireMaxSize = 16;            // Components per ciphertext
+
+// Record flags
+const uint8_t kWireNTT = 1;             // Components are in NTT (evaluation) form
+const uint8_t kWireSeededC1 = 2;        // c1 = expand_uniform(seed, 0, N, q), coefficient form
+
+// One ciphertext to write; components[i] points at N residues in [0, q).
+// With seeded, components[1] is not read and the caller vouches for the seed.
+struct WireCiphertext {
+    std::vector<const ModInt*> components;
+    bool ntt_form = false;
+    bool seeded = false;
+    Seed c1_seed;
+};
+
+// Parsed batch layout; rows count every component, seeded ones included
+struct WireBatch {
+    struct Record {
+        size_t data_offset;             // Byte offset of the first packed component
+        size_t row;                     // First output row
+        int size;
+        bool ntt_form;
+        bool seeded;
+        Seed c1_seed;
+    };
+
+    int N = 0;
+    ModInt q = 0;
+    ModInt t = 0;
+    int coeff_bits = 0;
+    std::vector<Record> records;
+    size_t total_rows = 0;
+};
+
+// ceil(log2 q): bits per packed coefficient
+int wire_coeff_bits(ModInt q);
+
+std::vector<uint8_t> serialize_ciphertexts(int N, ModInt q, ModInt t, const std::vector<WireCiphertext>& cts);
+
+// Streaming form of serialize_ciphertexts: write the header for `count` records, then
+// append the records in any number of calls. The batch is only valid once exactly
+// `count` records follow the header.
+void write_wire_header(std::vector<uint8_t>& out, int N, ModInt q, ModInt t, size_t count);
+void append_ciphertexts(std::vector<uint8_t>& out, int N, ModInt q, const std::vector<WireCiphertext>& cts);
+
+// Encoded size of one record with `size` components; a seeded record stores its
+// 32-byte seed in place of c1
+size_t wire_record_bytes(int N, ModInt q, int size, bool seeded = false);
+
+// Records [begin, end) of a batch as a batch of their own, copied as-is (seeds stay
+// seeds): the row range one shard of a sharded store holds
+std::vector<uint8_t> slice_ciphertexts(const uint8_t* data, size_t len, size_t begin, size_t end);
+
+// Batches over one (N, q, t) joined in order, e.g. a sharded scan's partial results
+std::vector<uint8_t> concat_ciphertexts(const std::vector<std::pair<const uint8_t*, size_t>>& batches);
+
+// Validates the header and every record length; throws std::invalid_argument on malformed input
+WireBatch parse_ciphertexts(const uint8_t* data, size_t len);
+
+// Unpacks every record of a parsed batch into out (total_rows x N), expanding seeded
+// c1 components (and transforming them for NTT-form records). Throws if any
+// coefficient is not below q.
+void unpack_ciphertexts(const uint8_t* data, const WireBatch& batch, ModInt* out);
+
+} // namespace fhe_cpp
+
+#endif // FHE_SERIALIZE_H
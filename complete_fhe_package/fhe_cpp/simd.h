@@ -0,0 +1,60 @@
+/*
+ * SIMD NTT Kernels with Runtime Dispatch
+ * AVX-512 IFMA52 for q < 2^50, AVX2 (32x32->64 emulation) for q < 2^62.
+ * The instruction set is chosen by CPUID at run time, not at build time.
+ */
+
+#ifndef FHE_SIMD_H
+#define FHE_SIMD_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace fhe_cpp {
+
+enum class SimdLevel {
+    Scalar = 0,
+    AVX2 = 1,
+    AVX512IFMA = 2
+};
+
+// Highest level supported by the CPU and OS (CPUID + XGETBV)
+SimdLevel detect_simd_level();
+
+// Level used by the kernels; defaults to detect_simd_level()
+SimdLevel get_simd_level();
+
+// Caps the active level (e.g. to compare kernels); clamped to what the CPU supports
+void set_simd_level(SimdLevel level);
+
+const char* simd_level_name(SimdLevel level);
+
+// Lazy-reduction butterflies over one block of the merged negacyclic NTT:
+// x and y are the two contiguous halves, all `len` butterflies share the twiddle
+// w < q (Shoup companion floor(w * 2^64 / q)); `len` is a multiple of `width`.
+struct NTTKernels {
+    SimdLevel level;
+    int width;
+
+    // Cooley-Tukey, inputs in [0, 4q):
+    // x[i], y[i] <- x[i] + w y[i], x[i] - w y[i] + 2q   (outputs in [0, 4q))
+    void (*ct_butterfly)(uint64_t* x, uint64_t* y, uint64_t w, uint64_t w_shoup,
+                         size_t len, uint64_t q);
+
+    // Gentleman-Sande, inputs in [0, 2q):
+    // x[i], y[i] <- x[i] + y[i], (x[i] - y[i] + 2q) w   (outputs in [0, 2q))
+    void (*gs_butterfly)(uint64_t* x, uint64_t* y, uint64_t w, uint64_t w_shoup,
+                         size_t len, uint64_t q);
+
+    // Last Gentleman-Sande stage with N^-1 folded in (n = N^-1, w = N^-1 * root):
+    // x[i], y[i] <- (x[i] + y[i]) n, (x[i] - y[i] + 2q) w   (outputs in [0, q))
+    void (*gs_butterfly_last)(uint64_t* x, uint64_t* y, uint64_t n, uint64_t n_shoup,
+                              uint64_t w, uint64_t w_shoup, size_t len, uint64_t q);
+};
+
+// Best kernels for modulus q at the active level; nullptr means use the scalar path
+const NTTKernels* select_ntt_kernels(uint64_t q);
+
+} // namespace fhe_cpp
+
+#endif // FHE_SIMD_H
@@ -0,0 +1,27 @@
+/*
+ * SIMD Build Helpers (internal)
+ * FHE_X86_64 marks x86-64 builds, where <immintrin.h> is available.
+ * FHE_TARGET(isa) enables an instruction set for one function, so files with
+ * runtime-dispatched kernels build without -mavx2/-mavx512*.
+ */
+
+#ifndef FHE_SIMD_TARGET_H
+#define FHE_SIMD_TARGET_H
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FHE_X86_64 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define FHE_TARGET(isa)
+#else
+#define FHE_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+#endif // FHE_SIMD_TARGET_H
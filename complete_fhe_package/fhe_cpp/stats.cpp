@@ -0,0 +1,164 @@
+/*
+ * Hot-Path Instrumentation Implementation
+ */
+
+#include "stats.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace fhe_cpp {
+
+static const int kNumStats = (int)Stat::Count;
+static const double kMinCalibrationSeconds = 0.01;
+
+namespace {
+
+// One thread's slots. Only the owner writes (relaxed load + store, no locked
+// instructions); snapshots read them relaxed from any thread.
+struct ThreadStats {
+    std::atomic<uint64_t> calls[kNumStats];
+    std::atomic<uint64_t> cycles[kNumStats];
+    std::atomic<uint64_t> bytes[kNumStats];
+
+    ThreadStats();
+    ~ThreadStats();
+
+    static void bump(std::atomic<uint64_t>& v, uint64_t x) {
+        v.store(v.load(std::memory_order_relaxed) + x, std::memory_order_relaxed);
+    }
+};
+
+struct StatsRegistry {
+    std::mutex mutex;
+    std::vector<ThreadStats*> threads;
+    StatTotals retired[kNumStats];    // Threads that have exited
+    StatTotals baseline[kNumStats];   // Totals at the last reset
+
+    // Clock pair for the tick rate
+    uint64_t start_ticks;
+    std::chrono::steady_clock::time_point start_time;
+
+    StatsRegistry() : start_ticks(stat_ticks()), start_time(std::chrono::steady_clock::now()) {}
+
+    // Lifetime totals; caller holds the mutex
+    void totals(StatTotals* out) const {
+        for (int s = 0; s < kNumStats; s++) out[s] = retired[s];
+        for (const ThreadStats* t : threads) {
+            for (int s = 0; s < kNumStats; s++) {
+                out[s].calls += t->calls[s].load(std::memory_order_relaxed);
+                out[s].cycles += t->cycles[s].load(std::memory_order_relaxed);
+                out[s].bytes += t->bytes[s].load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+// Never destroyed: pool threads may still exit after static destructors run
+StatsRegistry& registry() {
+    static StatsRegistry* reg = new StatsRegistry();
+    return *reg;
+}
+
+ThreadStats::ThreadStats() {
+    for (int s = 0; s < kNumStats; s++) {
+        calls[s].store(0, std::memory_order_relaxed);
+        cycles[s].store(0, std::memory_order_relaxed);
+        bytes[s].store(0, std::memory_order_relaxed);
+    }
+    StatsRegistry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.threads.push_back(this);
+}
+
+ThreadStats::~ThreadStats() {
+    StatsRegistry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (int s = 0; s < kNumStats; s++) {
+        reg.retired[s].calls += calls[s].load(std::memory_order_relaxed);
+        reg.retired[s].cycles += cycles[s].load(std::memory_order_relaxed);
+        reg.retired[s].bytes += bytes[s].load(std::memory_order_relaxed);
+    }
+    reg.threads.erase(std::find(reg.threads.begin(), reg.threads.end(), this));
+}
+
+ThreadStats& thread_stats() {
+    thread_local ThreadStats stats;
+    return stats;
+}
+
+} // namespace
+
+const char* stat_name(Stat s) {
+    switch (s) {
+        case Stat::NTTForward: return "ntt_forward";
+        case Stat::NTTInverse: return "ntt_inverse";
+        case Stat::PointwiseMultiply: return "pointwise_multiply";
+        case Stat::Tensor: return "tensor";
+        case Stat::ScaleRound: return "scale_round";
+        case Stat::KeySwitch: return "key_switch";
+        case Stat::NumpyCopy: return "numpy_copy";
+        case Stat::ArenaGrow: return "arena_grow";
+        case Stat::PipelineDecode: return "pipeline_decode";
+        case Stat::PipelineScan: return "pipeline_scan";
+        case Stat::PipelineEncode: return "pipeline_encode";
+        case Stat::PlainEncode: return "plain_encode";
+        default: return "unknown";
+    }
+}
+
+bool stats_enabled() {
+#ifdef FHE_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void stat_record(Stat s, uint64_t cycles, uint64_t bytes) {
+    ThreadStats& t = thread_stats();
+    const int i = (int)s;
+    ThreadStats::bump(t.calls[i], 1);
+    if (cycles) ThreadStats::bump(t.cycles[i], cycles);
+    if (bytes) ThreadStats::bump(t.bytes[i], bytes);
+}
+
+std::vector<StatTotals> snapshot_stats() {
+    StatsRegistry& reg = registry();
+    StatTotals now[kNumStats];
+    std::vector<StatTotals> res(kNumStats);
+
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.totals(now);
+    for (int s = 0; s < kNumStats; s++) {
+        res[s].calls = now[s].calls - reg.baseline[s].calls;
+        res[s].cycles = now[s].cycles - reg.baseline[s].cycles;
+        res[s].bytes = now[s].bytes - reg.baseline[s].bytes;
+    }
+    return res;
+}
+
+// A baseline rather than zeroing the slots: other threads own those
+void reset_stats() {
+    StatsRegistry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.totals(reg.baseline);
+}
+
+double stat_ticks_per_second() {
+#ifdef FHE_X86_64
+    StatsRegistry& reg = registry();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - reg.start_time).count();
+    if (elapsed < kMinCalibrationSeconds) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(kMinCalibrationSeconds - elapsed));
+    }
+    const uint64_t ticks = stat_ticks() - reg.start_ticks;
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - reg.start_time).count();
+    return (double)ticks / elapsed;
+#else
+    return 1e9;
+#endif
+}
+
+} // namespace fhe_cpp
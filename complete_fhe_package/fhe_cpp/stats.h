@@ -0,0 +1,93 @@
+/*
+ * Hot-Path Instrumentation
+ * Per-thread call counts, TSC cycle totals and byte counts for the kernels a
+ * request spends its time in. Each thread writes only its own slots (no
+ * atomics read-modify-write, no locks); snapshot_stats() sums every live
+ * thread plus the totals of threads that have exited.
+ *
+ * Compiled in when FHE_STATS is defined (CMake option FHE_ENABLE_STATS);
+ * otherwise FHE_STAT_SCOPE / FHE_STAT_BYTES expand to nothing and snapshots
+ * are all zero. Timers are inclusive: key switching includes its NTTs.
+ */
+
+#ifndef FHE_STATS_H
+#define FHE_STATS_H
+
+#include "simd_target.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace fhe_cpp {
+
+enum class Stat {
+    NTTForward = 0,
+    NTTInverse,
+    PointwiseMultiply,
+    Tensor,             // BFVMultiplier::multiply_into, scale-and-round included
+    ScaleRound,
+    KeySwitch,
+    NumpyCopy,          // Bytes copied from NumPy into std::vector (numpy_to_vector)
+    ArenaGrow,          // Heap blocks taken by the scratch arenas
+    PipelineDecode,     // SearchPipeline stages, per query / per row chunk
+    PipelineScan,
+    PipelineEncode,
+    PlainEncode,        // PlaintextEvaluator cache misses (scaling and forward NTTs)
+    Count
+};
+
+struct StatTotals {
+    uint64_t calls = 0;
+    uint64_t cycles = 0;
+    uint64_t bytes = 0;
+};
+
+const char* stat_name(Stat s);
+bool stats_enabled();
+
+// Adds one call to the calling thread's slot
+void stat_record(Stat s, uint64_t cycles, uint64_t bytes);
+
+// Totals per Stat since the last reset_stats(), indexed by (int)Stat
+std::vector<StatTotals> snapshot_stats();
+void reset_stats();
+
+// Timer ticks per second (the TSC rate on x86-64, measured against steady_clock)
+double stat_ticks_per_second();
+
+inline uint64_t stat_ticks() {
+#ifdef FHE_X86_64
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Times the enclosing scope as one call of `s`
+class StatScope {
+private:
+    Stat stat;
+    uint64_t start;
+
+public:
+    explicit StatScope(Stat s) : stat(s), start(stat_ticks()) {}
+    ~StatScope() { stat_record(stat, stat_ticks() - start, 0); }
+    StatScope(const StatScope&) = delete;
+    StatScope& operator=(const StatScope&) = delete;
+};
+
+} // namespace fhe_cpp
+
+#define FHE_STAT_CONCAT_(a, b) a##b
+#define FHE_STAT_CONCAT(a, b) FHE_STAT_CONCAT_(a, b)
+
+#ifdef FHE_STATS
+#define FHE_STAT_SCOPE(s) ::fhe_cpp::StatScope FHE_STAT_CONCAT(fhe_stat_scope_, __LINE__)(s)
+#define FHE_STAT_BYTES(s, n) ::fhe_cpp::stat_record((s), 0, (uint64_t)(n))
+#else
+#define FHE_STAT_SCOPE(s) ((void)0)
+#define FHE_STAT_BYTES(s, n) ((void)0)
+#endif
+
+#endif // FHE_STATS_H
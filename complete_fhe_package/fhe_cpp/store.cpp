@@ -0,0 +1,329 @@
+/*
+ * Memory-Mapped Ciphertext Store Implementation
+ */
+
+#include "store.h"
+#include "serialize.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fhe_cpp {
+
+static const uint8_t kStoreMagic[4] = {'F', 'H', 'E', 'S'};
+static const size_t kPageBytes = 4096;
+static const size_t kHeaderFixedBytes = 40;
+static const size_t kColumnEntryBytes = kStoreNameBytes + 8;
+
+static inline size_t round_up_page(size_t n) {
+    return (n + kPageBytes - 1) / kPageBytes * kPageBytes;
+}
+
+static bool host_is_little_endian() {
+    const uint16_t probe = 1;
+    uint8_t first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+// Header fields are read with memcpy; the store is only produced and consumed on
+// little-endian hosts, where the raw column data can be used in place
+template <typename T>
+static inline T load_field(const uint8_t* p) { T v; std::memcpy(&v, p, sizeof(T)); return v; }
+
+template <typename T>
+static inline void store_field(uint8_t* p, T v) { std::memcpy(p, &v, sizeof(T)); }
+
+// ---------------------------------------------------------------------------
+// File mapping
+// ---------------------------------------------------------------------------
+
+struct CiphertextStore::Mapping {
+    uint8_t* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+    // size == 0: map an existing file read-only; otherwise create/truncate it to size, read-write
+    Mapping(const std::string& path, size_t create_size) {
+        const bool writable = create_size != 0;
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ | (writable ? GENERIC_WRITE : 0),
+                           FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                           writable ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open store file: " + path);
+        if (writable) {
+            size = create_size;
+        } else {
+            LARGE_INTEGER len;
+            if (!GetFileSizeEx(file, &len)) { release(); throw std::runtime_error("Cannot stat store file"); }
+            size = (size_t)len.QuadPart;
+        }
+        if (size == 0) { release(); throw std::invalid_argument("Store file is empty"); }
+        mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                     (DWORD)((uint64_t)size >> 32), (DWORD)(size & 0xffffffffu), nullptr);
+        if (!mapping) { release(); throw std::runtime_error("Cannot map store file"); }
+        data = static_cast<uint8_t*>(MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size));
+        if (!data) { release(); throw std::runtime_error("Cannot map store file"); }
+#else
+        int fd = writable ? ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)
+                          : ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Cannot open store file: " + path);
+        if (writable) {
+            size = create_size;
+            if (::ftruncate(fd, (off_t)size) != 0) { ::close(fd); throw std::runtime_error("Cannot size store file"); }
+        } else {
+            struct stat st;
+            if (::fstat(fd, &st) != 0) { ::close(fd); throw std::runtime_error("Cannot stat store file"); }
+            size = (size_t)st.st_size;
+        }
+        if (size == 0) { ::close(fd); throw std::invalid_argument("Store file is empty"); }
+        void* p = ::mmap(nullptr, size, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, fd, 0);
+        ::close(fd);                    // The mapping keeps the file referenced
+        if (p == MAP_FAILED) throw std::runtime_error("Cannot map store file");
+        data = static_cast<uint8_t*>(p);
+#endif
+    }
+
+    ~Mapping() { release(); }
+
+    void flush() {
+#ifdef _WIN32
+        FlushViewOfFile(data, 0);
+        FlushFileBuffers(file);
+#else
+        ::msync(data, size, MS_SYNC);
+#endif
+    }
+
+    // Page-aligned madvise over [offset, offset + len)
+    void advise(size_t offset, size_t len, int how) const {
+#if defined(_WIN32)
+        (void)offset; (void)len; (void)how;
+#else
+        const size_t begin = offset / kPageBytes * kPageBytes;
+        const size_t end = std::min(size, round_up_page(offset + len));
+        if (end > begin) ::madvise(data + begin, end - begin, how);
+#endif
+    }
+
+private:
+    void release() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        data = nullptr;
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (data) ::munmap(data, size);
+        data = nullptr;
+#endif
+    }
+};
+
+static void replace_file(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    if (!MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        throw std::runtime_error("Cannot replace store file: " + to);
+    }
+#else
+    if (std::rename(from.c_str(), to.c_str()) != 0) throw std::runtime_error("Cannot replace store file: " + to);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Store
+// ---------------------------------------------------------------------------
+
+CiphertextStore::CiphertextStore(const std::string& path) {
+    if (!host_is_little_endian()) throw std::runtime_error("Ciphertext stores require a little-endian host");
+    map.reset(new Mapping(path, 0));
+    const uint8_t* h = map->data;
+    if (map->size < kStoreHeaderBytes || std::memcmp(h, kStoreMagic, 4) != 0) {
+        throw std::invalid_argument("Not a ciphertext store: " + path);
+    }
+    if (load_field<uint16_t>(h + 4) != kStoreVersion) throw std::invalid_argument("Unsupported store version");
+
+    ntt_form = (load_field<uint16_t>(h + 6) & kStoreNTT) != 0;
+    const uint32_t n = load_field<uint32_t>(h + 8);
+    q = (ModInt)load_field<uint64_t>(h + 12);
+    t = (ModInt)load_field<uint64_t>(h + 20);
+    const uint64_t row_count = load_field<uint64_t>(h + 28);
+    const uint32_t cols = load_field<uint32_t>(h + 36);
+    if (n == 0 || (n & (n - 1)) != 0 || n > (1u << 20) || q < 2 || cols > (uint32_t)kStoreMaxColumns) {
+        throw std::invalid_argument("Invalid store header");
+    }
+    N = (int)n;
+    rows = (size_t)row_count;
+
+    // Every column must lie inside the file (compared by division, so no overflow)
+    const size_t row_bytes = 2 * (size_t)N * sizeof(ModInt);
+    if (rows > (map->size / row_bytes)) throw std::invalid_argument("Store row count exceeds file size");
+    const size_t column_bytes = rows * row_bytes;
+    for (uint32_t c = 0; c < cols; c++) {
+        const uint8_t* e = h + kHeaderFixedBytes + c * kColumnEntryBytes;
+        const char* name = reinterpret_cast<const char*>(e);
+        names.emplace_back(name, strnlen(name, kStoreNameBytes));
+        const uint64_t off = load_field<uint64_t>(e + kStoreNameBytes);
+        if (off % kPageBytes != 0 || off < kStoreHeaderBytes || off > map->size ||
+            map->size - off < column_bytes) {
+            throw std::invalid_argument("Store column '" + names.back() + "' is out of bounds");
+        }
+        offsets.push_back((size_t)off);
+    }
+}
+
+CiphertextStore::~CiphertextStore() = default;
+
+void CiphertextStore::build(const std::string& path,
+                            const std::vector<std::string>& column_names,
+                            const std::vector<std::pair<const uint8_t*, size_t>>& batches,
+                            bool ntt_form) {
+    if (!host_is_little_endian()) throw std::runtime_error("Ciphertext stores require a little-endian host");
+    if (column_names.empty() || column_names.size() != batches.size()) {
+        throw std::invalid_argument("Need one batch per column");
+    }
+    if ((int)column_names.size() > kStoreMaxColumns) throw std::invalid_argument("Too many columns");
+    for (size_t c = 0; c < column_names.size(); c++) {
+        const std::string& name = column_names[c];
+        if (name.empty() || name.size() >= kStoreNameBytes) {
+            throw std::invalid_argument("Column names must be 1 to 31 bytes");
+        }
+        for (size_t d = 0; d < c; d++) {
+            if (column_names[d] == name) throw std::invalid_argument("Duplicate column name: " + name);
+        }
+    }
+
+    // Parse every batch up front: shapes must agree before anything is written
+    std::vector<WireBatch> parsed;
+    for (const auto& b : batches) parsed.push_back(parse_ciphertexts(b.first, b.second));
+    const WireBatch& first = parsed[0];
+    for (const WireBatch& wb : parsed) {
+        if (wb.N != first.N || wb.q != first.q || wb.t != first.t) {
+            throw std::invalid_argument("Columns must share N, q and t");
+        }
+        if (wb.records.size() != first.records.size()) throw std::invalid_argument("Columns must have the same row count");
+        for (const auto& rec : wb.records) {
+            if (rec.size != 2) throw std::invalid_argument("Store rows must be fresh (size-2) ciphertexts");
+        }
+    }
+
+    const int N = first.N;
+    const size_t rows = first.records.size();
+    const size_t column_bytes = rows * 2 * (size_t)N * sizeof(ModInt);
+    const size_t stride = round_up_page(column_bytes);
+
+    std::unique_ptr<NTT> ntt(new NTT(N, first.q));
+    if (!ntt->is_valid()) throw std::invalid_argument("Store modulus must be NTT-friendly");
+
+    // On failure the old store is untouched and the partial .tmp is removed
+    const std::string tmp = path + ".tmp";
+    try {
+        {
+            Mapping out(tmp, kStoreHeaderBytes + stride * column_names.size());
+            uint8_t* h = out.data;
+            std::memcpy(h, kStoreMagic, 4);
+            store_field<uint16_t>(h + 4, kStoreVersion);
+            store_field<uint16_t>(h + 6, ntt_form ? kStoreNTT : 0);
+            store_field<uint32_t>(h + 8, (uint32_t)N);
+            store_field<uint64_t>(h + 12, (uint64_t)first.q);
+            store_field<uint64_t>(h + 20, (uint64_t)first.t);
+            store_field<uint64_t>(h + 28, (uint64_t)rows);
+            store_field<uint32_t>(h + 36, (uint32_t)column_names.size());
+
+            for (size_t c = 0; c < column_names.size(); c++) {
+                uint8_t* e = h + kHeaderFixedBytes + c * kColumnEntryBytes;
+                std::memcpy(e, column_names[c].data(), column_names[c].size());
+                const size_t off = kStoreHeaderBytes + c * stride;
+                store_field<uint64_t>(e + kStoreNameBytes, (uint64_t)off);
+
+                ModInt* col = reinterpret_cast<ModInt*>(out.data + off);
+                unpack_ciphertexts(batches[c].first, parsed[c], col);
+
+                // Bring each row to the store's form in place
+                const WireBatch& wb = parsed[c];
+                default_pool()->parallel_for(rows, [&](size_t r) {
+                    if (wb.records[r].ntt_form == ntt_form) return;
+                    ModInt* row = col + r * 2 * (size_t)N;
+                    for (int k = 0; k < 2; k++) {
+                        if (ntt_form) ntt->forward(row + k * N);
+                        else ntt->inverse(row + k * N);
+                    }
+                });
+            }
+            out.flush();
+        }
+        replace_file(tmp, path);
+    } catch (...) {
+        std::remove(tmp.c_str());
+        throw;
+    }
+}
+
+int CiphertextStore::column_index(const std::string& name) const {
+    for (size_t c = 0; c < names.size(); c++) {
+        if (names[c] == name) return (int)c;
+    }
+    throw std::invalid_argument("No such column: " + name);
+}
+
+const ModInt* CiphertextStore::column_data(int column) const {
+    if (column < 0 || column >= (int)offsets.size()) throw std::invalid_argument("Column index out of range");
+    return reinterpret_cast<const ModInt*>(map->data + offsets[(size_t)column]);
+}
+
+void CiphertextStore::advise_sequential(int column) const {
+#ifndef _WIN32
+    column_data(column);
+    map->advise(offsets[(size_t)column], rows * 2 * (size_t)N * sizeof(ModInt), MADV_SEQUENTIAL);
+#else
+    (void)column;
+#endif
+}
+
+void CiphertextStore::prefetch_rows(int column, size_t begin, size_t end) const {
+#ifndef _WIN32
+    column_data(column);
+    end = std::min(end, rows);
+    if (begin >= end) return;
+    const size_t row_bytes = 2 * (size_t)N * sizeof(ModInt);
+    map->advise(offsets[(size_t)column] + begin * row_bytes, (end - begin) * row_bytes, MADV_WILLNEED);
+#else
+    (void)column; (void)begin; (void)end;
+#endif
+}
+
+void CiphertextStore::release_rows(int column, size_t begin, size_t end) const {
+#ifndef _WIN32
+    column_data(column);
+    end = std::min(end, rows);
+    if (begin >= end) return;
+    // Only whole pages inside the range are dropped, so neighbouring rows stay resident
+    const size_t row_bytes = 2 * (size_t)N * sizeof(ModInt);
+    const size_t from = round_up_page(offsets[(size_t)column] + begin * row_bytes);
+    const size_t to = (offsets[(size_t)column] + end * row_bytes) / kPageBytes * kPageBytes;
+    if (to > from) map->advise(from, to - from, MADV_DONTNEED);
+#else
+    (void)column; (void)begin; (void)end;
+#endif
+}
+
+} // namespace fhe_cpp
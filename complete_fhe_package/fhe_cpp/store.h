@@ -0,0 +1,88 @@
+/*
+ * Memory-Mapped Ciphertext Store
+ * On-disk columnar table of fresh (size-2) ciphertexts over one (N, q, t),
+ * opened with mmap so a server can stream a column page by page without
+ * materializing rows. Each column holds rows x 2 x N raw int64 residues
+ * (c0 then c1 per row), optionally in NTT form, at a page-aligned offset so
+ * rows can be handed to the NTT kernels as-is.
+ *
+ *   header (4096 bytes): "FHES"  u16 version  u16 flags  u32 N  u64 q  u64 t
+ *                        u64 rows  u32 num_columns  u32 reserved
+ *                        num_columns x { char name[32]  u64 offset }
+ *   column data        : little-endian int64, page aligned
+ */
+
+#ifndef FHE_STORE_H
+#define FHE_STORE_H
+
+#include "ntt.h"
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace fhe_cpp {
+
+const uint16_t kStoreVersion = 1;
+const uint16_t kStoreNTT = 1;           // Header flag: every column is in NTT form
+const size_t kStoreHeaderBytes = 4096;
+const size_t kStoreNameBytes = 32;
+const int kStoreMaxColumns = 64;
+
+class CiphertextStore {
+private:
+    struct Mapping;                     // OS-specific file mapping
+    std::unique_ptr<Mapping> map;
+
+    int N;
+    ModInt q;
+    ModInt t;
+    size_t rows;
+    bool ntt_form;
+    std::vector<std::string> names;
+    std::vector<size_t> offsets;
+
+public:
+    // Maps an existing store read-only; throws std::runtime_error / invalid_argument
+    explicit CiphertextStore(const std::string& path);
+    ~CiphertextStore();
+
+    CiphertextStore(const CiphertextStore&) = delete;
+    CiphertextStore& operator=(const CiphertextStore&) = delete;
+
+    // Writes a store from one serialize_ciphertexts batch per column (same N, q, t and
+    // row count, size-2 records), unpacking straight into the mapped file and then
+    // converting every row to the requested form. The file is written beside path and
+    // renamed over it, so readers holding the old store keep a consistent view.
+    static void build(const std::string& path,
+                      const std::vector<std::string>& column_names,
+                      const std::vector<std::pair<const uint8_t*, size_t>>& batches,
+                      bool ntt_form = true);
+
+    int get_N() const { return N; }
+    ModInt get_q() const { return q; }
+    ModInt get_t() const { return t; }
+    size_t num_rows() const { return rows; }
+    bool is_ntt() const { return ntt_form; }
+    const std::vector<std::string>& column_names() const { return names; }
+
+    // Throws std::invalid_argument for unknown names
+    int column_index(const std::string& name) const;
+
+    // rows x 2N residues of a column; row r is c0 at [2rN, 2rN + N), c1 right after
+    const ModInt* column_data(int column) const;
+    const ModInt* row(int column, size_t r) const { return column_data(column) + r * 2 * (size_t)N; }
+
+    // Paging hints for streaming scans (no-ops where unsupported):
+    // prefetch_rows asks for [begin, end) to be read ahead, release_rows lets the
+    // kernel drop those pages again so resident memory stays flat
+    void advise_sequential(int column) const;
+    void prefetch_rows(int column, size_t begin, size_t end) const;
+    void release_rows(int column, size_t begin, size_t end) const;
+};
+
+} // namespace fhe_cpp
+
+#endif // FHE_STORE_H
@@ -0,0 +1,125 @@
+/*
+ * Thread Pool Implementation
+ */
+
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace fhe_cpp {
+
+ThreadPool::ThreadPool(int num_threads) : stopping(false) {
+    for (int i = 1; i < num_threads; i++) workers.emplace_back(&ThreadPool::worker_loop, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& w : workers) w.join();
+}
+
+void ThreadPool::worker_loop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+namespace {
+
+// Shared by the caller and its helpers; a helper that starts after every index
+// was claimed only touches the counter, so it may outlive the call safely
+struct ParallelFor {
+    const std::function<void(size_t)>* body;
+    size_t n;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::exception_ptr error;
+
+    void run() {
+        for (;;) {
+            size_t i = next.fetch_add(1);
+            if (i >= n) return;
+            try {
+                (*body)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (!error) error = std::current_exception();
+            }
+            if (done.fetch_add(1) + 1 == n) {
+                std::lock_guard<std::mutex> lock(mtx);
+                cv.notify_all();
+            }
+        }
+    }
+};
+
+} // namespace
+
+void ThreadPool::parallel_for(size_t n, const std::function<void(size_t)>& body) {
+    if (n == 0) return;
+    if (n == 1 || workers.empty()) {
+        for (size_t i = 0; i < n; i++) body(i);
+        return;
+    }
+
+    auto state = std::make_shared<ParallelFor>();
+    state->body = &body;
+    state->n = n;
+
+    size_t helpers = std::min(workers.size(), n - 1);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (size_t h = 0; h < helpers; h++) tasks.emplace_back([state] { state->run(); });
+    }
+    cv.notify_all();
+
+    state->run();
+
+    std::unique_lock<std::mutex> lock(state->mtx);
+    state->cv.wait(lock, [&] { return state->done.load() == n; });
+    if (state->error) std::rethrow_exception(state->error);
+}
+
+static std::mutex pool_mtx;
+static std::shared_ptr<ThreadPool> pool;
+
+static int default_threads() {
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : (int)hw;
+}
+
+std::shared_ptr<ThreadPool> default_pool() {
+    std::lock_guard<std::mutex> lock(pool_mtx);
+    if (!pool) pool = std::make_shared<ThreadPool>(default_threads());
+    return pool;
+}
+
+void set_num_threads(int num_threads) {
+    std::shared_ptr<ThreadPool> old;
+    {
+        std::lock_guard<std::mutex> lock(pool_mtx);
+        old = std::move(pool);
+        pool = std::make_shared<ThreadPool>(num_threads > 0 ? num_threads : default_threads());
+    }
+    // The old workers are joined here, or by the last call still holding them
+}
+
+int get_num_threads() {
+    return default_pool()->size();
+}
+
+} // namespace fhe_cpp
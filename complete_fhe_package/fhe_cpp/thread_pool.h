@@ -0,0 +1,53 @@
+/*
+ * Thread Pool
+ * Fixed set of workers behind the batch entry points. parallel_for blocks the
+ * caller, which also takes indices, so a nested call can never deadlock.
+ */
+
+#ifndef FHE_THREAD_POOL_H
+#define FHE_THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fhe_cpp {
+
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping;
+
+    void worker_loop();
+
+public:
+    // num_threads counts the caller: a pool of 1 runs everything on the calling thread
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return (int)workers.size() + 1; }
+
+    // Runs body(i) for every i in [0, n); rethrows the first exception after all indices finish
+    void parallel_for(size_t n, const std::function<void(size_t)>& body);
+};
+
+// Process-wide pool used by the batch APIs; defaults to std::thread::hardware_concurrency()
+std::shared_ptr<ThreadPool> default_pool();
+
+// num_threads <= 0 restores the default. Calls already running keep their old pool.
+void set_num_threads(int num_threads);
+int get_num_threads();
+
+} // namespace fhe_cpp
+
+#endif // FHE_THREAD_POOL_H
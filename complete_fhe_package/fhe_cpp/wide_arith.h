@@ -0,0 +1,171 @@
+/*
+ * Portable Wide-Integer Arithmetic
+ * 128/192-bit helpers built on unsigned __int128 (GCC/Clang) or
+ * _umul128/_udiv128 (MSVC), plus Barrett division by a 64-bit modulus
+ * with a precomputed reciprocal floor(2^128 / q).
+ */
+
+#ifndef FHE_WIDE_ARITH_H
+#define FHE_WIDE_ARITH_H
+
+#include <cstdint>
+#include <stdexcept>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#pragma intrinsic(_umul128)
+#pragma intrinsic(_udiv128)
+#endif
+
+namespace fhe_cpp {
+
+struct uint128_w { uint64_t low; uint64_t high; };
+struct uint192_w { uint64_t low; uint64_t mid; uint64_t high; };
+
+inline uint128_w mul64x64(uint64_t a, uint64_t b) {
+    uint128_w res;
+#ifdef _MSC_VER
+    unsigned __int64 high;
+    res.low = _umul128(a, b, &high);
+    res.high = high;
+#else
+    unsigned __int128 p = (unsigned __int128)a * b;
+    res.low = (uint64_t)p; res.high = (uint64_t)(p >> 64);
+#endif
+    return res;
+}
+
+inline uint128_w add128(uint128_w a, uint128_w b) {
+    uint128_w res; res.low = a.low + b.low;
+    res.high = a.high + b.high + (res.low < a.low ? 1 : 0);
+    return res;
+}
+
+inline uint128_w sub128(uint128_w a, uint128_w b) {
+    uint128_w res; res.low = a.low - b.low;
+    uint64_t borrow = (a.low < b.low) ? 1 : 0;
+    res.high = a.high - b.high - borrow;
+    return res;
+}
+
+// Low 192 bits of a * b (callers guarantee the product fits)
+inline uint192_w mul192x64(uint192_w a, uint64_t b) {
+    uint128_w p_low = mul64x64(a.low, b);
+    uint128_w p_mid = mul64x64(a.mid, b);
+    uint192_w res; res.low = p_low.low;
+    uint64_t mid_sum = p_low.high + p_mid.low;
+    uint64_t carry_mid = (mid_sum < p_low.high) ? 1 : 0;
+    res.mid = mid_sum; res.high = p_mid.high + a.high * b + carry_mid;
+    return res;
+}
+
+inline uint192_w add192_scalar(uint192_w a, uint64_t b) {
+    uint192_w res = a; res.low += b;
+    if (res.low < b) { res.mid++; if (res.mid == 0) res.high++; }
+    return res;
+}
+
+// floor(a * b / 2^128), truncated to 64 bits
+inline uint64_t mul128x128_hi64(uint128_w a, uint128_w b) {
+    uint128_w ll = mul64x64(a.low, b.low);
+    uint128_w lh = mul64x64(a.low, b.high);
+    uint128_w hl = mul64x64(a.high, b.low);
+    uint64_t hh = a.high * b.high;
+
+    // Column 1 (bits 64..127) only contributes its carries
+    uint128_w col = {ll.high, 0};
+    col = add128(col, {lh.low, 0});
+    col = add128(col, {hl.low, 0});
+
+    return hh + lh.high + hl.high + col.high;
+}
+
+/*
+ * A modulus q in [2, 2^63) with its Barrett ratio floor(2^128 / q).
+ * All reductions use a fixed number of multiplies and one conditional
+ * subtraction; no hardware division outside the constructor.
+ */
+class Modulus {
+private:
+    uint64_t q;
+    uint128_w ratio;
+
+public:
+    Modulus() : q(0), ratio({0, 0}) {}
+
+    explicit Modulus(uint64_t q) : q(q) {
+        if (q < 2 || (q >> 63) != 0) throw std::invalid_argument("Modulus must be in [2, 2^63)");
+#ifdef _MSC_VER
+        // Long division of 2^128 = (1 : 0 : 0) by q
+        unsigned __int64 rem;
+        ratio.high = _udiv128(1, 0, q, &rem);
+        ratio.low = _udiv128(rem, 0, q, &rem);
+#else
+        unsigned __int128 all_ones = ~(unsigned __int128)0;
+        unsigned __int128 r = all_ones / q;
+        if (all_ones % q == q - 1) r += 1;  // q divides 2^128
+        ratio.low = (uint64_t)r; ratio.high = (uint64_t)(r >> 64);
+#endif
+    }
+
+    uint64_t value() const { return q; }
+    // floor(2^128 / q): the Barrett constant, e.g. for uploading to a device
+    uint128_w barrett_ratio() const { return ratio; }
+
+    // (hi : lo) / q for hi < q; returns the quotient and sets rem
+    inline uint64_t divrem(uint64_t hi, uint64_t lo, uint64_t& rem) const {
+        uint128_w x = {lo, hi};
+        // floor(x * ratio / 2^128) undershoots floor(x / q) by at most 1,
+        // so r < 2q < 2^64
+        uint64_t quot = mul128x128_hi64(x, ratio);
+        uint64_t r = lo - quot * q;
+
+        uint64_t ge = (uint64_t)(r >= q);
+        r -= q & (0 - ge); quot += ge;
+
+        rem = r;
+        return quot;
+    }
+
+    // (hi : lo) mod q for hi < q
+    inline uint64_t reduce(uint64_t hi, uint64_t lo) const {
+        uint64_t rem;
+        divrem(hi, lo, rem);
+        return rem;
+    }
+
+    inline uint64_t reduce(uint64_t a) const { return reduce(0, a); }
+
+    // a * b mod q for a, b < q
+    inline uint64_t mul(uint64_t a, uint64_t b) const {
+        uint128_w p = mul64x64(a, b);
+        return reduce(p.high, p.low);
+    }
+
+    // floor(w * 2^64 / q) for w < q: Shoup companion of a fixed multiplicand
+    inline uint64_t shoup(uint64_t w) const {
+        uint64_t rem;
+        return divrem(w, 0, rem);
+    }
+
+    uint64_t pow(uint64_t base, uint64_t exp) const {
+        uint64_t res = 1;
+        base = reduce(base);
+        while (exp > 0) {
+            if (exp & 1) res = mul(res, base);
+            base = mul(base, base);
+            exp >>= 1;
+        }
+        return res;
+    }
+};
+
+// w * y mod q in [0, 2q), given w_shoup = floor(w * 2^64 / q); any y < 2^64
+inline uint64_t mul_shoup_lazy(uint64_t w, uint64_t w_shoup, uint64_t y, uint64_t q) {
+    uint64_t quot = mul64x64(w_shoup, y).high;
+    return w * y - quot * q;
+}
+
+} // namespace fhe_cpp
+
+#endif // FHE_WIDE_ARITH_H
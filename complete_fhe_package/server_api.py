@@ -1,13 +1,20 @@
 # server_api.py
-from fastapi import FastAPI, UploadFile, File
+from fastapi import FastAPI, UploadFile, File, Form, HTTPException, Response
 from pydantic import BaseModel
-import pickle
+from typing import List, Optional
+from collections import OrderedDict
+import atexit
+import json
+import secrets
 import sys
 import os
+import threading
+import time
 
 # Import your FHE Library
 # Ensure 'example_accelerated.py' and 'custom_fhe' are in the same folder
 from example_accelerated import BFVSchemeAccelerated
+from custom_fhe import db_store, sharding
 
 app = FastAPI()
 
@@ -22,34 +29,253 @@ def home():
     return {"status": "FHE Server Online", "backend": "C++ Accelerated"}
 
 
+# Uploaded database, memory-mapped; replaced atomically by /db
+DB_PATH = os.environ.get("FHE_DB_PATH", "encrypted_db.fhes")
+STORE = None
+STORE_LOCK = threading.Lock()
+
+
+def get_store():
+    global STORE
+    if STORE is None and os.path.exists(DB_PATH):
+        STORE = db_store.open_store(DB_PATH)
+    return STORE
+
+
+# Coordinator mode: with FHE_SHARD_WORKERS set (comma-separated worker URLs, each
+# a server_api instance), rows are partitioned across the workers and searches
+# are broadcast to them; the workers serve the /shard endpoints below
+SHARD_WORKERS = [u for u in os.environ.get("FHE_SHARD_WORKERS", "").split(",") if u.strip()]
+COORDINATOR = sharding.ShardCoordinator(SHARD_WORKERS) if SHARD_WORKERS else None
+
+
+@app.post("/db")
+def upload_db(
+        date_file: UploadFile = File(...),
+        email_file: Optional[UploadFile] = File(None)
+):
+    """
+    Receives: Encrypted Database columns (serialization.dumps batches, row i has id i)
+    Stores them once, in NTT form, in the memory-mapped store (or across the shards)
+    """
+    columns = {"date": date_file.file.read()}
+    if email_file is not None:
+        columns["email"] = email_file.file.read()
+    if COORDINATOR is not None:
+        # Bad batches (here or as a worker's 400) are the client's fault; a worker
+        # that fails or cannot be reached is a bad gateway
+        try:
+            rows = COORDINATOR.upload(columns, ntt=True)
+        except ValueError as e:
+            raise HTTPException(status_code=400, detail=str(e))
+        except (sharding.WorkerError, sharding.SessionExpired) as e:
+            raise HTTPException(status_code=502, detail=f"Shard upload failed: {e}")
+        return {"rows": rows, "columns": list(columns), "shards": len(SHARD_WORKERS)}
+    try:
+        store = replace_store(columns, ntt=True)
+    except ValueError as e:
+        raise HTTPException(status_code=400, detail=str(e))
+    return {"rows": store.num_rows(), "columns": store.column_names()}
+
+
+def replace_store(columns, ntt, shard_range=None):
+    """
+    Rebuild the local store; sessions over the old one are dropped. The store
+    is written beside DB_PATH and renamed over it, so a failed build leaves the
+    old store, its shard range and its sessions untouched. The range file is
+    rewritten once the new store is in place (removed for a whole-table upload).
+    Uploads run on the threadpool, so one at a time holds STORE_LOCK.
+    """
+    global STORE, SHARD_RANGE
+    with STORE_LOCK:
+        db_store.build_store_from_batches(DB_PATH, columns, ntt=ntt)
+        store = db_store.open_store(DB_PATH)
+        with SESSIONS_LOCK:
+            STORE, SHARD_RANGE = store, shard_range
+            SESSIONS.clear()
+        range_path = DB_PATH + ".range"
+        if shard_range is None:
+            if os.path.exists(range_path):
+                os.remove(range_path)
+        else:
+            with open(range_path + ".tmp", "w") as f:
+                json.dump(shard_range, f)
+            os.replace(range_path + ".tmp", range_path)
+        return store
+
+
+# Searches run on the native pipeline: query decoding, the scan and result
+# serialization overlap across row chunks and requests, and the handler only
+# awaits the job, so the event loop stays free
+PIPELINE = db_store.SearchPipeline(max_pending=int(os.environ.get("FHE_MAX_PENDING", "64")))
+atexit.register(PIPELINE.close)
+
+
 @app.post("/search")
 async def blind_search(
-        db_file: UploadFile = File(...),
-        query_file: UploadFile = File(...)
+        query_file: UploadFile = File(...),
+        column: str = Form("date")
 ):
     """
-    Receives: Encrypted Database + Encrypted Query
-    Returns: Encrypted Search Results
-    """
-    # 1. Load the binary data (Pickled objects)
-    encrypted_db = pickle.load(db_file.file)
-    encrypted_query = pickle.load(query_file.file)
-
-    print(f"Processing {len(encrypted_db)} rows...")
-
-    # 2. Perform Blind Search (Homomorphic Subtraction)
-    results = []
-    for row in encrypted_db:
-        # Assuming row is a dictionary {'data': ciphertext}
-        # and query is a list of ciphertexts
-        diffs = []
-        for target in encrypted_query:
-            # CALLING YOUR C++ ACCELERATED FUNCTION
-            # Note: We assume your library supports direct subtraction like this
-            # You might need to adapt this based on your exact object structure
-            diff = SERVER_FHE.homomorphic_sub(row['date'], target)
-            diffs.append(diff)
-        results.append({'id': row['id'], 'diffs': diffs})
-
-    # 3. Serialize and Return Results
-    return pickle.dumps(results)
\ No newline at end of file
+    Receives: Encrypted Query (serialization.dumps batch) against the stored database
+    Returns: Encrypted Search Results, one batch of rows * len(query)
+             differences in row-major order (NTT form)
+    """
+    query = await query_file.read()
+    try:
+        if COORDINATOR is not None:
+            if COORDINATOR.params is None:
+                raise HTTPException(status_code=409, detail="No database uploaded; POST /db first")
+            payload = await COORDINATOR.search(column, query)
+        else:
+            store = get_store()
+            if store is None:
+                raise HTTPException(status_code=409, detail="No database uploaded; POST /db first")
+            payload = await PIPELINE.search(store, column, query)
+    except db_store.PipelineBusy:
+        raise HTTPException(status_code=503, detail="Search queue is full; retry later",
+                            headers={"Retry-After": "1"})
+    except ValueError as e:
+        raise HTTPException(status_code=400, detail=str(e))
+    except (sharding.WorkerError, sharding.SessionExpired) as e:
+        raise HTTPException(status_code=502, detail=f"Shard search failed: {e}")
+    return Response(content=payload, media_type="application/octet-stream")
+
+
+# ---------------------------------------------------------------------------
+# Shard worker endpoints (called by a coordinator, never by clients)
+# ---------------------------------------------------------------------------
+
+# session id -> {"store": CiphertextStore, "ntt": NTT, "used": monotonic time}; the
+# NTT pins the ring's tables in the registry so per-request query conversion never
+# rebuilds them. Sessions idle for SESSION_TTL seconds expire, and past MAX_SESSIONS
+# the least recently used one goes; the coordinator renegotiates on the 410.
+SESSIONS = OrderedDict()
+SESSIONS_LOCK = threading.Lock()
+SESSION_TTL = float(os.environ.get("FHE_SESSION_TTL", "3600"))
+MAX_SESSIONS = int(os.environ.get("FHE_MAX_SESSIONS", "256"))
+SHARD_RANGE = None
+if os.path.exists(DB_PATH + ".range"):
+    with open(DB_PATH + ".range") as f:
+        SHARD_RANGE = tuple(json.load(f))
+
+
+def _expire_sessions(now):
+    """Drop sessions idle past SESSION_TTL; SESSIONS_LOCK must be held"""
+    while SESSIONS:
+        session, state = next(iter(SESSIONS.items()))
+        if now - state["used"] < SESSION_TTL:
+            break
+        del SESSIONS[session]
+
+
+def _lookup_session(session):
+    """The session's state, marked as just used; None if unknown or expired"""
+    with SESSIONS_LOCK:
+        now = time.monotonic()
+        _expire_sessions(now)
+        state = SESSIONS.get(session)
+        if state is not None:
+            state["used"] = now
+            SESSIONS.move_to_end(session)
+        return state
+
+
+@app.post("/shard/db")
+def shard_upload(
+        columns: List[UploadFile] = File(...),
+        row_begin: int = Form(...),
+        row_end: int = Form(...),
+        ntt: int = Form(1)
+):
+    """Receives this node's rows [row_begin, row_end), one batch per column (file name = column)"""
+    batches = {f.filename: f.file.read() for f in columns}
+    # Checked before anything is replaced: a bad upload must not cost the current shard
+    try:
+        sharding.check_shard_batches(batches, row_begin, row_end)
+    except ValueError as e:
+        raise HTTPException(status_code=400, detail=str(e))
+    # The range is kept beside the store, so a restarted worker can still take sessions
+    try:
+        store = replace_store(batches, ntt=bool(ntt), shard_range=(row_begin, row_end))
+    except ValueError as e:
+        raise HTTPException(status_code=400, detail=str(e))
+    return {"rows": store.num_rows()}
+
+
+class ShardSession(BaseModel):
+    N: int
+    q: int
+    t: int
+    row_begin: int
+    row_end: int
+    columns: List[str]
+
+
+@app.post("/shard/session")
+def shard_session(params: ShardSession):
+    """Checks the coordinator's parameters against the local shard once, then hands out a session id"""
+    import fhe_fast_mult
+    get_store()
+    with SESSIONS_LOCK:
+        store, shard_range = STORE, SHARD_RANGE
+    if store is None or shard_range is None:
+        raise HTTPException(status_code=409, detail="No shard uploaded")
+    if (params.N, params.q, params.t) != (store.get_N(), store.get_q(), store.get_t()):
+        raise HTTPException(status_code=400, detail="Parameters do not match this shard")
+    if (params.row_begin, params.row_end) != shard_range:
+        raise HTTPException(status_code=400, detail="Row range does not match this shard")
+    if not set(params.columns) <= set(store.column_names()):
+        raise HTTPException(status_code=400, detail="Unknown columns for this shard")
+    session = secrets.token_hex(16)
+    state = {"store": store, "ntt": fhe_fast_mult.NTT(store.get_N(), store.get_q())}
+    with SESSIONS_LOCK:
+        if STORE is not store:
+            raise HTTPException(status_code=409, detail="Shard was replaced; retry")
+        now = time.monotonic()
+        _expire_sessions(now)
+        state["used"] = now
+        SESSIONS[session] = state
+        while len(SESSIONS) > MAX_SESSIONS:
+            SESSIONS.popitem(last=False)
+    return {"session": session}
+
+
+@app.post("/shard/search")
+async def shard_search(
+        query_file: UploadFile = File(...),
+        session: str = Form(...),
+        column: str = Form("date")
+):
+    """This shard's rows against the broadcast query; 410 tells the coordinator to renegotiate"""
+    state = _lookup_session(session)
+    if state is None:
+        raise HTTPException(status_code=410, detail="Unknown or expired session")
+    query = await query_file.read()
+    try:
+        payload = await PIPELINE.search(state["store"], column, query)
+    except db_store.PipelineBusy:
+        raise HTTPException(status_code=503, detail="Search queue is full; retry later",
+                            headers={"Retry-After": "1"})
+    except ValueError as e:
+        raise HTTPException(status_code=400, detail=str(e))
+    return Response(content=payload, media_type="application/octet-stream")
+
+
+@app.get("/metrics")
+def metrics():
+    """
+    Native hot-path counters (fhe_fast_mult.stats()) in the Prometheus text
+    format: per-operation calls, seconds and bytes since the server started
+    """
+    import fhe_fast_mult
+    stats = fhe_fast_mult.stats()
+    lines = []
+    for field, metric in (("calls", "fhe_native_calls_total"),
+                          ("seconds", "fhe_native_seconds_total"),
+                          ("bytes", "fhe_native_bytes_total")):
+        lines.append(f"# TYPE {metric} counter")
+        for op, entry in stats.items():
+            if isinstance(entry, dict):
+                lines.append(f'{metric}{{op="{op}"}} {entry[field]}')
+    return Response(content="\n".join(lines) + "\n", media_type="text/plain; version=0.0.4")
@@ -214,6 +214,634 @@ def test_exact_match_scenario(fhe):
     return False
 
 
+def _raises(fn, *args, errors=(ValueError,)):
+    """True if fn(*args) raises one of errors"""
+    try:
+        fn(*args)
+    except errors:
+        return True
+    return False
+
+
+def test_serialization(fhe):
+    """Test the binary ciphertext batch format"""
+    print("\n" + "=" * 60)
+    print("TEST 7: Ciphertext Serialization")
+    print("=" * 60)
+
+    if not fhe.use_cpp:
+        print(" Skipped (needs the C++ backend)")
+        return
+
+    import fhe_fast_mult
+    from custom_fhe import serialization
+
+    cts = [fhe.encrypt(fhe.encode(v)) for v in (7, 1234, fhe.t - 1)]
+    cts.append(fhe.to_ntt(fhe.encrypt(fhe.encode(42))))
+    cts.append(fhe.encrypt_symmetric(fhe.encode(99)))             # Seeded, coefficient form
+    cts.append(fhe.encrypt_symmetric(fhe.encode(5), ntt=True))    # Seeded, NTT form
+
+    # Round trip: components, form and seeds come back unchanged
+    data = serialization.dumps(cts, fhe.N, fhe.q, fhe.t)
+    loaded, params = serialization.loads(data)
+    assert params == {'N': fhe.N, 't': fhe.t, 'q': fhe.q}, f"Wrong params {params}"
+    assert len(loaded) == len(cts)
+    for ct, back in zip(cts, loaded):
+        assert back.is_ntt == ct.is_ntt and back.a_seed == ct.a_seed
+        for a, b in zip(ct.get_components(), back.get_components()):
+            assert np.array_equal(np.asarray(a), b), "Component changed in round trip"
+    for ct, value in zip(loaded[3:], (42, 99, 5)):
+        assert fhe.decode(fhe.decrypt(ct)) == value
+    print(f" Round trip: {len(cts)} ciphertexts in {len(data)} bytes")
+
+    # A seeded c1 travels as its seed; the NTT-form one is transformed again on load
+    seeded = serialization.dumps(cts[5:], fhe.N, fhe.q, fhe.t)
+    full = serialization.dumps(cts[5:], fhe.N, fhe.q, fhe.t, compress_seeds=False)
+    assert len(seeded) < len(full)
+    assert np.array_equal(serialization.loads(seeded)[0][0].get_components()[1],
+                          serialization.loads(full)[0][0].get_components()[1])
+    print(f" Seeded c1: {len(seeded)} bytes instead of {len(full)}")
+
+    # Corrupted headers and bodies are rejected, never misread
+    def patch(offset, raw):
+        return data[:offset] + raw + data[offset + len(raw):]
+    body = 36 + 8                                   # Batch header, first record header
+    corrupted = {
+        'magic': patch(0, b'XHEB'),
+        'version': patch(4, (2).to_bytes(2, 'little')),
+        'coefficient width': patch(6, bytes([data[6] + 1])),
+        'N': patch(8, (3).to_bytes(4, 'little')),
+        't >= q': patch(20, fhe.q.to_bytes(8, 'little')),
+        'count': patch(28, (len(cts) + 1).to_bytes(4, 'little')),
+        'record flags': patch(36 + 5, b'\x80'),
+        'coefficient >= q': patch(body, b'\xff' * 8),
+        'short header': data[:20],
+        'truncated body': data[:-8],
+        'trailing bytes': data + b'\x00' * 8,
+    }
+    for name, buf in corrupted.items():
+        assert _raises(serialization.loads, buf), f"Accepted a batch with a bad {name}"
+    print(f" Rejected {len(corrupted)} corrupted or truncated batches")
+
+    # Slices of a batch concatenate back to the same bytes
+    parts = [fhe_fast_mult.slice_ciphertexts(data, 0, 2),
+             fhe_fast_mult.slice_ciphertexts(data, 2, len(cts))]
+    assert fhe_fast_mult.ciphertext_batch_info(parts[1]) == (fhe.N, fhe.q, fhe.t, len(cts) - 2)
+    assert fhe_fast_mult.concat_ciphertexts(parts) == data
+    assert _raises(fhe_fast_mult.slice_ciphertexts, data, 2, len(cts) + 1)
+    other = serialization.dumps(cts[:1], fhe.N, fhe.q + 2, fhe.t)
+    assert _raises(fhe_fast_mult.concat_ciphertexts, [data, other])
+    print(" Slice and concat preserve the batch")
+
+
+def test_store(fhe):
+    """Test the memory-mapped ciphertext store"""
+    print("\n" + "=" * 60)
+    print("TEST 8: Memory-Mapped Ciphertext Store")
+    print("=" * 60)
+
+    if not fhe.use_cpp:
+        print(" Skipped (needs the C++ backend)")
+        return
+
+    import os
+    import tempfile
+    from custom_fhe import db_store
+
+    dates = [20260205, 20260215, 20260225]
+    columns = {'date': [fhe.encrypt(fhe.encode(d % fhe.t)) for d in dates],
+               'id': [fhe.encrypt_symmetric(fhe.encode(i)) for i in range(len(dates))]}
+
+    with tempfile.TemporaryDirectory() as tmp:
+        coeff_path = os.path.join(tmp, 'coeff.fhes')
+        ntt_path = os.path.join(tmp, 'ntt.fhes')
+        db_store.build_store(coeff_path, columns, fhe.N, fhe.q, fhe.t, ntt=False)
+        db_store.build_store(ntt_path, columns, fhe.N, fhe.q, fhe.t, ntt=True)
+
+        # Build -> open -> read: rows come back as written, through read-only views
+        store = db_store.open_store(coeff_path)
+        assert (store.get_N(), store.get_q(), store.get_t()) == (fhe.N, fhe.q, fhe.t)
+        assert store.num_rows() == len(dates) and not store.is_ntt()
+        assert store.column_names() == ['date', 'id']
+        for name, cts in columns.items():
+            col = store.column(name)
+            assert col.shape == (len(dates), 2, fhe.N) and not col.flags.writeable
+            for r, ct in enumerate(cts):
+                for c in range(2):
+                    assert np.array_equal(col[r, c], np.asarray(ct.get_components()[c]))
+        assert _raises(store.column, 'missing')
+        print(f" Build / open / read: {store.num_rows()} rows x {len(columns)} columns")
+
+        # The NTT store was converted in place: each row is the forward transform
+        ntt_store = db_store.open_store(ntt_path)
+        assert ntt_store.is_ntt()
+        col = ntt_store.column('date')
+        for r, ct in enumerate(columns['date']):
+            ref = fhe.to_ntt(ct).get_components()
+            for c in range(2):
+                assert np.array_equal(col[r, c], np.asarray(ref[c]))
+        found = [fhe.decode(fhe.decrypt(ct)) for ct in db_store.iter_ciphertexts(ntt_store, 'date')]
+        assert found == [d % fhe.t for d in dates], f"NTT store decrypted to {found}"
+        print(" NTT-form store holds the transformed rows and decrypts")
+
+        # Bad headers and short files are refused at open
+        with open(coeff_path, 'rb') as f:
+            raw = f.read()
+        broken = {
+            'magic': b'XHES' + raw[4:],
+            'version': raw[:4] + (2).to_bytes(2, 'little') + raw[6:],
+            'N': raw[:8] + (3).to_bytes(4, 'little') + raw[12:],
+            'header only': raw[:100],
+            'short file': raw[:len(raw) - 8],
+            'empty file': b'',
+        }
+        for name, content in broken.items():
+            path = os.path.join(tmp, 'broken.fhes')
+            with open(path, 'wb') as f:
+                f.write(content)
+            assert _raises(db_store.open_store, path), f"Opened a store with a bad {name}"
+        assert _raises(db_store.open_store, os.path.join(tmp, 'absent.fhes'), errors=(RuntimeError,))
+
+        # A build that cannot be renamed into place leaves no partial .tmp behind
+        blocked = os.path.join(tmp, 'blocked.fhes')
+        os.mkdir(blocked)
+        assert _raises(db_store.build_store, blocked, columns, fhe.N, fhe.q, fhe.t, errors=(RuntimeError,))
+        assert not os.path.exists(blocked + '.tmp')
+        del store, ntt_store, col                   # Unmap before the directory goes
+        print(f" Rejected {len(broken)} bad or short store files")
+
+
+def test_search_pipeline(fhe):
+    """Test pipelined searches against the direct store scan"""
+    print("\n" + "=" * 60)
+    print("TEST 9: Search Pipeline")
+    print("=" * 60)
+
+    if not fhe.use_cpp:
+        print(" Skipped (needs the C++ backend)")
+        return
+
+    import asyncio
+    import os
+    import tempfile
+    import threading
+    import fhe_fast_mult
+    from custom_fhe import db_store, serialization
+
+    rows = 6
+    column = [fhe.encrypt(fhe.encode(20260200 + i)) for i in range(rows)]
+    queries = [fhe.encrypt(fhe.encode(20260203)), fhe.encrypt_symmetric(fhe.encode(7))]
+    query = serialization.dumps(queries, fhe.N, fhe.q, fhe.t)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, 'db.fhes')
+        db_store.build_store(path, {'date': column}, fhe.N, fhe.q, fhe.t, ntt=True)
+        store = db_store.open_store(path)
+
+        # Reference: the direct scan with the queries already in the store's form
+        targets = np.array([[np.asarray(c) for c in fhe.to_ntt(ct).get_components()] for ct in queries])
+        arena = store.scan_subtract('date', targets)
+        expected = serialization.dumps_array(arena.reshape(-1, 2, fhe.N), fhe.q, fhe.t, is_ntt=True)
+
+        # One row per chunk, so every stage hands over several chunks per search
+        pipeline = db_store.SearchPipeline(max_pending=1, chunk_bytes=1, depth=1)
+        try:
+            result = asyncio.run(pipeline.search(store, 'date', query))
+            assert result == expected, "Pipeline result differs from scan_subtract"
+            print(f" Pipelined search matches scan_subtract ({rows} rows x {len(queries)} targets)")
+
+            # Hold the encode stage in a done callback: the stages back up behind it, and
+            # once one search waits in the queue try_submit must refuse the next
+            gate, entered = threading.Event(), threading.Event()
+            inline = []
+
+            def hold():
+                if threading.current_thread() is threading.main_thread():
+                    inline.append(True)     # Search already done; the callback ran right away
+                    return
+                entered.set()
+                gate.wait(30)
+
+            accepted, refused = [], False
+            try:
+                for _ in range(5):
+                    inline.clear()
+                    held = pipeline.submit(store, 'date', query)
+                    held.add_done_callback(hold)
+                    if not inline:
+                        break
+                assert entered.wait(30), "Encode stage never ran the done callback"
+                for _ in range(10):
+                    job = pipeline._pipeline.try_submit(store, 'date', query)
+                    if job is None:
+                        refused = True
+                        break
+                    accepted.append(job)
+                    time.sleep(0.05)
+                assert refused, "try_submit never reported a full queue"
+                assert pipeline.pending() == 1
+                assert _raises(pipeline.submit, store, 'date', query, errors=(db_store.PipelineBusy,))
+            finally:
+                gate.set()
+            for job in [held] + accepted:
+                assert job.wait(30) and job.result() == expected
+            print(f" Full queue refused a search after {len(accepted)} more were accepted")
+        finally:
+            pipeline.close()
+        del store
+
+
+def _is_prime_reference(n):
+    """Miller-Rabin on the primes to 41, deterministic far beyond 2^64"""
+    bases = (2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41)
+    if n < 2:
+        return False
+    for p in bases:
+        if n % p == 0:
+            return n == p
+    d, r = n - 1, 0
+    while d % 2 == 0:
+        d //= 2
+        r += 1
+    for a in bases:
+        x = pow(a, d, n)
+        if x in (1, n - 1):
+            continue
+        for _ in range(r - 1):
+            x = x * x % n
+            if x == n - 1:
+                break
+        else:
+            return False
+    return True
+
+
+def test_ntt_primes(fhe):
+    """Test the Miller-Rabin and the NTT-friendly prime search against known values"""
+    print("\n" + "=" * 60)
+    print("TEST 10: NTT-Friendly Primes")
+    print("=" * 60)
+
+    if not fhe.use_cpp:
+        print(" Skipped (needs the C++ backend)")
+        return
+
+    import fhe_fast_mult
+
+    # Every n below 2^14 against a sieve
+    limit = 1 << 14
+    sieve = [False, False] + [True] * (limit - 2)
+    for i in range(2, int(limit ** 0.5) + 1):
+        if sieve[i]:
+            sieve[i * i::i] = [False] * len(sieve[i * i::i])
+    assert all(fhe_fast_mult.is_prime(n) == sieve[n] for n in range(limit))
+
+    primes = [
+        65537, 2 ** 31 - 1, 2 ** 61 - 1,
+        73, 193, 407521, 299210837,             # Factors of the witnesses 28178, 9780504, 1795265022
+        1152921504606830593,                    # Largest 60-bit p = 1 (mod 2 * 4096)
+        2 ** 64 - 59,                           # Largest prime below 2^64
+    ]
+    composites = [
+        561, 1105, 1729, 2465, 2821, 6601, 8911,    # Carmichael numbers
+        3215031751,                             # Strong pseudoprime to bases 2, 3, 5, 7
+        3825123056546413051,                    # Strong pseudoprime to every prime base up to 23
+        73 * 193, 41 * 41, (2 ** 31 - 1) ** 2,
+        1152921504606830593 * 3, 2 ** 64 - 1,
+    ]
+    for n in primes:
+        assert fhe_fast_mult.is_prime(n), n
+    for n in composites:
+        assert not fhe_fast_mult.is_prime(n), n
+    print(f" is_prime agrees with a sieve below {limit} and on {len(primes) + len(composites)} known values")
+
+    # The search returns the largest primes 1 (mod 2N), descending, skipping none
+    N, m = 4096, 2 * 4096
+    found = fhe_fast_mult.find_ntt_primes(N, 60, 8)
+    assert found[0] == 1152921504606830593
+    assert found == sorted(found, reverse=True) and len(set(found)) == 8
+    expected = []
+    cand = ((2 ** 60 - 1) // m) * m + 1
+    while len(expected) < 8:
+        if _is_prime_reference(cand):
+            expected.append(cand)
+        cand -= m
+    assert found == expected
+    assert fhe_fast_mult.find_ntt_prime(N, 60) == found[0]
+
+    # A SEAL-style chain: sizes respected, equal sizes descending, exclusions honoured
+    chain = fhe_fast_mult.find_ntt_prime_chain(N, [60, 40, 40, 60])
+    assert [p.bit_length() for p in chain] == [60, 40, 40, 60]
+    assert chain[0] > chain[3] and chain[1] > chain[2] and len(set(chain)) == 4
+    assert all(p % m == 1 and _is_prime_reference(p) for p in chain)
+    assert chain[0] == found[0] and chain[3] == found[1]
+    shifted = fhe_fast_mult.find_ntt_prime_chain(N, [60, 40], exclude=[chain[0], chain[1]])
+    assert shifted == [chain[3], chain[2]]
+
+    assert _raises(fhe_fast_mult.find_ntt_primes, N, 63, 1)
+    assert _raises(fhe_fast_mult.find_ntt_primes, 1024, 12, 1, errors=(RuntimeError,))
+    print(f" Prime search matches the reference: {found[0]} ... {found[-1]}")
+
+
+class _FakeShard:
+    """In-process stand-in for one server_api worker's /shard endpoints"""
+
+    def __init__(self, path, pipeline):
+        self.path = path
+        self.pipeline = pipeline
+        self.store = None
+        self.range = None
+        self.sessions = set()
+        self.fail_uploads = False
+        self.uploads = 0
+        self.session_requests = 0
+
+    def post(self, path, files=None, data=None, json=None):
+        from types import SimpleNamespace
+        from custom_fhe import db_store, sharding
+        if path == "/shard/db":
+            if self.fail_uploads:
+                raise ValueError("Shard row count does not match its range")      # A 400
+            batches = {name: content for _, (name, content) in files}
+            sharding.check_shard_batches(batches, data['row_begin'], data['row_end'])
+            self.store = None                                                       # Unmap first
+            db_store.build_store_from_batches(self.path, batches, ntt=bool(data['ntt']))
+            self.store = db_store.open_store(self.path)
+            self.range = (data['row_begin'], data['row_end'])
+            self.sessions.clear()
+            self.uploads += 1
+            return SimpleNamespace(json=lambda: {"rows": self.store.num_rows()})
+        if path == "/shard/session":
+            self.session_requests += 1
+            store = self.store
+            if (json['N'], json['q'], json['t']) != (store.get_N(), store.get_q(), store.get_t()) or \
+                    (json['row_begin'], json['row_end']) != self.range:
+                raise ValueError("Parameters do not match this shard")
+            session = f"s{self.session_requests}"
+            self.sessions.add(session)
+            return SimpleNamespace(json=lambda: {"session": session})
+        if path == "/shard/search":
+            if data['session'] not in self.sessions:
+                raise sharding.SessionExpired(self.path)                            # A 410
+            job = self.pipeline.submit(self.store, data['column'], files['query_file'])
+            assert job.wait(30)
+            return SimpleNamespace(content=job.result())
+        raise AssertionError(f"Unexpected worker path {path}")
+
+
+def test_sharding(fhe):
+    """Test the shard coordinator against in-process workers"""
+    print("\n" + "=" * 60)
+    print("TEST 11: Sharded Store")
+    print("=" * 60)
+
+    if not fhe.use_cpp:
+        print(" Skipped (needs the C++ backend)")
+        return
+
+    import asyncio
+    import os
+    import tempfile
+    from custom_fhe import db_store, serialization, sharding
+
+    if sharding.requests is None:
+        print(" Skipped (needs the requests package)")
+        return
+
+    import fhe_fast_mult
+
+    # Row ranges: contiguous, sizes differing by at most one, empty shards allowed
+    assert sharding.shard_ranges(7, 3) == [(0, 3), (3, 5), (5, 7)]
+    assert sharding.shard_ranges(2, 3) == [(0, 1), (1, 2), (2, 2)]
+    assert sharding.shard_ranges(6, 1) == [(0, 6)]
+    assert _raises(sharding.shard_ranges, 5, 0)
+
+    rows = 7
+    queries = [fhe.encrypt(fhe.encode(20260203)), fhe.encrypt_symmetric(fhe.encode(5))]
+    query = serialization.dumps(queries, fhe.N, fhe.q, fhe.t)
+
+    def table(base):
+        return serialization.dumps([fhe.encrypt(fhe.encode(base + i)) for i in range(rows)],
+                                   fhe.N, fhe.q, fhe.t)
+
+    # Worker-side upload validation (server_api's /shard/db answers 400 on these)
+    old, new = table(20260200), table(20260300)
+    sharding.check_shard_batches({'date': old}, 0, rows)
+    sharding.check_shard_batches({'date': old, 'id': new}, 10, 10 + rows)
+    bad = {
+        'short range': ({'date': old}, 0, rows - 1),
+        'negative begin': ({'date': old}, -1, rows - 1),
+        'uneven columns': ({'date': old, 'id': fhe_fast_mult.slice_ciphertexts(new, 0, 3)}, 0, rows),
+        'garbage batch': ({'date': b'not a batch'}, 0, rows),
+        'no columns': ({}, 0, 0),
+    }
+    for name, args in bad.items():
+        assert _raises(sharding.check_shard_batches, *args), f"Accepted a shard with {name}"
+    print(f" Shard ranges and upload validation ({len(bad)} bad uploads refused)")
+
+    with tempfile.TemporaryDirectory() as tmp:
+        pipeline = db_store.SearchPipeline(max_pending=8)
+        shards = [_FakeShard(os.path.join(tmp, f'shard{i}.fhes'), pipeline) for i in range(3)]
+        coordinator = sharding.ShardCoordinator([f"http://worker{i}" for i in range(3)])
+        coordinator._post = lambda i, path, **kwargs: shards[i].post(path, **kwargs)
+
+        def expected(columns, column):
+            # What one node holding the whole table returns
+            path = os.path.join(tmp, 'whole.fhes')
+            db_store.build_store_from_batches(path, columns, ntt=True)
+            job = pipeline.submit(db_store.open_store(path), column, query)
+            assert job.wait(30)
+            return job.result()
+
+        def search(column):
+            return asyncio.run(coordinator.search(column, query))
+
+        try:
+            # Each worker holds its row range; the merged result is the single-node one
+            columns = {'date': old, 'id': new}
+            assert coordinator.upload(columns) == rows and coordinator.num_rows() == rows
+            assert [s.range for s in shards] == sharding.shard_ranges(rows, len(shards))
+            assert [s.store.num_rows() for s in shards] == [3, 2, 2]
+            for column in columns:
+                assert search(column) == expected(columns, column), f"Merged '{column}' differs"
+            assert fhe_fast_mult.ciphertext_batch_info(search('date'))[3] == rows * len(queries)
+            assert _raises(search, 'missing')
+            print(f" {rows} rows x {len(queries)} targets merged across {len(shards)} shards")
+
+            # A restarted worker forgets its sessions: the 410 renegotiates that shard only
+            requests_before = [s.session_requests for s in shards]
+            shards[2].sessions.clear()
+            assert search('date') == expected(columns, 'date')
+            assert [s.session_requests - r for s, r in zip(shards, requests_before)] == [0, 0, 1]
+
+            # ...unless it came back holding other rows, which the renegotiation refuses
+            shards[2].sessions.clear()
+            shards[2].range = (5, 6)
+            assert _raises(search, 'date')
+            shards[2].range = (5, 7)
+            print(" Expired sessions are renegotiated; a mismatched shard is refused")
+
+            # A worker refusing its shard (the last, so the others are done): they hold
+            # the new table under the old row ranges, so no search may be served at all
+            shards[2].fail_uploads = True
+            assert _raises(coordinator.upload, {'date': new})
+            assert shards[0].uploads == 2 and shards[1].uploads == 2 and shards[2].uploads == 1
+            assert coordinator.params is None
+            assert _raises(search, 'date', errors=(RuntimeError,))
+            shards[2].fail_uploads = False
+            assert coordinator.upload({'date': new}) == rows
+            assert search('date') == expected({'date': new}, 'date')
+            print(" A failed upload leaves no table served until the next one succeeds")
+        finally:
+            coordinator.close()
+            pipeline.close()
+            for shard in shards:
+                shard.store = None
+
+
+def test_rns_multiplication(fhe):
+    """Test RNS BFV multiplication over Q = three 60-bit primes"""
+    print("\n" + "=" * 60)
+    print("TEST 12: RNS Multiplication")
+    print("=" * 60)
+
+    if not fhe.use_cpp:
+        print(" Skipped (needs the C++ backend)")
+        return
+
+    import fhe_fast_mult
+
+    # Its own ring: Q ~ 2^180 does not fit the scheme's single modulus
+    N, t = 4096, 1 << 25
+    primes = fhe_fast_mult.find_ntt_primes(N, 60, 3)
+    ctx = fhe_fast_mult.RNSContext(N, primes)
+    mult = fhe_fast_mult.RNSBFVMultiplier(N, primes, t)
+    assert mult.get_primes() == primes and ctx.modulus_bits() == 180
+    assert not set(mult.aux_primes()) & set(primes)
+
+    Q = 1
+    for p in primes:
+        Q *= p
+    delta = Q // t
+    moduli = np.array(primes, dtype=np.int64)[:, None]
+    crt = [(Q // p) * pow(Q // p, -1, p) for p in primes]
+    rng = np.random.default_rng(7)
+
+    # Plaintexts as {degree: coefficient}; products are negacyclic mod t
+    def poly_mul(a, b):
+        out = {}
+        for i, x in a.items():
+            for j, y in b.items():
+                k, sign = (i + j, 1) if i + j < N else (i + j - N, -1)
+                out[k] = (out.get(k, 0) + sign * x * y) % t
+        return {k: v for k, v in out.items() if v}
+
+    def small(low, high):
+        return rng.integers(low, high + 1, N) % moduli
+
+    def uniform():
+        return np.array([rng.integers(0, p, N) for p in primes], dtype=np.int64)
+
+    s = small(-1, 1)
+
+    def encrypt(m):
+        a = uniform()
+        scaled = np.zeros((len(primes), N), dtype=np.int64)
+        for i, p in enumerate(primes):
+            for k, v in m.items():
+                scaled[i, k] = delta * v % p
+        return [(scaled + small(-3, 3) - ctx.multiply(a, s)) % moduli, a]
+
+    def decrypt(ct):
+        # c0 + c1 s + c2 s^2 over Q, CRT-combined per coefficient, then round(t x / Q)
+        x, power = ct[0], s
+        for c in ct[1:]:
+            x = (x + ctx.multiply(c, power)) % moduli
+            power = ctx.multiply(power, s)
+        out = {}
+        for j in range(N):
+            v = sum(int(x[i, j]) * crt[i] for i in range(len(primes))) % Q
+            m = (v * t + Q // 2) // Q % t
+            if m:
+                out[j] = m
+        return out
+
+    # Digit i encrypts g_i s^2, g_i the CRT idempotent of q_i: s^2 in limb i, 0 elsewhere
+    s2 = ctx.multiply(s, s)
+    key_b, key_a = [], []
+    for i in range(len(primes)):
+        a = uniform()
+        g_s2 = np.zeros_like(s2)
+        g_s2[i] = s2[i]
+        key_b.append((g_s2 + small(-3, 3) - ctx.multiply(a, s)) % moduli)
+        key_a.append(a)
+    mult.set_relin_key(key_b, key_a)
+    assert mult.has_relin_key()
+
+    m1, m2 = {0: 3, 1: 1}, {0: 2, N - 1: 5}              # x^(N-1) wraps negacyclically
+    m3, m4 = {0: 7, 5: t - 1}, {2: 11}
+    c1, c2 = encrypt(m1), encrypt(m2)
+    assert decrypt(c1) == m1, "Fresh RNS ciphertext does not decrypt"
+
+    d = mult.multiply_ciphertexts(c1[0], c1[1], c2[0], c2[1])
+    assert decrypt(list(d)) == poly_mul(m1, m2), "Tensor product decrypts wrong"
+    r = mult.relinearize(*d)
+    assert decrypt(list(r)) == poly_mul(m1, m2), "Relinearized product decrypts wrong"
+    print(" Encrypt / multiply / relinearize round trip")
+
+    # NTT-form inputs give the same (exact) results as coefficient form
+    n1, n2 = [ctx.to_ntt(c) for c in c1], [ctx.to_ntt(c) for c in c2]
+    dn = mult.multiply_ciphertexts(n1[0], n1[1], n2[0], n2[1], ntt_form=True)
+    assert all(np.array_equal(x, y) for x, y in zip(dn, d))
+    rn = mult.relinearize(*[ctx.to_ntt(x) for x in d], ntt_form=True)
+    assert all(np.array_equal(ctx.to_coeff(x), y) for x, y in zip(rn, r))
+    print(" NTT-form inputs match coefficient form")
+
+    # Depth 3: ((m1 m2) m3) m4, relinearized after every product
+    ct, expected = c1, m1
+    for m in (m2, m3, m4):
+        other = encrypt(m)
+        ct = list(mult.relinearize(*mult.multiply_ciphertexts(ct[0], ct[1], other[0], other[1])))
+        expected = poly_mul(expected, m)
+    assert decrypt(ct) == expected, "Depth-3 product decrypts wrong"
+    print(f" Depth 3 over Q ~ 2^{ctx.modulus_bits()} decrypts correctly")
+
+
+def test_plaintext_ring_check(fhe):
+    """Test that encoded plaintexts only work with an evaluator for their own ring"""
+    print("\n" + "=" * 60)
+    print("TEST 13: Plaintext Ring Check")
+    print("=" * 60)
+
+    if not fhe.use_cpp:
+        print(" Skipped (needs the C++ backend)")
+        return
+
+    import fhe_fast_mult
+
+    ev = fhe_fast_mult.PlaintextEvaluator(fhe.N, fhe.q, fhe.t)
+    pt = ev.encode(5)
+    ct = np.array([np.asarray(c) for c in fhe.encrypt(fhe.encode(37)).get_components()], dtype=np.int64)
+    assert np.array_equal(ev.add_plain(ct, pt), ev.add_plain(ct, 5))
+
+    other_q = next(p for p in fhe_fast_mult.find_ntt_primes(fhe.N, 50, 2) if p != fhe.q)
+    foreign = {
+        'q': fhe_fast_mult.PlaintextEvaluator(fhe.N, other_q, fhe.t),
+        't': fhe_fast_mult.PlaintextEvaluator(fhe.N, fhe.q, 257),
+    }
+    for name, other in foreign.items():
+        for op in (other.add_plain, other.sub_plain, other.multiply_plain):
+            assert _raises(op, ct, pt), f"Accepted a plaintext encoded for another {name}"
+        assert _raises(other.scan_subtract_plain, ct.reshape(1, 2, fhe.N), [pt])
+        assert _raises(other.encode, pt)
+
+    # A smaller ring's plaintext would have been read past its end
+    small = fhe_fast_mult.PlaintextEvaluator(1024, fhe_fast_mult.find_ntt_prime(1024, 50), fhe.t)
+    assert _raises(ev.add_plain, ct, small.encode(5))
+    assert _raises(small.add_plain, np.zeros((2, 1024), dtype=np.int64), pt)
+    print(" Plaintexts from evaluators for another N, q or t are refused")
+
+
 def run_all_tests():
     """Run complete test suite"""
     print("\n" + "=" * 70)
@@ -241,7 +869,28 @@ def run_all_tests():
         
         # Test 6: Original use case
         match_success = test_exact_match_scenario(fhe)
-        
+
+        # Test 7: Wire format
+        test_serialization(fhe)
+
+        # Test 8: Ciphertext store
+        test_store(fhe)
+
+        # Test 9: Pipelined search
+        test_search_pipeline(fhe)
+
+        # Test 10: NTT-friendly primes
+        test_ntt_primes(fhe)
+
+        # Test 11: Sharding
+        test_sharding(fhe)
+
+        # Test 12: RNS multiplication
+        test_rns_multiplication(fhe)
+
+        # Test 13: Plaintext ring check
+        test_plaintext_ring_check(fhe)
+
         # Summary
         print("\n" + "=" * 70)
         print("TEST SUMMARY")